@@ -0,0 +1,170 @@
+#include "allocation-counter.h"
+#include "memory-tracker.h"
+
+#include <new>
+#include <limits>
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+
+#ifdef DDN_ALLOCATION_COUNTING_ENABLED
+
+namespace
+{
+
+// Every allocation is preceded by its requested size and memory tag, so that a deallocation can be charged to
+// the tag it was allocated under. Aligned allocations reserve a whole alignment unit for the header.
+struct AllocationHeader
+{
+    uint64_t size;
+    ddn::MemoryTag tag;
+};
+
+constexpr std::size_t s_header_size = alignof(std::max_align_t);
+static_assert(sizeof(AllocationHeader) <= s_header_size);
+
+void* Track(std::byte* base, std::size_t header_size, std::size_t size) noexcept
+{
+    auto* pointer = base + header_size;
+    auto* header = reinterpret_cast<AllocationHeader*>(pointer) - 1;
+    header->size = size;
+    header->tag = ddn::GetCurrentMemoryTag();
+    ddn::RecordAllocation(header->tag, size);
+    return pointer;
+}
+
+std::byte* Untrack(void* pointer, std::size_t header_size) noexcept
+{
+    const auto* header = static_cast<const AllocationHeader*>(pointer) - 1;
+    ddn::RecordDeallocation(header->tag, header->size);
+    return static_cast<std::byte*>(pointer) - header_size;
+}
+
+void* Allocate(std::size_t size)
+{
+    if (size > std::numeric_limits<std::size_t>::max() - s_header_size) {
+        throw std::bad_alloc();
+    }
+
+    auto* base = static_cast<std::byte*>(std::malloc(size + s_header_size));
+    if (!base) {
+        throw std::bad_alloc();
+    }
+    return Track(base, s_header_size, size);
+}
+
+void* AllocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    const auto alignment_size = std::max(static_cast<std::size_t>(alignment), s_header_size);
+    if (size > std::numeric_limits<std::size_t>::max() - 2 * alignment_size) {
+        throw std::bad_alloc();
+    }
+
+    const auto aligned_size = (size + 2 * alignment_size - 1) & ~(alignment_size - 1);
+#ifdef _MSC_VER
+    auto* base = static_cast<std::byte*>(_aligned_malloc(aligned_size, alignment_size));
+#else
+    auto* base = static_cast<std::byte*>(std::aligned_alloc(alignment_size, aligned_size));
+#endif
+    if (!base) {
+        throw std::bad_alloc();
+    }
+    return Track(base, alignment_size, size);
+}
+
+void Deallocate(void* pointer) noexcept
+{
+    if (pointer) {
+        std::free(Untrack(pointer, s_header_size));
+    }
+}
+
+void DeallocateAligned(void* pointer, std::align_val_t alignment) noexcept
+{
+    if (pointer) {
+        auto* base = Untrack(pointer, std::max(static_cast<std::size_t>(alignment), s_header_size));
+#ifdef _MSC_VER
+        _aligned_free(base);
+#else
+        std::free(base);
+#endif
+    }
+}
+
+}
+
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new[](std::size_t size) { return Allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return AllocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return AllocateAligned(size, alignment); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try {
+        return Allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try {
+        return Allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* pointer) noexcept { Deallocate(pointer); }
+void operator delete[](void* pointer) noexcept { Deallocate(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { Deallocate(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { Deallocate(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { Deallocate(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { Deallocate(pointer); }
+void operator delete(void* pointer, std::align_val_t alignment) noexcept { DeallocateAligned(pointer, alignment); }
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept { DeallocateAligned(pointer, alignment); }
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept { DeallocateAligned(pointer, alignment); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t alignment) noexcept { DeallocateAligned(pointer, alignment); }
+
+#endif
+
+namespace ddn
+{
+
+AllocationCounters operator -(const AllocationCounters& lhs, const AllocationCounters& rhs)
+{
+    AllocationCounters counters;
+    counters.allocation_count = lhs.allocation_count - rhs.allocation_count;
+    counters.deallocation_count = lhs.deallocation_count - rhs.deallocation_count;
+    counters.allocated_size = lhs.allocated_size - rhs.allocated_size;
+    return counters;
+}
+
+AllocationCounters GetAllocationCounters()
+{
+    AllocationCounters counters;
+#ifdef DDN_ALLOCATION_COUNTING_ENABLED
+    for (size_t i = 0; i < s_memory_tag_count; ++i) {
+        const auto tag = static_cast<MemoryTag>(i);
+        if (!IsGpuMemoryTag(tag)) {
+            const auto tag_counters = GetMemoryTagCounters(tag);
+            counters.allocation_count += tag_counters.allocation_count;
+            counters.deallocation_count += tag_counters.deallocation_count;
+            counters.allocated_size += tag_counters.allocated_size;
+        }
+    }
+#endif
+    return counters;
+}
+
+bool IsAllocationCountingEnabled()
+{
+#ifdef DDN_ALLOCATION_COUNTING_ENABLED
+    return true;
+#else
+    return false;
+#endif
+}
+
+}  // namespace ddn
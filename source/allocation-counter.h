@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ddn
+{
+
+struct AllocationCounters
+{
+    uint64_t allocation_count = 0;
+    uint64_t deallocation_count = 0;
+    uint64_t allocated_size = 0;
+};
+
+AllocationCounters operator -(const AllocationCounters& lhs, const AllocationCounters& rhs);
+
+// Process-wide counts of global operator new/delete calls, summed over the CPU memory tags. All zero unless
+// the build replaces the global allocation functions (DDN_ALLOCATION_COUNTING_ENABLED).
+AllocationCounters GetAllocationCounters();
+bool IsAllocationCountingEnabled();
+
+}  // namespace ddn
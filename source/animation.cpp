@@ -0,0 +1,498 @@
+#include "animation.h"
+#include "simd.h"
+#include "profiler.h"
+#include "thread-pool.h"
+#include "memory-tracker.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr size_t s_character_grain_size = 4;
+constexpr float s_rotation_range = 0.70710678f;
+constexpr uint32_t s_rotation_max = 0x7fff;
+constexpr uint32_t s_vector_max = 0xffff;
+
+using ddn::Float4;
+using Key = std::array<uint16_t, 3>;
+
+uint16_t Quantize(float value, uint32_t max)
+{
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * max));
+}
+
+template <uint32_t Max>
+float Dequantize(uint32_t value)
+{
+    constexpr float s_scale = 1.0f / Max;
+    return static_cast<float>(value) * s_scale;
+}
+
+// The largest component is dropped and rebuilt from the unit length; its index goes into the top bits of the
+// first two components, and its sign is made positive since q and -q are the same rotation.
+Key EncodeRotation(const glm::quat& rotation)
+{
+    const std::array<float, 4> components = { rotation.x, rotation.y, rotation.z, rotation.w };
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; ++i) {
+        if (std::abs(components[i]) > std::abs(components[largest])) {
+            largest = i;
+        }
+    }
+
+    const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+    Key key = {};
+    for (uint32_t i = 0, k = 0; i < 4; ++i) {
+        if (i != largest) {
+            key[k++] = Quantize(components[i] * sign / s_rotation_range * 0.5f + 0.5f, s_rotation_max);
+        }
+    }
+    key[0] |= static_cast<uint16_t>((largest & 1) << 15);
+    key[1] |= static_cast<uint16_t>((largest >> 1) << 15);
+    return key;
+}
+
+glm::quat DecodeRotation(const Key& key)
+{
+    // Where the three stored components go for each index of the dropped one; avoids branching on it.
+    static constexpr uint8_t s_component_indexes[4][3] = { { 1, 2, 3 }, { 0, 2, 3 }, { 0, 1, 3 }, { 0, 1, 2 } };
+
+    const uint32_t largest = (key[0] >> 15) | (key[1] >> 15) << 1;
+    const float a = (Dequantize<s_rotation_max>(key[0] & s_rotation_max) * 2.0f - 1.0f) * s_rotation_range;
+    const float b = (Dequantize<s_rotation_max>(key[1] & s_rotation_max) * 2.0f - 1.0f) * s_rotation_range;
+    const float c = (Dequantize<s_rotation_max>(key[2] & s_rotation_max) * 2.0f - 1.0f) * s_rotation_range;
+
+    std::array<float, 4> components;
+    components[s_component_indexes[largest][0]] = a;
+    components[s_component_indexes[largest][1]] = b;
+    components[s_component_indexes[largest][2]] = c;
+    components[largest] = std::sqrt(std::max(0.0f, 1.0f - a * a - b * b - c * c));
+    return glm::quat(components[3], components[0], components[1], components[2]);
+}
+
+Key EncodeVector(const glm::vec3& value, const glm::vec3& min, const glm::vec3& extent)
+{
+    Key key = {};
+    for (int i = 0; i < 3; ++i) {
+        key[i] = extent[i] > 0.0f ? Quantize((value[i] - min[i]) / extent[i], s_vector_max) : 0;
+    }
+    return key;
+}
+
+glm::vec3 DecodeVector(const Key& key, const glm::vec3& min, const glm::vec3& extent)
+{
+    return min + glm::vec3(Dequantize<s_vector_max>(key[0]), Dequantize<s_vector_max>(key[1]), Dequantize<s_vector_max>(key[2])) * extent;
+}
+
+glm::quat Nlerp(const glm::quat& from, const glm::quat& to, float weight)
+{
+    const glm::quat blended = from * (1.0f - weight) + to * (glm::dot(from, to) < 0.0f ? -weight : weight);
+    return blended * (1.0f / std::sqrt(glm::dot(blended, blended)));
+}
+
+glm::mat4 ToMatrix(const ddn::JointTransform& transform)
+{
+    const glm::mat3 rotation = glm::mat3_cast(transform.rotation);
+    glm::mat4 matrix;
+    matrix[0] = glm::vec4(rotation[0] * transform.scale.x, 0.0f);
+    matrix[1] = glm::vec4(rotation[1] * transform.scale.y, 0.0f);
+    matrix[2] = glm::vec4(rotation[2] * transform.scale.z, 0.0f);
+    matrix[3] = glm::vec4(transform.translation, 1.0f);
+    return matrix;
+}
+
+void Multiply(const glm::mat4& lhs, const glm::mat4& rhs, glm::mat4& result)
+{
+    const Float4 column0 = Float4::Load(&lhs[0][0]);
+    const Float4 column1 = Float4::Load(&lhs[1][0]);
+    const Float4 column2 = Float4::Load(&lhs[2][0]);
+    const Float4 column3 = Float4::Load(&lhs[3][0]);
+    for (int i = 0; i < 4; ++i) {
+        const Float4 value = column0 * Float4::Splat(rhs[i][0]) + column1 * Float4::Splat(rhs[i][1]) + column2 * Float4::Splat(rhs[i][2]) + column3 * Float4::Splat(rhs[i][3]);
+        value.Store(&result[i][0]);
+    }
+}
+
+template <typename GetValue, typename IsEqual>
+bool IsConstant(size_t count, GetValue&& get_value, IsEqual&& is_equal)
+{
+    const auto first = get_value(0);
+    for (size_t i = 1; i < count; ++i) {
+        if (!is_equal(first, get_value(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+namespace ddn
+{
+
+Skeleton::Skeleton(std::vector<int32_t> parent_indexes, std::vector<JointTransform> bind_pose)
+    : m_parent_indexes(std::move(parent_indexes))
+    , m_bind_pose(std::move(bind_pose))
+{
+    if (m_parent_indexes.empty() || m_parent_indexes.size() != m_bind_pose.size()) {
+        throw std::invalid_argument("Expected one bind pose transform per joint");
+    }
+
+    std::vector<glm::mat4> model_matrices(m_parent_indexes.size());
+    m_inverse_bind_matrices.resize(m_parent_indexes.size());
+    for (size_t i = 0; i < m_parent_indexes.size(); ++i) {
+        const int32_t parent_index = m_parent_indexes[i];
+        if (parent_index >= static_cast<int32_t>(i)) {
+            throw std::invalid_argument("Expected parents to precede their children");
+        }
+
+        const auto local_matrix = ToMatrix(m_bind_pose[i]);
+        model_matrices[i] = parent_index < 0 ? local_matrix : model_matrices[parent_index] * local_matrix;
+        m_inverse_bind_matrices[i] = glm::inverse(model_matrices[i]);
+    }
+}
+
+uint32_t Skeleton::GetJointCount() const
+{
+    return static_cast<uint32_t>(m_parent_indexes.size());
+}
+
+std::span<const int32_t> Skeleton::GetParentIndexes() const
+{
+    return m_parent_indexes;
+}
+
+std::span<const JointTransform> Skeleton::GetBindPose() const
+{
+    return m_bind_pose;
+}
+
+std::span<const glm::mat4> Skeleton::GetInverseBindMatrices() const
+{
+    return m_inverse_bind_matrices;
+}
+
+AnimationClip::AnimationClip(const RawAnimationClip& raw_clip, const AnimationCompressionDesc& desc)
+    : m_sample_rate(raw_clip.sample_rate)
+{
+    if (raw_clip.tracks.empty() || raw_clip.tracks.front().empty() || raw_clip.sample_rate <= 0.0f) {
+        throw std::invalid_argument("Expected non-empty clip with positive sample rate");
+    }
+
+    MemoryTagScope tag_scope(MemoryTag::Animation);
+    m_frame_count = static_cast<uint32_t>(raw_clip.tracks.front().size());
+    m_duration = (m_frame_count - 1) / m_sample_rate;
+
+    const double min_rotation_dot = std::cos(0.5 * desc.rotation_tolerance);
+    m_tracks.resize(raw_clip.tracks.size());
+    for (size_t joint = 0; joint < raw_clip.tracks.size(); ++joint) {
+        const auto& keys = raw_clip.tracks[joint];
+        if (keys.size() != m_frame_count) {
+            throw std::invalid_argument("Expected the same frame count for every track");
+        }
+
+        auto& track = m_tracks[joint];
+        // Unit quaternions an angle apart have |dot| = cos(angle / 2), which is too close to 1 for float.
+        const bool is_rotation_constant = IsConstant(keys.size(), [&](size_t i) { return glm::normalize(keys[i].rotation); }, [&](const glm::quat& lhs, const glm::quat& rhs) {
+            const double dot = double(lhs.x) * rhs.x + double(lhs.y) * rhs.y + double(lhs.z) * rhs.z + double(lhs.w) * rhs.w;
+            return std::abs(dot) >= min_rotation_dot;
+        });
+        track.rotation_first = static_cast<uint32_t>(m_rotation_keys.size());
+        track.rotation_stride = is_rotation_constant ? 0 : 1;
+        for (size_t i = 0; i < (is_rotation_constant ? 1 : keys.size()); ++i) {
+            m_rotation_keys.push_back(EncodeRotation(glm::normalize(keys[i].rotation)));
+        }
+
+        auto encode_vectors = [&](glm::vec3 JointTransform::* member, float tolerance, uint32_t& first, uint32_t& stride, glm::vec3& min, glm::vec3& extent, std::vector<Key>& output) {
+            glm::vec3 max = keys.front().*member;
+            min = max;
+            for (const auto& key : keys) {
+                min = glm::min(min, key.*member);
+                max = glm::max(max, key.*member);
+            }
+            const auto range = max - min;
+            const bool is_constant = std::max({ range.x, range.y, range.z }) <= tolerance;
+            extent = is_constant ? glm::vec3(0.0f) : max - min;
+            if (is_constant) {
+                min = keys.front().*member;
+            }
+
+            first = static_cast<uint32_t>(output.size());
+            stride = is_constant ? 0 : 1;
+            for (size_t i = 0; i < (is_constant ? 1 : keys.size()); ++i) {
+                output.push_back(EncodeVector(keys[i].*member, min, extent));
+            }
+        };
+        encode_vectors(&JointTransform::translation, desc.translation_tolerance, track.translation_first, track.translation_stride, track.translation_min, track.translation_extent, m_translation_keys);
+        encode_vectors(&JointTransform::scale, desc.scale_tolerance, track.scale_first, track.scale_stride, track.scale_min, track.scale_extent, m_scale_keys);
+    }
+}
+
+float AnimationClip::GetDuration() const
+{
+    return m_duration;
+}
+
+uint32_t AnimationClip::GetJointCount() const
+{
+    return static_cast<uint32_t>(m_tracks.size());
+}
+
+size_t AnimationClip::GetSize() const
+{
+    return sizeof(*this) + m_tracks.size() * sizeof(Track) + (m_rotation_keys.size() + m_translation_keys.size() + m_scale_keys.size()) * sizeof(Key);
+}
+
+void AnimationClip::Sample(float time, std::span<JointTransform> pose) const
+{
+    if (pose.size() != m_tracks.size()) {
+        throw std::invalid_argument("Pose joint count does not match clip");
+    }
+
+    float frame = 0.0f;
+    if (m_duration > 0.0f) {
+        frame = (time - std::floor(time / m_duration) * m_duration) * m_sample_rate;
+    }
+    const uint32_t frame0 = std::min(static_cast<uint32_t>(frame), m_frame_count - 1);
+    const uint32_t frame1 = std::min(frame0 + 1, m_frame_count - 1);
+    const float weight = std::clamp(frame - frame0, 0.0f, 1.0f);
+
+    for (size_t joint = 0; joint < m_tracks.size(); ++joint) {
+        const auto& track = m_tracks[joint];
+        auto& transform = pose[joint];
+
+        const auto rotation0 = DecodeRotation(m_rotation_keys[track.rotation_first + frame0 * track.rotation_stride]);
+        transform.rotation = track.rotation_stride == 0 ? rotation0 : Nlerp(rotation0, DecodeRotation(m_rotation_keys[track.rotation_first + frame1]), weight);
+
+        const auto translation0 = DecodeVector(m_translation_keys[track.translation_first + frame0 * track.translation_stride], track.translation_min, track.translation_extent);
+        transform.translation = track.translation_stride == 0 ? translation0 : glm::mix(translation0, DecodeVector(m_translation_keys[track.translation_first + frame1], track.translation_min, track.translation_extent), weight);
+
+        const auto scale0 = DecodeVector(m_scale_keys[track.scale_first + frame0 * track.scale_stride], track.scale_min, track.scale_extent);
+        transform.scale = track.scale_stride == 0 ? scale0 : glm::mix(scale0, DecodeVector(m_scale_keys[track.scale_first + frame1], track.scale_min, track.scale_extent), weight);
+    }
+}
+
+BlendNodeId BlendTree::AddClip(const AnimationClip& clip, float speed)
+{
+    Node node;
+    node.clip = &clip;
+    node.speed = speed;
+    m_nodes.push_back(std::move(node));
+    return static_cast<BlendNodeId>(m_nodes.size() - 1);
+}
+
+BlendNodeId BlendTree::AddBlend1D(uint32_t parameter_index, std::vector<float> thresholds, std::vector<BlendNodeId> children)
+{
+    if (children.empty() || children.size() != thresholds.size() || !std::is_sorted(thresholds.begin(), thresholds.end())) {
+        throw std::invalid_argument("Expected one ascending threshold per child");
+    }
+    // Children have to exist already, which also rules out cycles.
+    for (const auto child : children) {
+        if (child >= m_nodes.size()) {
+            throw std::invalid_argument("Unknown blend tree child");
+        }
+    }
+
+    Node node;
+    node.parameter_index = parameter_index;
+    node.thresholds = std::move(thresholds);
+    node.children = std::move(children);
+    m_nodes.push_back(std::move(node));
+    m_parameter_count = std::max(m_parameter_count, parameter_index + 1);
+    return static_cast<BlendNodeId>(m_nodes.size() - 1);
+}
+
+void BlendTree::SetRoot(BlendNodeId id)
+{
+    if (id >= m_nodes.size()) {
+        throw std::invalid_argument("Unknown blend tree root");
+    }
+    m_root = id;
+}
+
+uint32_t BlendTree::GetParameterCount() const
+{
+    return m_parameter_count;
+}
+
+uint32_t BlendTree::GetScratchPoseCount() const
+{
+    return m_nodes.empty() ? 0 : GetScratchPoseCount(m_root);
+}
+
+void BlendTree::Evaluate(float time, std::span<const float> parameters, std::span<JointTransform> pose, std::span<JointTransform> scratch) const
+{
+    if (m_nodes.empty()) {
+        throw std::logic_error("Blend tree is empty");
+    }
+    if (parameters.size() < m_parameter_count || scratch.size() < size_t(GetScratchPoseCount()) * pose.size()) {
+        throw std::invalid_argument("Not enough blend tree parameters or scratch poses");
+    }
+    Evaluate(m_root, time, parameters, pose, scratch);
+}
+
+void BlendTree::Evaluate(BlendNodeId id, float time, std::span<const float> parameters, std::span<JointTransform> pose, std::span<JointTransform> scratch) const
+{
+    const auto& node = m_nodes[id];
+    if (node.clip) {
+        node.clip->Sample(time * node.speed, pose);
+        return;
+    }
+
+    const float parameter = parameters[node.parameter_index];
+    const auto upper = std::upper_bound(node.thresholds.begin(), node.thresholds.end(), parameter);
+    if (upper == node.thresholds.begin()) {
+        Evaluate(node.children.front(), time, parameters, pose, scratch);
+        return;
+    }
+    if (upper == node.thresholds.end()) {
+        Evaluate(node.children.back(), time, parameters, pose, scratch);
+        return;
+    }
+
+    const size_t index = upper - node.thresholds.begin();
+    const float weight = (parameter - node.thresholds[index - 1]) / (node.thresholds[index] - node.thresholds[index - 1]);
+    const auto other_pose = scratch.first(pose.size());
+    Evaluate(node.children[index - 1], time, parameters, pose, scratch.subspan(pose.size()));
+    Evaluate(node.children[index], time, parameters, other_pose, scratch.subspan(pose.size()));
+    BlendPoses(pose, other_pose, weight, pose);
+}
+
+uint32_t BlendTree::GetScratchPoseCount(BlendNodeId id) const
+{
+    const auto& node = m_nodes[id];
+    uint32_t count = 0;
+    for (const auto child : node.children) {
+        count = std::max(count, 1 + GetScratchPoseCount(child));
+    }
+    return count;
+}
+
+void BlendPoses(std::span<const JointTransform> from, std::span<const JointTransform> to, float weight, std::span<JointTransform> pose)
+{
+    for (size_t i = 0; i < pose.size(); ++i) {
+        pose[i].rotation = Nlerp(from[i].rotation, to[i].rotation, weight);
+        pose[i].translation = glm::mix(from[i].translation, to[i].translation, weight);
+        pose[i].scale = glm::mix(from[i].scale, to[i].scale, weight);
+    }
+}
+
+CharacterId AnimationSystem::AddCharacter(const Skeleton& skeleton, const BlendTree& blend_tree, float time)
+{
+    MemoryTagScope tag_scope(MemoryTag::Animation);
+    const uint32_t joint_count = skeleton.GetJointCount();
+
+    Character character;
+    character.skeleton = &skeleton;
+    character.blend_tree = &blend_tree;
+    character.time = time;
+    character.parameters.resize(blend_tree.GetParameterCount());
+    character.pose.resize(joint_count);
+    character.scratch.resize(size_t(blend_tree.GetScratchPoseCount()) * joint_count);
+    character.model_matrices.resize(joint_count);
+    character.skinning_matrices.resize(joint_count);
+    m_characters.push_back(std::move(character));
+    return static_cast<CharacterId>(m_characters.size() - 1);
+}
+
+void AnimationSystem::SetParameter(CharacterId id, uint32_t parameter_index, float value)
+{
+    m_characters.at(id).parameters.at(parameter_index) = value;
+}
+
+void AnimationSystem::Update(float delta_time)
+{
+    DDN_PROFILE_SCOPE("AnimationSystem::Update");
+
+    ParallelFor(0, m_characters.size(), s_character_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_characters[i].time += delta_time;
+            UpdateCharacter(m_characters[i]);
+        }
+    });
+}
+
+uint32_t AnimationSystem::GetCharacterCount() const
+{
+    return static_cast<uint32_t>(m_characters.size());
+}
+
+std::span<const glm::mat4> AnimationSystem::GetSkinningMatrices(CharacterId id) const
+{
+    return m_characters.at(id).skinning_matrices;
+}
+
+void AnimationSystem::UpdateCharacter(Character& character)
+{
+    character.blend_tree->Evaluate(character.time, character.parameters, character.pose, character.scratch);
+
+    const auto parent_indexes = character.skeleton->GetParentIndexes();
+    const auto inverse_bind_matrices = character.skeleton->GetInverseBindMatrices();
+    for (size_t i = 0; i < parent_indexes.size(); ++i) {
+        const auto local_matrix = ToMatrix(character.pose[i]);
+        if (parent_indexes[i] < 0) {
+            character.model_matrices[i] = local_matrix;
+        } else {
+            Multiply(character.model_matrices[parent_indexes[i]], local_matrix, character.model_matrices[i]);
+        }
+        Multiply(character.model_matrices[i], inverse_bind_matrices[i], character.skinning_matrices[i]);
+    }
+}
+
+void SkinVertices(std::span<const SkinningJob> jobs)
+{
+    DDN_PROFILE_SCOPE("SkinVertices");
+
+    for (const auto& job : jobs) {
+        if (job.output.size() < job.vertices.size()) {
+            throw std::invalid_argument("Skinning output is smaller than the input");
+        }
+    }
+
+    ParallelFor(0, jobs.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t job_index = begin; job_index < end; ++job_index) {
+            const auto& job = jobs[job_index];
+            const auto joint_count = job.skinning_matrices.size();
+
+            for (size_t i = 0; i < job.vertices.size(); ++i) {
+                const auto& vertex = job.vertices[i];
+
+                // Blend the matrices first, then transform once; columns are SIMD vectors.
+                Float4 column0 = Float4::Splat(0.0f);
+                Float4 column1 = column0;
+                Float4 column2 = column0;
+                Float4 column3 = column0;
+                for (int k = 0; k < 4; ++k) {
+                    if (vertex.joints[k] >= joint_count) {
+                        throw std::out_of_range("Skinning joint index out of range");
+                    }
+                    const auto& matrix = job.skinning_matrices[vertex.joints[k]];
+                    const Float4 weight = Float4::Splat(vertex.weights[k]);
+                    column0 = column0 + Float4::Load(&matrix[0][0]) * weight;
+                    column1 = column1 + Float4::Load(&matrix[1][0]) * weight;
+                    column2 = column2 + Float4::Load(&matrix[2][0]) * weight;
+                    column3 = column3 + Float4::Load(&matrix[3][0]) * weight;
+                }
+
+                const Float4 position = column0 * Float4::Splat(vertex.position.x) + column1 * Float4::Splat(vertex.position.y) + column2 * Float4::Splat(vertex.position.z) + column3;
+                Float4 normal = column0 * Float4::Splat(vertex.normal.x) + column1 * Float4::Splat(vertex.normal.y) + column2 * Float4::Splat(vertex.normal.z);
+                const float length_squared = HorizontalSum(normal * normal);
+                normal = normal * Float4::Splat(length_squared > 0.0f ? 1.0f / std::sqrt(length_squared) : 0.0f);
+
+                alignas(16) float position_values[4];
+                alignas(16) float normal_values[4];
+                position.Store(position_values);
+                normal.Store(normal_values);
+                job.output[i].position = glm::vec3(position_values[0], position_values[1], position_values[2]);
+                job.output[i].normal = glm::vec3(normal_values[0], normal_values[1], normal_values[2]);
+            }
+        }
+    });
+}
+
+}  // namespace ddn
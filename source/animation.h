@@ -0,0 +1,194 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <span>
+#include <array>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+struct JointTransform
+{
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+};
+
+// Joints are ordered so that every parent comes before its children; the root has parent index -1.
+class Skeleton
+{
+public:
+    Skeleton(std::vector<int32_t> parent_indexes, std::vector<JointTransform> bind_pose);
+
+    uint32_t GetJointCount() const;
+    std::span<const int32_t> GetParentIndexes() const;
+    std::span<const JointTransform> GetBindPose() const;
+    std::span<const glm::mat4> GetInverseBindMatrices() const;
+
+private:
+    std::vector<int32_t> m_parent_indexes;
+    std::vector<JointTransform> m_bind_pose;
+    std::vector<glm::mat4> m_inverse_bind_matrices;
+};
+
+struct RawAnimationClip
+{
+    float sample_rate = 30.0f;
+    // Local transforms indexed by joint, then by frame; every track has the same number of frames.
+    std::vector<std::vector<JointTransform>> tracks;
+};
+
+struct AnimationCompressionDesc
+{
+    // Tracks that stay within these tolerances of their first key are stored as a single key. The rotation
+    // tolerance is an angle in radians, the others are distances in the track's units.
+    float rotation_tolerance = 1e-3f;
+    float translation_tolerance = 1e-4f;
+    float scale_tolerance = 1e-4f;
+};
+
+// Uniformly sampled clip with 6-byte keys: rotations use the smallest-three encoding with 15 bits per
+// component, translations and scales are quantized to 16 bits within each track's range.
+class AnimationClip
+{
+public:
+    explicit AnimationClip(const RawAnimationClip& raw_clip, const AnimationCompressionDesc& desc = {});
+
+    float GetDuration() const;
+    uint32_t GetJointCount() const;
+    size_t GetSize() const;
+
+    // Wraps time into the clip and interpolates between the two nearest frames.
+    void Sample(float time, std::span<JointTransform> pose) const;
+
+private:
+    using Key = std::array<uint16_t, 3>;
+
+    struct Track
+    {
+        uint32_t rotation_first = 0;
+        uint32_t translation_first = 0;
+        uint32_t scale_first = 0;
+        uint32_t rotation_stride = 0;
+        uint32_t translation_stride = 0;
+        uint32_t scale_stride = 0;
+        glm::vec3 translation_min = glm::vec3(0.0f);
+        glm::vec3 translation_extent = glm::vec3(0.0f);
+        glm::vec3 scale_min = glm::vec3(0.0f);
+        glm::vec3 scale_extent = glm::vec3(0.0f);
+    };
+
+private:
+    float m_sample_rate = 0.0f;
+    float m_duration = 0.0f;
+    uint32_t m_frame_count = 0;
+    std::vector<Track> m_tracks;
+    std::vector<Key> m_rotation_keys;
+    std::vector<Key> m_translation_keys;
+    std::vector<Key> m_scale_keys;
+};
+
+using BlendNodeId = uint32_t;
+
+// Clip nodes sample a clip at the character's time scaled by their speed; 1D blend nodes pick the two
+// children whose thresholds bracket a character parameter and blend them, so only those two are evaluated.
+class BlendTree
+{
+public:
+    BlendNodeId AddClip(const AnimationClip& clip, float speed = 1.0f);
+    BlendNodeId AddBlend1D(uint32_t parameter_index, std::vector<float> thresholds, std::vector<BlendNodeId> children);
+    void SetRoot(BlendNodeId id);
+
+    uint32_t GetParameterCount() const;
+    // Number of scratch poses Evaluate needs.
+    uint32_t GetScratchPoseCount() const;
+
+    void Evaluate(float time, std::span<const float> parameters, std::span<JointTransform> pose, std::span<JointTransform> scratch) const;
+
+private:
+    struct Node
+    {
+        const AnimationClip* clip = nullptr;
+        float speed = 1.0f;
+        uint32_t parameter_index = 0;
+        std::vector<float> thresholds;
+        std::vector<BlendNodeId> children;
+    };
+
+    void Evaluate(BlendNodeId id, float time, std::span<const float> parameters, std::span<JointTransform> pose, std::span<JointTransform> scratch) const;
+    uint32_t GetScratchPoseCount(BlendNodeId id) const;
+
+private:
+    std::vector<Node> m_nodes;
+    BlendNodeId m_root = 0;
+    uint32_t m_parameter_count = 0;
+};
+
+void BlendPoses(std::span<const JointTransform> from, std::span<const JointTransform> to, float weight, std::span<JointTransform> pose);
+
+using CharacterId = uint32_t;
+
+// Advances, samples and blends every character in parallel and produces its skinning matrices, i.e. model
+// space joint matrices multiplied by the inverse bind matrices.
+class AnimationSystem
+{
+public:
+    CharacterId AddCharacter(const Skeleton& skeleton, const BlendTree& blend_tree, float time = 0.0f);
+
+    void SetParameter(CharacterId id, uint32_t parameter_index, float value);
+    void Update(float delta_time);
+
+    uint32_t GetCharacterCount() const;
+    std::span<const glm::mat4> GetSkinningMatrices(CharacterId id) const;
+
+private:
+    struct Character
+    {
+        const Skeleton* skeleton = nullptr;
+        const BlendTree* blend_tree = nullptr;
+        float time = 0.0f;
+        std::vector<float> parameters;
+        std::vector<JointTransform> pose;
+        std::vector<JointTransform> scratch;
+        std::vector<glm::mat4> model_matrices;
+        std::vector<glm::mat4> skinning_matrices;
+    };
+
+    static void UpdateCharacter(Character& character);
+
+private:
+    std::vector<Character> m_characters;
+};
+
+struct SkinVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    std::array<uint16_t, 4> joints = {};
+    glm::vec4 weights;
+};
+
+struct SkinnedVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+struct SkinningJob
+{
+    std::span<const SkinVertex> vertices;
+    std::span<const glm::mat4> skinning_matrices;
+    std::span<SkinnedVertex> output;
+};
+
+// Linear blend skinning, parallel over jobs. Normals go through the blended matrix and are renormalized,
+// which is exact only for rigid and uniformly scaled joints.
+void SkinVertices(std::span<const SkinningJob> jobs);
+
+}  // namespace ddn
@@ -0,0 +1,742 @@
+#include "async-io.h"
+#include "profiler.h"
+#include "memory-tracker.h"
+
+#include <span>
+#include <atomic>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DDN_POSIX_IO
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#else
+#include <fstream>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define DDN_IO_URING_AVAILABLE
+#include <sys/mman.h>
+#include <linux/io_uring.h>
+#endif
+#endif
+
+namespace
+{
+
+// Larger reads go through the plain read path so that a single request never exceeds the 32-bit length.
+constexpr uint64_t s_max_ring_read_size = 1ull << 30;
+
+bool IsLessUrgent(ddn::IoPriority lhs_priority, uint64_t lhs_sequence, ddn::IoPriority rhs_priority, uint64_t rhs_sequence)
+{
+    return lhs_priority != rhs_priority ? lhs_priority < rhs_priority : lhs_sequence > rhs_sequence;
+}
+
+class File
+{
+public:
+    explicit File(const std::filesystem::path& path)
+    {
+#ifdef DDN_POSIX_IO
+        m_descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (m_descriptor < 0) {
+            throw std::runtime_error("Failed to open file");
+        }
+#else
+        m_stream.open(path, std::ios::binary);
+        if (!m_stream) {
+            throw std::runtime_error("Failed to open file");
+        }
+#endif
+    }
+
+    ~File()
+    {
+#ifdef DDN_POSIX_IO
+        close(m_descriptor);
+#endif
+    }
+
+    File(const File& other) = delete;
+    File& operator =(const File& other) = delete;
+
+    uint64_t GetSize()
+    {
+#ifdef DDN_POSIX_IO
+        struct stat status = {};
+        if (fstat(m_descriptor, &status) != 0) {
+            throw std::runtime_error("Failed to query file size");
+        }
+        return static_cast<uint64_t>(status.st_size);
+#else
+        m_stream.seekg(0, std::ios::end);
+        return static_cast<uint64_t>(m_stream.tellg());
+#endif
+    }
+
+    // Returns the number of bytes read, which is short only at the end of the file.
+    uint64_t Read(uint64_t offset, std::span<uint8_t> data)
+    {
+#ifdef DDN_POSIX_IO
+        uint64_t read_size = 0;
+        while (read_size < data.size()) {
+            const auto result = pread(m_descriptor, data.data() + read_size, data.size() - read_size, static_cast<off_t>(offset + read_size));
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result < 0) {
+                throw std::runtime_error("Failed to read file");
+            }
+            if (result == 0) {
+                break;
+            }
+            read_size += static_cast<uint64_t>(result);
+        }
+        return read_size;
+#else
+        m_stream.clear();
+        m_stream.seekg(static_cast<std::streamoff>(offset));
+        m_stream.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        return static_cast<uint64_t>(m_stream.gcount());
+#endif
+    }
+
+#ifdef DDN_POSIX_IO
+    int GetDescriptor() const
+    {
+        return m_descriptor;
+    }
+#endif
+
+private:
+#ifdef DDN_POSIX_IO
+    int m_descriptor = -1;
+#else
+    std::ifstream m_stream;
+#endif
+};
+
+// Sizes the batch to what the file holds; reads past the end are reported per request.
+uint64_t PrepareBatchData(File& file, uint64_t offset, uint64_t size, std::vector<uint8_t>& data)
+{
+    const uint64_t file_size = file.GetSize();
+    if (offset > file_size) {
+        throw std::runtime_error("Read offset exceeds file size");
+    }
+    data.resize(static_cast<size_t>(std::min(size, file_size - offset)));
+    return data.size();
+}
+
+}
+
+namespace ddn
+{
+
+#ifdef DDN_IO_URING_AVAILABLE
+
+// Minimal io_uring wrapper over the raw system calls, so no liburing dependency is needed. Reads fall
+// back to pread when the kernel rejects the ring or the read opcode, or when entering the ring fails.
+class AsyncIo::Ring
+{
+public:
+    explicit Ring(uint32_t entry_count)
+    {
+        io_uring_params params = {};
+        m_descriptor = static_cast<int>(syscall(__NR_io_uring_setup, entry_count, &params));
+        if (m_descriptor < 0) {
+            return;
+        }
+
+        m_sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool is_single_map = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (is_single_map) {
+            m_sq_size = std::max(m_sq_size, m_cq_size);
+        }
+
+        m_sq_pointer = Map(m_sq_size, IORING_OFF_SQ_RING);
+        m_cq_pointer = is_single_map ? m_sq_pointer : Map(m_cq_size, IORING_OFF_CQ_RING);
+        m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = static_cast<io_uring_sqe*>(Map(m_sqes_size, IORING_OFF_SQES));
+        if (!m_sq_pointer || !m_cq_pointer || !m_sqes) {
+            Release();
+            return;
+        }
+
+        auto* sq = static_cast<uint8_t*>(m_sq_pointer);
+        m_sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+        m_sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+        m_sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+        auto* cq = static_cast<uint8_t*>(m_cq_pointer);
+        m_cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+        m_cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+        m_cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        m_entry_count = params.sq_entries;
+    }
+
+    ~Ring()
+    {
+        Release();
+    }
+
+    Ring(const Ring& other) = delete;
+    Ring& operator =(const Ring& other) = delete;
+
+    bool IsValid() const
+    {
+        return m_descriptor >= 0;
+    }
+
+    void ReadBatches(std::span<Batch> batches)
+    {
+        std::vector<std::optional<File>> files(batches.size());
+        std::vector<size_t> prepared_indexes;
+        for (size_t i = 0; i < batches.size(); ++i) {
+            auto& batch = batches[i];
+            try {
+                auto& file = files[i].emplace(batch.path);
+                const auto size = PrepareBatchData(file, batch.offset, batch.size, batch.data);
+                if (!m_is_read_supported || size == 0 || size > s_max_ring_read_size || prepared_indexes.size() == m_entry_count) {
+                    batch.data.resize(static_cast<size_t>(file.Read(batch.offset, batch.data)));
+                    continue;
+                }
+                PrepareRead(file.GetDescriptor(), batch.data, batch.offset, i);
+                prepared_indexes.push_back(i);
+            } catch (const std::exception& e) {
+                batch.error = e.what();
+            }
+        }
+
+        // The kernel may accept only part of the queued entries; the rest stay in the submission ring and go
+        // out with the next enter.
+        std::vector<bool> is_pending(batches.size());
+        for (const size_t index : prepared_indexes) {
+            is_pending[index] = true;
+        }
+        uint32_t queued_count = static_cast<uint32_t>(prepared_indexes.size());
+        uint32_t in_flight_count = 0;
+        try {
+            while (queued_count + in_flight_count > 0) {
+                uint64_t index = 0;
+                int32_t result = 0;
+                if (!PopCompletion(index, result)) {
+                    const uint32_t accepted_count = Enter(queued_count, 1);
+                    queued_count -= accepted_count;
+                    in_flight_count += accepted_count;
+                    continue;
+                }
+                --in_flight_count;
+                is_pending[index] = false;
+
+                // Short reads and retryable errors are finished with pread, as is everything after the kernel
+                // turns out not to support the read opcode.
+                if (result == -EINVAL || result == -EOPNOTSUPP) {
+                    m_is_read_supported = false;
+                } else if (result < 0 && result != -EINTR && result != -EAGAIN) {
+                    batches[index].error = "Failed to read file";
+                    continue;
+                }
+                ReadRemainder(*files[index], batches[index], result > 0 ? static_cast<uint64_t>(result) : 0);
+            }
+        } catch (const std::exception&) {
+            // The ring is unusable from here on. Entries the kernel never saw are taken back, the buffers of reads
+            // it may still complete are kept alive with the ring, and every unfinished batch is read with pread.
+            m_is_read_supported = false;
+            RetractSubmissions(queued_count);
+            const size_t accepted_count = prepared_indexes.size() - queued_count;
+            for (size_t i = 0; i < prepared_indexes.size(); ++i) {
+                const size_t index = prepared_indexes[i];
+                if (!is_pending[index]) {
+                    continue;
+                }
+                auto& batch = batches[index];
+                if (i < accepted_count) {
+                    m_abandoned_data.push_back(std::move(batch.data));
+                    batch.data = {};
+                }
+                try {
+                    PrepareBatchData(*files[index], batch.offset, batch.size, batch.data);
+                    ReadRemainder(*files[index], batch, 0);
+                } catch (const std::exception& e) {
+                    batch.error = e.what();
+                }
+            }
+        }
+    }
+
+private:
+    void* Map(size_t size, uint64_t offset)
+    {
+        void* pointer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_descriptor, static_cast<off_t>(offset));
+        return pointer == MAP_FAILED ? nullptr : pointer;
+    }
+
+    void Release()
+    {
+        if (m_sqes) {
+            munmap(m_sqes, m_sqes_size);
+        }
+        if (m_cq_pointer && m_cq_pointer != m_sq_pointer) {
+            munmap(m_cq_pointer, m_cq_size);
+        }
+        if (m_sq_pointer) {
+            munmap(m_sq_pointer, m_sq_size);
+        }
+        if (m_descriptor >= 0) {
+            close(m_descriptor);
+        }
+        m_sqes = nullptr;
+        m_cq_pointer = nullptr;
+        m_sq_pointer = nullptr;
+        m_descriptor = -1;
+    }
+
+    void PrepareRead(int file_descriptor, std::span<uint8_t> data, uint64_t offset, uint64_t user_data)
+    {
+        std::atomic_ref<uint32_t> tail(*m_sq_tail);
+        const uint32_t index = tail.load(std::memory_order_relaxed) & m_sq_mask;
+
+        auto& sqe = m_sqes[index];
+        sqe = {};
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = file_descriptor;
+        sqe.addr = reinterpret_cast<uint64_t>(data.data());
+        sqe.len = static_cast<uint32_t>(data.size());
+        sqe.off = offset;
+        sqe.user_data = user_data;
+
+        m_sq_array[index] = index;
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void RetractSubmissions(uint32_t count)
+    {
+        std::atomic_ref<uint32_t> tail(*m_sq_tail);
+        tail.store(tail.load(std::memory_order_relaxed) - count, std::memory_order_release);
+    }
+
+    bool PopCompletion(uint64_t& user_data, int32_t& result)
+    {
+        std::atomic_ref<uint32_t> head(*m_cq_head);
+        std::atomic_ref<uint32_t> tail(*m_cq_tail);
+        const uint32_t current_head = head.load(std::memory_order_relaxed);
+        if (current_head == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        const auto& cqe = m_cqes[current_head & m_cq_mask];
+        user_data = cqe.user_data;
+        result = cqe.res;
+        head.store(current_head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns the number of entries the kernel accepted, which is zero when the call should simply be retried.
+    uint32_t Enter(uint32_t submit_count, uint32_t wait_count)
+    {
+        const auto result = syscall(__NR_io_uring_enter, m_descriptor, submit_count, wait_count, wait_count > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        if (result >= 0) {
+            return static_cast<uint32_t>(result);
+        }
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            throw std::runtime_error("Failed to enter io_uring");
+        }
+        return 0;
+    }
+
+    static void ReadRemainder(File& file, Batch& batch, uint64_t read_size)
+    {
+        try {
+            const auto remainder = std::span<uint8_t>(batch.data).subspan(static_cast<size_t>(read_size));
+            const uint64_t remainder_size = remainder.empty() ? 0 : file.Read(batch.offset + read_size, remainder);
+            batch.data.resize(static_cast<size_t>(read_size + remainder_size));
+        } catch (const std::exception& e) {
+            batch.error = e.what();
+        }
+    }
+
+private:
+    int m_descriptor = -1;
+    void* m_sq_pointer = nullptr;
+    void* m_cq_pointer = nullptr;
+    size_t m_sq_size = 0;
+    size_t m_cq_size = 0;
+    size_t m_sqes_size = 0;
+    io_uring_sqe* m_sqes = nullptr;
+    uint32_t* m_sq_tail = nullptr;
+    uint32_t* m_sq_array = nullptr;
+    uint32_t m_sq_mask = 0;
+    uint32_t* m_cq_head = nullptr;
+    uint32_t* m_cq_tail = nullptr;
+    uint32_t m_cq_mask = 0;
+    io_uring_cqe* m_cqes = nullptr;
+    uint32_t m_entry_count = 0;
+    bool m_is_read_supported = true;
+    std::vector<std::vector<uint8_t>> m_abandoned_data;
+};
+
+#else
+
+class AsyncIo::Ring
+{
+public:
+    explicit Ring(uint32_t)
+    {
+    }
+
+    bool IsValid() const
+    {
+        return false;
+    }
+
+    void ReadBatches(std::span<Batch> batches)
+    {
+        for (auto& batch : batches) {
+            ReadBatch(batch);
+        }
+    }
+};
+
+#endif
+
+AsyncIo::AsyncIo(const AsyncIoDesc& desc)
+    : m_desc(desc)
+{
+    if (m_desc.thread_count == 0 || m_desc.queue_depth == 0) {
+        throw std::invalid_argument("Async I/O needs at least one thread and a queue depth of one");
+    }
+
+    if (m_desc.backend != IoBackend::Threads && Ring(m_desc.queue_depth).IsValid()) {
+        m_backend = IoBackend::IoUring;
+    }
+
+    m_threads.reserve(m_desc.thread_count);
+    for (uint32_t i = 0; i < m_desc.thread_count; ++i) {
+        m_threads.emplace_back([this]() {
+            RunWorker();
+        });
+    }
+}
+
+AsyncIo::~AsyncIo()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_is_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+
+    // Requests the workers never reached still hear back, as cancelled, like every finished one.
+    for (auto& request : m_queue) {
+        AddCancelledCompletion(request);
+    }
+    m_queue.clear();
+    DispatchCompletions();
+}
+
+IoRequestId AsyncIo::Submit(IoRequestDesc desc)
+{
+    IoRequestId id = 0;
+    {
+        std::lock_guard lock(m_mutex);
+        id = m_next_id++;
+        m_queue.push_back({ id, m_next_sequence++, std::move(desc) });
+        std::push_heap(m_queue.begin(), m_queue.end(), [](const Request& lhs, const Request& rhs) {
+            return IsLessUrgent(lhs.desc.priority, lhs.sequence, rhs.desc.priority, rhs.sequence);
+        });
+        ++m_statistics.request_count;
+    }
+    m_condition.notify_one();
+    return id;
+}
+
+bool AsyncIo::Cancel(IoRequestId id)
+{
+    std::lock_guard lock(m_mutex);
+    const auto it = std::find_if(m_queue.begin(), m_queue.end(), [id](const Request& request) {
+        return request.id == id;
+    });
+    if (it == m_queue.end()) {
+        return false;
+    }
+
+    AddCancelledCompletion(*it);
+    m_queue.erase(it);
+    std::make_heap(m_queue.begin(), m_queue.end(), [](const Request& lhs, const Request& rhs) {
+        return IsLessUrgent(lhs.desc.priority, lhs.sequence, rhs.desc.priority, rhs.sequence);
+    });
+
+    if (m_queue.empty() && m_in_flight_count == 0) {
+        m_idle_condition.notify_all();
+    }
+    return true;
+}
+
+size_t AsyncIo::DispatchCompletions()
+{
+    DDN_PROFILE_FUNCTION();
+
+    std::vector<Completion> completions;
+    {
+        std::lock_guard lock(m_mutex);
+        completions.swap(m_completions);
+    }
+
+    for (auto& completion : completions) {
+        if (completion.complete) {
+            completion.complete(completion.result);
+        }
+    }
+    return completions.size();
+}
+
+void AsyncIo::WaitIdle()
+{
+    std::unique_lock lock(m_mutex);
+    m_idle_condition.wait(lock, [this]() {
+        return m_queue.empty() && m_in_flight_count == 0;
+    });
+}
+
+IoBackend AsyncIo::GetBackend() const
+{
+    return m_backend;
+}
+
+AsyncIoStatistics AsyncIo::GetStatistics() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_statistics;
+}
+
+void AsyncIo::ReadBatch(Batch& batch)
+{
+    try {
+        File file(batch.path);
+        PrepareBatchData(file, batch.offset, batch.size, batch.data);
+        batch.data.resize(static_cast<size_t>(file.Read(batch.offset, batch.data)));
+    } catch (const std::exception& e) {
+        batch.error = e.what();
+    }
+}
+
+void AsyncIo::RunWorker()
+{
+    DDN_PROFILE_THREAD("I/O");
+    MemoryTagScope tag_scope(MemoryTag::Io);
+
+    std::optional<Ring> ring;
+    if (m_backend == IoBackend::IoUring) {
+        ring.emplace(m_desc.queue_depth);
+    }
+    uint32_t max_batch_count = ring && ring->IsValid() ? m_desc.queue_depth : 1;
+
+    std::vector<Batch> batches;
+    while (true) {
+        batches.clear();
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this]() {
+                return m_is_stopping || !m_queue.empty();
+            });
+            if (m_is_stopping) {
+                return;
+            }
+
+            while (batches.size() < max_batch_count && !m_queue.empty()) {
+                PopBatch(batches.emplace_back());
+            }
+            m_in_flight_count += static_cast<uint32_t>(batches.size());
+        }
+
+        {
+            DDN_PROFILE_SCOPE("ReadBatches");
+            if (max_batch_count > 1) {
+                // An exception must not leave this thread, so a failing ring hands the batch and every later one
+                // to the plain read path.
+                try {
+                    ring->ReadBatches(batches);
+                } catch (...) {
+                    max_batch_count = 1;
+                    for (auto& batch : batches) {
+                        batch.error.clear();
+                        ReadBatch(batch);
+                    }
+                }
+            } else {
+                for (auto& batch : batches) {
+                    ReadBatch(batch);
+                }
+            }
+        }
+
+        for (auto& batch : batches) {
+            FinishBatch(batch);
+        }
+
+        std::lock_guard lock(m_mutex);
+        m_in_flight_count -= static_cast<uint32_t>(batches.size());
+        if (m_queue.empty() && m_in_flight_count == 0) {
+            m_idle_condition.notify_all();
+        }
+    }
+}
+
+// Takes the most urgent request plus every queued range of the same file reachable from it through gaps
+// of at most coalesce_gap, as long as the combined span stays within max_coalesced_size.
+void AsyncIo::PopBatch(Batch& batch)
+{
+    const auto is_less_urgent = [](const Request& lhs, const Request& rhs) {
+        return IsLessUrgent(lhs.desc.priority, lhs.sequence, rhs.desc.priority, rhs.sequence);
+    };
+
+    std::pop_heap(m_queue.begin(), m_queue.end(), is_less_urgent);
+    auto first = std::move(m_queue.back());
+    m_queue.pop_back();
+
+    batch.path = first.desc.path;
+    batch.offset = first.desc.offset;
+    batch.size = first.desc.size;
+    batch.requests.push_back(std::move(first));
+    if (batch.size == IoRequestDesc::s_whole_file) {
+        return;
+    }
+
+    std::vector<size_t> candidates;
+    for (size_t i = 0; i < m_queue.size(); ++i) {
+        const auto& desc = m_queue[i].desc;
+        if (desc.size != IoRequestDesc::s_whole_file && desc.path == batch.path) {
+            candidates.push_back(i);
+        }
+    }
+    if (candidates.empty()) {
+        return;
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [this](size_t lhs, size_t rhs) {
+        return m_queue[lhs].desc.offset < m_queue[rhs].desc.offset;
+    });
+
+    uint64_t begin = batch.offset;
+    uint64_t end = batch.offset + batch.size;
+    const auto try_extend = [&](size_t index) {
+        const auto& desc = m_queue[index].desc;
+        const uint64_t new_begin = std::min(begin, desc.offset);
+        const uint64_t new_end = std::max(end, desc.offset + desc.size);
+        if (desc.offset > end + m_desc.coalesce_gap || desc.offset + desc.size + m_desc.coalesce_gap < begin || new_end - new_begin > m_desc.max_coalesced_size) {
+            return false;
+        }
+        begin = new_begin;
+        end = new_end;
+        return true;
+    };
+
+    const auto split = std::lower_bound(candidates.begin(), candidates.end(), batch.offset, [this](size_t index, uint64_t offset) {
+        return m_queue[index].desc.offset < offset;
+    });
+
+    std::vector<size_t> selected;
+    for (auto it = split; it != candidates.end() && try_extend(*it); ++it) {
+        selected.push_back(*it);
+    }
+    for (auto it = split; it != candidates.begin() && try_extend(*(it - 1)); --it) {
+        selected.push_back(*(it - 1));
+    }
+    if (selected.empty()) {
+        return;
+    }
+
+    batch.offset = begin;
+    batch.size = end - begin;
+
+    std::sort(selected.begin(), selected.end());
+    for (auto it = selected.rbegin(); it != selected.rend(); ++it) {
+        batch.requests.push_back(std::move(m_queue[*it]));
+        if (*it + 1 != m_queue.size()) {
+            m_queue[*it] = std::move(m_queue.back());
+        }
+        m_queue.pop_back();
+    }
+    std::make_heap(m_queue.begin(), m_queue.end(), is_less_urgent);
+}
+
+void AsyncIo::AddCancelledCompletion(Request& request)
+{
+    IoResult result;
+    result.id = request.id;
+    result.status = IoStatus::Cancelled;
+    result.path = request.desc.path;
+    result.offset = request.desc.offset;
+    m_completions.push_back({ std::move(result), std::move(request.desc.complete) });
+    ++m_statistics.cancelled_count;
+}
+
+void AsyncIo::FinishBatch(Batch& batch)
+{
+    const uint64_t read_size = batch.error.empty() ? batch.data.size() : 0;
+    uint64_t failed_count = 0;
+    std::vector<Completion> completions;
+    completions.reserve(batch.requests.size());
+    for (auto& request : batch.requests) {
+        IoResult result;
+        result.id = request.id;
+        result.path = std::move(request.desc.path);
+        result.offset = request.desc.offset;
+
+        try {
+            if (!batch.error.empty()) {
+                throw std::runtime_error(batch.error);
+            }
+
+            const uint64_t relative_offset = request.desc.offset - batch.offset;
+            const uint64_t size = request.desc.size == IoRequestDesc::s_whole_file ? batch.data.size() : request.desc.size;
+            if (relative_offset + size > batch.data.size()) {
+                throw std::runtime_error("Read exceeds file size");
+            }
+
+            if (batch.requests.size() == 1) {
+                result.data = std::move(batch.data);
+            } else {
+                const auto begin = batch.data.begin() + static_cast<ptrdiff_t>(relative_offset);
+                result.data.assign(begin, begin + static_cast<ptrdiff_t>(size));
+            }
+
+            if (request.desc.decode) {
+                request.desc.decode(result);
+            }
+        } catch (const std::exception& e) {
+            result.status = IoStatus::Failed;
+            result.error = e.what();
+            ++failed_count;
+        } catch (...) {
+            result.status = IoStatus::Failed;
+            result.error = "Decode failed with an unknown exception";
+            ++failed_count;
+        }
+
+        completions.push_back({ std::move(result), std::move(request.desc.complete) });
+    }
+
+    std::lock_guard lock(m_mutex);
+    ++m_statistics.read_count;
+    m_statistics.coalesced_request_count += batch.requests.size() - 1;
+    m_statistics.bytes_read += read_size;
+    m_statistics.failed_count += failed_count;
+    for (auto& completion : completions) {
+        m_completions.push_back(std::move(completion));
+    }
+}
+
+}  // namespace ddn
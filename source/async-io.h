@@ -0,0 +1,159 @@
+#pragma once
+
+#include <mutex>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <filesystem>
+#include <condition_variable>
+
+namespace ddn
+{
+
+using IoRequestId = uint64_t;
+
+enum class IoPriority
+{
+    Background,
+    Normal,
+    High,
+    Critical,
+};
+
+enum class IoStatus
+{
+    Completed,
+    Cancelled,
+    Failed,
+};
+
+enum class IoBackend
+{
+    Auto,
+    Threads,
+    IoUring,
+};
+
+struct IoResult
+{
+    IoRequestId id = 0;
+    IoStatus status = IoStatus::Completed;
+    std::filesystem::path path;
+    uint64_t offset = 0;
+    std::vector<uint8_t> data;
+    std::string error;
+};
+
+struct IoRequestDesc
+{
+    static constexpr uint64_t s_whole_file = std::numeric_limits<uint64_t>::max();
+
+    std::filesystem::path path;
+    uint64_t offset = 0;
+    uint64_t size = s_whole_file;
+    IoPriority priority = IoPriority::Normal;
+
+    // Runs on an I/O thread once the data is read, e.g. to decompress or parse it; throwing fails the request.
+    std::function<void(IoResult& result)> decode;
+    // Runs on the thread calling DispatchCompletions, which is where results reach the upload path.
+    std::function<void(IoResult& result)> complete;
+};
+
+struct AsyncIoDesc
+{
+    uint32_t thread_count = 2;
+    uint32_t queue_depth = 16;
+    uint64_t coalesce_gap = 64 * 1024;
+    uint64_t max_coalesced_size = 4 * 1024 * 1024;
+    IoBackend backend = IoBackend::Auto;
+};
+
+struct AsyncIoStatistics
+{
+    uint64_t request_count = 0;
+    uint64_t read_count = 0;
+    uint64_t coalesced_request_count = 0;
+    uint64_t bytes_read = 0;
+    uint64_t cancelled_count = 0;
+    uint64_t failed_count = 0;
+};
+
+// Prioritized file reads on a small pool of I/O threads. Each thread takes the most urgent request together
+// with queued ranges of the same file that lie within coalesce_gap of it and reads them as one span. With
+// io_uring every thread keeps up to queue_depth such reads in flight; otherwise it reads them one at a time.
+// Destroying it cancels the requests still queued and dispatches all outstanding completions on the calling
+// thread.
+class AsyncIo
+{
+public:
+    explicit AsyncIo(const AsyncIoDesc& desc = {});
+    ~AsyncIo();
+
+    AsyncIo(const AsyncIo& other) = delete;
+    AsyncIo& operator =(const AsyncIo& other) = delete;
+
+    IoRequestId Submit(IoRequestDesc desc);
+
+    // Succeeds only while the request is still queued; its result is then delivered as Cancelled.
+    bool Cancel(IoRequestId id);
+
+    size_t DispatchCompletions();
+    void WaitIdle();
+
+    IoBackend GetBackend() const;
+    AsyncIoStatistics GetStatistics() const;
+
+private:
+    class Ring;
+
+    struct Request
+    {
+        IoRequestId id = 0;
+        uint64_t sequence = 0;
+        IoRequestDesc desc;
+    };
+
+    struct Batch
+    {
+        std::filesystem::path path;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        std::vector<Request> requests;
+        std::vector<uint8_t> data;
+        std::string error;
+    };
+
+    struct Completion
+    {
+        IoResult result;
+        std::function<void(IoResult& result)> complete;
+    };
+
+    static void ReadBatch(Batch& batch);
+
+    void RunWorker();
+    void PopBatch(Batch& batch);
+    void AddCancelledCompletion(Request& request);
+    void FinishBatch(Batch& batch);
+
+private:
+    AsyncIoDesc m_desc;
+    IoBackend m_backend = IoBackend::Threads;
+    std::vector<std::thread> m_threads;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::condition_variable m_idle_condition;
+    std::vector<Request> m_queue;
+    std::vector<Completion> m_completions;
+    IoRequestId m_next_id = 1;
+    uint64_t m_next_sequence = 0;
+    uint32_t m_in_flight_count = 0;
+    bool m_is_stopping = false;
+    AsyncIoStatistics m_statistics;
+};
+
+}  // namespace ddn
@@ -0,0 +1,296 @@
+#include "benchmark.h"
+
+#include "json.h"
+
+#include <fstream>
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+
+using BenchmarkRegistry = std::vector<std::pair<std::string, ddn::BenchmarkFunction>>;
+
+BenchmarkRegistry& GetBenchmarkRegistry()
+{
+    static BenchmarkRegistry registry;
+    return registry;
+}
+
+ddn::JsonValue ToJson(const ddn::BenchmarkResult& result)
+{
+    ddn::JsonValue::Object counters;
+    for (const auto& [name, value] : result.counters) {
+        counters[name] = value;
+    }
+
+    ddn::JsonValue::Object object;
+    object["name"] = result.name;
+    object["samples"] = result.timings.sample_count;
+    object["mean_ms"] = result.timings.mean_ms;
+    object["min_ms"] = result.timings.min_ms;
+    object["p50_ms"] = result.timings.p50_ms;
+    object["p95_ms"] = result.timings.p95_ms;
+    object["p99_ms"] = result.timings.p99_ms;
+    object["max_ms"] = result.timings.max_ms;
+    object["counters"] = std::move(counters);
+    return object;
+}
+
+double GetNumber(const ddn::JsonValue& object, const std::string& key)
+{
+    const auto* value = object.Find(key);
+    return value && value->IsNumber() ? value->GetNumber() : 0.0;
+}
+
+ddn::BenchmarkResult FromJson(const ddn::JsonValue& object)
+{
+    ddn::BenchmarkResult result;
+
+    const auto* name = object.Find("name");
+    if (!name || !name->IsString()) {
+        throw std::runtime_error("Benchmark result without name");
+    }
+
+    result.name = name->GetString();
+    result.timings.sample_count = static_cast<size_t>(GetNumber(object, "samples"));
+    result.timings.mean_ms = GetNumber(object, "mean_ms");
+    result.timings.min_ms = GetNumber(object, "min_ms");
+    result.timings.p50_ms = GetNumber(object, "p50_ms");
+    result.timings.p95_ms = GetNumber(object, "p95_ms");
+    result.timings.p99_ms = GetNumber(object, "p99_ms");
+    result.timings.max_ms = GetNumber(object, "max_ms");
+
+    if (const auto* counters = object.Find("counters"); counters && counters->IsObject()) {
+        for (const auto& [counter_name, value] : counters->GetObject()) {
+            if (value.IsNumber()) {
+                result.counters[counter_name] = value.GetNumber();
+            }
+        }
+    }
+
+    return result;
+}
+
+void CompareMetric(std::vector<ddn::BenchmarkRegression>& regressions, const std::string& name, const char* metric, double baseline_value, double current_value, double tolerance)
+{
+    if (baseline_value > 0.0 && current_value > baseline_value * (1.0 + tolerance)) {
+        regressions.push_back({ name, metric, baseline_value, current_value });
+    }
+}
+
+}
+
+namespace ddn
+{
+
+BenchmarkState::BenchmarkState(uint32_t iteration_count)
+    : m_iteration_count(std::max<uint32_t>(1, iteration_count))
+{
+    m_samples_ms.reserve(m_iteration_count);
+}
+
+uint32_t BenchmarkState::GetIterationCount() const
+{
+    return m_iteration_count;
+}
+
+void BenchmarkState::AddSample(double time_ms)
+{
+    m_samples_ms.push_back(time_ms);
+}
+
+void BenchmarkState::SetCounter(const std::string& name, double value)
+{
+    m_counters[name] = value;
+}
+
+TimingSummary BenchmarkState::GetSummary() const
+{
+    return SummarizeTimings(m_samples_ms);
+}
+
+BenchmarkResult BenchmarkState::CreateResult(std::string name) const
+{
+    auto result = CreateBenchmarkResult(std::move(name), GetSummary());
+    result.counters = m_counters;
+    return result;
+}
+
+bool RegisterBenchmark(std::string name, BenchmarkFunction function)
+{
+    GetBenchmarkRegistry().emplace_back(std::move(name), std::move(function));
+    return true;
+}
+
+std::vector<BenchmarkResult> RunBenchmarks(const BenchmarkOptions& options)
+{
+    std::vector<BenchmarkResult> results;
+    for (const auto& [name, function] : GetBenchmarkRegistry()) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+
+        std::cout << "Running " << name << "..." << std::endl;
+
+        BenchmarkState state(options.iteration_count);
+        function(state);
+        results.push_back(state.CreateResult(name));
+    }
+    return results;
+}
+
+BenchmarkResult CreateBenchmarkResult(std::string name, const TimingSummary& timings)
+{
+    BenchmarkResult result;
+    result.name = std::move(name);
+    result.timings = timings;
+    return result;
+}
+
+void WriteBenchmarkResults(const std::filesystem::path& file_path, const std::vector<BenchmarkResult>& results)
+{
+    std::ofstream stream(file_path);
+    if (!stream) {
+        throw std::runtime_error("Failed to open benchmark output file");
+    }
+
+    JsonValue::Array benchmarks;
+    for (const auto& result : results) {
+        benchmarks.push_back(ToJson(result));
+    }
+
+    JsonValue::Object root;
+    root["benchmarks"] = std::move(benchmarks);
+
+    stream << std::setprecision(9);
+    WriteJson(stream, root);
+    stream << std::endl;
+}
+
+std::vector<BenchmarkResult> ReadBenchmarkResults(const std::filesystem::path& file_path)
+{
+    std::ifstream stream(file_path);
+    if (!stream) {
+        throw std::runtime_error("Failed to open benchmark baseline file");
+    }
+
+    std::ostringstream oss;
+    oss << stream.rdbuf();
+    const auto root = ParseJson(oss.str());
+
+    const auto* benchmarks = root.Find("benchmarks");
+    if (!benchmarks || !benchmarks->IsArray()) {
+        throw std::runtime_error("Expected benchmarks array");
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (const auto& benchmark : benchmarks->GetArray()) {
+        results.push_back(FromJson(benchmark));
+    }
+    return results;
+}
+
+std::vector<BenchmarkRegression> CompareBenchmarkResults(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline, double tolerance)
+{
+    std::map<std::string, const BenchmarkResult*> name_to_baseline;
+    for (const auto& result : baseline) {
+        name_to_baseline[result.name] = &result;
+    }
+
+    std::vector<BenchmarkRegression> regressions;
+    for (const auto& result : results) {
+        auto it = name_to_baseline.find(result.name);
+        if (it == name_to_baseline.end()) {
+            continue;
+        }
+
+        const auto& baseline_timings = it->second->timings;
+        CompareMetric(regressions, result.name, "p50_ms", baseline_timings.p50_ms, result.timings.p50_ms, tolerance);
+        CompareMetric(regressions, result.name, "p95_ms", baseline_timings.p95_ms, result.timings.p95_ms, tolerance);
+    }
+    return regressions;
+}
+
+BenchmarkOptions ParseBenchmarkOptions(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view argument = argv[i];
+        if (argument.substr(0, 2) != "--") {
+            throw std::invalid_argument("Unexpected argument: " + std::string(argument));
+        }
+
+        std::string key;
+        std::string value;
+        if (const auto separator = argument.find('='); separator != std::string_view::npos) {
+            key = argument.substr(2, separator - 2);
+            value = argument.substr(separator + 1);
+        } else if (i + 1 < argc) {
+            key = argument.substr(2);
+            value = argv[++i];
+        } else {
+            throw std::invalid_argument("Missing value for argument: " + std::string(argument));
+        }
+
+        if (key == "filter") {
+            options.filter = value;
+        } else if (key == "iterations") {
+            options.iteration_count = static_cast<uint32_t>(std::stoul(value));
+        } else if (key == "frames") {
+            options.frame_count = static_cast<uint32_t>(std::stoul(value));
+        } else if (key == "frames-in-flight") {
+            options.frames_in_flight = static_cast<uint32_t>(std::stoul(value));
+        } else if (key == "output") {
+            options.output_path = value;
+        } else if (key == "baseline") {
+            options.baseline_path = value;
+        } else if (key == "memory-snapshot") {
+            options.memory_snapshot_path = value;
+        } else if (key == "tolerance") {
+            options.tolerance = std::stod(value);
+        } else {
+            throw std::invalid_argument("Unknown argument: " + key);
+        }
+    }
+    return options;
+}
+
+int ReportBenchmarkResults(const std::vector<BenchmarkResult>& results, const BenchmarkOptions& options)
+{
+    std::cout << std::fixed << std::setprecision(4);
+    for (const auto& result : results) {
+        const auto& timings = result.timings;
+        std::cout << std::left << std::setw(40) << result.name << std::right
+                  << " mean " << timings.mean_ms << " ms"
+                  << " p50 " << timings.p50_ms << " ms"
+                  << " p95 " << timings.p95_ms << " ms"
+                  << " max " << timings.max_ms << " ms" << std::endl;
+
+        for (const auto& [name, value] : result.counters) {
+            std::cout << "    " << name << ": " << value << std::endl;
+        }
+    }
+
+    if (!options.output_path.empty()) {
+        WriteBenchmarkResults(options.output_path, results);
+    }
+
+    if (options.baseline_path.empty()) {
+        return 0;
+    }
+
+    const auto regressions = CompareBenchmarkResults(results, ReadBenchmarkResults(options.baseline_path), options.tolerance);
+    for (const auto& regression : regressions) {
+        std::cout << "Regression in " << regression.name << ": " << regression.metric
+                  << " " << regression.baseline_value << " -> " << regression.current_value << std::endl;
+    }
+    return regressions.empty() ? 0 : 1;
+}
+
+}  // namespace ddn
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "frame-statistics.h"
+
+#include <map>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <filesystem>
+
+namespace ddn
+{
+
+struct BenchmarkResult
+{
+    std::string name;
+    TimingSummary timings;
+    std::map<std::string, double> counters;
+};
+
+struct BenchmarkRegression
+{
+    std::string name;
+    std::string metric;
+    double baseline_value = 0.0;
+    double current_value = 0.0;
+};
+
+struct BenchmarkOptions
+{
+    std::string filter;
+    uint32_t iteration_count = 10;
+    uint32_t frame_count = 0;
+    uint32_t frames_in_flight = 2;
+    std::filesystem::path output_path;
+    std::filesystem::path baseline_path;
+    std::filesystem::path memory_snapshot_path;
+    double tolerance = 0.05;
+};
+
+class BenchmarkState
+{
+public:
+    explicit BenchmarkState(uint32_t iteration_count);
+
+    uint32_t GetIterationCount() const;
+
+    template <typename Function>
+    void Measure(Function&& function)
+    {
+        function();
+        for (uint32_t i = 0; i < m_iteration_count; ++i) {
+            const auto begin = std::chrono::steady_clock::now();
+            function();
+            const auto end = std::chrono::steady_clock::now();
+            AddSample(std::chrono::duration<double, std::milli>(end - begin).count());
+        }
+    }
+
+    void AddSample(double time_ms);
+    void SetCounter(const std::string& name, double value);
+
+    TimingSummary GetSummary() const;
+    BenchmarkResult CreateResult(std::string name) const;
+
+private:
+    uint32_t m_iteration_count = 0;
+    std::vector<double> m_samples_ms;
+    std::map<std::string, double> m_counters;
+};
+
+using BenchmarkFunction = std::function<void(BenchmarkState&)>;
+
+bool RegisterBenchmark(std::string name, BenchmarkFunction function);
+std::vector<BenchmarkResult> RunBenchmarks(const BenchmarkOptions& options);
+
+BenchmarkResult CreateBenchmarkResult(std::string name, const TimingSummary& timings);
+
+void WriteBenchmarkResults(const std::filesystem::path& file_path, const std::vector<BenchmarkResult>& results);
+std::vector<BenchmarkResult> ReadBenchmarkResults(const std::filesystem::path& file_path);
+
+std::vector<BenchmarkRegression> CompareBenchmarkResults(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline, double tolerance);
+
+BenchmarkOptions ParseBenchmarkOptions(int argc, char* argv[]);
+int ReportBenchmarkResults(const std::vector<BenchmarkResult>& results, const BenchmarkOptions& options);
+
+}  // namespace ddn
+
+#define DDN_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define DDN_BENCHMARK_CONCAT(a, b) DDN_BENCHMARK_CONCAT_IMPL(a, b)
+
+#define DDN_BENCHMARK(name, function) \
+    static const bool DDN_BENCHMARK_CONCAT(ddn_benchmark_registered_, __LINE__) = ::ddn::RegisterBenchmark(name, function)
@@ -0,0 +1,161 @@
+#include "animation.h"
+#include "benchmark.h"
+#include "thread-pool.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t s_character_count = 1000;
+constexpr uint32_t s_joint_count = 100;
+constexpr uint32_t s_chain_length = 20;
+constexpr uint32_t s_vertex_count = 1000;
+constexpr uint32_t s_frame_count = 61;
+constexpr float s_sample_rate = 30.0f;
+constexpr float s_frame_time = 1.0f / 60.0f;
+
+// Five 20-joint chains hanging off the root, animated by idle, walk and run clips that are blended by speed.
+struct AnimationScene
+{
+    std::unique_ptr<ddn::Skeleton> skeleton;
+    std::vector<ddn::RawAnimationClip> raw_clips;
+    std::vector<std::unique_ptr<ddn::AnimationClip>> clips;
+    ddn::BlendTree blend_tree;
+    ddn::AnimationSystem animation_system;
+};
+
+ddn::RawAnimationClip CreateRawClip(const ddn::Skeleton& skeleton, float frequency, float amplitude)
+{
+    ddn::RawAnimationClip clip;
+    clip.sample_rate = s_sample_rate;
+    clip.tracks.resize(s_joint_count);
+    for (uint32_t joint = 0; joint < s_joint_count; ++joint) {
+        const auto& bind_transform = skeleton.GetBindPose()[joint];
+        for (uint32_t frame = 0; frame < s_frame_count; ++frame) {
+            const float phase = frame / s_sample_rate * frequency * 6.2831853f + joint * 0.3f;
+            auto transform = bind_transform;
+            // Every fifth joint stays still, as fingers and helper joints often do.
+            if (joint % 5 != 0) {
+                transform.rotation = glm::angleAxis(std::sin(phase) * amplitude, glm::normalize(glm::vec3(1.0f, 0.5f * (joint % 3), 0.25f)));
+            }
+            if (joint == 0) {
+                transform.translation = glm::vec3(0.0f, std::abs(std::sin(phase)) * amplitude * 0.2f, 0.0f);
+            }
+            clip.tracks[joint].push_back(transform);
+        }
+    }
+    return clip;
+}
+
+void InitializeScene(AnimationScene& scene)
+{
+    std::vector<int32_t> parent_indexes(s_joint_count);
+    std::vector<ddn::JointTransform> bind_pose(s_joint_count);
+    parent_indexes[0] = -1;
+    for (uint32_t joint = 1; joint < s_joint_count; ++joint) {
+        parent_indexes[joint] = (joint - 1) % s_chain_length == 0 ? 0 : joint - 1;
+        bind_pose[joint].translation = glm::vec3(0.0f, 0.1f, 0.0f);
+    }
+    scene.skeleton = std::make_unique<ddn::Skeleton>(std::move(parent_indexes), std::move(bind_pose));
+
+    scene.raw_clips.push_back(CreateRawClip(*scene.skeleton, 0.5f, 0.1f));
+    scene.raw_clips.push_back(CreateRawClip(*scene.skeleton, 1.0f, 0.4f));
+    scene.raw_clips.push_back(CreateRawClip(*scene.skeleton, 1.5f, 0.7f));
+
+    std::vector<ddn::BlendNodeId> children;
+    for (const auto& raw_clip : scene.raw_clips) {
+        scene.clips.push_back(std::make_unique<ddn::AnimationClip>(raw_clip));
+        children.push_back(scene.blend_tree.AddClip(*scene.clips.back()));
+    }
+    scene.blend_tree.SetRoot(scene.blend_tree.AddBlend1D(0, { 0.0f, 1.0f, 2.0f }, children));
+
+    std::mt19937 generator(5);
+    std::uniform_real_distribution<float> distribution(0.0f, 2.0f);
+    for (uint32_t i = 0; i < s_character_count; ++i) {
+        const auto id = scene.animation_system.AddCharacter(*scene.skeleton, scene.blend_tree, distribution(generator));
+        scene.animation_system.SetParameter(id, 0, distribution(generator));
+    }
+}
+
+// Largest rotation error of the compressed clip at its own keys, in degrees.
+double GetMaxRotationError(const ddn::RawAnimationClip& raw_clip, const ddn::AnimationClip& clip)
+{
+    std::vector<ddn::JointTransform> pose(s_joint_count);
+    double max_error = 0.0;
+    for (uint32_t frame = 0; frame + 1 < s_frame_count; ++frame) {
+        clip.Sample(frame / s_sample_rate, pose);
+        for (uint32_t joint = 0; joint < s_joint_count; ++joint) {
+            const float cosine = std::min(1.0f, std::abs(glm::dot(pose[joint].rotation, raw_clip.tracks[joint][frame].rotation)));
+            max_error = std::max(max_error, 2.0 * std::acos(cosine) * 57.29578);
+        }
+    }
+    return max_error;
+}
+
+void BenchmarkUpdate(ddn::BenchmarkState& state)
+{
+    AnimationScene scene;
+    InitializeScene(scene);
+
+    state.Measure([&]() {
+        scene.animation_system.Update(s_frame_time);
+    });
+
+    size_t raw_size = 0;
+    size_t compressed_size = 0;
+    double max_rotation_error = 0.0;
+    for (size_t i = 0; i < scene.clips.size(); ++i) {
+        raw_size += size_t(s_joint_count) * s_frame_count * sizeof(ddn::JointTransform);
+        compressed_size += scene.clips[i]->GetSize();
+        max_rotation_error = std::max(max_rotation_error, GetMaxRotationError(scene.raw_clips[i], *scene.clips[i]));
+    }
+
+    state.SetCounter("characters", s_character_count);
+    state.SetCounter("joints_per_us", s_character_count * s_joint_count / (state.GetSummary().p50_ms * 1000.0));
+    state.SetCounter("compression_ratio", static_cast<double>(raw_size) / compressed_size);
+    state.SetCounter("max_rotation_error_deg", max_rotation_error);
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkSkinning(ddn::BenchmarkState& state)
+{
+    AnimationScene scene;
+    InitializeScene(scene);
+    scene.animation_system.Update(s_frame_time);
+
+    std::mt19937 generator(9);
+    std::uniform_int_distribution<uint32_t> joint_distribution(0, s_joint_count - 4);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    std::vector<ddn::SkinVertex> vertices(s_vertex_count);
+    for (auto& vertex : vertices) {
+        const uint32_t joint = joint_distribution(generator);
+        vertex.position = glm::vec3(distribution(generator), distribution(generator) + 1.0f, distribution(generator));
+        vertex.normal = glm::normalize(glm::vec3(distribution(generator), distribution(generator), 1.0f));
+        vertex.joints = { static_cast<uint16_t>(joint), static_cast<uint16_t>(joint + 1), static_cast<uint16_t>(joint + 2), static_cast<uint16_t>(joint + 3) };
+        vertex.weights = glm::vec4(0.4f, 0.3f, 0.2f, 0.1f);
+    }
+
+    std::vector<ddn::SkinnedVertex> output(size_t(s_character_count) * s_vertex_count);
+    std::vector<ddn::SkinningJob> jobs;
+    for (uint32_t i = 0; i < s_character_count; ++i) {
+        jobs.push_back({ vertices, scene.animation_system.GetSkinningMatrices(i), std::span(output).subspan(size_t(i) * s_vertex_count, s_vertex_count) });
+    }
+
+    state.Measure([&]() {
+        ddn::SkinVertices(jobs);
+    });
+
+    state.SetCounter("vertices", static_cast<double>(output.size()));
+    state.SetCounter("vertices_per_us", output.size() / (state.GetSummary().p50_ms * 1000.0));
+}
+
+}
+
+DDN_BENCHMARK("animation/update-1000x100", BenchmarkUpdate);
+DDN_BENCHMARK("animation/skin-1000x1000", BenchmarkSkinning);
@@ -0,0 +1,250 @@
+#include "async-io.h"
+#include "benchmark.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+constexpr uint32_t s_file_count = 128;
+constexpr uint64_t s_file_size = 512 * 1024;
+constexpr uint32_t s_chunk_count = 2048;
+constexpr uint64_t s_chunk_size = 16 * 1024;
+
+// Loose asset files plus one pack file that is read as many adjacent chunks, in a scratch directory that
+// is removed again afterwards.
+class BenchmarkFiles
+{
+public:
+    BenchmarkFiles()
+        : m_directory(std::filesystem::temp_directory_path() / "ddn-async-io-benchmark")
+    {
+        std::filesystem::create_directories(m_directory);
+
+        std::mt19937 generator(3);
+        std::vector<uint8_t> data(s_chunk_count * s_chunk_size);
+        for (auto& value : data) {
+            value = static_cast<uint8_t>(generator());
+        }
+
+        for (uint32_t i = 0; i < s_file_count; ++i) {
+            m_file_paths.push_back(m_directory / ("asset-" + std::to_string(i) + ".bin"));
+            Write(m_file_paths.back(), data.data() + (i * s_file_size) % (data.size() - s_file_size), s_file_size);
+        }
+
+        m_pack_path = m_directory / "assets.pack";
+        Write(m_pack_path, data.data(), data.size());
+    }
+
+    ~BenchmarkFiles()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(m_directory, error);
+    }
+
+    const std::vector<std::filesystem::path>& GetFilePaths() const
+    {
+        return m_file_paths;
+    }
+
+    const std::filesystem::path& GetPackPath() const
+    {
+        return m_pack_path;
+    }
+
+    // Drops the files from the page cache where the platform allows it; returns whether it did.
+    bool DropPageCache() const
+    {
+#ifdef __linux__
+        bool is_dropped = true;
+        for (const auto& path : m_file_paths) {
+            is_dropped = DropPageCache(path) && is_dropped;
+        }
+        return DropPageCache(m_pack_path) && is_dropped;
+#else
+        return false;
+#endif
+    }
+
+private:
+    static void Write(const std::filesystem::path& path, const uint8_t* data, uint64_t size)
+    {
+        std::ofstream stream(path, std::ios::binary);
+        stream.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+
+#ifdef __linux__
+    static bool DropPageCache(const std::filesystem::path& path)
+    {
+        const int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return false;
+        }
+        fdatasync(descriptor);
+        const bool is_dropped = posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED) == 0;
+        close(descriptor);
+        return is_dropped;
+    }
+#endif
+
+private:
+    std::filesystem::path m_directory;
+    std::filesystem::path m_pack_path;
+    std::vector<std::filesystem::path> m_file_paths;
+};
+
+uint64_t LoadFilesSync(const BenchmarkFiles& files)
+{
+    uint64_t byte_count = 0;
+    std::vector<char> data;
+    for (const auto& path : files.GetFilePaths()) {
+        std::ifstream stream(path, std::ios::binary);
+        data.resize(static_cast<size_t>(std::filesystem::file_size(path)));
+        stream.read(data.data(), static_cast<std::streamsize>(data.size()));
+        byte_count += static_cast<uint64_t>(stream.gcount());
+    }
+    return byte_count;
+}
+
+uint64_t LoadFilesAsync(ddn::AsyncIo& io, const BenchmarkFiles& files)
+{
+    uint64_t byte_count = 0;
+    for (const auto& path : files.GetFilePaths()) {
+        ddn::IoRequestDesc desc;
+        desc.path = path;
+        desc.complete = [&byte_count](ddn::IoResult& result) {
+            byte_count += result.data.size();
+        };
+        io.Submit(std::move(desc));
+    }
+    io.WaitIdle();
+    io.DispatchCompletions();
+    return byte_count;
+}
+
+uint64_t LoadChunksAsync(ddn::AsyncIo& io, const BenchmarkFiles& files)
+{
+    uint64_t byte_count = 0;
+    for (uint32_t i = 0; i < s_chunk_count; ++i) {
+        ddn::IoRequestDesc desc;
+        desc.path = files.GetPackPath();
+        desc.offset = i * s_chunk_size;
+        desc.size = s_chunk_size;
+        desc.complete = [&byte_count](ddn::IoResult& result) {
+            byte_count += result.data.size();
+        };
+        io.Submit(std::move(desc));
+    }
+    io.WaitIdle();
+    io.DispatchCompletions();
+    return byte_count;
+}
+
+template <typename Function>
+void MeasureLoads(ddn::BenchmarkState& state, const BenchmarkFiles& files, bool is_cold, Function&& function)
+{
+    bool is_cache_dropped = false;
+    uint64_t byte_count = function();
+    for (uint32_t i = 0; i < state.GetIterationCount(); ++i) {
+        if (is_cold) {
+            is_cache_dropped = files.DropPageCache();
+        }
+        const auto begin = std::chrono::steady_clock::now();
+        byte_count = function();
+        const auto end = std::chrono::steady_clock::now();
+        state.AddSample(std::chrono::duration<double, std::milli>(end - begin).count());
+    }
+
+    state.SetCounter("mb_per_s", byte_count / (1024.0 * 1024.0) / (state.GetSummary().p50_ms / 1000.0));
+    state.SetCounter("cold_cache", is_cache_dropped ? 1.0 : 0.0);
+}
+
+void SetIoCounters(ddn::BenchmarkState& state, const ddn::AsyncIo& io)
+{
+    const auto statistics = io.GetStatistics();
+    state.SetCounter("io_uring", io.GetBackend() == ddn::IoBackend::IoUring ? 1.0 : 0.0);
+    state.SetCounter("reads_per_request", static_cast<double>(statistics.read_count) / statistics.request_count);
+}
+
+void BenchmarkSyncFiles(ddn::BenchmarkState& state, bool is_cold)
+{
+    BenchmarkFiles files;
+    MeasureLoads(state, files, is_cold, [&]() {
+        return LoadFilesSync(files);
+    });
+}
+
+void BenchmarkAsyncFiles(ddn::BenchmarkState& state, bool is_cold, ddn::IoBackend backend)
+{
+    BenchmarkFiles files;
+    ddn::AsyncIo io({ 4, 16, 64 * 1024, 4 * 1024 * 1024, backend });
+    MeasureLoads(state, files, is_cold, [&]() {
+        return LoadFilesAsync(io, files);
+    });
+    SetIoCounters(state, io);
+}
+
+void BenchmarkAsyncChunks(ddn::BenchmarkState& state, uint64_t max_coalesced_size)
+{
+    BenchmarkFiles files;
+    ddn::AsyncIo io({ 4, 16, 64 * 1024, max_coalesced_size });
+    MeasureLoads(state, files, false, [&]() {
+        return LoadChunksAsync(io, files);
+    });
+    SetIoCounters(state, io);
+}
+
+void BenchmarkSyncFilesWarm(ddn::BenchmarkState& state)
+{
+    BenchmarkSyncFiles(state, false);
+}
+
+void BenchmarkSyncFilesCold(ddn::BenchmarkState& state)
+{
+    BenchmarkSyncFiles(state, true);
+}
+
+void BenchmarkAsyncFilesWarm(ddn::BenchmarkState& state)
+{
+    BenchmarkAsyncFiles(state, false, ddn::IoBackend::Auto);
+}
+
+void BenchmarkAsyncFilesCold(ddn::BenchmarkState& state)
+{
+    BenchmarkAsyncFiles(state, true, ddn::IoBackend::Auto);
+}
+
+void BenchmarkAsyncThreadFilesCold(ddn::BenchmarkState& state)
+{
+    BenchmarkAsyncFiles(state, true, ddn::IoBackend::Threads);
+}
+
+void BenchmarkCoalescedChunks(ddn::BenchmarkState& state)
+{
+    BenchmarkAsyncChunks(state, 4 * 1024 * 1024);
+}
+
+void BenchmarkUncoalescedChunks(ddn::BenchmarkState& state)
+{
+    BenchmarkAsyncChunks(state, 0);
+}
+
+}
+
+DDN_BENCHMARK("async-io/sync-files-warm", BenchmarkSyncFilesWarm);
+DDN_BENCHMARK("async-io/sync-files-cold", BenchmarkSyncFilesCold);
+DDN_BENCHMARK("async-io/async-files-warm", BenchmarkAsyncFilesWarm);
+DDN_BENCHMARK("async-io/async-files-cold", BenchmarkAsyncFilesCold);
+DDN_BENCHMARK("async-io/async-thread-files-cold", BenchmarkAsyncThreadFilesCold);
+DDN_BENCHMARK("async-io/async-chunks-coalesced", BenchmarkCoalescedChunks);
+DDN_BENCHMARK("async-io/async-chunks-uncoalesced", BenchmarkUncoalescedChunks);
+
@@ -0,0 +1,143 @@
+#include "bounds.h"
+#include "benchmark.h"
+#include "broadphase.h"
+#include "thread-pool.h"
+
+#include <glm/vec3.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t s_body_count = 100'000;
+constexpr float s_time_step = 1.0f / 60.0f;
+constexpr float s_max_speed = 2.0f;
+
+// Boxes drifting through a flat slab of world, bouncing off its walls, the way most game objects spread.
+class MovingBodies
+{
+public:
+    MovingBodies(float min_size, float max_size)
+        : m_world_size(200.0f, 20.0f, 200.0f)
+    {
+        std::mt19937 generator(11);
+        std::uniform_real_distribution<float> unit_distribution(0.0f, 1.0f);
+        std::uniform_real_distribution<float> velocity_distribution(-s_max_speed, s_max_speed);
+
+        m_positions.resize(s_body_count);
+        m_velocities.resize(s_body_count);
+        m_half_sizes.resize(s_body_count);
+        m_bounds.resize(s_body_count);
+        for (uint32_t i = 0; i < s_body_count; ++i) {
+            m_positions[i] = glm::vec3(unit_distribution(generator), unit_distribution(generator), unit_distribution(generator)) * m_world_size;
+            m_velocities[i] = glm::vec3(velocity_distribution(generator), velocity_distribution(generator), velocity_distribution(generator));
+            m_half_sizes[i] = 0.5f * (min_size + (max_size - min_size) * unit_distribution(generator));
+        }
+        UpdateBounds();
+    }
+
+    void Step()
+    {
+        ddn::ParallelFor(0, s_body_count, 4096, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                auto& position = m_positions[i];
+                auto& velocity = m_velocities[i];
+                position += velocity * s_time_step;
+                for (int axis = 0; axis < 3; ++axis) {
+                    if (position[axis] < 0.0f || position[axis] > m_world_size[axis]) {
+                        velocity[axis] = -velocity[axis];
+                    }
+                }
+            }
+        });
+        UpdateBounds();
+    }
+
+    const std::vector<ddn::Aabb>& GetBounds() const
+    {
+        return m_bounds;
+    }
+
+private:
+    void UpdateBounds()
+    {
+        for (uint32_t i = 0; i < s_body_count; ++i) {
+            m_bounds[i].min = m_positions[i] - glm::vec3(m_half_sizes[i]);
+            m_bounds[i].max = m_positions[i] + glm::vec3(m_half_sizes[i]);
+        }
+    }
+
+private:
+    glm::vec3 m_world_size;
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::vec3> m_velocities;
+    std::vector<float> m_half_sizes;
+    std::vector<ddn::Aabb> m_bounds;
+};
+
+// Measures whole frames of motion plus update, and reports the broadphase's own time as update_ms.
+template <typename Broadphase>
+void RunBroadphase(ddn::BenchmarkState& state, Broadphase& broadphase, float min_size, float max_size)
+{
+    MovingBodies bodies(min_size, max_size);
+    broadphase.Update(bodies.GetBounds());
+
+    double update_ms = 0.0;
+    double pair_count = 0.0;
+    double test_count = 0.0;
+    double swap_count = 0.0;
+    uint32_t frame_count = 0;
+    state.Measure([&]() {
+        bodies.Step();
+        broadphase.Update(bodies.GetBounds());
+
+        const auto& statistics = broadphase.GetStatistics();
+        update_ms += statistics.update_ms;
+        pair_count += static_cast<double>(statistics.pair_count);
+        test_count += static_cast<double>(statistics.test_count);
+        swap_count += static_cast<double>(statistics.swap_count);
+        ++frame_count;
+    });
+
+    state.SetCounter("pairs", pair_count / frame_count);
+    state.SetCounter("pairs_per_ms", pair_count / update_ms);
+    state.SetCounter("tests_per_body", test_count / frame_count / s_body_count);
+    state.SetCounter("swaps_per_body", swap_count / frame_count / s_body_count);
+    state.SetCounter("update_ms", update_ms / frame_count);
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkSweepAndPrune(ddn::BenchmarkState& state)
+{
+    ddn::SweepAndPrune broadphase;
+    RunBroadphase(state, broadphase, 1.0f, 1.0f);
+}
+
+void BenchmarkSpatialHash(ddn::BenchmarkState& state)
+{
+    ddn::SpatialHash broadphase;
+    RunBroadphase(state, broadphase, 1.0f, 1.0f);
+}
+
+// Sizes spread over an order of magnitude: the hash has to size its cells for the largest bodies.
+void BenchmarkSweepAndPruneMixed(ddn::BenchmarkState& state)
+{
+    ddn::SweepAndPrune broadphase;
+    RunBroadphase(state, broadphase, 0.25f, 2.5f);
+}
+
+void BenchmarkSpatialHashMixed(ddn::BenchmarkState& state)
+{
+    ddn::SpatialHash broadphase;
+    RunBroadphase(state, broadphase, 0.25f, 2.5f);
+}
+
+}
+
+DDN_BENCHMARK("broadphase/sap-100k", BenchmarkSweepAndPrune);
+DDN_BENCHMARK("broadphase/hash-100k", BenchmarkSpatialHash);
+DDN_BENCHMARK("broadphase/sap-100k-mixed", BenchmarkSweepAndPruneMixed);
+DDN_BENCHMARK("broadphase/hash-100k-mixed", BenchmarkSpatialHashMixed);
@@ -0,0 +1,156 @@
+#include "bvh.h"
+#include "camera.h"
+#include "benchmark.h"
+#include "thread-pool.h"
+
+#include <glm/glm.hpp>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr size_t s_object_count = 1'000'000;
+constexpr size_t s_query_count = 10'000;
+constexpr float s_world_extent = 1000.0f;
+
+std::vector<ddn::Aabb> CreateBounds(uint32_t seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> position_distribution(-s_world_extent, s_world_extent);
+    std::uniform_real_distribution<float> size_distribution(0.25f, 2.0f);
+
+    std::vector<ddn::Aabb> bounds(s_object_count);
+    for (auto& aabb : bounds) {
+        const glm::vec3 center(position_distribution(generator), position_distribution(generator), position_distribution(generator));
+        const glm::vec3 extents(size_distribution(generator), size_distribution(generator), size_distribution(generator));
+        aabb.min = center - extents;
+        aabb.max = center + extents;
+    }
+    return bounds;
+}
+
+void BenchmarkBuild(ddn::BenchmarkState& state)
+{
+    const auto bounds = CreateBounds(1);
+
+    ddn::Bvh bvh;
+    state.Measure([&]() {
+        bvh.Build(bounds);
+    });
+
+    state.SetCounter("objects_per_ms", s_object_count / state.GetSummary().p50_ms);
+    state.SetCounter("nodes", static_cast<double>(bvh.GetNodes().size()));
+    state.SetCounter("depth", bvh.GetDepth());
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkRefit(ddn::BenchmarkState& state)
+{
+    auto bounds = CreateBounds(2);
+
+    ddn::Bvh bvh;
+    bvh.Build(bounds);
+
+    float offset = 0.01f;
+    state.Measure([&]() {
+        ddn::ParallelFor(0, bounds.size(), 16384, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                bounds[i].min.y += offset;
+                bounds[i].max.y += offset;
+            }
+        });
+        bvh.Refit(bounds);
+        offset = -offset;
+    });
+
+    state.SetCounter("objects_per_ms", s_object_count / state.GetSummary().p50_ms);
+}
+
+template <typename Function>
+void RunQueries(ddn::BenchmarkState& state, Function&& query)
+{
+    const auto bounds = CreateBounds(3);
+
+    ddn::Bvh bvh;
+    bvh.Build(bounds);
+
+    std::vector<uint32_t> results;
+    double result_count = 0.0;
+    state.Measure([&]() {
+        result_count = 0.0;
+        std::mt19937 generator(4);
+        for (size_t i = 0; i < s_query_count; ++i) {
+            result_count += query(bvh, bounds, generator, results);
+        }
+    });
+
+    state.SetCounter("queries_per_ms", s_query_count / state.GetSummary().p50_ms);
+    state.SetCounter("results_per_query", result_count / s_query_count);
+}
+
+glm::vec3 CreatePoint(std::mt19937& generator)
+{
+    std::uniform_real_distribution<float> distribution(-s_world_extent, s_world_extent);
+    return glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+}
+
+void BenchmarkAabbQuery(ddn::BenchmarkState& state)
+{
+    RunQueries(state, [](const ddn::Bvh& bvh, const std::vector<ddn::Aabb>&, std::mt19937& generator, std::vector<uint32_t>& results) {
+        const auto center = CreatePoint(generator);
+        ddn::Aabb aabb;
+        aabb.min = center - glm::vec3(20.0f);
+        aabb.max = center + glm::vec3(20.0f);
+        bvh.QueryAabb(aabb, results);
+        return static_cast<double>(results.size());
+    });
+}
+
+void BenchmarkSphereQuery(ddn::BenchmarkState& state)
+{
+    RunQueries(state, [](const ddn::Bvh& bvh, const std::vector<ddn::Aabb>&, std::mt19937& generator, std::vector<uint32_t>& results) {
+        bvh.QuerySphere({ CreatePoint(generator), 20.0f }, results);
+        return static_cast<double>(results.size());
+    });
+}
+
+void BenchmarkRaycast(ddn::BenchmarkState& state)
+{
+    RunQueries(state, [](const ddn::Bvh& bvh, const std::vector<ddn::Aabb>& bounds, std::mt19937& generator, std::vector<uint32_t>&) {
+        ddn::Ray ray;
+        ray.origin = CreatePoint(generator);
+        ray.direction = glm::normalize(CreatePoint(generator));
+        const auto hit = bvh.Raycast(ray, [&](uint32_t primitive, const ddn::Ray& primitive_ray, float& distance) {
+            return primitive_ray.Intersects(bounds[primitive], distance);
+        });
+        return hit.IsValid() ? 1.0 : 0.0;
+    });
+}
+
+void BenchmarkFrustumQuery(ddn::BenchmarkState& state)
+{
+    const auto bounds = CreateBounds(5);
+
+    ddn::Bvh bvh;
+    bvh.Build(bounds);
+
+    ddn::Camera camera(1920, 1080, 60.0f, 0.1f, 500.0f);
+    std::vector<uint32_t> results;
+    state.Measure([&]() {
+        bvh.QueryFrustum(camera.GetFrustum(), results);
+    });
+
+    state.SetCounter("visible", static_cast<double>(results.size()));
+    state.SetCounter("objects_per_ms", s_object_count / state.GetSummary().p50_ms);
+}
+
+}
+
+DDN_BENCHMARK("bvh/build-1m", BenchmarkBuild);
+DDN_BENCHMARK("bvh/refit-1m", BenchmarkRefit);
+DDN_BENCHMARK("bvh/aabb-query-1m", BenchmarkAabbQuery);
+DDN_BENCHMARK("bvh/sphere-query-1m", BenchmarkSphereQuery);
+DDN_BENCHMARK("bvh/raycast-1m", BenchmarkRaycast);
+DDN_BENCHMARK("bvh/frustum-query-1m", BenchmarkFrustumQuery);
@@ -0,0 +1,57 @@
+#include "camera.h"
+#include "benchmark.h"
+
+#include <glm/glm.hpp>
+
+namespace
+{
+
+constexpr size_t s_query_count = 1'000'000;
+
+template <typename Function>
+void RunQueries(ddn::BenchmarkState& state, Function&& function)
+{
+    float checksum = 0.0f;
+    state.Measure([&]() {
+        for (size_t i = 0; i < s_query_count; ++i) {
+            checksum += function(i);
+        }
+    });
+
+    state.SetCounter("ns_per_query", state.GetSummary().p50_ms * 1e6 / s_query_count);
+    state.SetCounter("checksum", checksum);
+}
+
+ddn::Camera CreateCamera()
+{
+    ddn::Camera camera(1920, 1080, 45.0f, 0.1f, 100.0f);
+    camera.SetPosition(glm::vec3(0.0f, 2.0f, -10.0f));
+    camera.LookAt(glm::vec3(0.0f));
+    return camera;
+}
+
+void BenchmarkCachedQueries(ddn::BenchmarkState& state)
+{
+    auto camera = CreateCamera();
+    RunQueries(state, [&](size_t) {
+        const auto& projection_view = camera.GetProjectionViewMatrix();
+        const auto& frustum = camera.GetFrustum();
+        return projection_view[3][3] + frustum.planes[0].w;
+    });
+}
+
+void BenchmarkDirtyQueries(ddn::BenchmarkState& state)
+{
+    auto camera = CreateCamera();
+    RunQueries(state, [&](size_t i) {
+        camera.SetPosition(glm::vec3(0.0f, 2.0f, -10.0f - static_cast<float>(i & 1)));
+        const auto& projection_view = camera.GetProjectionViewMatrix();
+        const auto& frustum = camera.GetFrustum();
+        return projection_view[3][3] + frustum.planes[0].w;
+    });
+}
+
+}
+
+DDN_BENCHMARK("camera/cached-queries", BenchmarkCachedQueries);
+DDN_BENCHMARK("camera/dirty-queries", BenchmarkDirtyQueries);
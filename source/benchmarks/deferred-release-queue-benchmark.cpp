@@ -0,0 +1,137 @@
+#include "benchmark.h"
+#include "deferred-release-queue.h"
+
+#include <limits>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr uint64_t s_frame_count = 10'000;
+constexpr uint64_t s_frames_in_flight = 3;
+constexpr uint64_t s_release_count = 64;
+constexpr uint64_t s_late_release_interval = 16;
+constexpr uint64_t s_callback_interval = 8;
+
+// Stands in for a D3D12 fence: the GPU side is whatever the test says it has completed.
+struct FakeTimeline
+{
+    uint64_t completed_value = 0;
+
+    uint64_t GetCompletedValue() const
+    {
+        return completed_value;
+    }
+};
+
+struct QueueCheck
+{
+    uint64_t live_count = 0;
+    uint64_t early_release_count = 0;
+    uint64_t callback_count = 0;
+    uint64_t expected_callback_count = 0;
+    uint64_t last_callback_fence_value = 0;
+    uint64_t max_pending_count = 0;
+};
+
+// Counts the objects still alive and those freed before the fake GPU was done with them. Released through a
+// shared_ptr, which like a ComPtr frees the object with its last reference.
+class TrackedObject
+{
+public:
+    TrackedObject(const FakeTimeline& timeline, uint64_t fence_value, QueueCheck& check)
+        : m_timeline(&timeline)
+        , m_fence_value(fence_value)
+        , m_check(&check)
+    {
+        ++check.live_count;
+    }
+
+    ~TrackedObject()
+    {
+        if (m_timeline->GetCompletedValue() < m_fence_value) {
+            ++m_check->early_release_count;
+        }
+        --m_check->live_count;
+    }
+
+    TrackedObject(const TrackedObject& other) = delete;
+    TrackedObject& operator =(const TrackedObject& other) = delete;
+
+private:
+    const FakeTimeline* m_timeline = nullptr;
+    uint64_t m_fence_value = 0;
+    QueueCheck* m_check = nullptr;
+};
+
+void Check(bool condition, const char* message)
+{
+    if (!condition) {
+        throw std::logic_error(message);
+    }
+}
+
+// Frames release objects tagged with the fence value of the frame that last used them while the fake GPU
+// trails a few frames behind. Some releases arrive late with an older value, and some entries are callbacks
+// that themselves release another object, as replacing a resource from a completion handler would.
+void RunFrames(ddn::DeferredReleaseQueue& queue, FakeTimeline& timeline, QueueCheck& check)
+{
+    for (uint64_t frame = 1; frame <= s_frame_count; ++frame) {
+        for (uint64_t i = 0; i < s_release_count; ++i) {
+            const uint64_t fence_value = i % s_late_release_interval == 0 ? frame - 1 : frame;
+            if (i % s_callback_interval == 1) {
+                ++check.expected_callback_count;
+                queue.OnCompleted(fence_value, [&queue, &timeline, &check, fence_value]() {
+                    Check(timeline.GetCompletedValue() >= fence_value, "Callback ran before its fence value");
+                    Check(fence_value >= check.last_callback_fence_value, "Callbacks ran out of fence order");
+                    check.last_callback_fence_value = fence_value;
+                    ++check.callback_count;
+                    const uint64_t next_fence_value = fence_value + s_frames_in_flight;
+                    queue.Release(next_fence_value, std::make_shared<TrackedObject>(timeline, next_fence_value, check));
+                });
+            } else {
+                queue.Release(fence_value, std::make_shared<TrackedObject>(timeline, fence_value, check));
+            }
+        }
+
+        if (frame > s_frames_in_flight) {
+            timeline.completed_value = frame - s_frames_in_flight;
+        }
+        queue.Collect(timeline);
+        check.max_pending_count = std::max<uint64_t>(check.max_pending_count, queue.GetPendingCount());
+    }
+
+    timeline.completed_value = std::numeric_limits<uint64_t>::max();
+    while (queue.GetPendingCount() > 0) {
+        queue.Collect(timeline);
+    }
+}
+
+void BenchmarkReleaseCollect(ddn::BenchmarkState& state)
+{
+    QueueCheck check;
+    uint64_t released_count = 0;
+    state.Measure([&]() {
+        ddn::DeferredReleaseQueue queue;
+        FakeTimeline timeline;
+        check = {};
+        RunFrames(queue, timeline, check);
+
+        Check(check.live_count == 0, "Objects leaked after draining the queue");
+        Check(check.early_release_count == 0, "Objects were freed before their fence value completed");
+        Check(check.callback_count == check.expected_callback_count, "Callbacks were lost or ran twice");
+        released_count = queue.GetReleasedCount();
+        Check(released_count == s_frame_count * s_release_count + check.callback_count, "Released count does not match");
+    });
+
+    state.SetCounter("ns_per_release", state.GetSummary().p50_ms * 1e6 / static_cast<double>(released_count));
+    state.SetCounter("max_pending", static_cast<double>(check.max_pending_count));
+    state.SetCounter("callbacks", static_cast<double>(check.callback_count));
+}
+
+}
+
+DDN_BENCHMARK("deferred-release-queue/release-collect-10k-frames", BenchmarkReleaseCollect);
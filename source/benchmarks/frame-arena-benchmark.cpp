@@ -0,0 +1,123 @@
+#include "benchmark.h"
+#include "thread-pool.h"
+#include "frame-arena.h"
+#include "render-queue.h"
+#include "allocation-counter.h"
+
+#include <span>
+#include <atomic>
+#include <random>
+#include <vector>
+#include <memory_resource>
+
+namespace
+{
+
+constexpr size_t s_item_count = 100'000;
+constexpr size_t s_item_grain_size = 4096;
+constexpr uint32_t s_warmup_frame_count = 4;
+
+std::vector<uint64_t> CreateSortKeys()
+{
+    std::mt19937 generator(5);
+    std::uniform_int_distribution<uint32_t> material_distribution(0, 255);
+    std::uniform_int_distribution<uint32_t> geometry_distribution(0, 63);
+    std::uniform_real_distribution<float> depth_distribution(0.0f, 1.0f);
+
+    std::vector<uint64_t> sort_keys(s_item_count);
+    for (auto& sort_key : sort_keys) {
+        ddn::RenderKey key;
+        key.material = material_distribution(generator);
+        key.geometry = geometry_distribution(generator);
+        key.depth = depth_distribution(generator);
+        sort_key = ddn::EncodeRenderKey(key);
+    }
+    return sort_keys;
+}
+
+// Stand-in for a render frame: per-thread visibility lists, then a sorted render queue and its batches,
+// all built in transient containers taken from the resource returned for the calling thread.
+template <typename GetResource>
+size_t RunFrame(std::span<const uint64_t> sort_keys, GetResource&& get_resource)
+{
+    std::atomic_size_t visible_count = 0;
+    ddn::ParallelFor(0, sort_keys.size(), s_item_grain_size, [&](size_t begin, size_t end) {
+        std::pmr::vector<uint32_t> visible_items(get_resource());
+        visible_items.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            if ((sort_keys[i] & 3) != 0) {
+                visible_items.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        visible_count.fetch_add(visible_items.size(), std::memory_order_relaxed);
+    });
+
+    auto* resource = get_resource();
+    ddn::RenderQueue queue(resource);
+    queue.Reserve(visible_count.load());
+    for (uint32_t i = 0; i < sort_keys.size(); ++i) {
+        if ((sort_keys[i] & 3) != 0) {
+            queue.Add(sort_keys[i], i);
+        }
+    }
+    queue.Sort();
+
+    std::pmr::vector<ddn::RenderBatch> batches(resource);
+    queue.BuildBatches(batches);
+    return batches.size();
+}
+
+template <typename Frame>
+void MeasureFrames(ddn::BenchmarkState& state, Frame&& frame)
+{
+    for (uint32_t i = 0; i < s_warmup_frame_count; ++i) {
+        frame();
+    }
+
+    uint64_t allocation_count = 0;
+    uint64_t frame_count = 0;
+    state.Measure([&]() {
+        const auto counters = ddn::GetAllocationCounters();
+        frame();
+        allocation_count += (ddn::GetAllocationCounters() - counters).allocation_count;
+        ++frame_count;
+    });
+
+    state.SetCounter("global_allocations_per_frame", static_cast<double>(allocation_count) / frame_count);
+    state.SetCounter("allocation_counting", ddn::IsAllocationCountingEnabled() ? 1.0 : 0.0);
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkArenaFrame(ddn::BenchmarkState& state)
+{
+    const auto sort_keys = CreateSortKeys();
+
+    ddn::FrameArena frame_arena;
+    uint64_t fence_value = 0;
+    MeasureFrames(state, [&]() {
+        // The simulated GPU trails the CPU by one frame.
+        frame_arena.BeginFrame(fence_value > 0 ? fence_value - 1 : 0);
+        RunFrame(sort_keys, [&]() {
+            return &frame_arena.GetThreadArena();
+        });
+        frame_arena.EndFrame(++fence_value);
+    });
+
+    state.SetCounter("arena_capacity_kb", frame_arena.GetCapacity() / 1024.0);
+}
+
+void BenchmarkHeapFrame(ddn::BenchmarkState& state)
+{
+    const auto sort_keys = CreateSortKeys();
+
+    MeasureFrames(state, [&]() {
+        RunFrame(sort_keys, []() {
+            return std::pmr::get_default_resource();
+        });
+    });
+}
+
+}
+
+DDN_BENCHMARK("frame-arena/arena-frame-100k", BenchmarkArenaFrame);
+DDN_BENCHMARK("frame-arena/heap-frame-100k", BenchmarkHeapFrame);
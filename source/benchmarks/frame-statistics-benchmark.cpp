@@ -0,0 +1,53 @@
+#include "benchmark.h"
+#include "frame-statistics.h"
+
+#include <random>
+
+namespace
+{
+
+void BenchmarkFrameStatistics(ddn::BenchmarkState& state)
+{
+    constexpr size_t s_frame_count = 100'000;
+
+    std::mt19937 generator(42);
+    std::gamma_distribution<double> frame_time_distribution(16.0, 1.0);
+
+    std::vector<double> frame_times(s_frame_count);
+    for (auto& frame_time : frame_times) {
+        frame_time = frame_time_distribution(generator);
+    }
+
+    ddn::FrameStatistics statistics({ "update", "render", "present" });
+    state.Measure([&]() {
+        for (const double frame_time : frame_times) {
+            statistics.AddPhaseTime(0, frame_time * 0.2);
+            statistics.AddPhaseTime(1, frame_time * 0.5);
+            statistics.AddPhaseTime(2, frame_time * 0.3);
+            statistics.AddFrame(frame_time);
+        }
+    });
+
+    const auto summary = statistics.GetFrameSummary();
+    state.SetCounter("frames_per_ms", s_frame_count / state.GetSummary().p50_ms);
+    state.SetCounter("window_p99_ms", summary.p99_ms);
+    state.SetCounter("hitches", static_cast<double>(statistics.GetHitchCount()));
+}
+
+void BenchmarkFrameSummary(ddn::BenchmarkState& state)
+{
+    ddn::FrameStatistics statistics({ "update", "render", "present" });
+    for (size_t i = 0; i < 1024; ++i) {
+        statistics.AddFrame(16.0 + static_cast<double>(i % 7));
+    }
+
+    state.Measure([&]() {
+        volatile double p99 = statistics.GetFrameSummary().p99_ms;
+        (void)p99;
+    });
+}
+
+}
+
+DDN_BENCHMARK("frame-statistics/add-frame", BenchmarkFrameStatistics);
+DDN_BENCHMARK("frame-statistics/summary", BenchmarkFrameSummary);
@@ -0,0 +1,43 @@
+#include "benchmark.h"
+#include "thread-pool.h"
+#include "indirect-draw.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <random>
+#include <numeric>
+
+namespace
+{
+
+constexpr size_t s_draw_count = 100'000;
+
+void BenchmarkIndirectDrawBuild(ddn::BenchmarkState& state)
+{
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> position_distribution(-100.0f, 100.0f);
+
+    std::vector<ddn::DrawItem> items(s_draw_count);
+    for (auto& item : items) {
+        const glm::vec3 position(position_distribution(generator), position_distribution(generator), position_distribution(generator));
+        item.model_matrix = glm::translate(glm::mat4(1.0f), position);
+        item.index_count = 36;
+    }
+
+    std::vector<uint32_t> visible_items(s_draw_count);
+    std::iota(visible_items.begin(), visible_items.end(), 0);
+
+    const glm::mat4 projection_view_matrix(1.0f);
+    ddn::IndirectDrawBuilder builder;
+    state.Measure([&]() {
+        builder.Build(items, visible_items, projection_view_matrix);
+    });
+
+    state.SetCounter("draws_per_ms", s_draw_count / state.GetSummary().p50_ms);
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+}
+
+DDN_BENCHMARK("indirect-draw/build-100k", BenchmarkIndirectDrawBuild);
@@ -0,0 +1,81 @@
+#include "camera.h"
+#include "benchmark.h"
+#include "thread-pool.h"
+#include "light-culler.h"
+
+#include <glm/vec3.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t s_light_count = 10'000;
+constexpr float s_world_size = 400.0f;
+
+// Lights scattered over a city-sized block with a few large ones, seen from street level across the block.
+std::vector<ddn::PointLight> CreateLights()
+{
+    std::mt19937 generator(17);
+    std::uniform_real_distribution<float> position_distribution(-s_world_size * 0.5f, s_world_size * 0.5f);
+    std::uniform_real_distribution<float> height_distribution(0.5f, 30.0f);
+    std::uniform_real_distribution<float> color_distribution(0.2f, 1.0f);
+    std::exponential_distribution<float> radius_distribution(0.25f);
+
+    std::vector<ddn::PointLight> lights(s_light_count);
+    for (auto& light : lights) {
+        light.position = glm::vec3(position_distribution(generator), height_distribution(generator), position_distribution(generator));
+        light.radius = 1.0f + radius_distribution(generator);
+        light.color = glm::vec3(color_distribution(generator), color_distribution(generator), color_distribution(generator));
+        light.intensity = 10.0f;
+    }
+    return lights;
+}
+
+void BenchmarkCull(ddn::BenchmarkState& state, uint32_t tile_size)
+{
+    const auto lights = CreateLights();
+    ddn::Camera camera(1920, 1080, 60.0f, 0.1f, 1000.0f);
+    ddn::LightCuller culler({ tile_size, 24, 256 });
+
+    uint32_t frame_index = 0;
+    state.Measure([&]() {
+        const float angle = frame_index++ * 0.01f;
+        camera.SetPosition(glm::vec3(std::cos(angle) * s_world_size * 0.45f, 2.0f, std::sin(angle) * s_world_size * 0.45f));
+        camera.LookAt(glm::vec3(0.0f, 5.0f, 0.0f));
+        culler.Cull(camera, lights);
+    });
+
+    const auto& statistics = culler.GetStatistics();
+    const auto& constants = culler.GetConstants();
+    state.SetCounter("lights", statistics.light_count);
+    state.SetCounter("visible_lights", statistics.visible_light_count);
+    state.SetCounter("clusters", statistics.cluster_count);
+    state.SetCounter("grid_x", constants.cluster_count_x);
+    state.SetCounter("grid_y", constants.cluster_count_y);
+    state.SetCounter("grid_z", constants.cluster_count_z);
+    state.SetCounter("occupied_clusters", statistics.occupied_cluster_count);
+    state.SetCounter("lights_per_occupied_cluster", static_cast<double>(statistics.index_count) / std::max(statistics.occupied_cluster_count, 1u));
+    state.SetCounter("max_cluster_lights", statistics.max_cluster_light_count);
+    state.SetCounter("indexes", static_cast<double>(statistics.index_count));
+    state.SetCounter("dropped_indexes", static_cast<double>(statistics.dropped_index_count));
+    state.SetCounter("tests_per_light", static_cast<double>(statistics.test_count) / std::max(statistics.visible_light_count, 1u));
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkCull64(ddn::BenchmarkState& state)
+{
+    BenchmarkCull(state, 64);
+}
+
+void BenchmarkCull32(ddn::BenchmarkState& state)
+{
+    BenchmarkCull(state, 32);
+}
+
+}
+
+DDN_BENCHMARK("light-culler/10k-lights-1080p-64px", BenchmarkCull64);
+DDN_BENCHMARK("light-culler/10k-lights-1080p-32px", BenchmarkCull32);
@@ -0,0 +1,16 @@
+#include "benchmark.h"
+
+#include <iostream>
+#include <exception>
+
+int main(int argc, char* argv[])
+{
+    try {
+        const auto options = ddn::ParseBenchmarkOptions(argc, argv);
+        const auto results = ddn::RunBenchmarks(options);
+        return ddn::ReportBenchmarkResults(results, options);
+    } catch (const std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 2;
+    }
+}
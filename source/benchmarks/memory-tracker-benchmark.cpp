@@ -0,0 +1,73 @@
+#include "benchmark.h"
+#include "thread-pool.h"
+#include "memory-tracker.h"
+#include "allocation-counter.h"
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+namespace
+{
+
+constexpr size_t s_allocation_count = 1'000'000;
+constexpr size_t s_allocation_grain_size = 16384;
+constexpr size_t s_batch_size = 64;
+
+// Allocates and frees small blocks in batches on every thread, the pattern that makes per-allocation
+// bookkeeping show up. With DDN_ALLOCATION_COUNTING_ENABLED each block pays for its header and tag counters.
+void BenchmarkNewDelete(ddn::BenchmarkState& state)
+{
+    state.Measure([&]() {
+        ddn::ParallelFor(0, s_allocation_count / s_batch_size, s_allocation_grain_size / s_batch_size, [&](size_t begin, size_t end) {
+            ddn::MemoryTagScope tag_scope(ddn::MemoryTag::Particles);
+            std::unique_ptr<std::byte[]> blocks[s_batch_size];
+            for (size_t batch = begin; batch < end; ++batch) {
+                for (size_t i = 0; i < s_batch_size; ++i) {
+                    blocks[i] = std::make_unique_for_overwrite<std::byte[]>(16 + (batch + i) % 16 * 16);
+                }
+                for (auto& block : blocks) {
+                    block.reset();
+                }
+            }
+        });
+    });
+
+    state.SetCounter("ns_per_allocation", state.GetSummary().p50_ms * 1e6 / s_allocation_count);
+    state.SetCounter("tracking_enabled", ddn::IsAllocationCountingEnabled() ? 1.0 : 0.0);
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+// The counter updates alone, all threads charging the same tag with blocks too small to flush every time.
+void BenchmarkRecord(ddn::BenchmarkState& state)
+{
+    state.Measure([&]() {
+        ddn::ParallelFor(0, s_allocation_count, s_allocation_grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                ddn::RecordAllocation(ddn::MemoryTag::Mesh, 64);
+                ddn::RecordDeallocation(ddn::MemoryTag::Mesh, 64);
+            }
+        });
+    });
+
+    state.SetCounter("ns_per_record", state.GetSummary().p50_ms * 1e6 / s_allocation_count);
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkSample(ddn::BenchmarkState& state)
+{
+    ddn::MemoryTracker tracker;
+    state.Measure([&]() {
+        for (size_t i = 0; i < 1000; ++i) {
+            tracker.Sample();
+        }
+    });
+
+    state.SetCounter("us_per_sample", state.GetSummary().p50_ms);
+}
+
+}
+
+DDN_BENCHMARK("memory-tracker/new-delete-1m", BenchmarkNewDelete);
+DDN_BENCHMARK("memory-tracker/record-1m", BenchmarkRecord);
+DDN_BENCHMARK("memory-tracker/sample", BenchmarkSample);
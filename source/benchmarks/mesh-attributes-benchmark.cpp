@@ -0,0 +1,86 @@
+#include "benchmark.h"
+#include "thread-pool.h"
+#include "mesh-generator.h"
+#include "mesh-attributes.h"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <memory>
+#include <vector>
+#include <cstring>
+
+namespace
+{
+
+constexpr uint32_t s_grid_size = 1415;
+
+struct TangentVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+    glm::vec4 tangent;
+};
+
+using TangentMesh = ddn::Mesh<TangentVertex, uint32_t>;
+
+TangentMesh CreateTangentMesh()
+{
+    const auto sphere = ddn::CreateSphereMesh({ 1.0f, s_grid_size, s_grid_size });
+    const auto* source = reinterpret_cast<const ddn::MeshVertex*>(sphere->GetVertices().data());
+
+    std::vector<TangentVertex> vertices(sphere->GetVertexCount());
+    ddn::ParallelFor(0, vertices.size(), 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            vertices[i] = { source[i].position, source[i].normal, source[i].uv, glm::vec4(0.0f) };
+        }
+    });
+
+    std::vector<uint32_t> indexes(sphere->GetIndexCount());
+    std::memcpy(indexes.data(), sphere->GetIndexes().data(), indexes.size() * sizeof(uint32_t));
+    return TangentMesh(std::move(vertices), std::move(indexes));
+}
+
+void SetCounters(ddn::BenchmarkState& state, const TangentMesh& mesh)
+{
+    const double triangle_count = static_cast<double>(mesh.GetIndexCount() / 3);
+    state.SetCounter("triangles", triangle_count);
+    state.SetCounter("vertices", static_cast<double>(mesh.GetVertexCount()));
+    state.SetCounter("triangles_per_ms", triangle_count / state.GetSummary().p50_ms);
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkAngleNormals(ddn::BenchmarkState& state)
+{
+    auto mesh = CreateTangentMesh();
+    state.Measure([&]() {
+        ddn::GenerateNormals(mesh, &TangentVertex::position, &TangentVertex::normal, ddn::NormalWeighting::Angle);
+    });
+    SetCounters(state, mesh);
+}
+
+void BenchmarkAreaNormals(ddn::BenchmarkState& state)
+{
+    auto mesh = CreateTangentMesh();
+    state.Measure([&]() {
+        ddn::GenerateNormals(mesh, &TangentVertex::position, &TangentVertex::normal, ddn::NormalWeighting::Area);
+    });
+    SetCounters(state, mesh);
+}
+
+void BenchmarkTangents(ddn::BenchmarkState& state)
+{
+    auto mesh = CreateTangentMesh();
+    state.Measure([&]() {
+        ddn::GenerateTangents(mesh, &TangentVertex::position, &TangentVertex::normal, &TangentVertex::uv, &TangentVertex::tangent);
+    });
+    SetCounters(state, mesh);
+}
+
+}
+
+DDN_BENCHMARK("mesh-attributes/angle-normals-4m", BenchmarkAngleNormals);
+DDN_BENCHMARK("mesh-attributes/area-normals-4m", BenchmarkAreaNormals);
+DDN_BENCHMARK("mesh-attributes/tangents-4m", BenchmarkTangents);
@@ -0,0 +1,137 @@
+#include "mesh.h"
+#include "mesh-bvh.h"
+#include "benchmark.h"
+#include "thread-pool.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cstddef>
+
+namespace
+{
+
+constexpr uint32_t s_stack_count = 500;
+constexpr uint32_t s_slice_count = 1000;
+constexpr size_t s_ray_count = 1'000'000;
+
+struct Vertex
+{
+    glm::vec3 normal;
+    glm::vec3 position;
+    glm::vec2 uv;
+};
+
+ddn::Mesh<Vertex, uint32_t> CreateSphere()
+{
+    std::vector<Vertex> vertices;
+    vertices.reserve(static_cast<size_t>(s_stack_count + 1) * (s_slice_count + 1));
+    for (uint32_t stack = 0; stack <= s_stack_count; ++stack) {
+        const float theta = glm::pi<float>() * stack / s_stack_count;
+        for (uint32_t slice = 0; slice <= s_slice_count; ++slice) {
+            const float phi = 2.0f * glm::pi<float>() * slice / s_slice_count;
+            const glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            const float displacement = 1.0f + 0.05f * std::sin(12.0f * theta) * std::cos(9.0f * phi);
+            vertices.push_back({ normal, normal * displacement, glm::vec2(static_cast<float>(slice) / s_slice_count, static_cast<float>(stack) / s_stack_count) });
+        }
+    }
+
+    std::vector<uint32_t> indexes;
+    indexes.reserve(static_cast<size_t>(s_stack_count) * s_slice_count * 6);
+    for (uint32_t stack = 0; stack < s_stack_count; ++stack) {
+        for (uint32_t slice = 0; slice < s_slice_count; ++slice) {
+            const uint32_t a = stack * (s_slice_count + 1) + slice;
+            const uint32_t b = a + s_slice_count + 1;
+            indexes.insert(indexes.end(), { a, b, a + 1, a + 1, b, b + 1 });
+        }
+    }
+
+    return ddn::Mesh<Vertex, uint32_t>(std::move(vertices), std::move(indexes));
+}
+
+glm::vec3 CreateDirection(std::mt19937& generator)
+{
+    std::normal_distribution<float> distribution;
+    return glm::normalize(glm::vec3(distribution(generator), distribution(generator), distribution(generator)));
+}
+
+std::vector<ddn::Ray> CreateRays()
+{
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> target_distribution(0.0f, 0.5f);
+
+    std::vector<ddn::Ray> rays(s_ray_count);
+    for (auto& ray : rays) {
+        ray.origin = CreateDirection(generator) * 3.0f;
+        const auto target = CreateDirection(generator) * target_distribution(generator);
+        ray.direction = glm::normalize(target - ray.origin);
+    }
+    return rays;
+}
+
+void SetRayCounters(ddn::BenchmarkState& state)
+{
+    const double rays_per_s = s_ray_count / (state.GetSummary().p50_ms * 1e-3);
+    state.SetCounter("rays_per_s", rays_per_s);
+    state.SetCounter("rays_per_s_per_core", rays_per_s / ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkBuild(ddn::BenchmarkState& state)
+{
+    const auto sphere = CreateSphere();
+
+    ddn::MeshBvh bvh;
+    state.Measure([&]() {
+        bvh.Build(sphere, offsetof(Vertex, position));
+    });
+
+    state.SetCounter("triangles", bvh.GetTriangleCount());
+    state.SetCounter("triangles_per_ms", bvh.GetTriangleCount() / state.GetSummary().p50_ms);
+}
+
+void BenchmarkRaycast(ddn::BenchmarkState& state)
+{
+    const auto sphere = CreateSphere();
+    const auto rays = CreateRays();
+
+    ddn::MeshBvh bvh;
+    bvh.Build(sphere, offsetof(Vertex, position));
+
+    std::vector<ddn::MeshHit> hits(rays.size());
+    state.Measure([&]() {
+        bvh.Raycast(rays, hits);
+    });
+
+    size_t hit_count = 0;
+    for (const auto& hit : hits) {
+        hit_count += hit.IsValid() ? 1 : 0;
+    }
+
+    SetRayCounters(state);
+    state.SetCounter("hit_ratio", static_cast<double>(hit_count) / rays.size());
+}
+
+void BenchmarkOcclusion(ddn::BenchmarkState& state)
+{
+    const auto sphere = CreateSphere();
+    const auto rays = CreateRays();
+
+    ddn::MeshBvh bvh;
+    bvh.Build(sphere, offsetof(Vertex, position));
+
+    std::vector<uint8_t> occluded(rays.size());
+    state.Measure([&]() {
+        bvh.IsOccluded(rays, occluded);
+    });
+
+    SetRayCounters(state);
+}
+
+}
+
+DDN_BENCHMARK("mesh-bvh/build-1m", BenchmarkBuild);
+DDN_BENCHMARK("mesh-bvh/raycast-1m", BenchmarkRaycast);
+DDN_BENCHMARK("mesh-bvh/occlusion-1m", BenchmarkOcclusion);
@@ -0,0 +1,74 @@
+#include "benchmark.h"
+#include "thread-pool.h"
+#include "mesh-generator.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t s_grid_size = 2237;
+
+template <typename Function>
+void RunGenerator(ddn::BenchmarkState& state, Function&& generate)
+{
+    std::unique_ptr<ddn::IMesh> mesh;
+    state.Measure([&]() {
+        mesh.reset();
+        mesh = generate();
+    });
+
+    const double triangle_count = static_cast<double>(mesh->GetIndexCount() / 3);
+    state.SetCounter("triangles", triangle_count);
+    state.SetCounter("vertices", static_cast<double>(mesh->GetVertexCount()));
+    state.SetCounter("index_size", static_cast<double>(mesh->GetIndexSize()));
+    state.SetCounter("triangles_per_ms", triangle_count / state.GetSummary().p50_ms);
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkSphere(ddn::BenchmarkState& state)
+{
+    RunGenerator(state, []() {
+        return ddn::CreateSphereMesh({ 1.0f, s_grid_size, s_grid_size });
+    });
+}
+
+void BenchmarkPlane(ddn::BenchmarkState& state)
+{
+    RunGenerator(state, []() {
+        return ddn::CreatePlaneMesh({ glm::vec2(100.0f), s_grid_size, s_grid_size });
+    });
+}
+
+void BenchmarkTorus(ddn::BenchmarkState& state)
+{
+    RunGenerator(state, []() {
+        return ddn::CreateTorusMesh({ 1.0f, 0.25f, s_grid_size, s_grid_size });
+    });
+}
+
+void BenchmarkHeightmap(ddn::BenchmarkState& state)
+{
+    const uint32_t sample_count = s_grid_size + 1;
+    std::vector<float> heights(size_t(sample_count) * sample_count);
+    ddn::ParallelFor(0, sample_count, 64, [&](size_t begin, size_t end) {
+        for (size_t z = begin; z < end; ++z) {
+            for (size_t x = 0; x < sample_count; ++x) {
+                heights[z * sample_count + x] = std::sin(x * 0.01f) * std::cos(z * 0.013f) + 0.1f * std::sin(x * 0.2f + z * 0.17f);
+            }
+        }
+    });
+
+    RunGenerator(state, [&]() {
+        return ddn::CreateHeightmapMesh({ heights, sample_count, sample_count, glm::vec2(1000.0f), 50.0f });
+    });
+}
+
+}
+
+DDN_BENCHMARK("mesh-generator/sphere-10m", BenchmarkSphere);
+DDN_BENCHMARK("mesh-generator/plane-10m", BenchmarkPlane);
+DDN_BENCHMARK("mesh-generator/torus-10m", BenchmarkTorus);
+DDN_BENCHMARK("mesh-generator/heightmap-10m", BenchmarkHeightmap);
@@ -0,0 +1,128 @@
+#include "camera.h"
+#include "meshlet.h"
+#include "benchmark.h"
+#include "thread-pool.h"
+#include "mesh-generator.h"
+
+#include <glm/vec3.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+namespace
+{
+
+constexpr uint32_t s_frame_count = 64;
+constexpr uint32_t s_torus_grid_size = 4;
+
+std::unique_ptr<ddn::IMesh> CreateDenseSphere()
+{
+    return ddn::CreateSphereMesh({ 1.0f, 1024, 512 });
+}
+
+ddn::MeshletMesh CreateMeshlets(const ddn::IMesh& mesh)
+{
+    return ddn::MeshletMesh(mesh, offsetof(ddn::MeshVertex, position));
+}
+
+void SetCounters(ddn::BenchmarkState& state, const ddn::MeshletCuller& culler, uint32_t frame_count)
+{
+    const auto& statistics = culler.GetStatistics();
+    const double triangle_count = static_cast<double>(statistics.triangle_count);
+    state.SetCounter("meshlets", statistics.meshlet_count / static_cast<double>(frame_count));
+    state.SetCounter("triangles", triangle_count / frame_count);
+    state.SetCounter("frustum_rejected_pct", statistics.frustum_rejected_triangle_count * 100.0 / triangle_count);
+    state.SetCounter("cone_rejected_pct", statistics.cone_rejected_triangle_count * 100.0 / triangle_count);
+    state.SetCounter("cull_ms", statistics.cull_ms / frame_count);
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkBuildSphere(ddn::BenchmarkState& state)
+{
+    const auto mesh = CreateDenseSphere();
+    size_t meshlet_count = 0;
+    double vertex_count = 0.0;
+    state.Measure([&]() {
+        const auto meshlets = CreateMeshlets(*mesh);
+        meshlet_count = meshlets.GetMeshletCount();
+        vertex_count = static_cast<double>(meshlets.GetVertexIndexes().size());
+    });
+
+    state.SetCounter("triangles", mesh->GetIndexCount() / 3.0);
+    state.SetCounter("meshlets", static_cast<double>(meshlet_count));
+    state.SetCounter("triangles_per_meshlet", mesh->GetIndexCount() / 3.0 / meshlet_count);
+    state.SetCounter("vertices_per_meshlet", vertex_count / meshlet_count);
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+// The camera orbits close to the sphere, so the frustum clips its silhouette and the far side faces away.
+void BenchmarkCullSphere(ddn::BenchmarkState& state)
+{
+    const auto mesh = CreateDenseSphere();
+    const auto meshlets = CreateMeshlets(*mesh);
+    ddn::Camera camera(1920, 1080, 60.0f, 0.1f, 100.0f);
+    ddn::MeshletCuller culler;
+    std::vector<uint32_t> indexes;
+
+    uint32_t frame_index = 0;
+    const auto run_frame = [&]() {
+        const float angle = frame_index++ * 0.05f;
+        camera.SetPosition(glm::vec3(std::cos(angle), 0.3f, std::sin(angle)) * 1.5f);
+        camera.LookAt(glm::vec3(0.0f));
+        indexes.clear();
+        culler.Cull(meshlets, camera, indexes);
+    };
+
+    state.Measure([&]() {
+        for (uint32_t frame = 0; frame < s_frame_count; ++frame) {
+            run_frame();
+        }
+    });
+
+    culler.BeginFrame();
+    for (uint32_t frame = 0; frame < s_frame_count; ++frame) {
+        run_frame();
+    }
+    SetCounters(state, culler, s_frame_count);
+    state.SetCounter("frame_us", state.GetSummary().p50_ms * 1000.0 / s_frame_count);
+}
+
+// A grid of tori seen from above at an angle; each is culled with its own model matrix into one stream.
+void BenchmarkCullTorusGrid(ddn::BenchmarkState& state)
+{
+    const auto mesh = ddn::CreateTorusMesh({ 1.0f, 0.3f, 512, 256 });
+    const auto meshlets = CreateMeshlets(*mesh);
+    ddn::Camera camera(1920, 1080, 60.0f, 0.1f, 100.0f);
+    camera.SetPosition(glm::vec3(-2.0f, 4.0f, -2.0f));
+    camera.LookAt(glm::vec3(4.0f, 0.0f, 4.0f));
+
+    std::vector<glm::mat4> model_matrices;
+    for (uint32_t z = 0; z < s_torus_grid_size; ++z) {
+        for (uint32_t x = 0; x < s_torus_grid_size; ++x) {
+            model_matrices.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(x * 3.0f, 0.0f, z * 3.0f)));
+        }
+    }
+
+    ddn::MeshletCuller culler;
+    std::vector<uint32_t> indexes;
+    const auto run_frame = [&]() {
+        culler.BeginFrame();
+        indexes.clear();
+        for (const auto& model_matrix : model_matrices) {
+            culler.Cull(meshlets, camera, model_matrix, indexes);
+        }
+    };
+
+    state.Measure(run_frame);
+    SetCounters(state, culler, 1);
+    state.SetCounter("indexes", static_cast<double>(indexes.size()));
+}
+
+}
+
+DDN_BENCHMARK("meshlet/build-sphere-1m", BenchmarkBuildSphere);
+DDN_BENCHMARK("meshlet/cull-sphere-1m", BenchmarkCullSphere);
+DDN_BENCHMARK("meshlet/cull-torus-grid-4m", BenchmarkCullTorusGrid);
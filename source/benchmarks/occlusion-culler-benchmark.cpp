@@ -0,0 +1,96 @@
+#include "cube.h"
+#include "camera.h"
+#include "benchmark.h"
+#include "thread-pool.h"
+#include "occlusion-culler.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr size_t s_object_count = 100'000;
+constexpr int s_building_grid_size = 16;
+constexpr float s_building_spacing = 24.0f;
+
+struct Scene
+{
+    std::vector<glm::mat4> occluder_matrices;
+    std::vector<ddn::Aabb> bounds;
+};
+
+Scene CreateScene()
+{
+    Scene scene;
+    std::mt19937 generator(5);
+    std::uniform_real_distribution<float> height_distribution(15.0f, 40.0f);
+
+    const float grid_origin = -0.5f * s_building_grid_size * s_building_spacing;
+    for (int z = 0; z < s_building_grid_size; ++z) {
+        for (int x = 0; x < s_building_grid_size; ++x) {
+            const float height = height_distribution(generator);
+            const glm::vec3 position(grid_origin + x * s_building_spacing, height, 10.0f + z * s_building_spacing);
+            auto matrix = glm::translate(glm::mat4(1.0f), position);
+            scene.occluder_matrices.push_back(glm::scale(matrix, glm::vec3(8.0f, height, 8.0f)));
+        }
+    }
+
+    const float extent = 0.5f * s_building_grid_size * s_building_spacing;
+    std::uniform_real_distribution<float> x_distribution(-extent, extent);
+    std::uniform_real_distribution<float> z_distribution(10.0f, 10.0f + 2.0f * extent);
+    std::uniform_real_distribution<float> y_distribution(0.0f, 4.0f);
+    for (size_t i = 0; i < s_object_count; ++i) {
+        const glm::vec3 center(x_distribution(generator), y_distribution(generator), z_distribution(generator));
+        ddn::Aabb aabb;
+        aabb.min = center - glm::vec3(0.5f);
+        aabb.max = center + glm::vec3(0.5f);
+        scene.bounds.push_back(aabb);
+    }
+
+    return scene;
+}
+
+void BenchmarkOcclusionCull(ddn::BenchmarkState& state)
+{
+    const auto scene = CreateScene();
+    const ddn::Cube cube;
+
+    ddn::Camera camera(1920, 1080, 60.0f, 0.1f, 1000.0f);
+    camera.SetPosition(glm::vec3(12.0f, 3.0f, 0.0f));
+    camera.LookAt(glm::vec3(-20.0f, 3.0f, 100.0f));
+
+    std::vector<uint32_t> frustum_visible_items;
+    const auto& frustum = camera.GetFrustum();
+    for (uint32_t i = 0; i < scene.bounds.size(); ++i) {
+        if (frustum.Intersects(scene.bounds[i])) {
+            frustum_visible_items.push_back(i);
+        }
+    }
+
+    ddn::OcclusionCuller culler;
+    std::vector<uint32_t> visible_items;
+    state.Measure([&]() {
+        culler.BeginFrame(camera.GetProjectionViewMatrix());
+        for (const auto& matrix : scene.occluder_matrices) {
+            culler.AddOccluder(cube, matrix);
+        }
+        culler.Rasterize();
+        culler.Cull(scene.bounds, frustum_visible_items, visible_items);
+    });
+
+    const auto& statistics = culler.GetStatistics();
+    state.SetCounter("rasterization_ms", statistics.rasterization_ms);
+    state.SetCounter("test_ms", statistics.test_ms);
+    state.SetCounter("occluder_triangles", statistics.occluder_triangle_count);
+    state.SetCounter("tested", statistics.tested_count);
+    state.SetCounter("rejected_percent", 100.0 * statistics.occluded_count / std::max<uint32_t>(1, statistics.tested_count));
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+}
+
+DDN_BENCHMARK("occlusion-culler/city-100k", BenchmarkOcclusionCull);
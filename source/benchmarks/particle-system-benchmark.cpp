@@ -0,0 +1,86 @@
+#include "benchmark.h"
+#include "thread-pool.h"
+#include "particle-system.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t s_particle_count = 1'000'000;
+constexpr uint32_t s_emitter_count = 16;
+constexpr float s_frame_time = 1.0f / 60.0f;
+constexpr float s_min_lifetime = 2.0f;
+constexpr float s_max_lifetime = 4.0f;
+
+// Emitters on a ring whose combined rate keeps about s_particle_count particles alive once warmed up.
+void InitializeParticles(ddn::ParticleSystem& particles)
+{
+    const float rate = s_particle_count / ((s_min_lifetime + s_max_lifetime) * 0.5f) / s_emitter_count;
+    for (uint32_t i = 0; i < s_emitter_count; ++i) {
+        const float angle = i * 6.2831853f / s_emitter_count;
+        ddn::ParticleEmitterDesc desc;
+        desc.position = glm::vec3(std::cos(angle) * 50.0f, 0.0f, std::sin(angle) * 50.0f);
+        desc.spawn_radius = 1.0f;
+        desc.velocity = glm::vec3(0.0f, 12.0f, 0.0f);
+        desc.velocity_spread = 4.0f;
+        desc.min_lifetime = s_min_lifetime;
+        desc.max_lifetime = s_max_lifetime;
+        desc.rate = rate;
+        desc.size = 0.1f;
+        desc.color = glm::vec4(1.0f, 0.6f, 0.2f, 1.0f);
+        particles.AddEmitter(desc);
+    }
+
+    for (float time = 0.0f; time < s_max_lifetime; time += s_frame_time * 4.0f) {
+        particles.Update(s_frame_time * 4.0f);
+    }
+}
+
+ddn::ParticleSystemDesc GetSystemDesc()
+{
+    ddn::ParticleSystemDesc desc;
+    desc.capacity = s_particle_count * 5 / 4;
+    desc.drag = 0.2f;
+    return desc;
+}
+
+void BenchmarkUpdate(ddn::BenchmarkState& state)
+{
+    ddn::ParticleSystem particles(GetSystemDesc());
+    InitializeParticles(particles);
+
+    const auto killed_count = particles.GetStatistics().killed_count;
+    uint32_t frame_count = 0;
+    state.Measure([&]() {
+        particles.Update(s_frame_time);
+        ++frame_count;
+    });
+
+    const auto& statistics = particles.GetStatistics();
+    state.SetCounter("particles", particles.GetParticleCount());
+    state.SetCounter("deaths_per_frame", static_cast<double>(statistics.killed_count - killed_count) / frame_count);
+    state.SetCounter("moves_per_frame", statistics.moved_count);
+    state.SetCounter("ns_per_particle", state.GetSummary().p50_ms * 1e6 / particles.GetParticleCount());
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkWriteInstances(ddn::BenchmarkState& state)
+{
+    ddn::ParticleSystem particles(GetSystemDesc());
+    InitializeParticles(particles);
+
+    std::vector<ddn::ParticleInstance> instances(particles.GetCapacity());
+    state.Measure([&]() {
+        particles.WriteInstances(instances);
+    });
+
+    state.SetCounter("particles", particles.GetParticleCount());
+    state.SetCounter("gb_per_s", particles.GetParticleCount() * sizeof(ddn::ParticleInstance) / (state.GetSummary().p50_ms * 1e6));
+}
+
+}
+
+DDN_BENCHMARK("particles/update-1m", BenchmarkUpdate);
+DDN_BENCHMARK("particles/write-instances-1m", BenchmarkWriteInstances);
@@ -0,0 +1,54 @@
+#include "cube.h"
+#include "camera.h"
+#include "benchmark.h"
+#include "path-tracer.h"
+#include "thread-pool.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+namespace
+{
+
+constexpr uint32_t s_width = 256;
+constexpr uint32_t s_height = 256;
+
+void BenchmarkRender(ddn::BenchmarkState& state)
+{
+    const ddn::Cube cube;
+
+    ddn::PathTracerDesc desc;
+    desc.width = s_width;
+    desc.height = s_height;
+
+    ddn::PathTracer path_tracer(desc);
+    path_tracer.AddMesh(cube, glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, 0.0f)), glm::vec3(10.0f, 0.05f, 10.0f)));
+    for (int z = -3; z <= 3; ++z) {
+        for (int x = -3; x <= 3; ++x) {
+            const auto model = glm::translate(glm::mat4(1.0f), glm::vec3(x * 2.5f, -0.5f, z * 2.5f));
+            path_tracer.AddMesh(cube, glm::scale(model, glm::vec3(0.5f)));
+        }
+    }
+    path_tracer.Build();
+
+    ddn::Camera camera(s_width, s_height, 60.0f, 0.1f, 100.0f);
+    camera.SetPosition(glm::vec3(0.0f, 6.0f, -12.0f));
+    camera.LookAt(glm::vec3(0.0f));
+
+    uint64_t ray_count = 0;
+    state.Measure([&]() {
+        path_tracer.Render(camera);
+        ray_count = path_tracer.GetStatistics().ray_count;
+    });
+
+    const double seconds = state.GetSummary().p50_ms * 1e-3;
+    const auto thread_count = ddn::ThreadPool::GetInstance().GetThreadCount();
+    state.SetCounter("threads", thread_count);
+    state.SetCounter("rays_per_s", ray_count / seconds);
+    state.SetCounter("samples_per_s", s_width * s_height / seconds);
+    state.SetCounter("samples_per_s_per_core", s_width * s_height / seconds / thread_count);
+}
+
+}
+
+DDN_BENCHMARK("path-tracer/cubes-256x256-1spp", BenchmarkRender);
@@ -0,0 +1,71 @@
+#include "benchmark.h"
+#include "thread-pool.h"
+#include "render-queue.h"
+
+#include <random>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+
+constexpr size_t s_packet_count = 1'000'000;
+
+std::vector<ddn::RenderPacket> CreatePackets()
+{
+    std::mt19937 generator(11);
+    std::uniform_int_distribution<uint32_t> pipeline_distribution(0, 31);
+    std::uniform_int_distribution<uint32_t> material_distribution(0, 1023);
+    std::uniform_int_distribution<uint32_t> geometry_distribution(0, 63);
+    std::uniform_real_distribution<float> depth_distribution(0.0f, 1.0f);
+
+    std::vector<ddn::RenderPacket> packets(s_packet_count);
+    for (uint32_t i = 0; i < packets.size(); ++i) {
+        ddn::RenderKey key;
+        key.pass = i % 3;
+        key.pipeline = pipeline_distribution(generator);
+        key.material = material_distribution(generator);
+        key.geometry = geometry_distribution(generator);
+        key.depth = depth_distribution(generator);
+        packets[i] = { ddn::EncodeRenderKey(key), i };
+    }
+    return packets;
+}
+
+void BenchmarkRadixSort(ddn::BenchmarkState& state)
+{
+    const auto packets = CreatePackets();
+
+    ddn::RenderQueue queue;
+    queue.Resize(packets.size());
+    std::pmr::vector<ddn::RenderBatch> batches;
+    state.Measure([&]() {
+        std::copy(packets.begin(), packets.end(), queue.GetPackets().begin());
+        queue.Sort();
+    });
+    queue.BuildBatches(batches);
+
+    state.SetCounter("packets_per_ms", s_packet_count / state.GetSummary().p50_ms);
+    state.SetCounter("batches", static_cast<double>(batches.size()));
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkStdSort(ddn::BenchmarkState& state)
+{
+    const auto packets = CreatePackets();
+
+    std::vector<ddn::RenderPacket> sorted_packets(packets.size());
+    state.Measure([&]() {
+        std::copy(packets.begin(), packets.end(), sorted_packets.begin());
+        std::sort(sorted_packets.begin(), sorted_packets.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.sort_key < rhs.sort_key;
+        });
+    });
+
+    state.SetCounter("packets_per_ms", s_packet_count / state.GetSummary().p50_ms);
+}
+
+}
+
+DDN_BENCHMARK("render-queue/radix-sort-1m", BenchmarkRadixSort);
+DDN_BENCHMARK("render-queue/std-sort-1m", BenchmarkStdSort);
@@ -0,0 +1,181 @@
+#include "texture.h"
+#include "benchmark.h"
+#include "thread-pool.h"
+#include "block-compression.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+
+constexpr uint32_t s_image_size = 1024;
+constexpr size_t s_row_grain_size = 16;
+
+uint8_t ToByte(float value)
+{
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+// Stand-ins for a texture set, since there is no image loader: a photo-like albedo with smooth
+// gradients, hard edges and grain, a tangent-space normal map of bumps, and a decal with soft alpha.
+ddn::Image CreateAlbedoImage()
+{
+    ddn::Image image = { s_image_size, s_image_size, std::vector<uint8_t>(size_t(s_image_size) * s_image_size * 4) };
+    ddn::ParallelFor(0, s_image_size, s_row_grain_size, [&](size_t begin, size_t end) {
+        std::minstd_rand generator(static_cast<uint32_t>(begin + 1));
+        std::uniform_real_distribution<float> grain(-0.03f, 0.03f);
+        for (size_t y = begin; y < end; ++y) {
+            for (size_t x = 0; x < s_image_size; ++x) {
+                const float u = float(x) / s_image_size;
+                const float v = float(y) / s_image_size;
+                const float wave = 0.5f + 0.5f * std::sin(u * 9.0f + std::cos(v * 7.0f) * 2.0f);
+                const bool is_tile = (x / 96 + y / 96) % 2 == 0 && v > 0.5f;
+                const float r = is_tile ? 0.75f : 0.2f + 0.6f * wave * u;
+                const float g = is_tile ? 0.7f : 0.3f + 0.5f * v * (1.0f - wave * 0.5f);
+                const float b = is_tile ? 0.6f : 0.5f + 0.4f * std::sin(v * 13.0f) * u;
+                auto* pixel = image.pixels.data() + (y * s_image_size + x) * 4;
+                pixel[0] = ToByte(r + grain(generator));
+                pixel[1] = ToByte(g + grain(generator));
+                pixel[2] = ToByte(b + grain(generator));
+                pixel[3] = 255;
+            }
+        }
+    });
+    return image;
+}
+
+ddn::Image CreateNormalImage()
+{
+    ddn::Image image = { s_image_size, s_image_size, std::vector<uint8_t>(size_t(s_image_size) * s_image_size * 4) };
+    ddn::ParallelFor(0, s_image_size, s_row_grain_size, [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; ++y) {
+            for (size_t x = 0; x < s_image_size; ++x) {
+                const float u = float(x) / s_image_size * 160.0f;
+                const float v = float(y) / s_image_size * 160.0f;
+                const float dx = 1.5f * std::cos(u) * std::sin(v);
+                const float dy = 1.5f * std::sin(u) * std::cos(v);
+                const float length = std::sqrt(dx * dx + dy * dy + 1.0f);
+                auto* pixel = image.pixels.data() + (y * s_image_size + x) * 4;
+                pixel[0] = ToByte(0.5f - 0.5f * dx / length);
+                pixel[1] = ToByte(0.5f - 0.5f * dy / length);
+                pixel[2] = ToByte(0.5f + 0.5f / length);
+                pixel[3] = 255;
+            }
+        }
+    });
+    return image;
+}
+
+ddn::Image CreateDecalImage()
+{
+    auto image = CreateAlbedoImage();
+    ddn::ParallelFor(0, s_image_size, s_row_grain_size, [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; ++y) {
+            for (size_t x = 0; x < s_image_size; ++x) {
+                const float u = float(x) / s_image_size - 0.5f;
+                const float v = float(y) / s_image_size - 0.5f;
+                const float distance = std::sqrt(u * u + v * v);
+                image.pixels[(y * s_image_size + x) * 4 + 3] = ToByte(1.0f - std::clamp((distance - 0.3f) * 8.0f, 0.0f, 1.0f));
+            }
+        }
+    });
+    return image;
+}
+
+void BenchmarkCompression(ddn::BenchmarkState& state, const ddn::Image& image, ddn::TextureFormat format, ddn::CompressionQuality quality)
+{
+    std::vector<uint8_t> blocks(ddn::GetImageByteCount(format, image.width, image.height));
+    state.Measure([&]() {
+        ddn::CompressImage(image.pixels, image.width, image.height, format, quality, blocks);
+    });
+
+    const auto decoded = ddn::DecompressImage(blocks, image.width, image.height, format);
+    const double pixel_count = double(image.width) * image.height;
+    state.SetCounter("mpixels_per_s", pixel_count / 1000.0 / state.GetSummary().p50_ms);
+    state.SetCounter("psnr_db", ddn::ComputePsnr(image.pixels, decoded, ddn::GetChannelCount(format)));
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkBc1Fast(ddn::BenchmarkState& state)
+{
+    BenchmarkCompression(state, CreateAlbedoImage(), ddn::TextureFormat::Bc1, ddn::CompressionQuality::Fast);
+}
+
+void BenchmarkBc1High(ddn::BenchmarkState& state)
+{
+    BenchmarkCompression(state, CreateAlbedoImage(), ddn::TextureFormat::Bc1, ddn::CompressionQuality::High);
+}
+
+void BenchmarkBc3Fast(ddn::BenchmarkState& state)
+{
+    BenchmarkCompression(state, CreateDecalImage(), ddn::TextureFormat::Bc3, ddn::CompressionQuality::Fast);
+}
+
+void BenchmarkBc4Fast(ddn::BenchmarkState& state)
+{
+    BenchmarkCompression(state, CreateAlbedoImage(), ddn::TextureFormat::Bc4, ddn::CompressionQuality::Fast);
+}
+
+void BenchmarkBc5Fast(ddn::BenchmarkState& state)
+{
+    BenchmarkCompression(state, CreateNormalImage(), ddn::TextureFormat::Bc5, ddn::CompressionQuality::Fast);
+}
+
+void BenchmarkBc5High(ddn::BenchmarkState& state)
+{
+    BenchmarkCompression(state, CreateNormalImage(), ddn::TextureFormat::Bc5, ddn::CompressionQuality::High);
+}
+
+void BenchmarkBc7Fast(ddn::BenchmarkState& state)
+{
+    BenchmarkCompression(state, CreateDecalImage(), ddn::TextureFormat::Bc7, ddn::CompressionQuality::Fast);
+}
+
+void BenchmarkBc7High(ddn::BenchmarkState& state)
+{
+    BenchmarkCompression(state, CreateDecalImage(), ddn::TextureFormat::Bc7, ddn::CompressionQuality::High);
+}
+
+void BenchmarkMipChain(ddn::BenchmarkState& state)
+{
+    const auto image = CreateAlbedoImage();
+    std::vector<ddn::Image> mips;
+    state.Measure([&]() {
+        mips = ddn::GenerateMipChain(image, true);
+    });
+    state.SetCounter("mips", static_cast<double>(mips.size()));
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+void BenchmarkTextureBc7(ddn::BenchmarkState& state)
+{
+    const auto image = CreateAlbedoImage();
+    ddn::Texture texture;
+    state.Measure([&]() {
+        texture = ddn::CreateTexture(image, { ddn::TextureFormat::Bc7, ddn::CompressionQuality::Fast, true, true });
+    });
+
+    size_t byte_count = 0;
+    for (const auto& mip : texture.mips) {
+        byte_count += mip.data.size();
+    }
+    state.SetCounter("mips", static_cast<double>(texture.mips.size()));
+    state.SetCounter("bytes", static_cast<double>(byte_count));
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+}
+
+DDN_BENCHMARK("texture-compression/bc1-fast-1k", BenchmarkBc1Fast);
+DDN_BENCHMARK("texture-compression/bc1-high-1k", BenchmarkBc1High);
+DDN_BENCHMARK("texture-compression/bc3-fast-1k", BenchmarkBc3Fast);
+DDN_BENCHMARK("texture-compression/bc4-fast-1k", BenchmarkBc4Fast);
+DDN_BENCHMARK("texture-compression/bc5-fast-1k", BenchmarkBc5Fast);
+DDN_BENCHMARK("texture-compression/bc5-high-1k", BenchmarkBc5High);
+DDN_BENCHMARK("texture-compression/bc7-fast-1k", BenchmarkBc7Fast);
+DDN_BENCHMARK("texture-compression/bc7-high-1k", BenchmarkBc7High);
+DDN_BENCHMARK("texture-compression/mip-chain-1k", BenchmarkMipChain);
+DDN_BENCHMARK("texture-compression/bc7-texture-1k", BenchmarkTextureBc7);
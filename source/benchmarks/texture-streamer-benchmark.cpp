@@ -0,0 +1,86 @@
+#include "camera.h"
+#include "benchmark.h"
+#include "thread-pool.h"
+#include "texture-streamer.h"
+
+#include <glm/vec3.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t s_texture_count = 10'000;
+constexpr uint32_t s_frame_count = 240;
+constexpr float s_world_size = 2000.0f;
+constexpr uint64_t s_memory_budget = 128ull * 1024 * 1024;
+
+struct StreamingScene
+{
+    ddn::TextureStreamer streamer = ddn::TextureStreamer({ s_memory_budget });
+    ddn::SimulatedTextureLoader loader;
+    ddn::Camera camera = ddn::Camera(1920, 1080, 60.0f, 0.1f, 5000.0f);
+    uint32_t frame_index = 0;
+};
+
+void InitializeScene(StreamingScene& scene)
+{
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<float> position_distribution(-s_world_size * 0.5f, s_world_size * 0.5f);
+    std::uniform_real_distribution<float> radius_distribution(1.0f, 20.0f);
+    std::uniform_int_distribution<uint32_t> size_distribution(9, 12);
+    std::uniform_int_distribution<uint32_t> format_distribution(0, 2);
+
+    constexpr ddn::TextureFormat s_formats[] = { ddn::TextureFormat::Bc7, ddn::TextureFormat::Bc1, ddn::TextureFormat::Bc5 };
+    for (uint32_t i = 0; i < s_texture_count; ++i) {
+        ddn::StreamingTextureDesc desc;
+        desc.width = 1u << size_distribution(generator);
+        desc.height = desc.width;
+        desc.format = s_formats[format_distribution(generator)];
+        desc.bounds = { glm::vec3(position_distribution(generator), 0.0f, position_distribution(generator)), radius_distribution(generator) };
+        scene.streamer.AddTexture(desc);
+    }
+}
+
+// The camera circles the world, so textures keep entering and leaving the view and the budget.
+void RunFrame(StreamingScene& scene)
+{
+    const float angle = scene.frame_index * 0.01f;
+    const glm::vec3 position(std::cos(angle) * s_world_size * 0.3f, 20.0f, std::sin(angle) * s_world_size * 0.3f);
+    scene.camera.SetPosition(position);
+    scene.camera.LookAt(position + glm::vec3(-std::sin(angle), -0.1f, std::cos(angle)));
+    ++scene.frame_index;
+
+    scene.loader.Update(scene.streamer);
+    scene.loader.Submit(scene.streamer.Update(scene.camera));
+}
+
+void BenchmarkStreaming(ddn::BenchmarkState& state)
+{
+    StreamingScene scene;
+    InitializeScene(scene);
+
+    state.Measure([&]() {
+        for (uint32_t frame = 0; frame < s_frame_count; ++frame) {
+            RunFrame(scene);
+        }
+    });
+
+    const auto& statistics = scene.streamer.GetStatistics();
+    const double frame_total = static_cast<double>(scene.frame_index);
+    state.SetCounter("textures", s_texture_count);
+    state.SetCounter("update_us", state.GetSummary().p50_ms * 1000.0 / s_frame_count);
+    state.SetCounter("resident_mb", statistics.resident_size / (1024.0 * 1024.0));
+    state.SetCounter("budget_mb", s_memory_budget / (1024.0 * 1024.0));
+    state.SetCounter("loads_per_frame", statistics.load_count / frame_total);
+    state.SetCounter("evictions_per_frame", statistics.eviction_count / frame_total);
+    state.SetCounter("budget_evictions_per_frame", statistics.budget_eviction_count / frame_total);
+    state.SetCounter("reloads", static_cast<double>(statistics.reload_count));
+    state.SetCounter("threads", ddn::ThreadPool::GetInstance().GetThreadCount());
+}
+
+}
+
+DDN_BENCHMARK("texture-streamer/orbit-10k", BenchmarkStreaming);
@@ -0,0 +1,1441 @@
+#include "block-compression.h"
+#include "simd.h"
+#include "profiler.h"
+#include "thread-pool.h"
+
+#include <bit>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+using ddn::Float4;
+using ddn::CompressionQuality;
+
+constexpr uint32_t s_block_dimension = 4;
+constexpr uint32_t s_block_pixel_count = 16;
+constexpr size_t s_block_grain_size = 256;
+constexpr uint32_t s_power_iteration_count = 8;
+constexpr uint32_t s_max_perturbation_pass_count = 8;
+constexpr uint32_t s_bc7_mode = 6;
+
+constexpr uint32_t s_bc7_refinement_count = 2;
+constexpr uint32_t s_bc7_partition_count = 64;
+constexpr uint32_t s_bc7_partition_candidate_count = 4;
+constexpr uint32_t s_partition_estimate_iteration_count = 2;
+
+constexpr std::array<uint32_t, 16> s_bc7_weights = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+constexpr std::array<uint32_t, 8> s_bc7_weights3 = { 0, 9, 18, 27, 37, 46, 55, 64 };
+constexpr std::array<uint32_t, 4> s_bc7_weights2 = { 0, 21, 43, 64 };
+
+// Pixels of the second subset in each two-subset partition, bit i for pixel i in row order.
+constexpr std::array<uint16_t, 64> s_bc7_partitions = {
+    0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80, 0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+    0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce, 0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+    0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a, 0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+    0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c, 0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22,
+};
+
+// Anchor pixel of the second subset, whose index is stored without its top bit like pixel 0's.
+constexpr std::array<uint8_t, 64> s_bc7_anchors = {
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+    15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+    6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15,
+};
+
+using BlockPixels = std::array<uint8_t, s_block_pixel_count * 4>;
+using BlockIndexes = std::array<uint8_t, s_block_pixel_count>;
+
+template <size_t ChannelCount>
+using Color = std::array<float, ChannelCount>;
+
+template <size_t ChannelCount>
+struct Endpoints
+{
+    Color<ChannelCount> first;
+    Color<ChannelCount> second;
+};
+
+// Channel c of block row r is rows[c][r], with one lane per column.
+template <size_t ChannelCount>
+struct BlockRows
+{
+    std::array<std::array<Float4, s_block_dimension>, ChannelCount> rows;
+};
+
+BlockPixels LoadBlock(std::span<const uint8_t> pixels, uint32_t width, uint32_t height, uint32_t block_x, uint32_t block_y)
+{
+    BlockPixels block;
+    for (uint32_t y = 0; y < s_block_dimension; ++y) {
+        const auto source_y = std::min(block_y * s_block_dimension + y, height - 1);
+        for (uint32_t x = 0; x < s_block_dimension; ++x) {
+            const auto source_x = std::min(block_x * s_block_dimension + x, width - 1);
+            const auto* source = pixels.data() + (size_t(source_y) * width + source_x) * 4;
+            std::copy(source, source + 4, block.data() + (y * s_block_dimension + x) * 4);
+        }
+    }
+    return block;
+}
+
+void StoreBlock(const BlockPixels& block, uint32_t width, uint32_t height, uint32_t block_x, uint32_t block_y, std::span<uint8_t> pixels)
+{
+    for (uint32_t y = 0; y < s_block_dimension && block_y * s_block_dimension + y < height; ++y) {
+        for (uint32_t x = 0; x < s_block_dimension && block_x * s_block_dimension + x < width; ++x) {
+            const auto* source = block.data() + (y * s_block_dimension + x) * 4;
+            auto* destination = pixels.data() + (size_t(block_y * s_block_dimension + y) * width + block_x * s_block_dimension + x) * 4;
+            std::copy(source, source + 4, destination);
+        }
+    }
+}
+
+template <size_t ChannelCount>
+BlockRows<ChannelCount> LoadRows(const BlockPixels& block, const std::array<uint32_t, ChannelCount>& channels)
+{
+    BlockRows<ChannelCount> rows;
+    for (uint32_t c = 0; c < ChannelCount; ++c) {
+        for (uint32_t y = 0; y < s_block_dimension; ++y) {
+            const auto* row = block.data() + y * s_block_dimension * 4 + channels[c];
+            rows.rows[c][y] = Float4::Set(row[0], row[4], row[8], row[12]);
+        }
+    }
+    return rows;
+}
+
+template <size_t ChannelCount>
+Color<ChannelCount> Clamp(Color<ChannelCount> color)
+{
+    for (auto& value : color) {
+        value = std::clamp(value, 0.0f, 255.0f);
+    }
+    return color;
+}
+
+// Endpoints spanning the block along the principal axis of its colors.
+template <size_t ChannelCount>
+Endpoints<ChannelCount> FindPrincipalEndpoints(const BlockRows<ChannelCount>& block)
+{
+    Color<ChannelCount> mean;
+    std::array<std::array<Float4, s_block_dimension>, ChannelCount> centered;
+    for (uint32_t c = 0; c < ChannelCount; ++c) {
+        const auto& rows = block.rows[c];
+        mean[c] = ddn::HorizontalSum(rows[0] + rows[1] + rows[2] + rows[3]) / s_block_pixel_count;
+        for (uint32_t y = 0; y < s_block_dimension; ++y) {
+            centered[c][y] = rows[y] - Float4::Splat(mean[c]);
+        }
+    }
+
+    std::array<Color<ChannelCount>, ChannelCount> covariance;
+    for (uint32_t i = 0; i < ChannelCount; ++i) {
+        for (uint32_t j = i; j < ChannelCount; ++j) {
+            const auto sum = centered[i][0] * centered[j][0] + centered[i][1] * centered[j][1] + centered[i][2] * centered[j][2] + centered[i][3] * centered[j][3];
+            covariance[i][j] = ddn::HorizontalSum(sum);
+            covariance[j][i] = covariance[i][j];
+        }
+    }
+
+    uint32_t largest_channel = 0;
+    for (uint32_t c = 1; c < ChannelCount; ++c) {
+        if (covariance[c][c] > covariance[largest_channel][largest_channel]) {
+            largest_channel = c;
+        }
+    }
+
+    auto axis = covariance[largest_channel];
+    for (uint32_t iteration = 0; iteration < s_power_iteration_count; ++iteration) {
+        Color<ChannelCount> next = {};
+        float largest_component = 0.0f;
+        for (uint32_t i = 0; i < ChannelCount; ++i) {
+            for (uint32_t j = 0; j < ChannelCount; ++j) {
+                next[i] += covariance[i][j] * axis[j];
+            }
+            largest_component = std::max(largest_component, std::abs(next[i]));
+        }
+        if (largest_component <= 0.0f) {
+            break;
+        }
+        for (uint32_t i = 0; i < ChannelCount; ++i) {
+            axis[i] = next[i] / largest_component;
+        }
+    }
+
+    float length_squared = 0.0f;
+    for (const auto component : axis) {
+        length_squared += component * component;
+    }
+    if (length_squared <= 0.0f) {
+        return { mean, mean };
+    }
+
+    const float inverse_length = 1.0f / std::sqrt(length_squared);
+    for (auto& component : axis) {
+        component *= inverse_length;
+    }
+
+    auto min_projection = Float4::Splat(std::numeric_limits<float>::max());
+    auto max_projection = Float4::Splat(-std::numeric_limits<float>::max());
+    for (uint32_t y = 0; y < s_block_dimension; ++y) {
+        auto projection = Float4::Splat(0.0f);
+        for (uint32_t c = 0; c < ChannelCount; ++c) {
+            projection = projection + centered[c][y] * Float4::Splat(axis[c]);
+        }
+        min_projection = ddn::Min(min_projection, projection);
+        max_projection = ddn::Max(max_projection, projection);
+    }
+
+    const float min_t = ddn::HorizontalMin(min_projection);
+    const float max_t = ddn::HorizontalMax(max_projection);
+    Endpoints<ChannelCount> endpoints;
+    for (uint32_t c = 0; c < ChannelCount; ++c) {
+        endpoints.first[c] = mean[c] + axis[c] * min_t;
+        endpoints.second[c] = mean[c] + axis[c] * max_t;
+    }
+    endpoints.first = Clamp(endpoints.first);
+    endpoints.second = Clamp(endpoints.second);
+    return endpoints;
+}
+
+// Picks the nearest palette entry for every pixel, four pixels per step. Returns the summed squared error.
+template <size_t ChannelCount, size_t PaletteSize>
+float SelectIndexes(const BlockRows<ChannelCount>& block, const std::array<Color<ChannelCount>, PaletteSize>& palette, BlockIndexes& indexes)
+{
+    auto total_error = Float4::Splat(0.0f);
+    for (uint32_t y = 0; y < s_block_dimension; ++y) {
+        auto best_error = Float4::Splat(std::numeric_limits<float>::max());
+        auto best_index = Float4::Splat(0.0f);
+        for (size_t entry = 0; entry < PaletteSize; ++entry) {
+            auto error = Float4::Splat(0.0f);
+            for (uint32_t c = 0; c < ChannelCount; ++c) {
+                const auto difference = block.rows[c][y] - Float4::Splat(palette[entry][c]);
+                error = error + difference * difference;
+            }
+            const auto is_better = error < best_error;
+            best_error = ddn::Select(is_better, error, best_error);
+            best_index = ddn::Select(is_better, Float4::Splat(static_cast<float>(entry)), best_index);
+        }
+
+        float row_indexes[s_block_dimension];
+        best_index.Store(row_indexes);
+        for (uint32_t x = 0; x < s_block_dimension; ++x) {
+            indexes[y * s_block_dimension + x] = static_cast<uint8_t>(row_indexes[x]);
+        }
+        total_error = total_error + best_error;
+    }
+    return ddn::HorizontalSum(total_error);
+}
+
+// Least-squares endpoints for fixed indexes, where weights[i] is the contribution of the second endpoint.
+template <size_t ChannelCount, size_t PaletteSize>
+bool FitEndpoints(const BlockRows<ChannelCount>& block, const BlockIndexes& indexes, const std::array<float, PaletteSize>& weights, Endpoints<ChannelCount>& endpoints)
+{
+    std::array<std::array<float, s_block_pixel_count>, ChannelCount> values;
+    for (uint32_t c = 0; c < ChannelCount; ++c) {
+        for (uint32_t y = 0; y < s_block_dimension; ++y) {
+            block.rows[c][y].Store(values[c].data() + y * s_block_dimension);
+        }
+    }
+
+    float first_first = 0.0f;
+    float first_second = 0.0f;
+    float second_second = 0.0f;
+    Color<ChannelCount> first_value = {};
+    Color<ChannelCount> second_value = {};
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        const float second_weight = weights[indexes[i]];
+        const float first_weight = 1.0f - second_weight;
+        first_first += first_weight * first_weight;
+        first_second += first_weight * second_weight;
+        second_second += second_weight * second_weight;
+        for (uint32_t c = 0; c < ChannelCount; ++c) {
+            first_value[c] += first_weight * values[c][i];
+            second_value[c] += second_weight * values[c][i];
+        }
+    }
+
+    const float determinant = first_first * second_second - first_second * first_second;
+    if (std::abs(determinant) < 1e-6f) {
+        return false;
+    }
+
+    const float inverse_determinant = 1.0f / determinant;
+    for (uint32_t c = 0; c < ChannelCount; ++c) {
+        endpoints.first[c] = (second_second * first_value[c] - first_second * second_value[c]) * inverse_determinant;
+        endpoints.second[c] = (first_first * second_value[c] - first_second * first_value[c]) * inverse_determinant;
+    }
+    endpoints.first = Clamp(endpoints.first);
+    endpoints.second = Clamp(endpoints.second);
+    return true;
+}
+
+class BitWriter
+{
+public:
+    explicit BitWriter(uint8_t* output)
+        : m_output(output)
+    {
+        std::fill(m_output, m_output + 16, uint8_t(0));
+    }
+
+    void Write(uint32_t value, uint32_t bit_count)
+    {
+        for (uint32_t bit = 0; bit < bit_count; ++bit, ++m_position) {
+            m_output[m_position / 8] |= static_cast<uint8_t>(((value >> bit) & 1) << (m_position % 8));
+        }
+    }
+
+private:
+    uint8_t* m_output = nullptr;
+    uint32_t m_position = 0;
+};
+
+class BitReader
+{
+public:
+    explicit BitReader(const uint8_t* input)
+        : m_input(input)
+    {}
+
+    uint32_t Read(uint32_t bit_count)
+    {
+        uint32_t value = 0;
+        for (uint32_t bit = 0; bit < bit_count; ++bit, ++m_position) {
+            value |= uint32_t((m_input[m_position / 8] >> (m_position % 8)) & 1) << bit;
+        }
+        return value;
+    }
+
+private:
+    const uint8_t* m_input = nullptr;
+    uint32_t m_position = 0;
+};
+
+uint16_t QuantizeRgb565(const Color<3>& color)
+{
+    const auto r = static_cast<uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+    const auto g = static_cast<uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+    const auto b = static_cast<uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+    return static_cast<uint16_t>(r << 11 | g << 5 | b);
+}
+
+std::array<uint32_t, 3> ExpandRgb565(uint16_t color)
+{
+    const uint32_t r = (color >> 11) & 31;
+    const uint32_t g = (color >> 5) & 63;
+    const uint32_t b = color & 31;
+    return { r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2 };
+}
+
+std::array<std::array<uint32_t, 3>, 4> GetBc1Palette(uint16_t color0, uint16_t color1, bool is_four_color)
+{
+    const auto first = ExpandRgb565(color0);
+    const auto second = ExpandRgb565(color1);
+    std::array<std::array<uint32_t, 3>, 4> palette = { first, second };
+    for (uint32_t c = 0; c < 3; ++c) {
+        if (is_four_color) {
+            palette[2][c] = (2 * first[c] + second[c]) / 3;
+            palette[3][c] = (first[c] + 2 * second[c]) / 3;
+        } else {
+            palette[2][c] = (first[c] + second[c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    return palette;
+}
+
+struct Bc1Block
+{
+    uint16_t color0 = 0;
+    uint16_t color1 = 0;
+    BlockIndexes indexes = {};
+    float error = 0.0f;
+};
+
+Bc1Block FitBc1(const BlockRows<3>& block, uint16_t color0, uint16_t color1)
+{
+    Bc1Block result;
+    result.color0 = color0;
+    result.color1 = color1;
+    if (result.color0 < result.color1) {
+        std::swap(result.color0, result.color1);
+    }
+
+    // Equal endpoints would select three-color mode, so the block is encoded as a single color.
+    const auto palette = GetBc1Palette(result.color0, result.color1, true);
+    std::array<Color<3>, 4> float_palette;
+    for (size_t entry = 0; entry < palette.size(); ++entry) {
+        for (uint32_t c = 0; c < 3; ++c) {
+            float_palette[entry][c] = static_cast<float>(palette[entry][c]);
+        }
+    }
+
+    if (result.color0 == result.color1) {
+        result.error = SelectIndexes<3, 1>(block, { float_palette[0] }, result.indexes);
+    } else {
+        result.error = SelectIndexes(block, float_palette, result.indexes);
+    }
+    return result;
+}
+
+Bc1Block FitBc1(const BlockRows<3>& block, const Endpoints<3>& endpoints)
+{
+    return FitBc1(block, QuantizeRgb565(endpoints.first), QuantizeRgb565(endpoints.second));
+}
+
+// Least squares ignores the rounding to 5:6:5 and the palette's integer interpolation, so the best encoding
+// often sits a step away from the fitted endpoints: nudge each endpoint channel while that lowers the error.
+Bc1Block PerturbBc1(const BlockRows<3>& block, Bc1Block best)
+{
+    static constexpr std::array<uint32_t, 3> s_shifts = { 11, 5, 0 };
+    static constexpr std::array<uint32_t, 3> s_masks = { 31, 63, 31 };
+
+    for (uint32_t pass = 0; pass < s_max_perturbation_pass_count && best.error > 0.0f; ++pass) {
+        bool is_improved = false;
+        for (uint32_t endpoint = 0; endpoint < 2; ++endpoint) {
+            for (uint32_t c = 0; c < 3; ++c) {
+                for (const int32_t step : { -1, 1 }) {
+                    std::array<uint16_t, 2> colors = { best.color0, best.color1 };
+                    const int32_t value = static_cast<int32_t>((colors[endpoint] >> s_shifts[c]) & s_masks[c]) + step;
+                    if (value < 0 || value > static_cast<int32_t>(s_masks[c])) {
+                        continue;
+                    }
+                    colors[endpoint] = static_cast<uint16_t>((colors[endpoint] & ~(s_masks[c] << s_shifts[c])) | uint32_t(value) << s_shifts[c]);
+
+                    const auto candidate = FitBc1(block, colors[0], colors[1]);
+                    if (candidate.error < best.error) {
+                        best = candidate;
+                        is_improved = true;
+                    }
+                }
+            }
+        }
+        if (!is_improved) {
+            break;
+        }
+    }
+    return best;
+}
+
+void EncodeBc1(const BlockRows<3>& block, CompressionQuality quality, uint8_t* output)
+{
+    static constexpr std::array<float, 4> s_weights = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    auto best = FitBc1(block, FindPrincipalEndpoints(block));
+    const uint32_t refinement_count = quality == CompressionQuality::High ? 4 : 1;
+    for (uint32_t i = 0; i < refinement_count && best.color0 != best.color1; ++i) {
+        Endpoints<3> endpoints;
+        if (!FitEndpoints(block, best.indexes, s_weights, endpoints)) {
+            break;
+        }
+        const auto candidate = FitBc1(block, endpoints);
+        if (candidate.error >= best.error) {
+            break;
+        }
+        best = candidate;
+    }
+    if (quality == CompressionQuality::High) {
+        best = PerturbBc1(block, best);
+    }
+
+    uint32_t packed_indexes = 0;
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        packed_indexes |= uint32_t(best.indexes[i]) << (i * 2);
+    }
+    output[0] = static_cast<uint8_t>(best.color0);
+    output[1] = static_cast<uint8_t>(best.color0 >> 8);
+    output[2] = static_cast<uint8_t>(best.color1);
+    output[3] = static_cast<uint8_t>(best.color1 >> 8);
+    for (uint32_t i = 0; i < 4; ++i) {
+        output[4 + i] = static_cast<uint8_t>(packed_indexes >> (i * 8));
+    }
+}
+
+void DecodeBc1(const uint8_t* input, bool is_four_color, BlockPixels& block)
+{
+    const auto color0 = static_cast<uint16_t>(input[0] | input[1] << 8);
+    const auto color1 = static_cast<uint16_t>(input[2] | input[3] << 8);
+    is_four_color = is_four_color || color0 > color1;
+    const auto palette = GetBc1Palette(color0, color1, is_four_color);
+
+    const uint32_t packed_indexes = uint32_t(input[4]) | uint32_t(input[5]) << 8 | uint32_t(input[6]) << 16 | uint32_t(input[7]) << 24;
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        const auto index = (packed_indexes >> (i * 2)) & 3;
+        for (uint32_t c = 0; c < 3; ++c) {
+            block[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+        }
+        block[i * 4 + 3] = !is_four_color && index == 3 ? 0 : 255;
+    }
+}
+
+std::array<uint32_t, 8> GetBc4Palette(uint32_t value0, uint32_t value1)
+{
+    std::array<uint32_t, 8> palette = { value0, value1 };
+    if (value0 > value1) {
+        for (uint32_t i = 2; i < 8; ++i) {
+            palette[i] = ((8 - i) * value0 + (i - 1) * value1 + 3) / 7;
+        }
+    } else {
+        for (uint32_t i = 2; i < 6; ++i) {
+            palette[i] = ((6 - i) * value0 + (i - 1) * value1 + 2) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    return palette;
+}
+
+struct Bc4Block
+{
+    uint8_t value0 = 0;
+    uint8_t value1 = 0;
+    BlockIndexes indexes = {};
+    float error = 0.0f;
+};
+
+Bc4Block FitBc4(const BlockRows<1>& block, uint8_t value0, uint8_t value1)
+{
+    Bc4Block result;
+    result.value0 = value0;
+    result.value1 = value1;
+
+    const auto palette = GetBc4Palette(value0, value1);
+    std::array<Color<1>, 8> float_palette;
+    for (size_t entry = 0; entry < palette.size(); ++entry) {
+        float_palette[entry][0] = static_cast<float>(palette[entry]);
+    }
+    result.error = SelectIndexes(block, float_palette, result.indexes);
+    return result;
+}
+
+void EncodeBc4(const BlockRows<1>& block, CompressionQuality quality, uint8_t* output)
+{
+    static constexpr std::array<float, 8> s_weights = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+
+    const auto& rows = block.rows[0];
+    const auto min_value = ddn::HorizontalMin(ddn::Min(ddn::Min(rows[0], rows[1]), ddn::Min(rows[2], rows[3])));
+    const auto max_value = ddn::HorizontalMax(ddn::Max(ddn::Max(rows[0], rows[1]), ddn::Max(rows[2], rows[3])));
+    auto best = FitBc4(block, static_cast<uint8_t>(max_value), static_cast<uint8_t>(min_value));
+
+    if (quality == CompressionQuality::High && best.value0 > best.value1) {
+        for (uint32_t i = 0; i < 2; ++i) {
+            Endpoints<1> endpoints;
+            if (!FitEndpoints(block, best.indexes, s_weights, endpoints)) {
+                break;
+            }
+            auto value0 = static_cast<uint8_t>(std::lround(endpoints.first[0]));
+            auto value1 = static_cast<uint8_t>(std::lround(endpoints.second[0]));
+            if (value0 == value1) {
+                break;
+            }
+            if (value0 < value1) {
+                std::swap(value0, value1);
+            }
+            const auto candidate = FitBc4(block, value0, value1);
+            if (candidate.error >= best.error) {
+                break;
+            }
+            best = candidate;
+        }
+
+        // Six-value mode stores exact 0 and 255, which helps blocks mixing extremes with mid tones.
+        if (min_value == 0.0f || max_value == 255.0f) {
+            auto inner_min = Float4::Splat(255.0f);
+            auto inner_max = Float4::Splat(0.0f);
+            for (const auto& row : rows) {
+                inner_min = ddn::Min(inner_min, ddn::Select(row > Float4::Splat(0.0f), row, Float4::Splat(255.0f)));
+                inner_max = ddn::Max(inner_max, ddn::Select(row < Float4::Splat(255.0f), row, Float4::Splat(0.0f)));
+            }
+            const auto value0 = static_cast<uint8_t>(ddn::HorizontalMin(inner_min));
+            const auto value1 = static_cast<uint8_t>(ddn::HorizontalMax(inner_max));
+            if (value0 <= value1) {
+                const auto candidate = FitBc4(block, value0, value1);
+                if (candidate.error < best.error) {
+                    best = candidate;
+                }
+            }
+        }
+    }
+
+    uint64_t packed_indexes = 0;
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        packed_indexes |= uint64_t(best.indexes[i]) << (i * 3);
+    }
+    output[0] = best.value0;
+    output[1] = best.value1;
+    for (uint32_t i = 0; i < 6; ++i) {
+        output[2 + i] = static_cast<uint8_t>(packed_indexes >> (i * 8));
+    }
+}
+
+void DecodeBc4(const uint8_t* input, uint32_t channel, BlockPixels& block)
+{
+    const auto palette = GetBc4Palette(input[0], input[1]);
+    uint64_t packed_indexes = 0;
+    for (uint32_t i = 0; i < 6; ++i) {
+        packed_indexes |= uint64_t(input[2 + i]) << (i * 8);
+    }
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        block[i * 4 + channel] = static_cast<uint8_t>(palette[(packed_indexes >> (i * 3)) & 7]);
+    }
+}
+
+struct Bc7Block
+{
+    std::array<uint8_t, 4> endpoint0 = {};
+    std::array<uint8_t, 4> endpoint1 = {};
+    uint32_t p_bit0 = 0;
+    uint32_t p_bit1 = 0;
+    BlockIndexes indexes = {};
+    float error = 0.0f;
+};
+
+std::array<uint8_t, 4> QuantizeBc7Endpoint(const Color<4>& color, uint32_t p_bit)
+{
+    std::array<uint8_t, 4> endpoint;
+    for (uint32_t c = 0; c < 4; ++c) {
+        endpoint[c] = static_cast<uint8_t>(std::clamp<long>(std::lround((color[c] - p_bit) * 0.5f), 0, 127));
+    }
+    return endpoint;
+}
+
+float GetBc7QuantizationError(const Color<4>& color, uint32_t p_bit)
+{
+    const auto endpoint = QuantizeBc7Endpoint(color, p_bit);
+    float error = 0.0f;
+    for (uint32_t c = 0; c < 4; ++c) {
+        const float difference = static_cast<float>(endpoint[c] << 1 | p_bit) - color[c];
+        error += difference * difference;
+    }
+    return error;
+}
+
+std::array<std::array<uint32_t, 4>, 16> GetBc7Palette(const std::array<uint8_t, 4>& endpoint0, const std::array<uint8_t, 4>& endpoint1, uint32_t p_bit0, uint32_t p_bit1)
+{
+    std::array<std::array<uint32_t, 4>, 16> palette;
+    for (uint32_t c = 0; c < 4; ++c) {
+        const uint32_t first = uint32_t(endpoint0[c]) << 1 | p_bit0;
+        const uint32_t second = uint32_t(endpoint1[c]) << 1 | p_bit1;
+        for (uint32_t i = 0; i < 16; ++i) {
+            palette[i][c] = ((64 - s_bc7_weights[i]) * first + s_bc7_weights[i] * second + 32) >> 6;
+        }
+    }
+    return palette;
+}
+
+Bc7Block FitBc7(const BlockRows<4>& block, const Endpoints<4>& endpoints, uint32_t p_bit0, uint32_t p_bit1)
+{
+    Bc7Block result;
+    result.endpoint0 = QuantizeBc7Endpoint(endpoints.first, p_bit0);
+    result.endpoint1 = QuantizeBc7Endpoint(endpoints.second, p_bit1);
+    result.p_bit0 = p_bit0;
+    result.p_bit1 = p_bit1;
+
+    const auto palette = GetBc7Palette(result.endpoint0, result.endpoint1, p_bit0, p_bit1);
+    std::array<Color<4>, 16> float_palette;
+    for (size_t entry = 0; entry < palette.size(); ++entry) {
+        for (uint32_t c = 0; c < 4; ++c) {
+            float_palette[entry][c] = static_cast<float>(palette[entry][c]);
+        }
+    }
+    result.error = SelectIndexes(block, float_palette, result.indexes);
+
+    // The anchor index is stored without its top bit; the weights are symmetric, so swapping the
+    // endpoints and mirroring the indexes keeps the decoded colors.
+    if (result.indexes[0] >= 8) {
+        std::swap(result.endpoint0, result.endpoint1);
+        std::swap(result.p_bit0, result.p_bit1);
+        for (auto& index : result.indexes) {
+            index = static_cast<uint8_t>(15 - index);
+        }
+    }
+    return result;
+}
+
+Bc7Block FitBc7(const BlockRows<4>& block, const Endpoints<4>& endpoints, CompressionQuality quality)
+{
+    if (quality == CompressionQuality::Fast) {
+        const uint32_t p_bit0 = GetBc7QuantizationError(endpoints.first, 1) < GetBc7QuantizationError(endpoints.first, 0) ? 1 : 0;
+        const uint32_t p_bit1 = GetBc7QuantizationError(endpoints.second, 1) < GetBc7QuantizationError(endpoints.second, 0) ? 1 : 0;
+        return FitBc7(block, endpoints, p_bit0, p_bit1);
+    }
+
+    Bc7Block best;
+    best.error = std::numeric_limits<float>::max();
+    for (uint32_t p_bits = 0; p_bits < 4; ++p_bits) {
+        const auto candidate = FitBc7(block, endpoints, p_bits & 1, p_bits >> 1);
+        if (candidate.error < best.error) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+// Two-subset modes. Mode 1 stores RGB with 6-bit endpoints, one p-bit per subset and 3-bit indexes, mode 7
+// RGBA with 5-bit endpoints, one p-bit per endpoint and 2-bit indexes.
+struct Bc7PartitionedMode
+{
+    uint32_t mode = 0;
+    uint32_t channel_count = 0;
+    uint32_t endpoint_bit_count = 0;
+    uint32_t index_bit_count = 0;
+    bool is_p_bit_shared = false;
+};
+
+constexpr Bc7PartitionedMode s_bc7_mode1 = { 1, 3, 6, 3, true };
+constexpr Bc7PartitionedMode s_bc7_mode7 = { 7, 4, 5, 2, false };
+
+using BlockValues = std::array<Color<4>, s_block_pixel_count>;
+
+struct Bc7Subset
+{
+    std::array<uint8_t, 4> endpoint0 = {};
+    std::array<uint8_t, 4> endpoint1 = {};
+    uint32_t p_bit0 = 0;
+    uint32_t p_bit1 = 0;
+    float error = 0.0f;
+};
+
+struct Bc7PartitionedBlock
+{
+    uint32_t partition = 0;
+    std::array<Bc7Subset, 2> subsets;
+    BlockIndexes indexes = {};
+    float error = 0.0f;
+};
+
+const uint32_t* GetBc7Weights(uint32_t index_bit_count)
+{
+    switch (index_bit_count) {
+    case 2:
+        return s_bc7_weights2.data();
+    case 3:
+        return s_bc7_weights3.data();
+    default:
+        return s_bc7_weights.data();
+    }
+}
+
+// The stored bits are the endpoint followed by its p-bit, replicated into the low bits of the byte.
+uint32_t ExpandBc7Endpoint(uint32_t value, uint32_t p_bit, uint32_t endpoint_bit_count)
+{
+    const uint32_t bit_count = endpoint_bit_count + 1;
+    const uint32_t expanded = (value << 1 | p_bit) << (8 - bit_count);
+    return expanded | expanded >> bit_count;
+}
+
+uint8_t QuantizeBc7Channel(float value, uint32_t p_bit, uint32_t endpoint_bit_count)
+{
+    const auto max_value = static_cast<long>((1u << endpoint_bit_count) - 1);
+    const float scaled = value * static_cast<float>((1u << (endpoint_bit_count + 1)) - 1) / 255.0f;
+    const long rounded = std::clamp<long>(std::lround((scaled - static_cast<float>(p_bit)) * 0.5f), 0, max_value);
+
+    // Bit replication makes the steps uneven, so the neighbours can decode closer.
+    long best = rounded;
+    float best_error = std::numeric_limits<float>::max();
+    for (long candidate = std::max(rounded - 1, 0l); candidate <= std::min(rounded + 1, max_value); ++candidate) {
+        const float error = std::abs(static_cast<float>(ExpandBc7Endpoint(static_cast<uint32_t>(candidate), p_bit, endpoint_bit_count)) - value);
+        if (error < best_error) {
+            best = candidate;
+            best_error = error;
+        }
+    }
+    return static_cast<uint8_t>(best);
+}
+
+std::array<std::array<uint32_t, 4>, 8> GetBc7SubsetPalette(const Bc7Subset& subset, const Bc7PartitionedMode& mode)
+{
+    const auto* weights = GetBc7Weights(mode.index_bit_count);
+    std::array<std::array<uint32_t, 4>, 8> palette = {};
+    for (uint32_t c = 0; c < 4; ++c) {
+        uint32_t first = 255;
+        uint32_t second = 255;
+        if (c < mode.channel_count) {
+            first = ExpandBc7Endpoint(subset.endpoint0[c], subset.p_bit0, mode.endpoint_bit_count);
+            second = ExpandBc7Endpoint(subset.endpoint1[c], subset.p_bit1, mode.endpoint_bit_count);
+        }
+        for (uint32_t i = 0; i < 1u << mode.index_bit_count; ++i) {
+            palette[i][c] = ((64 - weights[i]) * first + weights[i] * second + 32) >> 6;
+        }
+    }
+    return palette;
+}
+
+// Endpoints spanning the pixels in pixel_mask along their principal axis.
+Endpoints<4> FindSubsetEndpoints(const BlockValues& values, uint32_t pixel_mask, uint32_t channel_count)
+{
+    Color<4> mean = {};
+    float pixel_count = 0.0f;
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        if (pixel_mask >> i & 1) {
+            for (uint32_t c = 0; c < channel_count; ++c) {
+                mean[c] += values[i][c];
+            }
+            pixel_count += 1.0f;
+        }
+    }
+    for (auto& value : mean) {
+        value /= pixel_count;
+    }
+
+    std::array<Color<4>, 4> covariance = {};
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        if (pixel_mask >> i & 1) {
+            for (uint32_t j = 0; j < channel_count; ++j) {
+                for (uint32_t k = j; k < channel_count; ++k) {
+                    covariance[j][k] += (values[i][j] - mean[j]) * (values[i][k] - mean[k]);
+                }
+            }
+        }
+    }
+
+    uint32_t largest_channel = 0;
+    for (uint32_t j = 0; j < channel_count; ++j) {
+        for (uint32_t k = 0; k < j; ++k) {
+            covariance[j][k] = covariance[k][j];
+        }
+        if (covariance[j][j] > covariance[largest_channel][largest_channel]) {
+            largest_channel = j;
+        }
+    }
+
+    auto axis = covariance[largest_channel];
+    for (uint32_t iteration = 0; iteration < s_power_iteration_count; ++iteration) {
+        Color<4> next = {};
+        float largest_component = 0.0f;
+        for (uint32_t j = 0; j < channel_count; ++j) {
+            for (uint32_t k = 0; k < channel_count; ++k) {
+                next[j] += covariance[j][k] * axis[k];
+            }
+            largest_component = std::max(largest_component, std::abs(next[j]));
+        }
+        if (largest_component <= 0.0f) {
+            break;
+        }
+        for (uint32_t j = 0; j < channel_count; ++j) {
+            axis[j] = next[j] / largest_component;
+        }
+    }
+
+    float length_squared = 0.0f;
+    for (uint32_t c = 0; c < channel_count; ++c) {
+        length_squared += axis[c] * axis[c];
+    }
+    if (length_squared <= 0.0f) {
+        return { mean, mean };
+    }
+
+    const float inverse_length = 1.0f / std::sqrt(length_squared);
+    for (uint32_t j = 0; j < channel_count; ++j) {
+        axis[j] *= inverse_length;
+    }
+
+    float min_t = std::numeric_limits<float>::max();
+    float max_t = -std::numeric_limits<float>::max();
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        if (pixel_mask >> i & 1) {
+            float t = 0.0f;
+            for (uint32_t c = 0; c < channel_count; ++c) {
+                t += (values[i][c] - mean[c]) * axis[c];
+            }
+            min_t = std::min(min_t, t);
+            max_t = std::max(max_t, t);
+        }
+    }
+
+    Endpoints<4> endpoints = { mean, mean };
+    for (uint32_t c = 0; c < channel_count; ++c) {
+        endpoints.first[c] = mean[c] + axis[c] * min_t;
+        endpoints.second[c] = mean[c] + axis[c] * max_t;
+    }
+    endpoints.first = Clamp(endpoints.first);
+    endpoints.second = Clamp(endpoints.second);
+    return endpoints;
+}
+
+// The palette runs along a line, so each pixel's projection onto it gives the nearest entry up to rounding,
+// which checking the neighbouring entries settles.
+float SelectSubsetIndexes(const BlockValues& values, uint32_t pixel_mask, const Bc7Subset& subset, const Bc7PartitionedMode& mode, BlockIndexes& indexes)
+{
+    const auto palette = GetBc7SubsetPalette(subset, mode);
+    const int32_t max_index = (1 << mode.index_bit_count) - 1;
+    std::array<Float4, 8> entries;
+    for (int32_t entry = 0; entry <= max_index; ++entry) {
+        entries[entry] = Float4::Set(static_cast<float>(palette[entry][0]), static_cast<float>(palette[entry][1]), static_cast<float>(palette[entry][2]), static_cast<float>(palette[entry][3]));
+    }
+
+    const auto direction = entries[max_index] - entries[0];
+    const float length_squared = ddn::HorizontalSum(direction * direction);
+    const float scale = length_squared > 0.0f ? static_cast<float>(max_index) / length_squared : 0.0f;
+
+    float total_error = 0.0f;
+    for (uint32_t mask = pixel_mask; mask != 0; mask &= mask - 1) {
+        const auto i = static_cast<uint32_t>(std::countr_zero(mask));
+        const auto value = Float4::Load(values[i].data());
+        const auto guess = std::clamp(static_cast<int32_t>(std::lround(ddn::HorizontalSum((value - entries[0]) * direction) * scale)), 0, max_index);
+
+        float best_error = std::numeric_limits<float>::max();
+        for (int32_t entry = std::max(guess - 1, 0); entry <= std::min(guess + 1, max_index); ++entry) {
+            const auto difference = value - entries[entry];
+            const float error = ddn::HorizontalSum(difference * difference);
+            if (error < best_error) {
+                best_error = error;
+                indexes[i] = static_cast<uint8_t>(entry);
+            }
+        }
+        total_error += best_error;
+    }
+    return total_error;
+}
+
+float GetBc7ChannelQuantizationError(const Color<4>& color, uint32_t p_bit, const Bc7PartitionedMode& mode)
+{
+    float error = 0.0f;
+    for (uint32_t c = 0; c < mode.channel_count; ++c) {
+        const auto value = QuantizeBc7Channel(color[c], p_bit, mode.endpoint_bit_count);
+        const float difference = static_cast<float>(ExpandBc7Endpoint(value, p_bit, mode.endpoint_bit_count)) - color[c];
+        error += difference * difference;
+    }
+    return error;
+}
+
+// Picks the p-bits that quantize the endpoints most closely, as the mode 6 fast path does.
+Bc7Subset FitBc7Subset(const BlockValues& values, uint32_t pixel_mask, const Endpoints<4>& endpoints, const Bc7PartitionedMode& mode, BlockIndexes& indexes)
+{
+    const auto get_error = [&](const Color<4>& color, uint32_t p_bit) {
+        return GetBc7ChannelQuantizationError(color, p_bit, mode);
+    };
+
+    Bc7Subset subset;
+    if (mode.is_p_bit_shared) {
+        const float error0 = get_error(endpoints.first, 0) + get_error(endpoints.second, 0);
+        const float error1 = get_error(endpoints.first, 1) + get_error(endpoints.second, 1);
+        subset.p_bit0 = error1 < error0 ? 1 : 0;
+        subset.p_bit1 = subset.p_bit0;
+    } else {
+        subset.p_bit0 = get_error(endpoints.first, 1) < get_error(endpoints.first, 0) ? 1 : 0;
+        subset.p_bit1 = get_error(endpoints.second, 1) < get_error(endpoints.second, 0) ? 1 : 0;
+    }
+    for (uint32_t c = 0; c < mode.channel_count; ++c) {
+        subset.endpoint0[c] = QuantizeBc7Channel(endpoints.first[c], subset.p_bit0, mode.endpoint_bit_count);
+        subset.endpoint1[c] = QuantizeBc7Channel(endpoints.second[c], subset.p_bit1, mode.endpoint_bit_count);
+    }
+    subset.error = SelectSubsetIndexes(values, pixel_mask, subset, mode, indexes);
+    return subset;
+}
+
+// Least-squares endpoints of one subset for its current indexes, as FitEndpoints does for whole blocks.
+bool FitSubsetEndpoints(const BlockValues& values, uint32_t pixel_mask, const BlockIndexes& indexes, const Bc7PartitionedMode& mode, Endpoints<4>& endpoints)
+{
+    const auto* weights = GetBc7Weights(mode.index_bit_count);
+    float first_first = 0.0f;
+    float first_second = 0.0f;
+    float second_second = 0.0f;
+    Color<4> first_value = {};
+    Color<4> second_value = {};
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        if (!(pixel_mask >> i & 1)) {
+            continue;
+        }
+        const float second_weight = static_cast<float>(weights[indexes[i]]) / 64.0f;
+        const float first_weight = 1.0f - second_weight;
+        first_first += first_weight * first_weight;
+        first_second += first_weight * second_weight;
+        second_second += second_weight * second_weight;
+        for (uint32_t c = 0; c < 4; ++c) {
+            first_value[c] += first_weight * values[i][c];
+            second_value[c] += second_weight * values[i][c];
+        }
+    }
+
+    const float determinant = first_first * second_second - first_second * first_second;
+    if (std::abs(determinant) < 1e-6f) {
+        return false;
+    }
+
+    const float inverse_determinant = 1.0f / determinant;
+    for (uint32_t c = 0; c < 4; ++c) {
+        endpoints.first[c] = (second_second * first_value[c] - first_second * second_value[c]) * inverse_determinant;
+        endpoints.second[c] = (first_first * second_value[c] - first_second * first_value[c]) * inverse_determinant;
+    }
+    endpoints.first = Clamp(endpoints.first);
+    endpoints.second = Clamp(endpoints.second);
+    return true;
+}
+
+Bc7PartitionedBlock FitBc7Partition(const BlockValues& values, uint32_t partition, const Bc7PartitionedMode& mode)
+{
+    Bc7PartitionedBlock result;
+    result.partition = partition;
+    const std::array<uint32_t, 2> pixel_masks = { ~uint32_t(s_bc7_partitions[partition]) & 0xffff, s_bc7_partitions[partition] };
+    for (uint32_t s = 0; s < 2; ++s) {
+        auto& subset = result.subsets[s];
+        subset = FitBc7Subset(values, pixel_masks[s], FindSubsetEndpoints(values, pixel_masks[s], mode.channel_count), mode, result.indexes);
+        for (uint32_t i = 0; i < s_bc7_refinement_count && subset.error > 0.0f; ++i) {
+            Endpoints<4> endpoints;
+            if (!FitSubsetEndpoints(values, pixel_masks[s], result.indexes, mode, endpoints)) {
+                break;
+            }
+            auto indexes = result.indexes;
+            const auto candidate = FitBc7Subset(values, pixel_masks[s], endpoints, mode, indexes);
+            if (candidate.error >= subset.error) {
+                break;
+            }
+            subset = candidate;
+            result.indexes = indexes;
+        }
+        result.error += subset.error;
+
+        // Each subset's anchor index is stored without its top bit; mirror the subset if it is set.
+        const uint32_t anchor = s == 0 ? 0 : s_bc7_anchors[partition];
+        const uint32_t max_index = (1u << mode.index_bit_count) - 1;
+        if (result.indexes[anchor] > max_index / 2) {
+            std::swap(subset.endpoint0, subset.endpoint1);
+            std::swap(subset.p_bit0, subset.p_bit1);
+            for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+                if (pixel_masks[s] >> i & 1) {
+                    result.indexes[i] = static_cast<uint8_t>(max_index - result.indexes[i]);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// Summed squared distance of a subset's pixels from their principal axis, from the subset's pixel count,
+// channel sums and sums of channel products, each lane a channel. Estimates the error of encoding them as one
+// subset; channels a mode does not store are constant in the blocks it is used for and add nothing.
+float EstimateSubsetResidual(float pixel_count, Float4 sums, const std::array<Float4, 4>& products)
+{
+    if (pixel_count <= 0.0f) {
+        return 0.0f;
+    }
+
+    float sum_values[4];
+    sums.Store(sum_values);
+    std::array<Float4, 4> covariance;
+    float trace = 0.0f;
+    float largest_variance = 0.0f;
+    uint32_t largest_channel = 0;
+    for (uint32_t c = 0; c < 4; ++c) {
+        covariance[c] = products[c] - sums * Float4::Splat(sum_values[c] / pixel_count);
+        float row[4];
+        covariance[c].Store(row);
+        trace += row[c];
+        if (row[c] > largest_variance) {
+            largest_variance = row[c];
+            largest_channel = c;
+        }
+    }
+    if (largest_variance <= 0.0f) {
+        return 0.0f;
+    }
+
+    // For a normalized axis |C axis| approaches the largest eigenvalue from below.
+    auto axis = covariance[largest_channel] * Float4::Splat(1.0f / std::sqrt(ddn::HorizontalSum(covariance[largest_channel] * covariance[largest_channel])));
+    float axis_variance = 0.0f;
+    for (uint32_t iteration = 0; iteration < s_partition_estimate_iteration_count; ++iteration) {
+        float axis_values[4];
+        axis.Store(axis_values);
+        auto next = covariance[0] * Float4::Splat(axis_values[0]);
+        for (uint32_t c = 1; c < 4; ++c) {
+            next = next + covariance[c] * Float4::Splat(axis_values[c]);
+        }
+        axis_variance = std::sqrt(ddn::HorizontalSum(next * next));
+        if (axis_variance <= 0.0f) {
+            break;
+        }
+        axis = next * Float4::Splat(1.0f / axis_variance);
+    }
+    return std::max(trace - axis_variance, 0.0f);
+}
+
+// Ranks all partitions by how well each subset fits a line and fully encodes only the most promising. The
+// first subset's moments are the block's minus the second's.
+Bc7PartitionedBlock FitBc7Partitioned(const BlockValues& values, const Bc7PartitionedMode& mode)
+{
+    std::array<Float4, s_block_pixel_count> pixel_values;
+    std::array<std::array<Float4, 4>, s_block_pixel_count> pixel_products;
+    auto block_sums = Float4::Splat(0.0f);
+    std::array<Float4, 4> block_products = { block_sums, block_sums, block_sums, block_sums };
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        pixel_values[i] = Float4::Load(values[i].data());
+        block_sums = block_sums + pixel_values[i];
+        for (uint32_t c = 0; c < 4; ++c) {
+            pixel_products[i][c] = pixel_values[i] * Float4::Splat(values[i][c]);
+            block_products[c] = block_products[c] + pixel_products[i][c];
+        }
+    }
+
+    std::array<std::pair<float, uint32_t>, s_bc7_partition_count> estimates;
+    for (uint32_t partition = 0; partition < s_bc7_partition_count; ++partition) {
+        float pixel_count = 0.0f;
+        auto sums = Float4::Splat(0.0f);
+        std::array<Float4, 4> products = { sums, sums, sums, sums };
+        for (uint32_t mask = s_bc7_partitions[partition]; mask != 0; mask &= mask - 1) {
+            const auto i = static_cast<uint32_t>(std::countr_zero(mask));
+            pixel_count += 1.0f;
+            sums = sums + pixel_values[i];
+            for (uint32_t c = 0; c < 4; ++c) {
+                products[c] = products[c] + pixel_products[i][c];
+            }
+        }
+
+        std::array<Float4, 4> other_products;
+        for (uint32_t c = 0; c < 4; ++c) {
+            other_products[c] = block_products[c] - products[c];
+        }
+        const float residual = EstimateSubsetResidual(pixel_count, sums, products)
+            + EstimateSubsetResidual(s_block_pixel_count - pixel_count, block_sums - sums, other_products);
+        estimates[partition] = { residual, partition };
+    }
+    std::partial_sort(estimates.begin(), estimates.begin() + s_bc7_partition_candidate_count, estimates.end());
+
+    Bc7PartitionedBlock best;
+    best.error = std::numeric_limits<float>::max();
+    for (uint32_t i = 0; i < s_bc7_partition_candidate_count; ++i) {
+        const auto candidate = FitBc7Partition(values, estimates[i].second, mode);
+        if (candidate.error < best.error) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+void WriteBc7Partitioned(const Bc7PartitionedBlock& block, const Bc7PartitionedMode& mode, uint8_t* output)
+{
+    BitWriter writer(output);
+    writer.Write(1u << mode.mode, mode.mode + 1);
+    writer.Write(block.partition, 6);
+    for (uint32_t c = 0; c < mode.channel_count; ++c) {
+        for (const auto& subset : block.subsets) {
+            writer.Write(subset.endpoint0[c], mode.endpoint_bit_count);
+            writer.Write(subset.endpoint1[c], mode.endpoint_bit_count);
+        }
+    }
+    for (const auto& subset : block.subsets) {
+        writer.Write(subset.p_bit0, 1);
+        if (!mode.is_p_bit_shared) {
+            writer.Write(subset.p_bit1, 1);
+        }
+    }
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        const bool is_anchor = i == 0 || i == s_bc7_anchors[block.partition];
+        writer.Write(block.indexes[i], mode.index_bit_count - (is_anchor ? 1 : 0));
+    }
+}
+
+void DecodeBc7Partitioned(BitReader& reader, const Bc7PartitionedMode& mode, BlockPixels& block)
+{
+    const uint32_t partition = reader.Read(6);
+    std::array<Bc7Subset, 2> subsets;
+    for (uint32_t c = 0; c < mode.channel_count; ++c) {
+        for (auto& subset : subsets) {
+            subset.endpoint0[c] = static_cast<uint8_t>(reader.Read(mode.endpoint_bit_count));
+            subset.endpoint1[c] = static_cast<uint8_t>(reader.Read(mode.endpoint_bit_count));
+        }
+    }
+    for (auto& subset : subsets) {
+        subset.p_bit0 = reader.Read(1);
+        subset.p_bit1 = mode.is_p_bit_shared ? subset.p_bit0 : reader.Read(1);
+    }
+
+    const std::array<std::array<std::array<uint32_t, 4>, 8>, 2> palettes = { GetBc7SubsetPalette(subsets[0], mode), GetBc7SubsetPalette(subsets[1], mode) };
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        const bool is_anchor = i == 0 || i == s_bc7_anchors[partition];
+        const auto index = reader.Read(mode.index_bit_count - (is_anchor ? 1 : 0));
+        const auto& palette = palettes[s_bc7_partitions[partition] >> i & 1];
+        for (uint32_t c = 0; c < 4; ++c) {
+            block[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+        }
+    }
+}
+
+void EncodeBc7(const BlockRows<4>& block, CompressionQuality quality, uint8_t* output)
+{
+    static const std::array<float, 16> s_weights = []() {
+        std::array<float, 16> weights;
+        for (uint32_t i = 0; i < 16; ++i) {
+            weights[i] = s_bc7_weights[i] / 64.0f;
+        }
+        return weights;
+    }();
+
+    auto best = FitBc7(block, FindPrincipalEndpoints(block), quality);
+    const uint32_t refinement_count = quality == CompressionQuality::High ? 3 : 1;
+    for (uint32_t i = 0; i < refinement_count && best.error > 0.0f; ++i) {
+        Endpoints<4> endpoints;
+        if (!FitEndpoints(block, best.indexes, s_weights, endpoints)) {
+            break;
+        }
+        const auto candidate = FitBc7(block, endpoints, quality);
+        if (candidate.error >= best.error) {
+            break;
+        }
+        best = candidate;
+    }
+
+    // Blocks whose colors do not lie along one line, such as edges between two materials, fit far better as
+    // two subsets: mode 1 when the block is opaque, mode 7 otherwise.
+    if (quality == CompressionQuality::High && best.error > 0.0f) {
+        BlockValues values;
+        bool is_opaque = true;
+        for (uint32_t c = 0; c < 4; ++c) {
+            for (uint32_t y = 0; y < s_block_dimension; ++y) {
+                float row[s_block_dimension];
+                block.rows[c][y].Store(row);
+                for (uint32_t x = 0; x < s_block_dimension; ++x) {
+                    values[y * s_block_dimension + x][c] = row[x];
+                    is_opaque = is_opaque && (c != 3 || row[x] == 255.0f);
+                }
+            }
+        }
+
+        const auto& mode = is_opaque ? s_bc7_mode1 : s_bc7_mode7;
+        const auto partitioned = FitBc7Partitioned(values, mode);
+        if (partitioned.error < best.error) {
+            WriteBc7Partitioned(partitioned, mode, output);
+            return;
+        }
+    }
+
+    BitWriter writer(output);
+    writer.Write(1u << s_bc7_mode, s_bc7_mode + 1);
+    for (uint32_t c = 0; c < 4; ++c) {
+        writer.Write(best.endpoint0[c], 7);
+        writer.Write(best.endpoint1[c], 7);
+    }
+    writer.Write(best.p_bit0, 1);
+    writer.Write(best.p_bit1, 1);
+    writer.Write(best.indexes[0], 3);
+    for (uint32_t i = 1; i < s_block_pixel_count; ++i) {
+        writer.Write(best.indexes[i], 4);
+    }
+}
+
+void DecodeBc7(const uint8_t* input, BlockPixels& block)
+{
+    BitReader reader(input);
+    uint32_t mode = 0;
+    while (mode < 8 && reader.Read(1) == 0) {
+        ++mode;
+    }
+    if (mode == s_bc7_mode1.mode || mode == s_bc7_mode7.mode) {
+        DecodeBc7Partitioned(reader, mode == s_bc7_mode1.mode ? s_bc7_mode1 : s_bc7_mode7, block);
+        return;
+    }
+    if (mode != s_bc7_mode) {
+        throw std::invalid_argument("Only BC7 modes 1, 6 and 7 can be decoded");
+    }
+
+    std::array<uint8_t, 4> endpoint0;
+    std::array<uint8_t, 4> endpoint1;
+    for (uint32_t c = 0; c < 4; ++c) {
+        endpoint0[c] = static_cast<uint8_t>(reader.Read(7));
+        endpoint1[c] = static_cast<uint8_t>(reader.Read(7));
+    }
+    const auto p_bit0 = reader.Read(1);
+    const auto p_bit1 = reader.Read(1);
+    const auto palette = GetBc7Palette(endpoint0, endpoint1, p_bit0, p_bit1);
+
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        const auto index = reader.Read(i == 0 ? 3 : 4);
+        for (uint32_t c = 0; c < 4; ++c) {
+            block[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+        }
+    }
+}
+
+void EncodeBlock(const BlockPixels& pixels, ddn::TextureFormat format, CompressionQuality quality, uint8_t* output)
+{
+    switch (format) {
+    case ddn::TextureFormat::Bc1:
+        EncodeBc1(LoadRows<3>(pixels, { 0, 1, 2 }), quality, output);
+        break;
+    case ddn::TextureFormat::Bc3:
+        EncodeBc4(LoadRows<1>(pixels, { 3 }), quality, output);
+        EncodeBc1(LoadRows<3>(pixels, { 0, 1, 2 }), quality, output + 8);
+        break;
+    case ddn::TextureFormat::Bc4:
+        EncodeBc4(LoadRows<1>(pixels, { 0 }), quality, output);
+        break;
+    case ddn::TextureFormat::Bc5:
+        EncodeBc4(LoadRows<1>(pixels, { 0 }), quality, output);
+        EncodeBc4(LoadRows<1>(pixels, { 1 }), quality, output + 8);
+        break;
+    case ddn::TextureFormat::Bc7:
+        EncodeBc7(LoadRows<4>(pixels, { 0, 1, 2, 3 }), quality, output);
+        break;
+    default:
+        throw std::invalid_argument("Format is not block compressed");
+    }
+}
+
+BlockPixels DecodeBlock(const uint8_t* input, ddn::TextureFormat format)
+{
+    BlockPixels pixels;
+    for (uint32_t i = 0; i < s_block_pixel_count; ++i) {
+        pixels[i * 4 + 0] = 0;
+        pixels[i * 4 + 1] = 0;
+        pixels[i * 4 + 2] = 0;
+        pixels[i * 4 + 3] = 255;
+    }
+
+    switch (format) {
+    case ddn::TextureFormat::Bc1:
+        DecodeBc1(input, false, pixels);
+        break;
+    case ddn::TextureFormat::Bc3:
+        DecodeBc1(input + 8, true, pixels);
+        DecodeBc4(input, 3, pixels);
+        break;
+    case ddn::TextureFormat::Bc4:
+        DecodeBc4(input, 0, pixels);
+        break;
+    case ddn::TextureFormat::Bc5:
+        DecodeBc4(input, 0, pixels);
+        DecodeBc4(input + 8, 1, pixels);
+        break;
+    case ddn::TextureFormat::Bc7:
+        DecodeBc7(input, pixels);
+        break;
+    default:
+        throw std::invalid_argument("Format is not block compressed");
+    }
+    return pixels;
+}
+
+}
+
+namespace ddn
+{
+
+bool IsBlockCompressed(TextureFormat format)
+{
+    return format != TextureFormat::Rgba8;
+}
+
+size_t GetBlockByteCount(TextureFormat format)
+{
+    switch (format) {
+    case TextureFormat::Bc1:
+    case TextureFormat::Bc4:
+        return 8;
+    case TextureFormat::Bc3:
+    case TextureFormat::Bc5:
+    case TextureFormat::Bc7:
+        return 16;
+    default:
+        throw std::invalid_argument("Format is not block compressed");
+    }
+}
+
+uint32_t GetChannelCount(TextureFormat format)
+{
+    switch (format) {
+    case TextureFormat::Bc1:
+        return 3;
+    case TextureFormat::Bc4:
+        return 1;
+    case TextureFormat::Bc5:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+size_t GetImageByteCount(TextureFormat format, uint32_t width, uint32_t height)
+{
+    if (!IsBlockCompressed(format)) {
+        return size_t(width) * height * 4;
+    }
+    const size_t block_count_x = (size_t(width) + s_block_dimension - 1) / s_block_dimension;
+    const size_t block_count_y = (size_t(height) + s_block_dimension - 1) / s_block_dimension;
+    return block_count_x * block_count_y * GetBlockByteCount(format);
+}
+
+void CompressImage(std::span<const uint8_t> pixels, uint32_t width, uint32_t height, TextureFormat format, CompressionQuality quality, std::span<uint8_t> blocks)
+{
+    DDN_PROFILE_FUNCTION();
+
+    if (!IsBlockCompressed(format)) {
+        throw std::invalid_argument("Format is not block compressed");
+    }
+    if (pixels.size() < size_t(width) * height * 4) {
+        throw std::invalid_argument("Expected RGBA8 pixels for the whole image");
+    }
+    if (blocks.size() < GetImageByteCount(format, width, height)) {
+        throw std::invalid_argument("Output is too small for the compressed image");
+    }
+
+    const uint32_t block_count_x = (width + s_block_dimension - 1) / s_block_dimension;
+    const uint32_t block_count_y = (height + s_block_dimension - 1) / s_block_dimension;
+    const size_t block_byte_count = GetBlockByteCount(format);
+    ParallelFor(0, size_t(block_count_x) * block_count_y, s_block_grain_size, [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; ++block) {
+            const auto block_x = static_cast<uint32_t>(block % block_count_x);
+            const auto block_y = static_cast<uint32_t>(block / block_count_x);
+            EncodeBlock(LoadBlock(pixels, width, height, block_x, block_y), format, quality, blocks.data() + block * block_byte_count);
+        }
+    });
+}
+
+std::vector<uint8_t> CompressImage(std::span<const uint8_t> pixels, uint32_t width, uint32_t height, TextureFormat format, CompressionQuality quality)
+{
+    std::vector<uint8_t> blocks(GetImageByteCount(format, width, height));
+    CompressImage(pixels, width, height, format, quality, blocks);
+    return blocks;
+}
+
+std::vector<uint8_t> DecompressImage(std::span<const uint8_t> blocks, uint32_t width, uint32_t height, TextureFormat format)
+{
+    DDN_PROFILE_FUNCTION();
+
+    if (!IsBlockCompressed(format)) {
+        throw std::invalid_argument("Format is not block compressed");
+    }
+    if (blocks.size() < GetImageByteCount(format, width, height)) {
+        throw std::invalid_argument("Expected blocks for the whole image");
+    }
+
+    std::vector<uint8_t> pixels(size_t(width) * height * 4);
+    const uint32_t block_count_x = (width + s_block_dimension - 1) / s_block_dimension;
+    const uint32_t block_count_y = (height + s_block_dimension - 1) / s_block_dimension;
+    const size_t block_byte_count = GetBlockByteCount(format);
+    ParallelFor(0, size_t(block_count_x) * block_count_y, s_block_grain_size, [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; ++block) {
+            const auto block_x = static_cast<uint32_t>(block % block_count_x);
+            const auto block_y = static_cast<uint32_t>(block / block_count_x);
+            StoreBlock(DecodeBlock(blocks.data() + block * block_byte_count, format), width, height, block_x, block_y, pixels);
+        }
+    });
+    return pixels;
+}
+
+double ComputePsnr(std::span<const uint8_t> lhs, std::span<const uint8_t> rhs, uint32_t channel_count)
+{
+    if (lhs.size() != rhs.size() || lhs.size() % 4 != 0) {
+        throw std::invalid_argument("Expected RGBA8 images of the same size");
+    }
+    if (channel_count == 0 || channel_count > 4) {
+        throw std::invalid_argument("Channel count must be between 1 and 4");
+    }
+
+    double squared_error = 0.0;
+    for (size_t i = 0; i < lhs.size(); i += 4) {
+        for (uint32_t c = 0; c < channel_count; ++c) {
+            const double difference = double(lhs[i + c]) - double(rhs[i + c]);
+            squared_error += difference * difference;
+        }
+    }
+
+    const double sample_count = double(lhs.size() / 4) * channel_count;
+    if (squared_error == 0.0 || sample_count == 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return 10.0 * std::log10(255.0 * 255.0 * sample_count / squared_error);
+}
+
+}  // namespace ddn
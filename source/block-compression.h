@@ -0,0 +1,46 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace ddn
+{
+
+enum class TextureFormat
+{
+    Rgba8,
+    Bc1,
+    Bc3,
+    Bc4,
+    Bc5,
+    Bc7,
+};
+
+enum class CompressionQuality
+{
+    Fast,
+    High,
+};
+
+bool IsBlockCompressed(TextureFormat format);
+size_t GetBlockByteCount(TextureFormat format);
+uint32_t GetChannelCount(TextureFormat format);
+size_t GetImageByteCount(TextureFormat format, uint32_t width, uint32_t height);
+
+// Encodes tightly packed RGBA8 pixels. BC1 stores opaque color only, BC4 and BC5 read red and red/green,
+// and BC7 uses mode 6 (one subset, RGBA endpoints with p-bits and 4-bit indexes). High quality refines
+// endpoints further, searching BC1 endpoints a quantization step around the fit, and for BC7 also tries
+// the most promising two-subset partitions in mode 1 for opaque blocks and mode 7 otherwise.
+void CompressImage(std::span<const uint8_t> pixels, uint32_t width, uint32_t height, TextureFormat format, CompressionQuality quality, std::span<uint8_t> blocks);
+std::vector<uint8_t> CompressImage(std::span<const uint8_t> pixels, uint32_t width, uint32_t height, TextureFormat format, CompressionQuality quality = CompressionQuality::Fast);
+
+// Decodes to RGBA8; channels a format does not store are written as 0, or 255 for alpha. BC7 blocks must use
+// the modes CompressImage writes.
+std::vector<uint8_t> DecompressImage(std::span<const uint8_t> blocks, uint32_t width, uint32_t height, TextureFormat format);
+
+// Peak signal-to-noise ratio in dB over the first channel_count channels of two RGBA8 images.
+double ComputePsnr(std::span<const uint8_t> lhs, std::span<const uint8_t> rhs, uint32_t channel_count = 4);
+
+}  // namespace ddn
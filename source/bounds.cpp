@@ -0,0 +1,167 @@
+#include "bounds.h"
+
+#include <glm/glm.hpp>
+
+#include <utility>
+
+namespace ddn
+{
+
+bool Aabb::IsValid() const
+{
+    return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+}
+
+glm::vec3 Aabb::GetCenter() const
+{
+    return (min + max) * 0.5f;
+}
+
+glm::vec3 Aabb::GetExtents() const
+{
+    return (max - min) * 0.5f;
+}
+
+float Aabb::GetSurfaceArea() const
+{
+    if (!IsValid()) {
+        return 0.0f;
+    }
+
+    const auto size = max - min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+void Aabb::Extend(const glm::vec3& point)
+{
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+void Aabb::Extend(const Aabb& other)
+{
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+}
+
+bool Aabb::Intersects(const Aabb& other) const
+{
+    return min.x <= other.max.x && max.x >= other.min.x
+        && min.y <= other.max.y && max.y >= other.min.y
+        && min.z <= other.max.z && max.z >= other.min.z;
+}
+
+bool Aabb::Contains(const glm::vec3& point) const
+{
+    return point.x >= min.x && point.x <= max.x
+        && point.y >= min.y && point.y <= max.y
+        && point.z >= min.z && point.z <= max.z;
+}
+
+Aabb Aabb::Transform(const glm::mat4& matrix) const
+{
+    const auto center = glm::vec3(matrix * glm::vec4(GetCenter(), 1.0f));
+    const auto extents = GetExtents();
+
+    glm::vec3 transformed_extents(0.0f);
+    for (int i = 0; i < 3; ++i) {
+        transformed_extents += glm::abs(glm::vec3(matrix[i])) * extents[i];
+    }
+
+    return { center - transformed_extents, center + transformed_extents };
+}
+
+bool Sphere::Intersects(const Sphere& other) const
+{
+    const auto offset = other.center - center;
+    const float radius_sum = radius + other.radius;
+    return glm::dot(offset, offset) <= radius_sum * radius_sum;
+}
+
+bool Sphere::Intersects(const Aabb& aabb) const
+{
+    const auto closest_point = glm::clamp(center, aabb.min, aabb.max);
+    const auto offset = closest_point - center;
+    return glm::dot(offset, offset) <= radius * radius;
+}
+
+glm::vec3 Ray::GetPoint(float distance) const
+{
+    return origin + direction * distance;
+}
+
+bool Ray::Intersects(const Aabb& aabb, float& distance) const
+{
+    float near_distance = 0.0f;
+    float far_distance = max_distance;
+    for (int i = 0; i < 3; ++i) {
+        const float inverse_direction = 1.0f / direction[i];
+        float t0 = (aabb.min[i] - origin[i]) * inverse_direction;
+        float t1 = (aabb.max[i] - origin[i]) * inverse_direction;
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+
+        near_distance = t0 > near_distance ? t0 : near_distance;
+        far_distance = t1 < far_distance ? t1 : far_distance;
+        if (near_distance > far_distance) {
+            return false;
+        }
+    }
+
+    distance = near_distance;
+    return true;
+}
+
+FrustumTestResult Frustum::Test(const Aabb& aabb) const
+{
+    const auto center = aabb.GetCenter();
+    const auto extents = aabb.GetExtents();
+
+    auto result = FrustumTestResult::Inside;
+    for (const auto& plane : planes) {
+        const auto normal = glm::vec3(plane);
+        const float distance = glm::dot(normal, center) + plane.w;
+        const float radius = glm::dot(glm::abs(normal), extents);
+        if (distance < -radius) {
+            return FrustumTestResult::Outside;
+        }
+        if (distance < radius) {
+            result = FrustumTestResult::Intersecting;
+        }
+    }
+    return result;
+}
+
+FrustumTestResult Frustum::Test(const Sphere& sphere) const
+{
+    auto result = FrustumTestResult::Inside;
+    for (const auto& plane : planes) {
+        const float distance = glm::dot(glm::vec3(plane), sphere.center) + plane.w;
+        if (distance < -sphere.radius) {
+            return FrustumTestResult::Outside;
+        }
+        if (distance < sphere.radius) {
+            result = FrustumTestResult::Intersecting;
+        }
+    }
+    return result;
+}
+
+bool Frustum::Intersects(const Aabb& aabb) const
+{
+    return Test(aabb) != FrustumTestResult::Outside;
+}
+
+bool Frustum::Intersects(const Sphere& sphere) const
+{
+    return Test(sphere) != FrustumTestResult::Outside;
+}
+
+glm::vec4 NormalizePlane(const glm::vec4& plane)
+{
+    const float length = glm::length(glm::vec3(plane));
+    return length > 0.0f ? plane / length : plane;
+}
+
+}  // namespace ddn
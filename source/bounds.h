@@ -0,0 +1,82 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <array>
+#include <limits>
+
+namespace ddn
+{
+
+struct Aabb
+{
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+    bool IsValid() const;
+    glm::vec3 GetCenter() const;
+    glm::vec3 GetExtents() const;
+    float GetSurfaceArea() const;
+
+    void Extend(const glm::vec3& point);
+    void Extend(const Aabb& other);
+
+    bool Intersects(const Aabb& other) const;
+    bool Contains(const glm::vec3& point) const;
+
+    Aabb Transform(const glm::mat4& matrix) const;
+};
+
+struct Sphere
+{
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+
+    bool Intersects(const Sphere& other) const;
+    bool Intersects(const Aabb& aabb) const;
+};
+
+struct Ray
+{
+    glm::vec3 origin = glm::vec3(0.0f);
+    glm::vec3 direction = glm::vec3(0.0f, 0.0f, 1.0f);
+    float max_distance = std::numeric_limits<float>::max();
+
+    glm::vec3 GetPoint(float distance) const;
+    bool Intersects(const Aabb& aabb, float& distance) const;
+};
+
+enum class FrustumPlane
+{
+    Left,
+    Right,
+    Bottom,
+    Top,
+    Near,
+    Far,
+    Count,
+};
+
+enum class FrustumTestResult
+{
+    Outside,
+    Intersecting,
+    Inside,
+};
+
+struct Frustum
+{
+    std::array<glm::vec4, static_cast<size_t>(FrustumPlane::Count)> planes = {};
+
+    FrustumTestResult Test(const Aabb& aabb) const;
+    FrustumTestResult Test(const Sphere& sphere) const;
+
+    bool Intersects(const Aabb& aabb) const;
+    bool Intersects(const Sphere& sphere) const;
+};
+
+glm::vec4 NormalizePlane(const glm::vec4& plane);
+
+}  // namespace ddn
@@ -0,0 +1,440 @@
+#include "broadphase.h"
+#include "simd.h"
+#include "profiler.h"
+#include "thread-pool.h"
+
+#include <glm/glm.hpp>
+
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+using ddn::Float4;
+
+constexpr size_t s_lane_count = 4;
+constexpr size_t s_chunk_size = 1024;
+constexpr size_t s_body_grain_size = 4096;
+constexpr uint32_t s_min_bucket_count = 64;
+
+// An insertion sort that moves bodies further than this on average is no longer cheaper than sorting afresh.
+constexpr uint64_t s_max_swaps_per_body = 8;
+
+// The half of the 3x3x3 neighbourhood that lies after the center cell in z, then y, then x order is the next
+// cell in x plus these rows of three cells, given as y and z offsets.
+constexpr int32_t s_forward_rows[4][2] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+
+ddn::BroadphasePair MakePair(uint32_t lhs, uint32_t rhs)
+{
+    return { std::min(lhs, rhs), std::max(lhs, rhs) };
+}
+
+// Concatenates the pairs of all chunks, in chunk order, and sums their test counts into the statistics.
+template <typename ChunkResult>
+void GatherPairs(const std::vector<ChunkResult>& chunk_results, std::vector<ddn::BroadphasePair>& pairs, ddn::BroadphaseStatistics& statistics)
+{
+    std::vector<size_t> chunk_offsets(chunk_results.size() + 1, 0);
+    for (size_t chunk = 0; chunk < chunk_results.size(); ++chunk) {
+        chunk_offsets[chunk + 1] = chunk_offsets[chunk] + chunk_results[chunk].pairs.size();
+        statistics.test_count += chunk_results[chunk].test_count;
+    }
+
+    pairs.resize(chunk_offsets.back());
+    ddn::ParallelFor(0, chunk_results.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            const auto& chunk_pairs = chunk_results[chunk].pairs;
+            std::copy(chunk_pairs.begin(), chunk_pairs.end(), pairs.begin() + chunk_offsets[chunk]);
+        }
+    });
+    statistics.pair_count = pairs.size();
+}
+
+void CheckBodyCount(size_t body_count)
+{
+    if (body_count > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Too many broadphase bodies");
+    }
+}
+
+void CheckFiniteBounds(const ddn::Aabb& aabb)
+{
+    for (int axis = 0; axis < 3; ++axis) {
+        if (!std::isfinite(aabb.min[axis]) || !std::isfinite(aabb.max[axis])) {
+            throw std::invalid_argument("Spatial hash bounds must be finite");
+        }
+    }
+}
+
+}
+
+namespace ddn
+{
+
+void SweepAndPrune::Update(std::span<const Aabb> bounds)
+{
+    DDN_PROFILE_FUNCTION();
+
+    CheckBodyCount(bounds.size());
+    m_statistics = {};
+    ScopedTimer timer(m_statistics.update_ms);
+    m_statistics.body_count = static_cast<uint32_t>(bounds.size());
+
+    if (m_order.size() != bounds.size() || !Resort(bounds)) {
+        Rebuild(bounds);
+    }
+    GatherBounds(bounds);
+
+    m_chunk_results.resize((bounds.size() + s_chunk_size - 1) / s_chunk_size);
+    ParallelFor(0, m_chunk_results.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            SweepChunk(chunk);
+        }
+    });
+    GatherPairs(m_chunk_results, m_pairs, m_statistics);
+}
+
+std::span<const BroadphasePair> SweepAndPrune::GetPairs() const
+{
+    return m_pairs;
+}
+
+const BroadphaseStatistics& SweepAndPrune::GetStatistics() const
+{
+    return m_statistics;
+}
+
+void SweepAndPrune::Rebuild(std::span<const Aabb> bounds)
+{
+    DDN_PROFILE_FUNCTION();
+
+    m_statistics.is_rebuilt = true;
+    m_statistics.swap_count = 0;
+
+    double sums[3] = {};
+    double square_sums[3] = {};
+    for (const auto& aabb : bounds) {
+        for (int axis = 0; axis < 3; ++axis) {
+            const double center = 0.5 * (double(aabb.min[axis]) + aabb.max[axis]);
+            sums[axis] += center;
+            square_sums[axis] += center * center;
+        }
+    }
+
+    double max_variance = -1.0;
+    for (int axis = 0; axis < 3; ++axis) {
+        const double mean = bounds.empty() ? 0.0 : sums[axis] / bounds.size();
+        const double variance = bounds.empty() ? 0.0 : square_sums[axis] / bounds.size() - mean * mean;
+        if (variance > max_variance) {
+            max_variance = variance;
+            m_axis = axis;
+        }
+    }
+
+    m_order.resize(bounds.size());
+    std::iota(m_order.begin(), m_order.end(), 0u);
+    std::sort(m_order.begin(), m_order.end(), [&](uint32_t lhs, uint32_t rhs) {
+        const float lhs_key = bounds[lhs].min[m_axis];
+        const float rhs_key = bounds[rhs].min[m_axis];
+        return lhs_key != rhs_key ? lhs_key < rhs_key : lhs < rhs;
+    });
+}
+
+// Insertion sort of the previous order by the bodies' new lower bounds. Gives up once the swap budget is spent,
+// leaving the order for Rebuild to replace.
+bool SweepAndPrune::Resort(std::span<const Aabb> bounds)
+{
+    DDN_PROFILE_FUNCTION();
+
+    const size_t count = m_order.size();
+    m_min_a.resize(count + s_lane_count);
+    ParallelFor(0, count, s_body_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_min_a[i] = bounds[m_order[i]].min[m_axis];
+        }
+    });
+
+    const uint64_t max_swap_count = count * s_max_swaps_per_body;
+    uint64_t swap_count = 0;
+    for (size_t i = 1; i < count; ++i) {
+        const float key = m_min_a[i];
+        const uint32_t body = m_order[i];
+        size_t j = i;
+        for (; j > 0 && m_min_a[j - 1] > key; --j) {
+            m_min_a[j] = m_min_a[j - 1];
+            m_order[j] = m_order[j - 1];
+        }
+        m_min_a[j] = key;
+        m_order[j] = body;
+
+        swap_count += i - j;
+        if (swap_count > max_swap_count) {
+            return false;
+        }
+    }
+
+    m_statistics.swap_count = swap_count;
+    return true;
+}
+
+void SweepAndPrune::GatherBounds(std::span<const Aabb> bounds)
+{
+    const size_t count = m_order.size();
+    const int axis_b = (m_axis + 1) % 3;
+    const int axis_c = (m_axis + 2) % 3;
+
+    for (auto* stream : { &m_min_a, &m_max_a, &m_min_b, &m_max_b, &m_min_c, &m_max_c }) {
+        stream->resize(count + s_lane_count);
+    }
+
+    ParallelFor(0, count, s_body_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto& aabb = bounds[m_order[i]];
+            m_min_a[i] = aabb.min[m_axis];
+            m_max_a[i] = aabb.max[m_axis];
+            m_min_b[i] = aabb.min[axis_b];
+            m_max_b[i] = aabb.max[axis_b];
+            m_min_c[i] = aabb.min[axis_c];
+            m_max_c[i] = aabb.max[axis_c];
+        }
+    });
+
+    // NaN padding fails every comparison, so it never overlaps anything on the sweep axis, not even a body whose
+    // upper bound is infinite, and every sweep ends at the last body.
+    std::fill(m_min_a.begin() + count, m_min_a.end(), std::numeric_limits<float>::quiet_NaN());
+}
+
+// Sweeps each body of the chunk forward through the bodies whose lower bound on the sweep axis lies within its
+// extent, four at a time, and tests those against the other two axes.
+void SweepAndPrune::SweepChunk(size_t chunk)
+{
+    auto& result = m_chunk_results[chunk];
+    result.pairs.clear();
+    result.test_count = 0;
+
+    // Locals rather than members, which the compiler would otherwise reload after every push_back.
+    const float* min_a = m_min_a.data();
+    const float* min_b = m_min_b.data();
+    const float* max_b = m_max_b.data();
+    const float* min_c = m_min_c.data();
+    const float* max_c = m_max_c.data();
+    const uint32_t* order = m_order.data();
+    uint64_t test_count = 0;
+
+    const size_t count = m_order.size();
+    const size_t begin = chunk * s_chunk_size;
+    const size_t end = std::min(begin + s_chunk_size, count);
+    for (size_t i = begin; i < end; ++i) {
+        const auto body_max_a = Float4::Splat(m_max_a[i]);
+        const auto body_min_b = Float4::Splat(min_b[i]);
+        const auto body_max_b = Float4::Splat(max_b[i]);
+        const auto body_min_c = Float4::Splat(min_c[i]);
+        const auto body_max_c = Float4::Splat(max_c[i]);
+
+        for (size_t j = i + 1; j < count; j += s_lane_count) {
+            // Lower bounds are sorted, so the candidates are always the first lanes.
+            const uint32_t candidates = GetBits(Float4::Load(min_a + j) <= body_max_a);
+            if (candidates == 0) {
+                break;
+            }
+
+            const auto overlap_b = (Float4::Load(min_b + j) <= body_max_b) & (Float4::Load(max_b + j) >= body_min_b);
+            const auto overlap_c = (Float4::Load(min_c + j) <= body_max_c) & (Float4::Load(max_c + j) >= body_min_c);
+            uint32_t overlaps = candidates & GetBits(overlap_b & overlap_c);
+            test_count += std::countr_one(candidates);
+            while (overlaps != 0) {
+                const auto lane = std::countr_zero(overlaps);
+                overlaps &= overlaps - 1;
+                result.pairs.push_back(MakePair(order[i], order[j + lane]));
+            }
+
+            if (candidates != (1u << s_lane_count) - 1) {
+                break;
+            }
+        }
+    }
+    result.test_count = test_count;
+}
+
+SpatialHash::SpatialHash(const SpatialHashDesc& desc)
+    : m_desc(desc)
+{
+    if (!(desc.cell_size >= 0.0f) || !std::isfinite(desc.cell_size)) {
+        throw std::invalid_argument("Spatial hash cell size must be finite and not negative");
+    }
+}
+
+void SpatialHash::Update(std::span<const Aabb> bounds)
+{
+    DDN_PROFILE_FUNCTION();
+
+    CheckBodyCount(bounds.size());
+    m_statistics = {};
+    ScopedTimer timer(m_statistics.update_ms);
+    m_statistics.body_count = static_cast<uint32_t>(bounds.size());
+    m_statistics.is_rebuilt = true;
+
+    float max_extent = 0.0f;
+    glm::vec3 min_corner(std::numeric_limits<float>::max());
+    glm::vec3 max_corner(std::numeric_limits<float>::lowest());
+    for (const auto& aabb : bounds) {
+        CheckFiniteBounds(aabb);
+        const auto extents = aabb.max - aabb.min;
+        max_extent = std::max({ max_extent, extents.x, extents.y, extents.z });
+        min_corner = glm::min(min_corner, aabb.min);
+        max_corner = glm::max(max_corner, aabb.min);
+    }
+
+    m_cell_size = m_desc.cell_size > 0.0f ? m_desc.cell_size : max_extent > 0.0f ? max_extent : 1.0f;
+    if (!bounds.empty()) {
+        int32_t cell_counts[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            m_cell_origin[axis] = static_cast<int32_t>(std::floor(min_corner[axis] / m_cell_size));
+            cell_counts[axis] = static_cast<int32_t>(std::floor(max_corner[axis] / m_cell_size)) - m_cell_origin[axis] + 1;
+        }
+        m_row_stride = static_cast<uint32_t>(cell_counts[0]);
+        m_slab_stride = m_row_stride * static_cast<uint32_t>(cell_counts[1]);
+    }
+
+    BinBodies(bounds);
+
+    m_chunk_results.resize((bounds.size() + s_chunk_size - 1) / s_chunk_size);
+    ParallelFor(0, m_chunk_results.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            FindChunkPairs(chunk);
+        }
+    });
+    GatherPairs(m_chunk_results, m_pairs, m_statistics);
+}
+
+std::span<const BroadphasePair> SpatialHash::GetPairs() const
+{
+    return m_pairs;
+}
+
+const BroadphaseStatistics& SpatialHash::GetStatistics() const
+{
+    return m_statistics;
+}
+
+float SpatialHash::GetCellSize() const
+{
+    return m_cell_size;
+}
+
+// The cell's index in the grid spanned by the bodies, wrapped to the table size. Cells outside that grid alias
+// cells inside it, which only costs a few rejected candidates.
+uint32_t SpatialHash::GetBucket(const int32_t cell[3]) const
+{
+    const auto x = static_cast<uint32_t>(cell[0] - m_cell_origin[0]);
+    const auto y = static_cast<uint32_t>(cell[1] - m_cell_origin[1]);
+    const auto z = static_cast<uint32_t>(cell[2] - m_cell_origin[2]);
+    return (x + y * m_row_stride + z * m_slab_stride) & m_bucket_mask;
+}
+
+// Counting sort of the bodies by hash bucket. Entries are built and placed in parallel; only the histogram and
+// the slot assignment run serially.
+void SpatialHash::BinBodies(std::span<const Aabb> bounds)
+{
+    DDN_PROFILE_FUNCTION();
+
+    const size_t count = bounds.size();
+    const uint32_t bucket_count = std::bit_ceil(std::max(static_cast<uint32_t>(std::min<size_t>(count * 2, 1u << 31)), s_min_bucket_count));
+    m_bucket_mask = bucket_count - 1;
+
+    const float inverse_cell_size = 1.0f / m_cell_size;
+    m_body_entries.resize(count);
+    m_body_slots.resize(count);
+    ParallelFor(0, count, s_body_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto& aabb = bounds[i];
+            auto& entry = m_body_entries[i];
+            for (int axis = 0; axis < 3; ++axis) {
+                entry.min[axis] = aabb.min[axis];
+                entry.max[axis] = aabb.max[axis];
+                entry.cell[axis] = static_cast<int32_t>(std::floor(aabb.min[axis] * inverse_cell_size));
+            }
+            entry.min[3] = 0.0f;
+            entry.max[3] = 0.0f;
+            entry.body = static_cast<uint32_t>(i);
+            m_body_slots[i] = GetBucket(entry.cell);
+        }
+    });
+
+    m_bucket_offsets.assign(bucket_count + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        ++m_bucket_offsets[m_body_slots[i] + 1];
+    }
+    std::partial_sum(m_bucket_offsets.begin(), m_bucket_offsets.end(), m_bucket_offsets.begin());
+    for (size_t i = 0; i < count; ++i) {
+        m_body_slots[i] = m_bucket_offsets[m_body_slots[i]]++;
+    }
+    // Assigning slots advanced every offset to the start of the next bucket.
+    std::copy_backward(m_bucket_offsets.begin(), m_bucket_offsets.end() - 1, m_bucket_offsets.end());
+    m_bucket_offsets[0] = 0;
+
+    m_entries.resize(count);
+    ParallelFor(0, count, s_body_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_entries[m_body_slots[i]] = m_body_entries[i];
+        }
+    });
+}
+
+// Tests each entry of the chunk against the later entries of its own cell and all entries of the forward
+// neighbour cells. Cells that are neighbours in x are neighbours in the table too, so the neighbourhood is one
+// run of buckets per row. Buckets can hold several cells, so candidates are matched by cell before testing.
+void SpatialHash::FindChunkPairs(size_t chunk)
+{
+    auto& result = m_chunk_results[chunk];
+    result.pairs.clear();
+    result.test_count = 0;
+
+    const size_t begin = chunk * s_chunk_size;
+    const size_t end = std::min(begin + s_chunk_size, m_entries.size());
+    for (size_t i = begin; i < end; ++i) {
+        const auto& entry = m_entries[i];
+        const auto min = Float4::Load(entry.min);
+        const auto max = Float4::Load(entry.max);
+
+        // Entries [first, last) whose cell lies in row (y + dy, z + dz) between x + min_dx and x + 1.
+        const auto scan = [&](size_t first, size_t last, int32_t min_dx, int32_t dy, int32_t dz) {
+            for (size_t j = first; j < last; ++j) {
+                const auto& other = m_entries[j];
+                const int32_t dx = other.cell[0] - entry.cell[0];
+                if (dx < min_dx || dx > 1 || other.cell[1] != entry.cell[1] + dy || other.cell[2] != entry.cell[2] + dz) {
+                    continue;
+                }
+
+                ++result.test_count;
+                if ((GetBits((min <= Float4::Load(other.max)) & (max >= Float4::Load(other.min))) & 7u) == 7u) {
+                    result.pairs.push_back(MakePair(entry.body, other.body));
+                }
+            }
+        };
+
+        // Runs of buckets that wrap around the end of the table are scanned in two parts.
+        const auto scan_buckets = [&](uint32_t first_bucket, uint32_t bucket_count, size_t first, int32_t min_dx, int32_t dy, int32_t dz) {
+            const uint32_t last_bucket = first_bucket + bucket_count;
+            if (last_bucket <= m_bucket_mask + 1) {
+                scan(first, m_bucket_offsets[last_bucket], min_dx, dy, dz);
+            } else {
+                scan(first, m_bucket_offsets[m_bucket_mask + 1], min_dx, dy, dz);
+                scan(0, m_bucket_offsets[last_bucket & m_bucket_mask], min_dx, dy, dz);
+            }
+        };
+
+        scan_buckets(GetBucket(entry.cell), 2, i + 1, 0, 0, 0);
+        for (const auto& row : s_forward_rows) {
+            const int32_t first_cell[3] = { entry.cell[0] - 1, entry.cell[1] + row[0], entry.cell[2] + row[1] };
+            const auto first_bucket = GetBucket(first_cell);
+            scan_buckets(first_bucket, 3, m_bucket_offsets[first_bucket], -1, row[0], row[1]);
+        }
+    }
+}
+
+}  // namespace ddn
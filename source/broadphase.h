@@ -0,0 +1,131 @@
+#pragma once
+
+#include "bounds.h"
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+// Indexes of two overlapping bodies in the span passed to Update, with first < second.
+struct BroadphasePair
+{
+    uint32_t first = 0;
+    uint32_t second = 0;
+};
+
+struct BroadphaseStatistics
+{
+    double update_ms = 0.0;
+    uint32_t body_count = 0;
+    uint64_t pair_count = 0;
+    uint64_t test_count = 0;
+    uint64_t swap_count = 0;
+    bool is_rebuilt = false;
+};
+
+// Finds the overlapping pairs among a set of AABBs. Bodies stay sorted by their lower bound on one axis between
+// updates, so that coherent motion re-sorts in close to linear time with an insertion sort; a new body count or
+// a sort that has to move bodies too far rebuilds the order on the axis along which the bodies spread the most.
+// Bounds are kept in sorted order as one stream per endpoint and swept four bodies at a time, in parallel over
+// runs of the order. Each pair is reported once, in no particular order.
+class SweepAndPrune
+{
+public:
+    void Update(std::span<const Aabb> bounds);
+
+    std::span<const BroadphasePair> GetPairs() const;
+    const BroadphaseStatistics& GetStatistics() const;
+
+private:
+    struct ChunkResult
+    {
+        std::vector<BroadphasePair> pairs;
+        uint64_t test_count = 0;
+    };
+
+    void Rebuild(std::span<const Aabb> bounds);
+    bool Resort(std::span<const Aabb> bounds);
+    void GatherBounds(std::span<const Aabb> bounds);
+    void SweepChunk(size_t chunk);
+
+private:
+    BroadphaseStatistics m_statistics;
+    int m_axis = 0;
+    std::vector<uint32_t> m_order;
+
+    // Endpoints in sorted order on the sweep axis (a) and the two others (b, c), padded by one SIMD width.
+    std::vector<float> m_min_a;
+    std::vector<float> m_max_a;
+    std::vector<float> m_min_b;
+    std::vector<float> m_max_b;
+    std::vector<float> m_min_c;
+    std::vector<float> m_max_c;
+
+    std::vector<ChunkResult> m_chunk_results;
+    std::vector<BroadphasePair> m_pairs;
+};
+
+struct SpatialHashDesc
+{
+    // Must be at least the largest extent of any body; zero derives it from the bodies on every update.
+    float cell_size = 0.0f;
+};
+
+// Finds the overlapping pairs among AABBs of similar size by binning each body by the grid cell of its lower
+// corner. As no body is larger than a cell, overlapping bodies sit in the same or adjacent cells, and each body
+// only visits its own cell and the 13 neighbours in one half of the surrounding block. Cells are numbered along
+// rows of the grid and wrapped to the table size, so the neighbour lookups run through the table in a few
+// sequential streams. A single large body makes the cells large for all of them; prefer SweepAndPrune for
+// widely varying sizes. Bounds must be finite, so unbounded bodies such as ground planes belong in SweepAndPrune.
+class SpatialHash
+{
+public:
+    explicit SpatialHash(const SpatialHashDesc& desc = {});
+
+    void Update(std::span<const Aabb> bounds);
+
+    std::span<const BroadphasePair> GetPairs() const;
+    const BroadphaseStatistics& GetStatistics() const;
+    float GetCellSize() const;
+
+private:
+    struct Entry
+    {
+        float min[4];
+        float max[4];
+        int32_t cell[3];
+        uint32_t body;
+    };
+
+    struct ChunkResult
+    {
+        std::vector<BroadphasePair> pairs;
+        uint64_t test_count = 0;
+    };
+
+    uint32_t GetBucket(const int32_t cell[3]) const;
+    void BinBodies(std::span<const Aabb> bounds);
+    void FindChunkPairs(size_t chunk);
+
+private:
+    SpatialHashDesc m_desc;
+    BroadphaseStatistics m_statistics;
+    float m_cell_size = 0.0f;
+    int32_t m_cell_origin[3] = {};
+    uint32_t m_row_stride = 0;
+    uint32_t m_slab_stride = 0;
+    uint32_t m_bucket_mask = 0;
+
+    std::vector<Entry> m_body_entries;
+    std::vector<uint32_t> m_body_slots;
+    std::vector<uint32_t> m_bucket_offsets;
+    std::vector<Entry> m_entries;
+
+    std::vector<ChunkResult> m_chunk_results;
+    std::vector<BroadphasePair> m_pairs;
+};
+
+}  // namespace ddn
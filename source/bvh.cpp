@@ -0,0 +1,495 @@
+#include "bvh.h"
+#include "thread-pool.h"
+
+#include <glm/glm.hpp>
+
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr uint32_t s_max_depth = 60;
+constexpr uint32_t s_max_bin_count = 64;
+constexpr uint32_t s_max_leaf_size_factor = 4;
+constexpr size_t s_parallel_build_threshold = 8192;
+constexpr size_t s_parallel_binning_threshold = 65536;
+constexpr size_t s_binning_grain_size = 16384;
+constexpr size_t s_refit_subtree_factor = 4;
+
+struct Bin
+{
+    glm::vec3 min;
+    glm::vec3 max;
+    glm::vec3 centroid_min;
+    glm::vec3 centroid_max;
+    uint32_t count;
+
+    void Reset()
+    {
+        min = centroid_min = glm::vec3(std::numeric_limits<float>::max());
+        max = centroid_max = glm::vec3(std::numeric_limits<float>::lowest());
+        count = 0;
+    }
+
+    void Extend(const ddn::Aabb& bounds, const glm::vec3& centroid)
+    {
+        min = glm::min(min, bounds.min);
+        max = glm::max(max, bounds.max);
+        centroid_min = glm::min(centroid_min, centroid);
+        centroid_max = glm::max(centroid_max, centroid);
+        ++count;
+    }
+
+    void Extend(const Bin& other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+        centroid_min = glm::min(centroid_min, other.centroid_min);
+        centroid_max = glm::max(centroid_max, other.centroid_max);
+        count += other.count;
+    }
+
+    float GetHalfSurfaceArea() const
+    {
+        const auto size = max - min;
+        return size.x * size.y + size.y * size.z + size.z * size.x;
+    }
+};
+
+using Bins = std::array<Bin, s_max_bin_count>;
+
+uint32_t GetBinIndex(float centroid, float min, float scale, uint32_t bin_count)
+{
+    const auto bin = static_cast<int32_t>((centroid - min) * scale);
+    return static_cast<uint32_t>(std::clamp<int32_t>(bin, 0, static_cast<int32_t>(bin_count) - 1));
+}
+
+void ResetBins(Bins& bins, uint32_t bin_count)
+{
+    for (uint32_t i = 0; i < bin_count; ++i) {
+        bins[i].Reset();
+    }
+}
+
+}
+
+namespace ddn
+{
+
+struct Bvh::BuildContext
+{
+    struct Reference
+    {
+        Aabb bounds;
+        uint32_t index;
+
+        glm::vec3 GetCentroid() const { return (bounds.min + bounds.max) * 0.5f; }
+    };
+
+    std::vector<Reference> references;
+    BvhBuildDesc desc;
+    std::atomic_uint32_t depth = 0;
+};
+
+void Bvh::Build(std::span<const Aabb> bounds, const BvhBuildDesc& desc)
+{
+    if (desc.max_leaf_size == 0 || desc.bin_count < 2 || desc.bin_count > s_max_bin_count) {
+        throw std::invalid_argument("Invalid BVH build description");
+    }
+
+    m_nodes.clear();
+    m_primitive_indices.resize(bounds.size());
+    m_primitive_bounds.resize(bounds.size());
+    m_depth = 0;
+    if (bounds.empty()) {
+        return;
+    }
+
+    BuildContext context;
+    context.desc = desc;
+    context.references.resize(bounds.size());
+    ParallelFor(0, bounds.size(), s_binning_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            context.references[i] = { bounds[i], static_cast<uint32_t>(i) };
+        }
+    });
+
+    const auto root = ComputeBuildRange(context, 0, static_cast<uint32_t>(bounds.size()));
+    m_nodes.reserve(bounds.size() * 2 / desc.max_leaf_size + 1);
+    BuildNode(context, root, m_nodes, 1);
+    m_depth = context.depth.load();
+
+    ParallelFor(0, bounds.size(), s_binning_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_primitive_indices[i] = context.references[i].index;
+            m_primitive_bounds[i] = context.references[i].bounds;
+        }
+    });
+}
+
+void Bvh::Refit(std::span<const Aabb> bounds)
+{
+    if (bounds.size() != m_primitive_indices.size()) {
+        throw std::invalid_argument("Primitive count differs from the built hierarchy");
+    }
+
+    if (m_nodes.empty()) {
+        return;
+    }
+
+    ParallelFor(0, bounds.size(), s_binning_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_primitive_bounds[i] = bounds[m_primitive_indices[i]];
+        }
+    });
+
+    const size_t subtree_count = ThreadPool::GetInstance().GetThreadCount() * s_refit_subtree_factor;
+    std::vector<uint32_t> top_nodes;
+    std::vector<uint32_t> subtree_roots = { 0 };
+    while (subtree_roots.size() < subtree_count) {
+        std::vector<uint32_t> next_roots;
+        for (const auto root : subtree_roots) {
+            if (m_nodes[root].IsLeaf()) {
+                next_roots.push_back(root);
+                continue;
+            }
+
+            top_nodes.push_back(root);
+            next_roots.push_back(root + 1);
+            next_roots.push_back(m_nodes[root].offset);
+        }
+
+        if (next_roots.size() == subtree_roots.size()) {
+            break;
+        }
+        subtree_roots = std::move(next_roots);
+    }
+
+    ParallelFor(0, subtree_roots.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto root = subtree_roots[i];
+            for (uint32_t node_index = GetSubtreeEnd(root); node_index-- > root;) {
+                RefitNode(node_index);
+            }
+        }
+    });
+
+    std::sort(top_nodes.begin(), top_nodes.end(), std::greater<>());
+    for (const auto node_index : top_nodes) {
+        RefitNode(node_index);
+    }
+}
+
+void Bvh::QueryAabb(const Aabb& aabb, std::vector<uint32_t>& results) const
+{
+    Query([&](const Aabb& bounds) {
+        return bounds.Intersects(aabb);
+    }, results);
+}
+
+void Bvh::QuerySphere(const Sphere& sphere, std::vector<uint32_t>& results) const
+{
+    Query([&](const Aabb& bounds) {
+        return sphere.Intersects(bounds);
+    }, results);
+}
+
+void Bvh::QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& results) const
+{
+    results.clear();
+    if (m_nodes.empty()) {
+        return;
+    }
+
+    std::array<uint32_t, s_max_stack_size> stack;
+    size_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        const auto node_index = stack[--stack_size];
+        const auto& node = m_nodes[node_index];
+
+        const auto result = frustum.Test(node.bounds);
+        if (result == FrustumTestResult::Outside) {
+            continue;
+        }
+
+        if (result == FrustumTestResult::Inside) {
+            uint32_t first_leaf = node_index;
+            while (!m_nodes[first_leaf].IsLeaf()) {
+                ++first_leaf;
+            }
+            const auto& last_leaf = m_nodes[GetSubtreeEnd(node_index) - 1];
+
+            const auto begin = m_primitive_indices.begin() + m_nodes[first_leaf].offset;
+            const auto end = m_primitive_indices.begin() + last_leaf.offset + last_leaf.count;
+            results.insert(results.end(), begin, end);
+            continue;
+        }
+
+        if (node.IsLeaf()) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                if (frustum.Intersects(m_primitive_bounds[i])) {
+                    results.push_back(m_primitive_indices[i]);
+                }
+            }
+            continue;
+        }
+
+        stack[stack_size++] = node.offset;
+        stack[stack_size++] = node_index + 1;
+    }
+}
+
+void Bvh::QueryRay(const Ray& ray, std::vector<uint32_t>& results) const
+{
+    const glm::vec3 inverse_direction(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+    Query([&](const Aabb& bounds) {
+        float distance = 0.0f;
+        return IntersectRay(ray, inverse_direction, bounds, ray.max_distance, distance);
+    }, results);
+}
+
+std::span<const BvhNode> Bvh::GetNodes() const
+{
+    return m_nodes;
+}
+
+std::span<const uint32_t> Bvh::GetPrimitiveIndices() const
+{
+    return m_primitive_indices;
+}
+
+uint32_t Bvh::GetDepth() const
+{
+    return m_depth;
+}
+
+Bvh::BuildRange Bvh::ComputeBuildRange(const BuildContext& context, uint32_t begin, uint32_t end)
+{
+    auto compute = [&](size_t chunk_begin, size_t chunk_end) {
+        BuildRange range;
+        for (size_t i = chunk_begin; i < chunk_end; ++i) {
+            const auto& reference = context.references[i];
+            range.bounds.Extend(reference.bounds);
+            range.centroid_bounds.Extend(reference.GetCentroid());
+        }
+        return range;
+    };
+
+    BuildRange range;
+    if (end - begin >= s_parallel_binning_threshold) {
+        std::mutex mutex;
+        ParallelFor(begin, end, s_binning_grain_size, [&](size_t chunk_begin, size_t chunk_end) {
+            const auto chunk_range = compute(chunk_begin, chunk_end);
+            std::lock_guard guard(mutex);
+            range.bounds.Extend(chunk_range.bounds);
+            range.centroid_bounds.Extend(chunk_range.centroid_bounds);
+        });
+    } else {
+        range = compute(begin, end);
+    }
+
+    range.begin = begin;
+    range.end = end;
+    return range;
+}
+
+uint32_t Bvh::BuildNode(BuildContext& context, const BuildRange& range, std::vector<BvhNode>& nodes, uint32_t depth)
+{
+    const auto node_index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({ range.bounds, range.begin, 0 });
+
+    auto current_depth = context.depth.load(std::memory_order_relaxed);
+    while (current_depth < depth && !context.depth.compare_exchange_weak(current_depth, depth, std::memory_order_relaxed)) {
+    }
+
+    const auto& desc = context.desc;
+    const auto count = range.end - range.begin;
+    if (count <= desc.max_leaf_size || depth >= s_max_depth) {
+        nodes[node_index].count = count;
+        return node_index;
+    }
+
+    const auto centroid_extent = range.centroid_bounds.max - range.centroid_bounds.min;
+    int axis = 0;
+    if (centroid_extent.y > centroid_extent[axis]) {
+        axis = 1;
+    }
+    if (centroid_extent.z > centroid_extent[axis]) {
+        axis = 2;
+    }
+
+    BuildRange left_range;
+    BuildRange right_range;
+    if (centroid_extent[axis] <= 0.0f) {
+        if (count <= desc.max_leaf_size * s_max_leaf_size_factor) {
+            nodes[node_index].count = count;
+            return node_index;
+        }
+
+        const auto mid = range.begin + count / 2;
+        left_range = ComputeBuildRange(context, range.begin, mid);
+        right_range = ComputeBuildRange(context, mid, range.end);
+    } else {
+        const auto bin_count = std::min(desc.bin_count, count);
+        const auto axis_min = range.centroid_bounds.min[axis];
+        const auto axis_scale = bin_count / centroid_extent[axis];
+        auto fill_bins = [&](Bins& bins, size_t chunk_begin, size_t chunk_end) {
+            for (size_t i = chunk_begin; i < chunk_end; ++i) {
+                const auto& reference = context.references[i];
+                const auto centroid = reference.GetCentroid();
+                bins[GetBinIndex(centroid[axis], axis_min, axis_scale, bin_count)].Extend(reference.bounds, centroid);
+            }
+        };
+
+        Bins bins;
+        ResetBins(bins, bin_count);
+        if (count >= s_parallel_binning_threshold) {
+            std::mutex mutex;
+            ParallelFor(range.begin, range.end, s_binning_grain_size, [&](size_t chunk_begin, size_t chunk_end) {
+                Bins chunk_bins;
+                ResetBins(chunk_bins, bin_count);
+                fill_bins(chunk_bins, chunk_begin, chunk_end);
+
+                std::lock_guard guard(mutex);
+                for (uint32_t i = 0; i < bin_count; ++i) {
+                    bins[i].Extend(chunk_bins[i]);
+                }
+            });
+        } else {
+            fill_bins(bins, range.begin, range.end);
+        }
+
+        Bins right_bins;
+        right_bins[bin_count - 1] = bins[bin_count - 1];
+        for (uint32_t i = bin_count - 1; i-- > 1;) {
+            right_bins[i] = right_bins[i + 1];
+            right_bins[i].Extend(bins[i]);
+        }
+
+        float best_cost = std::numeric_limits<float>::max();
+        uint32_t best_split = 0;
+        Bin left_bin;
+        Bin best_left_bin;
+        left_bin.Reset();
+        for (uint32_t split = 1; split < bin_count; ++split) {
+            left_bin.Extend(bins[split - 1]);
+            if (left_bin.count == 0 || right_bins[split].count == 0) {
+                continue;
+            }
+
+            const float cost = left_bin.count * left_bin.GetHalfSurfaceArea() + right_bins[split].count * right_bins[split].GetHalfSurfaceArea();
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_split = split;
+                best_left_bin = left_bin;
+            }
+        }
+
+        const float node_area = std::max(0.5f * range.bounds.GetSurfaceArea(), std::numeric_limits<float>::min());
+        const float split_cost = desc.traversal_cost + best_cost / node_area;
+        if (best_split == 0 || (split_cost >= static_cast<float>(count) && count <= desc.max_leaf_size * s_max_leaf_size_factor)) {
+            nodes[node_index].count = count;
+            return node_index;
+        }
+
+        const auto partition_end = std::partition(context.references.begin() + range.begin, context.references.begin() + range.end, [&](const BuildContext::Reference& reference) {
+            return GetBinIndex(reference.GetCentroid()[axis], axis_min, axis_scale, bin_count) < best_split;
+        });
+        const auto mid = static_cast<uint32_t>(partition_end - context.references.begin());
+
+        const auto& right_bin = right_bins[best_split];
+        left_range = { { best_left_bin.min, best_left_bin.max }, { best_left_bin.centroid_min, best_left_bin.centroid_max }, range.begin, mid };
+        right_range = { { right_bin.min, right_bin.max }, { right_bin.centroid_min, right_bin.centroid_max }, mid, range.end };
+    }
+
+    if (count >= s_parallel_build_threshold) {
+        std::vector<BvhNode> right_nodes;
+        right_nodes.reserve((right_range.end - right_range.begin) * 2 / desc.max_leaf_size + 1);
+        ParallelFor(0, 2, 1, [&](size_t task_begin, size_t task_end) {
+            for (size_t task = task_begin; task < task_end; ++task) {
+                if (task == 0) {
+                    BuildNode(context, left_range, nodes, depth + 1);
+                } else {
+                    BuildNode(context, right_range, right_nodes, depth + 1);
+                }
+            }
+        });
+
+        const auto right_offset = static_cast<uint32_t>(nodes.size());
+        for (auto node : right_nodes) {
+            if (!node.IsLeaf()) {
+                node.offset += right_offset;
+            }
+            nodes.push_back(node);
+        }
+        nodes[node_index].offset = right_offset;
+    } else {
+        BuildNode(context, left_range, nodes, depth + 1);
+        const auto right_child = BuildNode(context, right_range, nodes, depth + 1);
+        nodes[node_index].offset = right_child;
+    }
+
+    return node_index;
+}
+
+void Bvh::RefitNode(uint32_t node_index)
+{
+    auto& node = m_nodes[node_index];
+    Aabb node_bounds;
+    if (node.IsLeaf()) {
+        for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+            node_bounds.Extend(m_primitive_bounds[i]);
+        }
+    } else {
+        node_bounds = m_nodes[node_index + 1].bounds;
+        node_bounds.Extend(m_nodes[node.offset].bounds);
+    }
+    node.bounds = node_bounds;
+}
+
+uint32_t Bvh::GetSubtreeEnd(uint32_t node_index) const
+{
+    while (!m_nodes[node_index].IsLeaf()) {
+        node_index = m_nodes[node_index].offset;
+    }
+    return node_index + 1;
+}
+
+template <typename Predicate>
+void Bvh::Query(Predicate&& predicate, std::vector<uint32_t>& results) const
+{
+    results.clear();
+    if (m_nodes.empty()) {
+        return;
+    }
+
+    std::array<uint32_t, s_max_stack_size> stack;
+    size_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        const auto& node = m_nodes[stack[--stack_size]];
+        if (!predicate(node.bounds)) {
+            continue;
+        }
+
+        if (node.IsLeaf()) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                if (predicate(m_primitive_bounds[i])) {
+                    results.push_back(m_primitive_indices[i]);
+                }
+            }
+            continue;
+        }
+
+        stack[stack_size++] = node.offset;
+        stack[stack_size++] = static_cast<uint32_t>(&node - m_nodes.data()) + 1;
+    }
+}
+
+}  // namespace ddn
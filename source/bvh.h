@@ -0,0 +1,187 @@
+#pragma once
+
+#include "bounds.h"
+
+#include <glm/common.hpp>
+
+#include <span>
+#include <array>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+namespace ddn
+{
+
+struct BvhNode
+{
+    Aabb bounds;
+    uint32_t offset = 0;
+    uint32_t count = 0;
+
+    bool IsLeaf() const { return count != 0; }
+};
+
+struct BvhBuildDesc
+{
+    uint32_t max_leaf_size = 4;
+    uint32_t bin_count = 16;
+    float traversal_cost = 1.0f;
+};
+
+struct BvhHit
+{
+    uint32_t primitive = std::numeric_limits<uint32_t>::max();
+    float distance = std::numeric_limits<float>::max();
+
+    bool IsValid() const { return primitive != std::numeric_limits<uint32_t>::max(); }
+};
+
+class Bvh
+{
+public:
+    void Build(std::span<const Aabb> bounds, const BvhBuildDesc& desc = {});
+    void Refit(std::span<const Aabb> bounds);
+
+    void QueryAabb(const Aabb& aabb, std::vector<uint32_t>& results) const;
+    void QuerySphere(const Sphere& sphere, std::vector<uint32_t>& results) const;
+    void QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& results) const;
+    void QueryRay(const Ray& ray, std::vector<uint32_t>& results) const;
+
+    template <typename Function>
+    BvhHit Raycast(const Ray& ray, Function&& intersect) const;
+
+    template <typename Function>
+    BvhHit RaycastLeaves(const Ray& ray, Function&& intersect_leaf) const;
+
+    std::span<const BvhNode> GetNodes() const;
+    std::span<const uint32_t> GetPrimitiveIndices() const;
+    uint32_t GetDepth() const;
+
+private:
+    struct BuildContext;
+
+    struct BuildRange
+    {
+        Aabb bounds;
+        Aabb centroid_bounds;
+        uint32_t begin = 0;
+        uint32_t end = 0;
+    };
+    struct RayStackEntry
+    {
+        uint32_t node_index;
+        float distance;
+    };
+    static constexpr size_t s_max_stack_size = 64;
+
+    static bool IntersectRay(const Ray& ray, const glm::vec3& inverse_direction, const Aabb& aabb, float max_distance, float& distance);
+
+    static BuildRange ComputeBuildRange(const BuildContext& context, uint32_t begin, uint32_t end);
+    uint32_t BuildNode(BuildContext& context, const BuildRange& range, std::vector<BvhNode>& nodes, uint32_t depth);
+    void RefitNode(uint32_t node_index);
+    uint32_t GetSubtreeEnd(uint32_t node_index) const;
+
+    template <typename Predicate>
+    void Query(Predicate&& predicate, std::vector<uint32_t>& results) const;
+
+private:
+    std::vector<BvhNode> m_nodes;
+    std::vector<uint32_t> m_primitive_indices;
+    std::vector<Aabb> m_primitive_bounds;
+    uint32_t m_depth = 0;
+};
+
+inline bool Bvh::IntersectRay(const Ray& ray, const glm::vec3& inverse_direction, const Aabb& aabb, float max_distance, float& distance)
+{
+    const auto t0 = (aabb.min - ray.origin) * inverse_direction;
+    const auto t1 = (aabb.max - ray.origin) * inverse_direction;
+    const auto near = glm::min(t0, t1);
+    const auto far = glm::max(t0, t1);
+
+    const float near_distance = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+    const float far_distance = std::min(std::min(far.x, far.y), std::min(far.z, max_distance));
+    distance = near_distance;
+    return near_distance <= far_distance;
+}
+
+template <typename Function>
+BvhHit Bvh::Raycast(const Ray& ray, Function&& intersect) const
+{
+    return RaycastLeaves(ray, [&](uint32_t first, uint32_t count, BvhHit& hit) {
+        for (uint32_t i = first; i < first + count; ++i) {
+            const auto primitive = m_primitive_indices[i];
+            float primitive_distance = hit.distance;
+            if (intersect(primitive, ray, primitive_distance) && primitive_distance <= hit.distance) {
+                hit.primitive = primitive;
+                hit.distance = primitive_distance;
+            }
+        }
+        return false;
+    });
+}
+
+template <typename Function>
+BvhHit Bvh::RaycastLeaves(const Ray& ray, Function&& intersect_leaf) const
+{
+    BvhHit hit;
+    hit.distance = ray.max_distance;
+    if (m_nodes.empty()) {
+        return hit;
+    }
+
+    const glm::vec3 inverse_direction(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+    float distance = 0.0f;
+    if (!IntersectRay(ray, inverse_direction, m_nodes.front().bounds, hit.distance, distance)) {
+        return hit;
+    }
+
+    std::array<RayStackEntry, s_max_stack_size> stack;
+    size_t stack_size = 0;
+    stack[stack_size++] = { 0, distance };
+
+    while (stack_size > 0) {
+        const auto [node_index, node_distance] = stack[--stack_size];
+        if (node_distance > hit.distance) {
+            continue;
+        }
+
+        const auto& node = m_nodes[node_index];
+        if (node.IsLeaf()) {
+            if (intersect_leaf(node.offset, node.count, hit)) {
+                break;
+            }
+            continue;
+        }
+
+        uint32_t near_child = node_index + 1;
+        uint32_t far_child = node.offset;
+        float near_distance = 0.0f;
+        float far_distance = 0.0f;
+        bool is_near_hit = IntersectRay(ray, inverse_direction, m_nodes[near_child].bounds, hit.distance, near_distance);
+        bool is_far_hit = IntersectRay(ray, inverse_direction, m_nodes[far_child].bounds, hit.distance, far_distance);
+
+        if (is_near_hit && is_far_hit && far_distance < near_distance) {
+            std::swap(near_child, far_child);
+            std::swap(near_distance, far_distance);
+        } else if (!is_near_hit) {
+            std::swap(near_child, far_child);
+            std::swap(near_distance, far_distance);
+            std::swap(is_near_hit, is_far_hit);
+        }
+
+        if (is_far_hit) {
+            stack[stack_size++] = { far_child, far_distance };
+        }
+        if (is_near_hit) {
+            stack[stack_size++] = { near_child, near_distance };
+        }
+    }
+
+    return hit;
+}
+
+}  // namespace ddn
@@ -1,28 +1,58 @@
 #include "camera.h"
 
+#include <glm/glm.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/ext/matrix_clip_space.hpp>
 
+#include <cmath>
+
+namespace
+{
+
+glm::vec4 GetRow(const glm::mat4& matrix, int index)
+{
+    return glm::vec4(matrix[0][index], matrix[1][index], matrix[2][index], matrix[3][index]);
+}
+
+}
+
 namespace ddn
 {
 
-Camera::Camera(uint32_t width, uint32_t height, float fov_y_deg, float near_z, float far_z)
-    : m_fov_y_rad(glm::radians(fov_y_deg))
+Camera::Camera(uint32_t width, uint32_t height, float fov_y_deg, float near_z, float far_z, ProjectionType projection_type)
+    : m_width(width)
+    , m_height(height)
+    , m_fov_y_rad(glm::radians(fov_y_deg))
     , m_aspect(static_cast<float>(width) / height)
     , m_near_z(near_z)
     , m_far_z(far_z)
+    , m_projection_type(projection_type)
     , m_position(0.0f)
+    , m_orientation(1.0f, 0.0f, 0.0f, 0.0f)
 {
+    UpdateView();
+    UpdateProjection();
+    UpdateProjectionView();
 }
 
 void Camera::OnResize(uint32_t width, uint32_t height)
 {
+    if (width == 0 || height == 0) {
+        return;
+    }
+
+    m_width = width;
+    m_height = height;
     m_aspect = static_cast<float>(width) / height;
+    UpdateProjection();
+    UpdateProjectionView();
 }
 
 void Camera::SetPosition(const glm::vec3& position)
 {
     m_position = position;
+    UpdateView();
+    UpdateProjectionView();
 }
 
 glm::vec3 Camera::GetPosition() const
@@ -30,11 +60,176 @@ glm::vec3 Camera::GetPosition() const
     return m_position;
 }
 
-glm::mat4 Camera::GetProjectionViewMatrix() const
+void Camera::SetOrientation(const glm::quat& orientation)
+{
+    m_orientation = glm::normalize(orientation);
+    UpdateView();
+    UpdateProjectionView();
+}
+
+glm::quat Camera::GetOrientation() const
+{
+    return m_orientation;
+}
+
+void Camera::SetRotation(float yaw_rad, float pitch_rad, float roll_rad)
+{
+    const auto yaw = glm::angleAxis(yaw_rad, glm::vec3(0.0f, 1.0f, 0.0f));
+    const auto pitch = glm::angleAxis(pitch_rad, glm::vec3(1.0f, 0.0f, 0.0f));
+    const auto roll = glm::angleAxis(roll_rad, glm::vec3(0.0f, 0.0f, 1.0f));
+    SetOrientation(yaw * pitch * roll);
+}
+
+void Camera::LookAt(const glm::vec3& target, const glm::vec3& up)
+{
+    const auto direction = target - m_position;
+    if (glm::dot(direction, direction) <= 0.0f) {
+        return;
+    }
+
+    SetOrientation(glm::quatLookAt(glm::normalize(direction), up));
+}
+
+glm::vec3 Camera::GetForward() const
+{
+    return m_orientation * glm::vec3(0.0f, 0.0f, 1.0f);
+}
+
+glm::vec3 Camera::GetRight() const
+{
+    return m_orientation * glm::vec3(1.0f, 0.0f, 0.0f);
+}
+
+glm::vec3 Camera::GetUp() const
+{
+    return m_orientation * glm::vec3(0.0f, 1.0f, 0.0f);
+}
+
+void Camera::SetProjectionType(ProjectionType projection_type)
+{
+    m_projection_type = projection_type;
+    UpdateProjection();
+    UpdateProjectionView();
+}
+
+ProjectionType Camera::GetProjectionType() const
+{
+    return m_projection_type;
+}
+
+uint32_t Camera::GetWidth() const
+{
+    return m_width;
+}
+
+uint32_t Camera::GetHeight() const
+{
+    return m_height;
+}
+
+float Camera::GetFovY() const
 {
-    auto projection_matrix = glm::perspective(m_fov_y_rad, m_aspect, m_near_z, m_far_z);
-    auto view_matrix = glm::lookAt(m_position, glm::vec3(), glm::vec3(0.0f, 1.0f, 0.0f));
-    return projection_matrix * view_matrix;
+    return m_fov_y_rad;
 }
 
+float Camera::GetAspect() const
+{
+    return m_aspect;
+}
+
+float Camera::GetNearZ() const
+{
+    return m_near_z;
+}
+
+float Camera::GetFarZ() const
+{
+    return m_far_z;
+}
+
+const glm::mat4& Camera::GetViewMatrix() const
+{
+    return m_view_matrix;
+}
+
+const glm::mat4& Camera::GetInverseViewMatrix() const
+{
+    return m_inverse_view_matrix;
+}
+
+const glm::mat4& Camera::GetProjectionMatrix() const
+{
+    return m_projection_matrix;
+}
+
+const glm::mat4& Camera::GetInverseProjectionMatrix() const
+{
+    return m_inverse_projection_matrix;
+}
+
+const glm::mat4& Camera::GetProjectionViewMatrix() const
+{
+    return m_projection_view_matrix;
 }
+
+const glm::mat4& Camera::GetInverseProjectionViewMatrix() const
+{
+    return m_inverse_projection_view_matrix;
+}
+
+const Frustum& Camera::GetFrustum() const
+{
+    return m_frustum;
+}
+
+void Camera::UpdateView()
+{
+    const auto rotation = glm::mat3_cast(m_orientation);
+    const auto inverse_rotation = glm::transpose(rotation);
+
+    m_view_matrix = glm::mat4(inverse_rotation);
+    m_view_matrix[3] = glm::vec4(-(inverse_rotation * m_position), 1.0f);
+
+    m_inverse_view_matrix = glm::mat4(rotation);
+    m_inverse_view_matrix[3] = glm::vec4(m_position, 1.0f);
+}
+
+void Camera::UpdateProjection()
+{
+    if (m_projection_type == ProjectionType::Standard) {
+        m_projection_matrix = glm::perspective(m_fov_y_rad, m_aspect, m_near_z, m_far_z);
+    } else {
+        const float focal_length = 1.0f / std::tan(m_fov_y_rad * 0.5f);
+        m_projection_matrix = glm::mat4(0.0f);
+        m_projection_matrix[0][0] = focal_length / m_aspect;
+        m_projection_matrix[1][1] = focal_length;
+        m_projection_matrix[2][3] = 1.0f;
+        m_projection_matrix[3][2] = m_near_z;
+    }
+    m_inverse_projection_matrix = glm::inverse(m_projection_matrix);
+}
+
+void Camera::UpdateProjectionView()
+{
+    m_projection_view_matrix = m_projection_matrix * m_view_matrix;
+    m_inverse_projection_view_matrix = m_inverse_view_matrix * m_inverse_projection_matrix;
+
+    const auto row_x = GetRow(m_projection_view_matrix, 0);
+    const auto row_y = GetRow(m_projection_view_matrix, 1);
+    const auto row_w = GetRow(m_projection_view_matrix, 3);
+
+    auto& planes = m_frustum.planes;
+    planes[static_cast<size_t>(FrustumPlane::Left)] = NormalizePlane(row_w + row_x);
+    planes[static_cast<size_t>(FrustumPlane::Right)] = NormalizePlane(row_w - row_x);
+    planes[static_cast<size_t>(FrustumPlane::Bottom)] = NormalizePlane(row_w + row_y);
+    planes[static_cast<size_t>(FrustumPlane::Top)] = NormalizePlane(row_w - row_y);
+
+    const auto forward = GetForward();
+    const float position_distance = glm::dot(forward, m_position);
+    planes[static_cast<size_t>(FrustumPlane::Near)] = glm::vec4(forward, -(position_distance + m_near_z));
+    planes[static_cast<size_t>(FrustumPlane::Far)] = m_projection_type == ProjectionType::Standard
+        ? glm::vec4(-forward, position_distance + m_far_z)
+        : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+}  // namespace ddn
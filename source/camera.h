@@ -1,31 +1,85 @@
 #pragma once
 
-#include "window.h"
+#include "bounds.h"
+#include "window-listener.h"
 
+#include <glm/vec3.hpp>
 #include <glm/mat4x4.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 namespace ddn
 {
 
+enum class ProjectionType
+{
+    Standard,
+    ReversedInfinite,
+};
+
+// The matrices and frustum are recomputed by the setters, so the const getters only read and may be called
+// from several threads at once while no setter runs.
 class Camera
     : public IWindowListener
 {
 public:
-    Camera(uint32_t width, uint32_t height, float fov_y_deg, float near_z, float far_z);
+    Camera(uint32_t width, uint32_t height, float fov_y_deg, float near_z, float far_z, ProjectionType projection_type = ProjectionType::Standard);
 
     void OnResize(uint32_t width, uint32_t height) override;
 
     void SetPosition(const glm::vec3& position);
     glm::vec3 GetPosition() const;
 
-    glm::mat4 GetProjectionViewMatrix() const;
+    void SetOrientation(const glm::quat& orientation);
+    glm::quat GetOrientation() const;
+
+    void SetRotation(float yaw_rad, float pitch_rad, float roll_rad);
+    void LookAt(const glm::vec3& target, const glm::vec3& up = glm::vec3(0.0f, 1.0f, 0.0f));
+
+    glm::vec3 GetForward() const;
+    glm::vec3 GetRight() const;
+    glm::vec3 GetUp() const;
+
+    void SetProjectionType(ProjectionType projection_type);
+    ProjectionType GetProjectionType() const;
+
+    uint32_t GetWidth() const;
+    uint32_t GetHeight() const;
+    float GetFovY() const;
+    float GetAspect() const;
+    float GetNearZ() const;
+    float GetFarZ() const;
+
+    const glm::mat4& GetViewMatrix() const;
+    const glm::mat4& GetInverseViewMatrix() const;
+    const glm::mat4& GetProjectionMatrix() const;
+    const glm::mat4& GetInverseProjectionMatrix() const;
+    const glm::mat4& GetProjectionViewMatrix() const;
+    const glm::mat4& GetInverseProjectionViewMatrix() const;
+    const Frustum& GetFrustum() const;
 
 private:
+    void UpdateView();
+    void UpdateProjection();
+    void UpdateProjectionView();
+
+private:
+    uint32_t m_width;
+    uint32_t m_height;
     float m_fov_y_rad;
     float m_aspect;
     float m_near_z;
     float m_far_z;
+    ProjectionType m_projection_type;
     glm::vec3 m_position;
+    glm::quat m_orientation;
+
+    glm::mat4 m_view_matrix;
+    glm::mat4 m_inverse_view_matrix;
+    glm::mat4 m_projection_matrix;
+    glm::mat4 m_inverse_projection_matrix;
+    glm::mat4 m_projection_view_matrix;
+    glm::mat4 m_inverse_projection_view_matrix;
+    Frustum m_frustum;
 };
 
 }  // namespace ddn
@@ -0,0 +1,179 @@
+#include "command-list-pool.h"
+#include "utils.h"
+
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace Microsoft::WRL;
+
+namespace ddn
+{
+
+PooledCommandList::PooledCommandList(CommandListPool& pool, std::unique_ptr<CommandListEntry> entry)
+    : m_pool(&pool)
+    , m_entry(std::move(entry))
+{
+}
+
+PooledCommandList::~PooledCommandList()
+{
+    if (m_entry) {
+        m_pool->DiscardEntry(std::move(m_entry));
+    }
+}
+
+PooledCommandList& PooledCommandList::operator =(PooledCommandList&& other) noexcept
+{
+    if (this != &other) {
+        if (m_entry) {
+            m_pool->DiscardEntry(std::move(m_entry));
+        }
+        m_pool = other.m_pool;
+        m_entry = std::move(other.m_entry);
+    }
+    return *this;
+}
+
+ID3D12GraphicsCommandList* PooledCommandList::operator ->() const
+{
+    return Get();
+}
+
+PooledCommandList::operator bool() const
+{
+    return m_entry != nullptr;
+}
+
+ID3D12GraphicsCommandList* PooledCommandList::Get() const
+{
+    return m_entry ? m_entry->command_list.Get() : nullptr;
+}
+
+D3D12_COMMAND_LIST_TYPE PooledCommandList::GetType() const
+{
+    return m_entry ? m_entry->type : D3D12_COMMAND_LIST_TYPE_DIRECT;
+}
+
+CommandListPool::CommandListPool(ID3D12Device& device, const CommandListPoolDesc& desc)
+    : m_device(device)
+    , m_desc(desc)
+{
+}
+
+PooledCommandList CommandListPool::Acquire(D3D12_COMMAND_LIST_TYPE type, uint64_t completed_fence_value, ID3D12PipelineState* initial_state)
+{
+    std::unique_ptr<CommandListEntry> entry;
+    {
+        std::lock_guard guard(m_mutex);
+        auto& pool = m_type_pools[GetTypeIndex(type)];
+
+        while (!pool.pending_entries.empty() && pool.pending_entries.front()->fence_value <= completed_fence_value) {
+            pool.pending_entries.front()->idle_since = m_trim_count;
+            pool.free_entries.push_back(std::move(pool.pending_entries.front()));
+            pool.pending_entries.pop_front();
+        }
+
+        // The most recently freed entry is the one most likely to have warm allocator pages.
+        if (!pool.free_entries.empty()) {
+            entry = std::move(pool.free_entries.back());
+            pool.free_entries.pop_back();
+        }
+    }
+
+    if (entry) {
+        ValidateResult(entry->allocator->Reset());
+        ValidateResult(entry->command_list->Reset(entry->allocator.Get(), initial_state));
+    } else {
+        entry = CreateEntry(type);
+        ValidateResult(entry->command_list->Reset(entry->allocator.Get(), initial_state));
+    }
+
+    return PooledCommandList(*this, std::move(entry));
+}
+
+void CommandListPool::Release(PooledCommandList command_list, uint64_t fence_value)
+{
+    if (!command_list) {
+        return;
+    }
+
+    auto entry = std::move(command_list.m_entry);
+    entry->fence_value = fence_value;
+
+    std::lock_guard guard(m_mutex);
+    auto& pending_entries = m_type_pools[GetTypeIndex(entry->type)].pending_entries;
+    auto position = pending_entries.end();
+    if (!pending_entries.empty() && pending_entries.back()->fence_value > fence_value) {
+        position = std::upper_bound(pending_entries.begin(), pending_entries.end(), fence_value, [](uint64_t value, const std::unique_ptr<CommandListEntry>& other) {
+            return value < other->fence_value;
+        });
+    }
+    pending_entries.insert(position, std::move(entry));
+}
+
+void CommandListPool::Trim()
+{
+    std::lock_guard guard(m_mutex);
+    ++m_trim_count;
+
+    for (auto& pool : m_type_pools) {
+        auto& free_entries = pool.free_entries;
+        if (free_entries.size() <= m_desc.min_free_count) {
+            continue;
+        }
+
+        // Acquire takes from the back, so the front holds the entries that have been idle the longest.
+        const auto trim_end = free_entries.end() - m_desc.min_free_count;
+        const auto idle_end = std::find_if(free_entries.begin(), trim_end, [this](const std::unique_ptr<CommandListEntry>& entry) {
+            return entry->idle_since + m_desc.max_idle_age > m_trim_count;
+        });
+
+        const auto trimmed_count = static_cast<uint32_t>(idle_end - free_entries.begin());
+        free_entries.erase(free_entries.begin(), idle_end);
+        pool.statistics.entry_count -= trimmed_count;
+        pool.statistics.trimmed_count += trimmed_count;
+    }
+}
+
+CommandListPoolStatistics CommandListPool::GetStatistics(D3D12_COMMAND_LIST_TYPE type) const
+{
+    std::lock_guard guard(m_mutex);
+    const auto& pool = m_type_pools[GetTypeIndex(type)];
+    auto statistics = pool.statistics;
+    statistics.free_count = static_cast<uint32_t>(pool.free_entries.size());
+    statistics.pending_count = static_cast<uint32_t>(pool.pending_entries.size());
+    return statistics;
+}
+
+size_t CommandListPool::GetTypeIndex(D3D12_COMMAND_LIST_TYPE type)
+{
+    const auto index = static_cast<size_t>(type);
+    if (index >= s_type_count) {
+        throw std::invalid_argument("Unexpected command list type");
+    }
+    return index;
+}
+
+std::unique_ptr<CommandListEntry> CommandListPool::CreateEntry(D3D12_COMMAND_LIST_TYPE type)
+{
+    auto entry = std::make_unique<CommandListEntry>();
+    entry->type = type;
+    ValidateResult(m_device.CreateCommandAllocator(type, IID_PPV_ARGS(&entry->allocator)));
+    ValidateResult(m_device.CreateCommandList(0, type, entry->allocator.Get(), nullptr, IID_PPV_ARGS(&entry->command_list)));
+    ValidateResult(entry->command_list->Close());
+
+    std::lock_guard guard(m_mutex);
+    auto& statistics = m_type_pools[GetTypeIndex(type)].statistics;
+    ++statistics.entry_count;
+    ++statistics.created_count;
+    return entry;
+}
+
+void CommandListPool::DiscardEntry(std::unique_ptr<CommandListEntry> entry)
+{
+    std::lock_guard guard(m_mutex);
+    --m_type_pools[GetTypeIndex(entry->type)].statistics.entry_count;
+}
+
+}  // namespace ddn
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <wrl.h>
+#include <directx/d3dx12.h>
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+struct CommandListEntry
+{
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> command_list;
+    D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    uint64_t fence_value = 0;
+    uint64_t idle_since = 0;
+};
+
+class CommandListPool;
+
+// An allocator/list pair that is open for recording. It has to be handed back to the pool that created it;
+// destroying it instead discards the entry, which is then only safe if the list was never executed.
+class PooledCommandList
+{
+public:
+    PooledCommandList() = default;
+    ~PooledCommandList();
+
+    PooledCommandList(PooledCommandList&& other) noexcept = default;
+    PooledCommandList& operator =(PooledCommandList&& other) noexcept;
+
+    ID3D12GraphicsCommandList* operator ->() const;
+    explicit operator bool() const;
+
+    ID3D12GraphicsCommandList* Get() const;
+    D3D12_COMMAND_LIST_TYPE GetType() const;
+
+private:
+    friend class CommandListPool;
+
+    PooledCommandList(CommandListPool& pool, std::unique_ptr<CommandListEntry> entry);
+
+private:
+    CommandListPool* m_pool = nullptr;
+    std::unique_ptr<CommandListEntry> m_entry;
+};
+
+struct CommandListPoolDesc
+{
+    // Free entries that have not been acquired for this many Trim calls are destroyed.
+    uint32_t max_idle_age = 120;
+    // Free entries per type that Trim keeps regardless of age.
+    uint32_t min_free_count = 2;
+};
+
+struct CommandListPoolStatistics
+{
+    uint32_t entry_count = 0;
+    uint32_t free_count = 0;
+    uint32_t pending_count = 0;
+    uint64_t created_count = 0;
+    uint64_t trimmed_count = 0;
+};
+
+// Hands out command lists per queue type and takes them back with the fence value that follows their
+// execution. An entry is reused only once that value has completed, so any number of lists can be recorded
+// per frame without waiting on the GPU; the pool grows when nothing has completed yet. Fence values are
+// per type, so every type has to be fed from the timeline of the queue that executes it.
+class CommandListPool
+{
+public:
+    explicit CommandListPool(ID3D12Device& device, const CommandListPoolDesc& desc = {});
+
+    CommandListPool(const CommandListPool& other) = delete;
+    CommandListPool& operator =(const CommandListPool& other) = delete;
+
+    PooledCommandList Acquire(D3D12_COMMAND_LIST_TYPE type, uint64_t completed_fence_value, ID3D12PipelineState* initial_state = nullptr);
+    void Release(PooledCommandList command_list, uint64_t fence_value);
+
+    void Trim();
+
+    CommandListPoolStatistics GetStatistics(D3D12_COMMAND_LIST_TYPE type) const;
+
+private:
+    friend class PooledCommandList;
+
+    static constexpr size_t s_type_count = D3D12_COMMAND_LIST_TYPE_VIDEO_ENCODE + 1;
+
+    struct TypePool
+    {
+        std::vector<std::unique_ptr<CommandListEntry>> free_entries;
+        std::deque<std::unique_ptr<CommandListEntry>> pending_entries;
+        CommandListPoolStatistics statistics;
+    };
+
+    static size_t GetTypeIndex(D3D12_COMMAND_LIST_TYPE type);
+    std::unique_ptr<CommandListEntry> CreateEntry(D3D12_COMMAND_LIST_TYPE type);
+    void DiscardEntry(std::unique_ptr<CommandListEntry> entry);
+
+private:
+    ID3D12Device& m_device;
+    CommandListPoolDesc m_desc;
+    mutable std::mutex m_mutex;
+    std::array<TypePool, s_type_count> m_type_pools;
+    uint64_t m_trim_count = 0;
+};
+
+}  // namespace ddn
@@ -1,5 +1,3 @@
-#pragma once
-
 #include "cube.h"
 
 namespace {
@@ -0,0 +1,56 @@
+#include "deferred-release-queue.h"
+
+#include <vector>
+#include <algorithm>
+
+namespace ddn
+{
+
+void DeferredReleaseQueue::OnCompleted(uint64_t fence_value, std::function<void()> callback)
+{
+    std::lock_guard guard(m_mutex);
+
+    // Values nearly always arrive in order, so this is an append; late arrivals are inserted to keep the
+    // entries sorted and Collect a pop from the front.
+    auto position = m_entries.end();
+    if (!m_entries.empty() && m_entries.back().fence_value > fence_value) {
+        position = std::upper_bound(m_entries.begin(), m_entries.end(), fence_value, [](uint64_t value, const Entry& entry) {
+            return value < entry.fence_value;
+        });
+    }
+    m_entries.insert(position, { fence_value, std::move(callback) });
+}
+
+size_t DeferredReleaseQueue::Collect(uint64_t completed_fence_value)
+{
+    std::vector<Entry> ready_entries;
+    {
+        std::lock_guard guard(m_mutex);
+        while (!m_entries.empty() && m_entries.front().fence_value <= completed_fence_value) {
+            ready_entries.push_back(std::move(m_entries.front()));
+            m_entries.pop_front();
+        }
+        m_released_count += ready_entries.size();
+    }
+
+    for (auto& entry : ready_entries) {
+        if (entry.callback) {
+            entry.callback();
+        }
+    }
+    return ready_entries.size();
+}
+
+size_t DeferredReleaseQueue::GetPendingCount() const
+{
+    std::lock_guard guard(m_mutex);
+    return m_entries.size();
+}
+
+uint64_t DeferredReleaseQueue::GetReleasedCount() const
+{
+    std::lock_guard guard(m_mutex);
+    return m_released_count;
+}
+
+}  // namespace ddn
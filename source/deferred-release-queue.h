@@ -0,0 +1,58 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <cstdint>
+#include <utility>
+#include <functional>
+
+namespace ddn
+{
+
+// Keeps GPU objects alive until a fence has passed the value that covers their last use, so that resources
+// can be replaced mid-run without idling the queue. Callbacks run on the thread that calls Collect, outside
+// the lock, and may release further objects. Anything still pending on destruction is dropped without its
+// callback running, so the GPU should be idle by then.
+class DeferredReleaseQueue
+{
+public:
+    DeferredReleaseQueue() = default;
+
+    DeferredReleaseQueue(const DeferredReleaseQueue& other) = delete;
+    DeferredReleaseQueue& operator =(const DeferredReleaseQueue& other) = delete;
+
+    void OnCompleted(uint64_t fence_value, std::function<void()> callback);
+
+    template <typename T>
+    void Release(uint64_t fence_value, T object)
+    {
+        OnCompleted(fence_value, [object = std::move(object)]() {});
+    }
+
+    // Runs every entry whose fence value is at most completed_fence_value; returns how many ran.
+    size_t Collect(uint64_t completed_fence_value);
+
+    // Works with any fence-like timeline exposing GetCompletedValue().
+    template <typename Timeline>
+    size_t Collect(const Timeline& timeline)
+    {
+        return Collect(static_cast<uint64_t>(timeline.GetCompletedValue()));
+    }
+
+    size_t GetPendingCount() const;
+    uint64_t GetReleasedCount() const;
+
+private:
+    struct Entry
+    {
+        uint64_t fence_value = 0;
+        std::function<void()> callback;
+    };
+
+private:
+    mutable std::mutex m_mutex;
+    std::deque<Entry> m_entries;
+    uint64_t m_released_count = 0;
+};
+
+}  // namespace ddn
@@ -1,6 +1,7 @@
 #include "fence.h"
 #include "utils.h"
 #include "command-queue.h"
+#include "profiler.h"
 
 namespace ddn
 {
@@ -32,6 +33,16 @@ uint64_t Fence::Signal(CommandQueue& command_queue)
     return value;
 }
 
+uint64_t Fence::GetCompletedValue() const
+{
+    return m_instance->GetCompletedValue();
+}
+
+uint64_t Fence::GetSignaledValue() const
+{
+    return m_signaled_value;
+}
+
 void Fence::Wait()
 {
     Wait(m_signaled_value);
@@ -39,6 +50,8 @@ void Fence::Wait()
 
 void Fence::Wait(uint64_t value)
 {
+    DDN_PROFILE_SCOPE("Fence::Wait");
+
     const auto current_value = m_instance->GetCompletedValue();
     if (current_value >= value) {
         return;
@@ -22,6 +22,9 @@ public:
     uint64_t Signal();
     uint64_t Signal(CommandQueue& command_queue);
 
+    uint64_t GetCompletedValue() const;
+    uint64_t GetSignaledValue() const;
+
     void Wait();
     void Wait(uint64_t value);
     void Wait(CommandQueue& command_queue);
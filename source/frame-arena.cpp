@@ -0,0 +1,200 @@
+#include "frame-arena.h"
+#include "thread-pool.h"
+#include "memory-tracker.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace ddn
+{
+
+LinearArena::LinearArena(size_t block_size, std::pmr::memory_resource* upstream)
+    : m_upstream(upstream)
+    , m_block_size(std::max<size_t>(block_size, 1))
+{
+    if (!m_upstream) {
+        throw std::invalid_argument("Expected an upstream memory resource");
+    }
+}
+
+LinearArena::~LinearArena()
+{
+    ReleaseBlocks();
+}
+
+void LinearArena::Reset()
+{
+    if (m_blocks.size() > 1) {
+        size_t capacity = 0;
+        for (const auto& block : m_blocks) {
+            capacity += block.size;
+        }
+        ReleaseBlocks();
+        AddBlock(capacity);
+    }
+
+    m_block_index = 0;
+    m_offset = 0;
+    m_used_size = 0;
+}
+
+size_t LinearArena::GetUsedSize() const
+{
+    return m_used_size;
+}
+
+size_t LinearArena::GetPeakUsedSize() const
+{
+    return m_peak_used_size;
+}
+
+size_t LinearArena::GetCapacity() const
+{
+    size_t capacity = 0;
+    for (const auto& block : m_blocks) {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+size_t LinearArena::GetBlockCount() const
+{
+    return m_blocks.size();
+}
+
+void* LinearArena::do_allocate(size_t size, size_t alignment)
+{
+    while (true) {
+        if (m_block_index == m_blocks.size()) {
+            AddBlock(std::max(m_block_size, size + alignment));
+        }
+
+        const auto& block = m_blocks[m_block_index];
+        const auto base = reinterpret_cast<uintptr_t>(block.data);
+        const auto aligned_offset = ((base + m_offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+        if (aligned_offset + size <= block.size) {
+            m_offset = aligned_offset + size;
+            m_used_size += size;
+            m_peak_used_size = std::max(m_peak_used_size, m_used_size);
+            return block.data + aligned_offset;
+        }
+
+        ++m_block_index;
+        m_offset = 0;
+    }
+}
+
+void LinearArena::do_deallocate(void*, size_t, size_t)
+{
+}
+
+bool LinearArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+void LinearArena::AddBlock(size_t size)
+{
+    MemoryTagScope tag_scope(MemoryTag::Arena);
+    Block block;
+    block.data = static_cast<std::byte*>(m_upstream->allocate(size, alignof(std::max_align_t)));
+    block.size = size;
+    m_blocks.push_back(block);
+}
+
+void LinearArena::ReleaseBlocks()
+{
+    for (const auto& block : m_blocks) {
+        m_upstream->deallocate(block.data, block.size, alignof(std::max_align_t));
+    }
+    m_blocks.clear();
+}
+
+FrameArena::FrameArena(const FrameArenaDesc& desc)
+    : m_thread_count(desc.thread_count > 0 ? desc.thread_count : ThreadPool::GetInstance().GetThreadCount())
+    , m_owner_thread_id(std::this_thread::get_id())
+{
+    if (desc.frame_count == 0) {
+        throw std::invalid_argument("Expected at least one frame");
+    }
+
+    m_frames.resize(desc.frame_count);
+    for (auto& frame : m_frames) {
+        frame.arenas.reserve(m_thread_count);
+        for (uint32_t i = 0; i < m_thread_count; ++i) {
+            frame.arenas.push_back(std::make_unique<LinearArena>(desc.block_size));
+        }
+    }
+}
+
+void FrameArena::BeginFrame(uint64_t completed_fence_value)
+{
+    auto& frame = m_frames[m_frame_index];
+    if (frame.fence_value > completed_fence_value) {
+        throw std::logic_error("Frame arena is still in use by the GPU");
+    }
+
+    for (auto& arena : frame.arenas) {
+        arena->Reset();
+    }
+}
+
+void FrameArena::EndFrame(uint64_t fence_value)
+{
+    m_frames[m_frame_index].fence_value = fence_value;
+    m_frame_index = (m_frame_index + 1) % static_cast<uint32_t>(m_frames.size());
+}
+
+LinearArena& FrameArena::GetArena(uint32_t thread_index)
+{
+    if (thread_index >= m_thread_count) {
+        throw std::out_of_range("Thread index exceeds frame arena thread count");
+    }
+    return *m_frames[m_frame_index].arenas[thread_index];
+}
+
+LinearArena& FrameArena::GetThreadArena()
+{
+    const uint32_t thread_index = ThreadPool::GetCurrentThreadIndex();
+    if (thread_index == 0 && std::this_thread::get_id() != m_owner_thread_id) {
+        throw std::logic_error("Only pool threads and the thread that created the frame arena may use thread arenas");
+    }
+    return GetArena(thread_index);
+}
+
+uint32_t FrameArena::GetFrameIndex() const
+{
+    return m_frame_index;
+}
+
+uint32_t FrameArena::GetFrameCount() const
+{
+    return static_cast<uint32_t>(m_frames.size());
+}
+
+uint32_t FrameArena::GetThreadCount() const
+{
+    return m_thread_count;
+}
+
+size_t FrameArena::GetUsedSize() const
+{
+    size_t used_size = 0;
+    for (const auto& arena : m_frames[m_frame_index].arenas) {
+        used_size += arena->GetUsedSize();
+    }
+    return used_size;
+}
+
+size_t FrameArena::GetCapacity() const
+{
+    size_t capacity = 0;
+    for (const auto& frame : m_frames) {
+        for (const auto& arena : frame.arenas) {
+            capacity += arena->GetCapacity();
+        }
+    }
+    return capacity;
+}
+
+}  // namespace ddn
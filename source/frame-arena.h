@@ -0,0 +1,105 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include <memory_resource>
+
+namespace ddn
+{
+
+// Bump allocator for transient data. Deallocation is a no-op; Reset() rewinds the arena and keeps its
+// memory, merging overflow blocks into one so that a steady-state workload stops touching the upstream resource.
+class LinearArena : public std::pmr::memory_resource
+{
+public:
+    static constexpr size_t s_default_block_size = 256 * 1024;
+
+    explicit LinearArena(size_t block_size = s_default_block_size, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~LinearArena() override;
+
+    LinearArena(const LinearArena& other) = delete;
+    LinearArena& operator =(const LinearArena& other) = delete;
+
+    void Reset();
+
+    size_t GetUsedSize() const;
+    size_t GetPeakUsedSize() const;
+    size_t GetCapacity() const;
+    size_t GetBlockCount() const;
+
+protected:
+    void* do_allocate(size_t size, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t size, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    struct Block
+    {
+        std::byte* data = nullptr;
+        size_t size = 0;
+    };
+
+    void AddBlock(size_t size);
+    void ReleaseBlocks();
+
+private:
+    std::pmr::memory_resource* m_upstream = nullptr;
+    std::vector<Block> m_blocks;
+    size_t m_block_size = 0;
+    size_t m_block_index = 0;
+    size_t m_offset = 0;
+    size_t m_used_size = 0;
+    size_t m_peak_used_size = 0;
+};
+
+struct FrameArenaDesc
+{
+    uint32_t frame_count = 2;
+    uint32_t thread_count = 0;
+    size_t block_size = LinearArena::s_default_block_size;
+};
+
+// One LinearArena per thread per frame in flight. A frame's arenas are reset when it is begun again, which
+// requires the fence value it was ended with to have completed.
+//
+// GetThreadArena picks the arena by ThreadPool::GetCurrentThreadIndex, which is 0 for every thread outside
+// the pool. Slot 0 therefore belongs to the thread that created the frame arena; other threads such as the
+// I/O workers need thread_count to leave room for them and must pass their own index to GetArena.
+class FrameArena
+{
+public:
+    explicit FrameArena(const FrameArenaDesc& desc = {});
+
+    FrameArena(const FrameArena& other) = delete;
+    FrameArena& operator =(const FrameArena& other) = delete;
+
+    void BeginFrame(uint64_t completed_fence_value);
+    void EndFrame(uint64_t fence_value);
+
+    LinearArena& GetArena(uint32_t thread_index);
+    LinearArena& GetThreadArena();
+
+    uint32_t GetFrameIndex() const;
+    uint32_t GetFrameCount() const;
+    uint32_t GetThreadCount() const;
+    size_t GetUsedSize() const;
+    size_t GetCapacity() const;
+
+private:
+    struct Frame
+    {
+        std::vector<std::unique_ptr<LinearArena>> arenas;
+        uint64_t fence_value = 0;
+    };
+
+private:
+    std::vector<Frame> m_frames;
+    uint32_t m_frame_index = 0;
+    uint32_t m_thread_count = 0;
+    std::thread::id m_owner_thread_id;
+};
+
+}  // namespace ddn
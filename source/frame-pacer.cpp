@@ -0,0 +1,107 @@
+#include "frame-pacer.h"
+
+#include <stdexcept>
+
+namespace ddn
+{
+
+FramePacer::FramePacer(const FramePacerDesc& desc)
+    : m_frames(desc.frame_count)
+    , m_latency_window_size(desc.latency_window_size)
+{
+    if (desc.frame_count == 0) {
+        throw std::invalid_argument("Expected at least one frame in flight");
+    }
+    if (desc.latency_window_size == 0) {
+        throw std::invalid_argument("Expected non-empty latency window");
+    }
+
+    m_latencies_ms.reserve(m_latency_window_size);
+}
+
+uint32_t FramePacer::GetFrameCount() const
+{
+    return static_cast<uint32_t>(m_frames.size());
+}
+
+uint32_t FramePacer::GetFrameIndex() const
+{
+    return m_frame_index;
+}
+
+uint64_t FramePacer::GetWaitFenceValue() const
+{
+    return m_frames[m_frame_index].fence_value;
+}
+
+void FramePacer::BeginFrame(uint64_t completed_fence_value, Clock::time_point time)
+{
+    if (m_is_recording) {
+        throw std::logic_error("Frame has already begun");
+    }
+
+    auto& frame = m_frames[m_frame_index];
+    if (frame.fence_value > completed_fence_value) {
+        throw std::logic_error("Frame is still in use by the GPU");
+    }
+
+    frame.begin_time = time;
+    m_is_recording = true;
+}
+
+void FramePacer::EndFrame(uint64_t fence_value, uint32_t present_count)
+{
+    if (!m_is_recording) {
+        throw std::logic_error("Frame has not begun");
+    }
+
+    auto& frame = m_frames[m_frame_index];
+    frame.fence_value = fence_value;
+    frame.present_count = present_count;
+    frame.is_pending = true;
+    m_is_recording = false;
+    m_frame_index = (m_frame_index + 1) % GetFrameCount();
+}
+
+void FramePacer::OnPresented(uint32_t present_count, Clock::time_point time)
+{
+    for (auto& frame : m_frames) {
+        if (!frame.is_pending || frame.present_count > present_count) {
+            continue;
+        }
+        if (frame.present_count == present_count) {
+            AddLatency(std::chrono::duration<double, std::milli>(time - frame.begin_time).count());
+        }
+        frame.is_pending = false;
+    }
+}
+
+uint64_t FramePacer::GetLatencySampleCount() const
+{
+    return m_latency_sample_count;
+}
+
+double FramePacer::GetLastLatencyMs() const
+{
+    return m_last_latency_ms;
+}
+
+TimingSummary FramePacer::GetLatencySummary() const
+{
+    return SummarizeTimings(m_latencies_ms);
+}
+
+void FramePacer::AddLatency(double latency_ms)
+{
+    if (m_latencies_ms.size() < m_latency_window_size) {
+        m_latencies_ms.push_back(latency_ms);
+    } else {
+        m_latencies_ms[m_next_latency] = latency_ms;
+        m_next_latency = (m_next_latency + 1) % m_latency_window_size;
+    }
+
+    ++m_latency_sample_count;
+    m_last_latency_ms = latency_ms;
+}
+
+}  // namespace ddn
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "frame-statistics.h"
+
+#include <chrono>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+struct FramePacerDesc
+{
+    uint32_t frame_count = 2;
+    size_t latency_window_size = 1024;
+};
+
+// Hands out per-frame slots for up to frame_count frames in flight, independent of the swap chain's back
+// buffer count. The CPU only has to wait when it is about to reuse a slot whose frame the GPU has not finished,
+// i.e. when it runs more than frame_count frames ahead. Latency is measured from BeginFrame to the time the
+// frame reached the screen, as reported through OnPresented. Frames whose present is never reported, because
+// a later one was displayed first, add no sample.
+class FramePacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FramePacer(const FramePacerDesc& desc = {});
+
+    uint32_t GetFrameCount() const;
+    uint32_t GetFrameIndex() const;
+
+    // The fence value that has to complete before the next BeginFrame, or zero if the slot is free.
+    uint64_t GetWaitFenceValue() const;
+
+    void BeginFrame(uint64_t completed_fence_value, Clock::time_point time = Clock::now());
+    void EndFrame(uint64_t fence_value, uint32_t present_count);
+    void OnPresented(uint32_t present_count, Clock::time_point time);
+
+    uint64_t GetLatencySampleCount() const;
+    double GetLastLatencyMs() const;
+    TimingSummary GetLatencySummary() const;
+
+private:
+    struct Frame
+    {
+        uint64_t fence_value = 0;
+        Clock::time_point begin_time = {};
+        uint32_t present_count = 0;
+        bool is_pending = false;
+    };
+
+    void AddLatency(double latency_ms);
+
+private:
+    std::vector<Frame> m_frames;
+    uint32_t m_frame_index = 0;
+    bool m_is_recording = false;
+
+    std::vector<double> m_latencies_ms;
+    size_t m_latency_window_size = 0;
+    size_t m_next_latency = 0;
+    uint64_t m_latency_sample_count = 0;
+    double m_last_latency_ms = 0.0;
+};
+
+}  // namespace ddn
@@ -0,0 +1,215 @@
+#include "frame-statistics.h"
+
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+double GetPercentile(std::vector<double>& sorted_samples, double percentile)
+{
+    const auto rank = percentile * static_cast<double>(sorted_samples.size() - 1);
+    const auto lower = static_cast<size_t>(std::floor(rank));
+    const auto upper = std::min(lower + 1, sorted_samples.size() - 1);
+    const auto fraction = rank - static_cast<double>(lower);
+    return sorted_samples[lower] + (sorted_samples[upper] - sorted_samples[lower]) * fraction;
+}
+
+}
+
+namespace ddn
+{
+
+TimingSummary SummarizeTimings(std::span<const double> samples_ms)
+{
+    TimingSummary summary;
+    if (samples_ms.empty()) {
+        return summary;
+    }
+
+    std::vector<double> sorted_samples(samples_ms.begin(), samples_ms.end());
+    std::sort(sorted_samples.begin(), sorted_samples.end());
+
+    summary.sample_count = sorted_samples.size();
+    summary.mean_ms = std::accumulate(sorted_samples.begin(), sorted_samples.end(), 0.0) / static_cast<double>(sorted_samples.size());
+    summary.min_ms = sorted_samples.front();
+    summary.p50_ms = GetPercentile(sorted_samples, 0.50);
+    summary.p95_ms = GetPercentile(sorted_samples, 0.95);
+    summary.p99_ms = GetPercentile(sorted_samples, 0.99);
+    summary.max_ms = sorted_samples.back();
+    return summary;
+}
+
+FrameStatistics::RollingWindow::RollingWindow(size_t capacity)
+    : m_samples(std::max<size_t>(1, capacity))
+{
+}
+
+std::optional<double> FrameStatistics::RollingWindow::Push(double value)
+{
+    std::optional<double> evicted;
+    if (m_count == m_samples.size()) {
+        evicted = m_samples[m_next];
+        m_sum -= *evicted;
+    } else {
+        ++m_count;
+    }
+
+    m_samples[m_next] = value;
+    m_sum += value;
+    m_next = (m_next + 1) % m_samples.size();
+    return evicted;
+}
+
+void FrameStatistics::RollingWindow::Clear()
+{
+    m_next = 0;
+    m_count = 0;
+    m_sum = 0.0;
+}
+
+double FrameStatistics::RollingWindow::GetMean() const
+{
+    return m_count > 0 ? m_sum / static_cast<double>(m_count) : 0.0;
+}
+
+std::vector<double> FrameStatistics::RollingWindow::CopySamples() const
+{
+    std::vector<double> samples;
+    samples.reserve(m_count);
+
+    const size_t first = (m_next + m_samples.size() - m_count) % m_samples.size();
+    for (size_t i = 0; i < m_count; ++i) {
+        samples.push_back(m_samples[(first + i) % m_samples.size()]);
+    }
+    return samples;
+}
+
+FrameStatistics::FrameStatistics(std::vector<std::string> phase_names, const FrameStatisticsDesc& desc)
+    : m_desc(desc)
+    , m_phase_names(std::move(phase_names))
+    , m_frame_times(desc.window_size)
+    , m_phase_times(m_phase_names.size(), RollingWindow(desc.window_size))
+    , m_current_phase_times(m_phase_names.size(), 0.0)
+    , m_histogram(std::max<size_t>(1, desc.histogram_bucket_count), 0)
+{
+    if (desc.histogram_bucket_ms <= 0.0) {
+        throw std::invalid_argument("Expected positive histogram bucket width");
+    }
+}
+
+size_t FrameStatistics::GetPhaseCount() const
+{
+    return m_phase_names.size();
+}
+
+const std::string& FrameStatistics::GetPhaseName(size_t phase_index) const
+{
+    return m_phase_names.at(phase_index);
+}
+
+void FrameStatistics::AddPhaseTime(size_t phase_index, double time_ms)
+{
+    if (phase_index < m_current_phase_times.size()) {
+        m_current_phase_times[phase_index] += time_ms;
+    }
+}
+
+void FrameStatistics::AddFrame(double frame_time_ms)
+{
+    const double mean_ms = m_frame_times.GetMean();
+    if (m_frame_count > 0 && frame_time_ms >= m_desc.hitch_min_ms && frame_time_ms > mean_ms * m_desc.hitch_ratio) {
+        ++m_hitch_count;
+    }
+
+    if (auto evicted = m_frame_times.Push(frame_time_ms)) {
+        --m_histogram[GetHistogramBucket(*evicted)];
+    }
+    ++m_histogram[GetHistogramBucket(frame_time_ms)];
+
+    for (size_t i = 0; i < m_phase_times.size(); ++i) {
+        m_phase_times[i].Push(m_current_phase_times[i]);
+        m_current_phase_times[i] = 0.0;
+    }
+
+    ++m_frame_count;
+}
+
+void FrameStatistics::EndFrame()
+{
+    const auto time = std::chrono::steady_clock::now();
+    if (m_last_frame_time) {
+        AddFrame(std::chrono::duration<double, std::milli>(time - *m_last_frame_time).count());
+    } else {
+        std::fill(m_current_phase_times.begin(), m_current_phase_times.end(), 0.0);
+    }
+    m_last_frame_time = time;
+}
+
+uint64_t FrameStatistics::GetFrameCount() const
+{
+    return m_frame_count;
+}
+
+uint64_t FrameStatistics::GetHitchCount() const
+{
+    return m_hitch_count;
+}
+
+TimingSummary FrameStatistics::GetFrameSummary() const
+{
+    const auto samples = m_frame_times.CopySamples();
+    return SummarizeTimings(samples);
+}
+
+TimingSummary FrameStatistics::GetPhaseSummary(size_t phase_index) const
+{
+    const auto samples = m_phase_times.at(phase_index).CopySamples();
+    return SummarizeTimings(samples);
+}
+
+std::span<const uint32_t> FrameStatistics::GetHistogram() const
+{
+    return m_histogram;
+}
+
+double FrameStatistics::GetHistogramBucketMs() const
+{
+    return m_desc.histogram_bucket_ms;
+}
+
+void FrameStatistics::Reset()
+{
+    m_frame_times.Clear();
+    for (auto& phase_times : m_phase_times) {
+        phase_times.Clear();
+    }
+    std::fill(m_current_phase_times.begin(), m_current_phase_times.end(), 0.0);
+    std::fill(m_histogram.begin(), m_histogram.end(), 0);
+    m_frame_count = 0;
+    m_hitch_count = 0;
+    m_last_frame_time.reset();
+}
+
+size_t FrameStatistics::GetHistogramBucket(double time_ms) const
+{
+    const auto bucket = static_cast<size_t>(std::max(0.0, time_ms) / m_desc.histogram_bucket_ms);
+    return std::min(bucket, m_histogram.size() - 1);
+}
+
+FramePhaseTimer::FramePhaseTimer(FrameStatistics& statistics, size_t phase_index)
+    : m_statistics(statistics)
+    , m_phase_index(phase_index)
+    , m_begin(std::chrono::steady_clock::now())
+{
+}
+
+FramePhaseTimer::~FramePhaseTimer()
+{
+    const auto end = std::chrono::steady_clock::now();
+    m_statistics.AddPhaseTime(m_phase_index, std::chrono::duration<double, std::milli>(end - m_begin).count());
+}
+
+}  // namespace ddn
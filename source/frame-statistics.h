@@ -0,0 +1,109 @@
+#pragma once
+
+#include <span>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+
+namespace ddn
+{
+
+struct TimingSummary
+{
+    size_t sample_count = 0;
+    double mean_ms = 0.0;
+    double min_ms = 0.0;
+    double p50_ms = 0.0;
+    double p95_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+TimingSummary SummarizeTimings(std::span<const double> samples_ms);
+
+struct FrameStatisticsDesc
+{
+    size_t window_size = 1024;
+    double histogram_bucket_ms = 1.0;
+    size_t histogram_bucket_count = 64;
+    double hitch_ratio = 2.0;
+    double hitch_min_ms = 8.0;
+};
+
+class FrameStatistics
+{
+public:
+    FrameStatistics(std::vector<std::string> phase_names, const FrameStatisticsDesc& desc = {});
+
+    size_t GetPhaseCount() const;
+    const std::string& GetPhaseName(size_t phase_index) const;
+
+    void AddPhaseTime(size_t phase_index, double time_ms);
+    void AddFrame(double frame_time_ms);
+    void EndFrame();
+
+    uint64_t GetFrameCount() const;
+    uint64_t GetHitchCount() const;
+
+    TimingSummary GetFrameSummary() const;
+    TimingSummary GetPhaseSummary(size_t phase_index) const;
+
+    std::span<const uint32_t> GetHistogram() const;
+    double GetHistogramBucketMs() const;
+
+    void Reset();
+
+private:
+    class RollingWindow
+    {
+    public:
+        explicit RollingWindow(size_t capacity);
+
+        std::optional<double> Push(double value);
+        void Clear();
+
+        double GetMean() const;
+        std::vector<double> CopySamples() const;
+
+    private:
+        std::vector<double> m_samples;
+        size_t m_next = 0;
+        size_t m_count = 0;
+        double m_sum = 0.0;
+    };
+
+    size_t GetHistogramBucket(double time_ms) const;
+
+private:
+    FrameStatisticsDesc m_desc;
+    std::vector<std::string> m_phase_names;
+
+    RollingWindow m_frame_times;
+    std::vector<RollingWindow> m_phase_times;
+    std::vector<double> m_current_phase_times;
+    std::vector<uint32_t> m_histogram;
+
+    uint64_t m_frame_count = 0;
+    uint64_t m_hitch_count = 0;
+
+    std::optional<std::chrono::steady_clock::time_point> m_last_frame_time;
+};
+
+class FramePhaseTimer
+{
+public:
+    FramePhaseTimer(FrameStatistics& statistics, size_t phase_index);
+    ~FramePhaseTimer();
+
+    FramePhaseTimer(const FramePhaseTimer& other) = delete;
+    FramePhaseTimer& operator =(const FramePhaseTimer& other) = delete;
+
+private:
+    FrameStatistics& m_statistics;
+    size_t m_phase_index;
+    std::chrono::steady_clock::time_point m_begin;
+};
+
+}  // namespace ddn
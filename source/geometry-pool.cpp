@@ -0,0 +1,246 @@
+#include "geometry-pool.h"
+
+#include "utils.h"
+
+#include <cstring>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace Microsoft::WRL;
+
+namespace
+{
+
+void TransitionCopiedPage(ID3D12GraphicsCommandList& command_list, ID3D12Resource* vertex_buffer, ID3D12Resource* index_buffer)
+{
+    const CD3DX12_RESOURCE_BARRIER barriers[] = {
+        CD3DX12_RESOURCE_BARRIER::Transition(vertex_buffer, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER),
+        CD3DX12_RESOURCE_BARRIER::Transition(index_buffer, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_INDEX_BUFFER),
+    };
+    command_list.ResourceBarrier(static_cast<UINT>(std::size(barriers)), barriers);
+}
+
+DXGI_FORMAT GetIndexFormat(uint32_t index_size)
+{
+    switch (index_size) {
+    case sizeof(uint16_t):
+        return DXGI_FORMAT_R16_UINT;
+    case sizeof(uint32_t):
+        return DXGI_FORMAT_R32_UINT;
+    default:
+        throw std::invalid_argument("Unsupported index size");
+    }
+}
+
+}
+
+namespace ddn
+{
+
+GeometryPool::GeometryPool(ID3D12Device& device, DeferredReleaseQueue& release_queue, const GeometryPoolDesc& desc)
+    : m_device(&device)
+    , m_release_queue(release_queue)
+    , m_desc(desc)
+{
+}
+
+GeometryPool::MeshId GeometryPool::Add(ID3D12GraphicsCommandList& command_list, const IMesh& mesh, uint64_t fence_value)
+{
+    const auto vertex_stride = static_cast<uint32_t>(mesh.GetVertexSize());
+    const auto index_size = static_cast<uint32_t>(mesh.GetIndexSize());
+    const auto vertex_count = mesh.GetVertexCount();
+    const auto index_count = mesh.GetIndexCount();
+    if (vertex_count == 0 || index_count == 0) {
+        throw std::invalid_argument("Expected non-empty mesh");
+    }
+    GetIndexFormat(index_size);
+
+    const auto page_index = FindPage(vertex_stride, index_size, vertex_count, index_count);
+    auto& page = *m_pages[page_index];
+    const auto vertex_offset = page.vertex_allocator.Allocate(vertex_count);
+    const auto index_offset = page.index_allocator.Allocate(index_count);
+
+    const auto vertices = mesh.GetVertices();
+    const auto indexes = mesh.GetIndexes();
+    auto upload_buffer = CreateBuffer(*m_device.Get(), vertices.size() + indexes.size(), D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
+
+    uint8_t* mapped_data = nullptr;
+    const D3D12_RANGE read_range = {};
+    ValidateResult(upload_buffer->Map(0, &read_range, reinterpret_cast<void**>(&mapped_data)));
+    std::memcpy(mapped_data, vertices.data(), vertices.size());
+    std::memcpy(mapped_data + vertices.size(), indexes.data(), indexes.size());
+    upload_buffer->Unmap(0, nullptr);
+
+    command_list.CopyBufferRegion(page.vertex_buffer.Get(), vertex_offset * vertex_stride, upload_buffer.Get(), 0, vertices.size());
+    command_list.CopyBufferRegion(page.index_buffer.Get(), index_offset * index_size, upload_buffer.Get(), vertices.size(), indexes.size());
+    TransitionCopiedPage(command_list, page.vertex_buffer.Get(), page.index_buffer.Get());
+    m_release_queue.Release(fence_value, std::move(upload_buffer));
+
+    MeshId mesh_id = 0;
+    if (m_free_mesh_ids.empty()) {
+        mesh_id = static_cast<MeshId>(m_meshes.size());
+        m_meshes.emplace_back();
+    } else {
+        mesh_id = m_free_mesh_ids.back();
+        m_free_mesh_ids.pop_back();
+    }
+
+    auto& record = m_meshes[mesh_id];
+    record.range.page_index = page_index;
+    record.range.index_count = static_cast<uint32_t>(index_count);
+    record.range.start_index = static_cast<uint32_t>(index_offset);
+    record.range.base_vertex = static_cast<int32_t>(vertex_offset);
+    record.vertex_count = static_cast<uint32_t>(vertex_count);
+    record.is_alive = true;
+
+    page.mesh_ids.push_back(mesh_id);
+    ++m_mesh_count;
+    return mesh_id;
+}
+
+void GeometryPool::Remove(ID3D12GraphicsCommandList& command_list, MeshId mesh_id, uint64_t fence_value)
+{
+    if (mesh_id >= m_meshes.size() || !m_meshes[mesh_id].is_alive) {
+        throw std::invalid_argument("Invalid mesh id");
+    }
+
+    auto& record = m_meshes[mesh_id];
+    auto& page = *m_pages[record.range.page_index];
+    page.vertex_allocator.Free(record.range.base_vertex, record.vertex_count);
+    page.index_allocator.Free(record.range.start_index, record.range.index_count);
+    page.mesh_ids.erase(std::find(page.mesh_ids.begin(), page.mesh_ids.end(), mesh_id));
+
+    const auto page_index = record.range.page_index;
+    record = {};
+    m_free_mesh_ids.push_back(mesh_id);
+    --m_mesh_count;
+
+    if (page.mesh_ids.empty()) {
+        RetirePageBuffers(page, fence_value);
+        m_pages[page_index].reset();
+        return;
+    }
+
+    if (page.vertex_allocator.GetFragmentation() > m_desc.defragment_threshold || page.index_allocator.GetFragmentation() > m_desc.defragment_threshold) {
+        Defragment(command_list, page, fence_value);
+    }
+}
+
+const GeometryRange& GeometryPool::GetRange(MeshId mesh_id) const
+{
+    return m_meshes.at(mesh_id).range;
+}
+
+const D3D12_VERTEX_BUFFER_VIEW& GeometryPool::GetVertexBufferView(uint32_t page_index) const
+{
+    return m_pages.at(page_index)->vertex_buffer_view;
+}
+
+const D3D12_INDEX_BUFFER_VIEW& GeometryPool::GetIndexBufferView(uint32_t page_index) const
+{
+    return m_pages.at(page_index)->index_buffer_view;
+}
+
+uint32_t GeometryPool::GetPageCount() const
+{
+    return static_cast<uint32_t>(std::count_if(m_pages.begin(), m_pages.end(), [](const auto& page) {
+        return page != nullptr;
+    }));
+}
+
+uint32_t GeometryPool::GetMeshCount() const
+{
+    return m_mesh_count;
+}
+
+uint32_t GeometryPool::FindPage(uint32_t vertex_stride, uint32_t index_size, uint64_t vertex_count, uint64_t index_count)
+{
+    for (uint32_t i = 0; i < m_pages.size(); ++i) {
+        const auto& page = m_pages[i];
+        if (!page || page->vertex_stride != vertex_stride || page->index_size != index_size) {
+            continue;
+        }
+
+        if (page->vertex_allocator.GetLargestFreeRange() >= vertex_count && page->index_allocator.GetLargestFreeRange() >= index_count) {
+            return i;
+        }
+    }
+
+    return CreatePage(vertex_stride, index_size, vertex_count, index_count);
+}
+
+uint32_t GeometryPool::CreatePage(uint32_t vertex_stride, uint32_t index_size, uint64_t vertex_count, uint64_t index_count)
+{
+    auto page = std::make_unique<Page>();
+    page->vertex_stride = vertex_stride;
+    page->index_size = index_size;
+    page->vertex_allocator = RangeAllocator(std::max<uint64_t>(vertex_count, m_desc.vertex_page_size / vertex_stride));
+    page->index_allocator = RangeAllocator(std::max<uint64_t>(index_count, m_desc.index_page_size / index_size));
+    CreatePageBuffers(*page);
+
+    auto it = std::find(m_pages.begin(), m_pages.end(), nullptr);
+    if (it != m_pages.end()) {
+        *it = std::move(page);
+        return static_cast<uint32_t>(it - m_pages.begin());
+    }
+
+    m_pages.push_back(std::move(page));
+    return static_cast<uint32_t>(m_pages.size() - 1);
+}
+
+void GeometryPool::CreatePageBuffers(Page& page)
+{
+    const auto vertex_buffer_size = page.vertex_allocator.GetSize() * page.vertex_stride;
+    const auto index_buffer_size = page.index_allocator.GetSize() * page.index_size;
+    page.vertex_buffer = CreateBuffer(*m_device.Get(), vertex_buffer_size, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON);
+    page.index_buffer = CreateBuffer(*m_device.Get(), index_buffer_size, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON);
+
+    page.vertex_buffer_view.BufferLocation = page.vertex_buffer->GetGPUVirtualAddress();
+    page.vertex_buffer_view.SizeInBytes = static_cast<UINT>(vertex_buffer_size);
+    page.vertex_buffer_view.StrideInBytes = page.vertex_stride;
+
+    page.index_buffer_view.BufferLocation = page.index_buffer->GetGPUVirtualAddress();
+    page.index_buffer_view.SizeInBytes = static_cast<UINT>(index_buffer_size);
+    page.index_buffer_view.Format = GetIndexFormat(page.index_size);
+}
+
+void GeometryPool::Defragment(ID3D12GraphicsCommandList& command_list, Page& page, uint64_t fence_value)
+{
+    auto source_vertex_buffer = page.vertex_buffer;
+    auto source_index_buffer = page.index_buffer;
+    RetirePageBuffers(page, fence_value);
+    CreatePageBuffers(page);
+
+    page.vertex_allocator.Reset();
+    page.index_allocator.Reset();
+
+    std::sort(page.mesh_ids.begin(), page.mesh_ids.end(), [this](MeshId lhs, MeshId rhs) {
+        return m_meshes[lhs].range.base_vertex < m_meshes[rhs].range.base_vertex;
+    });
+
+    for (const auto mesh_id : page.mesh_ids) {
+        auto& record = m_meshes[mesh_id];
+        const auto vertex_offset = page.vertex_allocator.Allocate(record.vertex_count);
+        const auto index_offset = page.index_allocator.Allocate(record.range.index_count);
+
+        command_list.CopyBufferRegion(page.vertex_buffer.Get(), vertex_offset * page.vertex_stride,
+            source_vertex_buffer.Get(), static_cast<uint64_t>(record.range.base_vertex) * page.vertex_stride,
+            static_cast<uint64_t>(record.vertex_count) * page.vertex_stride);
+        command_list.CopyBufferRegion(page.index_buffer.Get(), index_offset * page.index_size,
+            source_index_buffer.Get(), static_cast<uint64_t>(record.range.start_index) * page.index_size,
+            static_cast<uint64_t>(record.range.index_count) * page.index_size);
+
+        record.range.base_vertex = static_cast<int32_t>(vertex_offset);
+        record.range.start_index = static_cast<uint32_t>(index_offset);
+    }
+    TransitionCopiedPage(command_list, page.vertex_buffer.Get(), page.index_buffer.Get());
+}
+
+void GeometryPool::RetirePageBuffers(Page& page, uint64_t fence_value)
+{
+    m_release_queue.Release(fence_value, std::move(page.vertex_buffer));
+    m_release_queue.Release(fence_value, std::move(page.index_buffer));
+}
+
+}  // namespace ddn
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "mesh.h"
+#include "range-allocator.h"
+#include "deferred-release-queue.h"
+
+#include <wrl.h>
+#include <directx/d3dx12.h>
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+struct GeometryRange
+{
+    uint32_t page_index = 0;
+    uint32_t index_count = 0;
+    uint32_t start_index = 0;
+    int32_t base_vertex = 0;
+};
+
+struct GeometryPoolDesc
+{
+    uint64_t vertex_page_size = 32ull << 20;
+    uint64_t index_page_size = 16ull << 20;
+    float defragment_threshold = 0.25f;
+};
+
+// Add and Remove record their copies into the given command list and take a fence value that is signaled
+// once it has executed; upload buffers and page buffers they replace are kept alive until then through the
+// release queue. The copies rely on implicit promotion from COMMON, so the list must not have used the
+// affected page's buffers before the call. Afterwards they are in their vertex and index buffer states, and
+// the list may draw from them. Remove can move the other meshes of the page, so draws read GetRange anew.
+class GeometryPool
+{
+public:
+    using MeshId = uint32_t;
+
+    GeometryPool(ID3D12Device& device, DeferredReleaseQueue& release_queue, const GeometryPoolDesc& desc = {});
+
+    GeometryPool(const GeometryPool& other) = delete;
+    GeometryPool& operator =(const GeometryPool& other) = delete;
+
+    MeshId Add(ID3D12GraphicsCommandList& command_list, const IMesh& mesh, uint64_t fence_value);
+    void Remove(ID3D12GraphicsCommandList& command_list, MeshId mesh_id, uint64_t fence_value);
+
+    const GeometryRange& GetRange(MeshId mesh_id) const;
+    const D3D12_VERTEX_BUFFER_VIEW& GetVertexBufferView(uint32_t page_index) const;
+    const D3D12_INDEX_BUFFER_VIEW& GetIndexBufferView(uint32_t page_index) const;
+
+    uint32_t GetPageCount() const;
+    uint32_t GetMeshCount() const;
+
+private:
+    struct Page
+    {
+        uint32_t vertex_stride = 0;
+        uint32_t index_size = 0;
+        Microsoft::WRL::ComPtr<ID3D12Resource> vertex_buffer;
+        Microsoft::WRL::ComPtr<ID3D12Resource> index_buffer;
+        D3D12_VERTEX_BUFFER_VIEW vertex_buffer_view = {};
+        D3D12_INDEX_BUFFER_VIEW index_buffer_view = {};
+        RangeAllocator vertex_allocator;
+        RangeAllocator index_allocator;
+        std::vector<MeshId> mesh_ids;
+    };
+
+    struct MeshRecord
+    {
+        GeometryRange range;
+        uint32_t vertex_count = 0;
+        bool is_alive = false;
+    };
+
+    uint32_t FindPage(uint32_t vertex_stride, uint32_t index_size, uint64_t vertex_count, uint64_t index_count);
+    uint32_t CreatePage(uint32_t vertex_stride, uint32_t index_size, uint64_t vertex_count, uint64_t index_count);
+    void CreatePageBuffers(Page& page);
+    void Defragment(ID3D12GraphicsCommandList& command_list, Page& page, uint64_t fence_value);
+    void RetirePageBuffers(Page& page, uint64_t fence_value);
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+    DeferredReleaseQueue& m_release_queue;
+    GeometryPoolDesc m_desc;
+    std::vector<std::unique_ptr<Page>> m_pages;
+    std::vector<MeshRecord> m_meshes;
+    std::vector<MeshId> m_free_mesh_ids;
+    uint32_t m_mesh_count = 0;
+};
+
+}  // namespace ddn
@@ -0,0 +1,140 @@
+#include "gpu-profiler.h"
+
+#include "utils.h"
+#include "command-queue.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr uint32_t s_invalid_scope_index = std::numeric_limits<uint32_t>::max();
+
+uint64_t ConvertTicks(uint64_t ticks, uint64_t frequency, uint64_t target_frequency)
+{
+    return (ticks / frequency) * target_frequency + (ticks % frequency) * target_frequency / frequency;
+}
+
+}
+
+namespace ddn
+{
+
+GpuProfiler::GpuProfiler(ID3D12Device& device, CommandQueue& command_queue, uint32_t frame_count, uint32_t max_scopes_per_frame)
+    : m_command_queue(command_queue)
+    , m_frames(frame_count)
+    , m_max_scopes_per_frame(max_scopes_per_frame)
+{
+    if (frame_count == 0 || max_scopes_per_frame == 0) {
+        throw std::invalid_argument("Expected non-zero frame count and scope count");
+    }
+
+    const uint32_t query_count = frame_count * max_scopes_per_frame * 2;
+
+    D3D12_QUERY_HEAP_DESC query_heap_desc = {};
+    query_heap_desc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    query_heap_desc.Count = query_count;
+    ValidateResult(device.CreateQueryHeap(&query_heap_desc, IID_PPV_ARGS(&m_query_heap)));
+
+    m_readback_buffer = CreateBuffer(device, sizeof(uint64_t) * query_count, D3D12_HEAP_TYPE_READBACK, D3D12_RESOURCE_STATE_COPY_DEST);
+
+    ValidateResult(m_command_queue->GetTimestampFrequency(&m_gpu_frequency));
+
+    LARGE_INTEGER cpu_frequency = {};
+    QueryPerformanceFrequency(&cpu_frequency);
+    m_cpu_frequency = static_cast<uint64_t>(cpu_frequency.QuadPart);
+}
+
+void GpuProfiler::BeginFrame(uint32_t frame_index)
+{
+    if (frame_index >= m_frames.size()) {
+        throw std::out_of_range("Frame index is out of range");
+    }
+
+    ValidateResult(m_command_queue->GetClockCalibration(&m_calibration_gpu_ticks, &m_calibration_cpu_ticks));
+
+    if (m_frames[frame_index].is_resolved) {
+        CollectFrame(frame_index);
+    }
+
+    m_frames[frame_index].scope_names.clear();
+    m_frames[frame_index].is_resolved = false;
+    m_frame_index = frame_index;
+}
+
+void GpuProfiler::EndFrame(ID3D12GraphicsCommandList& command_list)
+{
+    auto& frame = m_frames[m_frame_index];
+    if (frame.scope_names.empty()) {
+        return;
+    }
+
+    const auto first_query = GetQueryIndex(m_frame_index, 0);
+    const auto query_count = static_cast<UINT>(frame.scope_names.size() * 2);
+    command_list.ResolveQueryData(m_query_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, first_query, query_count, m_readback_buffer.Get(), sizeof(uint64_t) * first_query);
+    frame.is_resolved = true;
+}
+
+uint32_t GpuProfiler::BeginScope(ID3D12GraphicsCommandList& command_list, const char* name)
+{
+    auto& frame = m_frames[m_frame_index];
+    if (frame.scope_names.size() >= m_max_scopes_per_frame) {
+        return s_invalid_scope_index;
+    }
+
+    const auto scope_index = static_cast<uint32_t>(frame.scope_names.size());
+    frame.scope_names.push_back(name);
+    command_list.EndQuery(m_query_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, GetQueryIndex(m_frame_index, scope_index));
+    return scope_index;
+}
+
+void GpuProfiler::EndScope(ID3D12GraphicsCommandList& command_list, uint32_t scope_index)
+{
+    if (scope_index == s_invalid_scope_index) {
+        return;
+    }
+
+    command_list.EndQuery(m_query_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, GetQueryIndex(m_frame_index, scope_index) + 1);
+}
+
+void GpuProfiler::CollectFrame(uint32_t frame_index)
+{
+    const auto& frame = m_frames[frame_index];
+    const auto first_query = GetQueryIndex(frame_index, 0);
+    const auto query_count = frame.scope_names.size() * 2;
+
+    D3D12_RANGE read_range = { sizeof(uint64_t) * first_query, sizeof(uint64_t) * (first_query + query_count) };
+    void* data = nullptr;
+    ValidateResult(m_readback_buffer->Map(0, &read_range, &data));
+
+    const auto* timestamps = static_cast<const uint64_t*>(data) + first_query;
+    auto& profiler = Profiler::GetInstance();
+    for (size_t i = 0; i < frame.scope_names.size(); ++i) {
+        const auto begin_ns = GpuTicksToSteadyClockNs(timestamps[2 * i]);
+        const auto end_ns = GpuTicksToSteadyClockNs(timestamps[2 * i + 1]);
+        profiler.RecordTrackEvent("GPU", frame.scope_names[i], begin_ns, end_ns);
+    }
+
+    D3D12_RANGE written_range = { 0, 0 };
+    m_readback_buffer->Unmap(0, &written_range);
+}
+
+uint32_t GpuProfiler::GetQueryIndex(uint32_t frame_index, uint32_t scope_index) const
+{
+    return (frame_index * m_max_scopes_per_frame + scope_index) * 2;
+}
+
+uint64_t GpuProfiler::GpuTicksToSteadyClockNs(uint64_t gpu_ticks) const
+{
+    // MSVC implements steady_clock on top of QueryPerformanceCounter, so QPC ticks map directly to its nanoseconds.
+    const auto cpu_ns = ConvertTicks(m_calibration_cpu_ticks, m_cpu_frequency, 1'000'000'000);
+    if (gpu_ticks >= m_calibration_gpu_ticks) {
+        return cpu_ns + ConvertTicks(gpu_ticks - m_calibration_gpu_ticks, m_gpu_frequency, 1'000'000'000);
+    }
+
+    const auto delta_ns = ConvertTicks(m_calibration_gpu_ticks - gpu_ticks, m_gpu_frequency, 1'000'000'000);
+    return cpu_ns > delta_ns ? cpu_ns - delta_ns : 0;
+}
+
+}  // namespace ddn
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "profiler.h"
+
+#include <wrl.h>
+#include <directx/d3dx12.h>
+
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+class CommandQueue;
+
+class GpuProfiler
+{
+public:
+    GpuProfiler(ID3D12Device& device, CommandQueue& command_queue, uint32_t frame_count, uint32_t max_scopes_per_frame = 256);
+
+    GpuProfiler(const GpuProfiler& other) = delete;
+    GpuProfiler& operator =(const GpuProfiler& other) = delete;
+
+    void BeginFrame(uint32_t frame_index);
+    void EndFrame(ID3D12GraphicsCommandList& command_list);
+
+    uint32_t BeginScope(ID3D12GraphicsCommandList& command_list, const char* name);
+    void EndScope(ID3D12GraphicsCommandList& command_list, uint32_t scope_index);
+
+private:
+    void CollectFrame(uint32_t frame_index);
+    uint32_t GetQueryIndex(uint32_t frame_index, uint32_t scope_index) const;
+    uint64_t GpuTicksToSteadyClockNs(uint64_t gpu_ticks) const;
+
+private:
+    struct Frame
+    {
+        std::vector<const char*> scope_names;
+        bool is_resolved = false;
+    };
+
+    CommandQueue& m_command_queue;
+    Microsoft::WRL::ComPtr<ID3D12QueryHeap> m_query_heap;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_readback_buffer;
+    std::vector<Frame> m_frames;
+    uint32_t m_max_scopes_per_frame = 0;
+    uint32_t m_frame_index = 0;
+
+    uint64_t m_gpu_frequency = 0;
+    uint64_t m_cpu_frequency = 0;
+    uint64_t m_calibration_gpu_ticks = 0;
+    uint64_t m_calibration_cpu_ticks = 0;
+};
+
+class GpuProfileScope
+{
+public:
+    GpuProfileScope(GpuProfiler& profiler, ID3D12GraphicsCommandList& command_list, const char* name)
+        : m_profiler(profiler)
+        , m_command_list(command_list)
+        , m_scope_index(profiler.BeginScope(command_list, name))
+    {}
+
+    ~GpuProfileScope()
+    {
+        m_profiler.EndScope(m_command_list, m_scope_index);
+    }
+
+    GpuProfileScope(const GpuProfileScope& other) = delete;
+    GpuProfileScope& operator =(const GpuProfileScope& other) = delete;
+
+private:
+    GpuProfiler& m_profiler;
+    ID3D12GraphicsCommandList& m_command_list;
+    uint32_t m_scope_index;
+};
+
+}  // namespace ddn
+
+#ifdef DDN_PROFILING_ENABLED
+#define DDN_GPU_PROFILE_SCOPE(profiler, command_list, name) \
+    ::ddn::GpuProfileScope DDN_PROFILE_CONCAT(ddn_gpu_profile_scope_, __LINE__)(profiler, command_list, name)
+#else
+#define DDN_GPU_PROFILE_SCOPE(profiler, command_list, name) ((void)0)
+#endif
@@ -0,0 +1,42 @@
+#include "indirect-draw.h"
+#include "thread-pool.h"
+
+namespace
+{
+
+constexpr size_t s_grain_size = 2048;
+
+}
+
+namespace ddn
+{
+
+void IndirectDrawBuilder::Build(std::span<const DrawItem> items, std::span<const uint32_t> visible_items, const glm::mat4& projection_view_matrix)
+{
+    if (m_commands.size() < visible_items.size()) {
+        m_commands.resize(visible_items.size());
+    }
+    m_command_count = visible_items.size();
+
+    IndirectDrawCommand* commands = m_commands.data();
+    ParallelFor(0, visible_items.size(), s_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto& item = items[visible_items[i]];
+
+            auto& command = commands[i];
+            command.mvp_matrix = projection_view_matrix * item.model_matrix;
+            command.arguments.index_count_per_instance = item.index_count;
+            command.arguments.instance_count = 1;
+            command.arguments.start_index_location = item.start_index;
+            command.arguments.base_vertex_location = item.base_vertex;
+            command.arguments.start_instance_location = 0;
+        }
+    });
+}
+
+std::span<const IndirectDrawCommand> IndirectDrawBuilder::GetCommands() const
+{
+    return std::span(m_commands.data(), m_command_count);
+}
+
+}  // namespace ddn
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+struct DrawIndexedArguments
+{
+    uint32_t index_count_per_instance = 0;
+    uint32_t instance_count = 0;
+    uint32_t start_index_location = 0;
+    int32_t base_vertex_location = 0;
+    uint32_t start_instance_location = 0;
+};
+
+struct IndirectDrawCommand
+{
+    glm::mat4 mvp_matrix;
+    DrawIndexedArguments arguments;
+};
+
+struct DrawItem
+{
+    glm::mat4 model_matrix;
+    uint32_t index_count = 0;
+    uint32_t start_index = 0;
+    int32_t base_vertex = 0;
+};
+
+class IndirectDrawBuilder
+{
+public:
+    void Build(std::span<const DrawItem> items, std::span<const uint32_t> visible_items, const glm::mat4& projection_view_matrix);
+
+    std::span<const IndirectDrawCommand> GetCommands() const;
+
+private:
+    std::vector<IndirectDrawCommand> m_commands;
+    size_t m_command_count = 0;
+};
+
+}  // namespace ddn
@@ -0,0 +1,86 @@
+#include "indirect-renderer.h"
+
+#include "utils.h"
+
+#include <array>
+#include <cstring>
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+static_assert(sizeof(ddn::DrawIndexedArguments) == sizeof(D3D12_DRAW_INDEXED_ARGUMENTS));
+static_assert(offsetof(ddn::IndirectDrawCommand, arguments) == sizeof(glm::mat4));
+static_assert(sizeof(ddn::IndirectDrawCommand) % sizeof(uint32_t) == 0);
+
+using namespace Microsoft::WRL;
+
+namespace ddn
+{
+
+IndirectRenderer::IndirectRenderer(ID3D12Device& device, ID3D12RootSignature& root_signature, uint32_t root_parameter_index, uint32_t frame_count, uint32_t max_draw_count)
+    : m_device(&device)
+    , m_frames(frame_count)
+{
+    if (frame_count == 0) {
+        throw std::invalid_argument("Expected non-zero frame count");
+    }
+
+    std::array<D3D12_INDIRECT_ARGUMENT_DESC, 2> argument_descs = {};
+    argument_descs[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+    argument_descs[0].Constant.RootParameterIndex = root_parameter_index;
+    argument_descs[0].Constant.DestOffsetIn32BitValues = 0;
+    argument_descs[0].Constant.Num32BitValuesToSet = sizeof(glm::mat4) / sizeof(float);
+    argument_descs[1].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+    D3D12_COMMAND_SIGNATURE_DESC desc = {};
+    desc.ByteStride = sizeof(IndirectDrawCommand);
+    desc.NumArgumentDescs = static_cast<UINT>(argument_descs.size());
+    desc.pArgumentDescs = argument_descs.data();
+    ValidateResult(device.CreateCommandSignature(&desc, &root_signature, IID_PPV_ARGS(&m_command_signature)));
+
+    for (auto& frame : m_frames) {
+        ResizeArgumentBuffer(frame, max_draw_count);
+    }
+}
+
+void IndirectRenderer::Upload(uint32_t frame_index, std::span<const IndirectDrawCommand> commands)
+{
+    auto& frame = m_frames.at(frame_index);
+    const auto draw_count = static_cast<uint32_t>(commands.size());
+    if (draw_count > frame.max_draw_count) {
+        ResizeArgumentBuffer(frame, std::max(draw_count, frame.max_draw_count * 2));
+    }
+
+    std::memcpy(frame.mapped_data, commands.data(), commands.size_bytes());
+    frame.draw_count = draw_count;
+}
+
+void IndirectRenderer::Draw(ID3D12GraphicsCommandList& command_list, uint32_t frame_index, uint32_t first_command, uint32_t command_count)
+{
+    const auto& frame = m_frames.at(frame_index);
+    if (first_command + command_count > frame.draw_count) {
+        throw std::out_of_range("Indirect draw range exceeds uploaded commands");
+    }
+
+    if (command_count == 0) {
+        return;
+    }
+
+    const auto argument_offset = sizeof(IndirectDrawCommand) * static_cast<uint64_t>(first_command);
+    command_list.ExecuteIndirect(m_command_signature.Get(), command_count, frame.argument_buffer.Get(), argument_offset, nullptr, 0);
+}
+
+void IndirectRenderer::ResizeArgumentBuffer(Frame& frame, uint32_t max_draw_count)
+{
+    max_draw_count = std::max<uint32_t>(1, max_draw_count);
+    const auto size = sizeof(IndirectDrawCommand) * static_cast<uint64_t>(max_draw_count);
+    frame.argument_buffer = CreateBuffer(*m_device.Get(), size, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
+
+    D3D12_RANGE read_range = { 0, 0 };
+    void* mapped_data = nullptr;
+    ValidateResult(frame.argument_buffer->Map(0, &read_range, &mapped_data));
+    frame.mapped_data = static_cast<uint8_t*>(mapped_data);
+    frame.max_draw_count = max_draw_count;
+}
+
+}  // namespace ddn
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "indirect-draw.h"
+
+#include <wrl.h>
+#include <directx/d3dx12.h>
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+class IndirectRenderer
+{
+public:
+    IndirectRenderer(ID3D12Device& device, ID3D12RootSignature& root_signature, uint32_t root_parameter_index, uint32_t frame_count, uint32_t max_draw_count);
+
+    IndirectRenderer(const IndirectRenderer& other) = delete;
+    IndirectRenderer& operator =(const IndirectRenderer& other) = delete;
+
+    void Upload(uint32_t frame_index, std::span<const IndirectDrawCommand> commands);
+    void Draw(ID3D12GraphicsCommandList& command_list, uint32_t frame_index, uint32_t first_command, uint32_t command_count);
+
+private:
+    struct Frame
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> argument_buffer;
+        uint8_t* mapped_data = nullptr;
+        uint32_t max_draw_count = 0;
+        uint32_t draw_count = 0;
+    };
+
+    void ResizeArgumentBuffer(Frame& frame, uint32_t max_draw_count);
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+    Microsoft::WRL::ComPtr<ID3D12CommandSignature> m_command_signature;
+    std::vector<Frame> m_frames;
+};
+
+}  // namespace ddn
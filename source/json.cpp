@@ -0,0 +1,385 @@
+#include "json.h"
+
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+
+class JsonParser
+{
+public:
+    explicit JsonParser(std::string_view text)
+        : m_text(text)
+    {}
+
+    ddn::JsonValue Parse()
+    {
+        auto value = ParseValue();
+        SkipWhitespace();
+        if (m_position != m_text.size()) {
+            throw std::runtime_error("Unexpected trailing characters in JSON");
+        }
+        return value;
+    }
+
+private:
+    ddn::JsonValue ParseValue()
+    {
+        SkipWhitespace();
+        switch (Peek()) {
+        case '{':
+            return ParseObject();
+        case '[':
+            return ParseArray();
+        case '"':
+            return ParseString();
+        case 't':
+            Expect("true");
+            return true;
+        case 'f':
+            Expect("false");
+            return false;
+        case 'n':
+            Expect("null");
+            return nullptr;
+        default:
+            return ParseNumber();
+        }
+    }
+
+    ddn::JsonValue ParseObject()
+    {
+        ddn::JsonValue::Object object;
+        Expect("{");
+        SkipWhitespace();
+        if (Peek() == '}') {
+            ++m_position;
+            return object;
+        }
+
+        while (true) {
+            SkipWhitespace();
+            auto key = ParseString();
+            SkipWhitespace();
+            Expect(":");
+            object[std::move(key)] = ParseValue();
+            SkipWhitespace();
+            if (Peek() == ',') {
+                ++m_position;
+                continue;
+            }
+            Expect("}");
+            return object;
+        }
+    }
+
+    ddn::JsonValue ParseArray()
+    {
+        ddn::JsonValue::Array array;
+        Expect("[");
+        SkipWhitespace();
+        if (Peek() == ']') {
+            ++m_position;
+            return array;
+        }
+
+        while (true) {
+            array.push_back(ParseValue());
+            SkipWhitespace();
+            if (Peek() == ',') {
+                ++m_position;
+                continue;
+            }
+            Expect("]");
+            return array;
+        }
+    }
+
+    std::string ParseString()
+    {
+        Expect("\"");
+        std::string result;
+        while (true) {
+            const char symbol = Next();
+            if (symbol == '"') {
+                return result;
+            }
+            if (symbol != '\\') {
+                result.push_back(symbol);
+                continue;
+            }
+
+            const char escaped = Next();
+            switch (escaped) {
+            case 'n':
+                result.push_back('\n');
+                break;
+            case 't':
+                result.push_back('\t');
+                break;
+            case 'r':
+                result.push_back('\r');
+                break;
+            case 'b':
+                result.push_back('\b');
+                break;
+            case 'f':
+                result.push_back('\f');
+                break;
+            case 'u':
+            {
+                const auto code = std::strtoul(std::string(m_text.substr(m_position, 4)).c_str(), nullptr, 16);
+                m_position += 4;
+                result.push_back(code < 0x80 ? static_cast<char>(code) : '?');
+                break;
+            }
+            default:
+                result.push_back(escaped);
+                break;
+            }
+        }
+    }
+
+    ddn::JsonValue ParseNumber()
+    {
+        const auto begin = m_position;
+        while (m_position < m_text.size() && (std::isdigit(static_cast<unsigned char>(m_text[m_position])) || std::strchr("+-.eE", m_text[m_position]))) {
+            ++m_position;
+        }
+        if (begin == m_position) {
+            throw std::runtime_error("Unexpected character in JSON");
+        }
+        return std::strtod(std::string(m_text.substr(begin, m_position - begin)).c_str(), nullptr);
+    }
+
+    void SkipWhitespace()
+    {
+        while (m_position < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_position]))) {
+            ++m_position;
+        }
+    }
+
+    void Expect(std::string_view token)
+    {
+        if (m_text.substr(m_position, token.size()) != token) {
+            throw std::runtime_error("Unexpected token in JSON");
+        }
+        m_position += token.size();
+    }
+
+    char Peek() const
+    {
+        if (m_position >= m_text.size()) {
+            throw std::runtime_error("Unexpected end of JSON");
+        }
+        return m_text[m_position];
+    }
+
+    char Next()
+    {
+        const char symbol = Peek();
+        ++m_position;
+        return symbol;
+    }
+
+private:
+    std::string_view m_text;
+    size_t m_position = 0;
+};
+
+void WriteString(std::ostream& stream, const std::string& value)
+{
+    stream << '"';
+    for (const char symbol : value) {
+        switch (symbol) {
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\\':
+            stream << "\\\\";
+            break;
+        case '\n':
+            stream << "\\n";
+            break;
+        case '\t':
+            stream << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(symbol) >= 0x20) {
+                stream << symbol;
+            }
+            break;
+        }
+    }
+    stream << '"';
+}
+
+void WriteIndent(std::ostream& stream, int indent)
+{
+    stream << '\n';
+    for (int i = 0; i < indent; ++i) {
+        stream << "  ";
+    }
+}
+
+}
+
+namespace ddn
+{
+
+JsonValue::JsonValue(std::nullptr_t)
+    : m_value(nullptr)
+{}
+
+JsonValue::JsonValue(bool value)
+    : m_value(value)
+{}
+
+JsonValue::JsonValue(const char* value)
+    : m_value(std::string(value))
+{}
+
+JsonValue::JsonValue(std::string value)
+    : m_value(std::move(value))
+{}
+
+JsonValue::JsonValue(Array value)
+    : m_value(std::move(value))
+{}
+
+JsonValue::JsonValue(Object value)
+    : m_value(std::move(value))
+{}
+
+bool JsonValue::IsNull() const
+{
+    return std::holds_alternative<std::nullptr_t>(m_value);
+}
+
+bool JsonValue::IsBool() const
+{
+    return std::holds_alternative<bool>(m_value);
+}
+
+bool JsonValue::IsNumber() const
+{
+    return std::holds_alternative<double>(m_value);
+}
+
+bool JsonValue::IsString() const
+{
+    return std::holds_alternative<std::string>(m_value);
+}
+
+bool JsonValue::IsArray() const
+{
+    return std::holds_alternative<Array>(m_value);
+}
+
+bool JsonValue::IsObject() const
+{
+    return std::holds_alternative<Object>(m_value);
+}
+
+bool JsonValue::GetBool() const
+{
+    return std::get<bool>(m_value);
+}
+
+double JsonValue::GetNumber() const
+{
+    return std::get<double>(m_value);
+}
+
+const std::string& JsonValue::GetString() const
+{
+    return std::get<std::string>(m_value);
+}
+
+const JsonValue::Array& JsonValue::GetArray() const
+{
+    return std::get<Array>(m_value);
+}
+
+JsonValue::Array& JsonValue::GetArray()
+{
+    return std::get<Array>(m_value);
+}
+
+const JsonValue::Object& JsonValue::GetObject() const
+{
+    return std::get<Object>(m_value);
+}
+
+JsonValue::Object& JsonValue::GetObject()
+{
+    return std::get<Object>(m_value);
+}
+
+const JsonValue* JsonValue::Find(const std::string& key) const
+{
+    if (!IsObject()) {
+        return nullptr;
+    }
+
+    const auto& object = GetObject();
+    auto it = object.find(key);
+    return it != object.end() ? &it->second : nullptr;
+}
+
+JsonValue ParseJson(std::string_view text)
+{
+    return JsonParser(text).Parse();
+}
+
+void WriteJson(std::ostream& stream, const JsonValue& value, int indent)
+{
+    if (value.IsNull()) {
+        stream << "null";
+    } else if (value.IsBool()) {
+        stream << (value.GetBool() ? "true" : "false");
+    } else if (value.IsNumber()) {
+        const double number = value.GetNumber();
+        if (std::isfinite(number)) {
+            stream << number;
+        } else {
+            stream << "null";
+        }
+    } else if (value.IsString()) {
+        WriteString(stream, value.GetString());
+    } else if (value.IsArray()) {
+        const auto& array = value.GetArray();
+        stream << '[';
+        for (size_t i = 0; i < array.size(); ++i) {
+            stream << (i == 0 ? "" : ",");
+            WriteIndent(stream, indent + 1);
+            WriteJson(stream, array[i], indent + 1);
+        }
+        if (!array.empty()) {
+            WriteIndent(stream, indent);
+        }
+        stream << ']';
+    } else {
+        const auto& object = value.GetObject();
+        stream << '{';
+        bool is_first = true;
+        for (const auto& [key, element] : object) {
+            stream << (is_first ? "" : ",");
+            is_first = false;
+            WriteIndent(stream, indent + 1);
+            WriteString(stream, key);
+            stream << ": ";
+            WriteJson(stream, element, indent + 1);
+        }
+        if (!object.empty()) {
+            WriteIndent(stream, indent);
+        }
+        stream << '}';
+    }
+}
+
+}  // namespace ddn
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <variant>
+#include <ostream>
+#include <type_traits>
+#include <string_view>
+
+namespace ddn
+{
+
+class JsonValue
+{
+public:
+    using Array = std::vector<JsonValue>;
+    using Object = std::map<std::string, JsonValue>;
+
+    JsonValue() = default;
+    JsonValue(std::nullptr_t);
+    JsonValue(bool value);
+
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>>>
+    JsonValue(T value)
+        : m_value(static_cast<double>(value))
+    {}
+
+    JsonValue(const char* value);
+    JsonValue(std::string value);
+    JsonValue(Array value);
+    JsonValue(Object value);
+
+    bool IsNull() const;
+    bool IsBool() const;
+    bool IsNumber() const;
+    bool IsString() const;
+    bool IsArray() const;
+    bool IsObject() const;
+
+    bool GetBool() const;
+    double GetNumber() const;
+    const std::string& GetString() const;
+    const Array& GetArray() const;
+    Array& GetArray();
+    const Object& GetObject() const;
+    Object& GetObject();
+
+    const JsonValue* Find(const std::string& key) const;
+
+private:
+    std::variant<std::nullptr_t, bool, double, std::string, Array, Object> m_value;
+};
+
+JsonValue ParseJson(std::string_view text);
+
+void WriteJson(std::ostream& stream, const JsonValue& value, int indent = 0);
+
+}  // namespace ddn
@@ -0,0 +1,406 @@
+#include "light-culler.h"
+#include "simd.h"
+#include "camera.h"
+#include "profiler.h"
+#include "thread-pool.h"
+
+#include <glm/glm.hpp>
+
+#include <bit>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+using ddn::Float4;
+
+constexpr uint32_t s_lane_count = 4;
+constexpr size_t s_light_grain_size = 1024;
+
+// Slopes (x / z or y / z) of the two planes through the eye that touch the sphere, found from the quadratic
+// for lines at distance radius from the center. Leaves the range alone when the sphere reaches around the eye
+// plane, where any slope is possible.
+void GetSlopeRange(float center, float depth, float radius, float& min_slope, float& max_slope)
+{
+    const float denominator = depth * depth - radius * radius;
+    if (denominator <= 0.0f) {
+        return;
+    }
+
+    const float root = radius * std::sqrt(std::max(center * center + denominator, 0.0f));
+    min_slope = (center * depth - root) / denominator;
+    max_slope = (center * depth + root) / denominator;
+}
+
+// Inclusive range of tiles covered by pixel coordinates [min_pixel, max_pixel]; empty if min > max.
+void GetTileRange(float min_pixel, float max_pixel, uint32_t tile_size, uint32_t tile_count, uint32_t& min_tile, uint32_t& max_tile)
+{
+    const float last_tile = static_cast<float>(tile_count - 1);
+    min_tile = static_cast<uint32_t>(std::clamp(std::floor(min_pixel / tile_size), 0.0f, last_tile));
+    max_tile = static_cast<uint32_t>(std::clamp(std::floor(max_pixel / tile_size), 0.0f, last_tile));
+    if (max_pixel < 0.0f || min_pixel >= static_cast<float>(tile_count * tile_size)) {
+        min_tile = 1;
+        max_tile = 0;
+    }
+}
+
+}
+
+namespace ddn
+{
+
+LightCuller::LightCuller(const LightCullerDesc& desc)
+    : m_desc(desc)
+{
+    if (desc.tile_size == 0 || desc.depth_slice_count == 0) {
+        throw std::invalid_argument("Light cluster grid must not be empty");
+    }
+    if (desc.max_lights_per_cluster == 0) {
+        throw std::invalid_argument("Light clusters must hold at least one light");
+    }
+}
+
+void LightCuller::Cull(const Camera& camera, std::span<const PointLight> lights)
+{
+    DDN_PROFILE_FUNCTION();
+
+    m_statistics = {};
+    ScopedTimer timer(m_statistics.cull_ms);
+
+    UpdateGrid(camera);
+    BoundLights(camera, lights);
+    BinLights();
+
+    ParallelFor(0, m_constants.cluster_count_z, 1, [&](size_t begin, size_t end) {
+        for (size_t slice = begin; slice < end; ++slice) {
+            AssignSlice(static_cast<uint32_t>(slice));
+        }
+    });
+
+    // Slices filled their clusters with offsets into their own index lists; rebase them onto one array.
+    const auto slice_cluster_count = m_constants.cluster_count_x * m_constants.cluster_count_y;
+    std::vector<uint32_t> slice_offsets(m_constants.cluster_count_z + 1, 0);
+    for (uint32_t slice = 0; slice < m_constants.cluster_count_z; ++slice) {
+        const auto& result = m_slice_results[slice];
+        slice_offsets[slice + 1] = slice_offsets[slice] + static_cast<uint32_t>(result.indexes.size());
+        m_statistics.test_count += result.test_count;
+        m_statistics.dropped_index_count += result.dropped_count;
+        m_statistics.occupied_cluster_count += result.occupied_count;
+        m_statistics.max_cluster_light_count = std::max(m_statistics.max_cluster_light_count, result.max_count);
+    }
+
+    m_light_indexes.resize(slice_offsets.back());
+    ParallelFor(0, m_constants.cluster_count_z, 1, [&](size_t begin, size_t end) {
+        for (size_t slice = begin; slice < end; ++slice) {
+            const auto& indexes = m_slice_results[slice].indexes;
+            std::copy(indexes.begin(), indexes.end(), m_light_indexes.begin() + slice_offsets[slice]);
+            for (size_t cluster = slice * slice_cluster_count; cluster < (slice + 1) * slice_cluster_count; ++cluster) {
+                m_cluster_ranges[cluster].offset += slice_offsets[slice];
+            }
+        }
+    });
+
+    m_statistics.light_count = static_cast<uint32_t>(lights.size());
+    m_statistics.cluster_count = static_cast<uint32_t>(m_cluster_ranges.size());
+    m_statistics.index_count = m_light_indexes.size();
+}
+
+std::span<const LightClusterRange> LightCuller::GetClusterRanges() const
+{
+    return m_cluster_ranges;
+}
+
+std::span<const uint32_t> LightCuller::GetLightIndexes() const
+{
+    return m_light_indexes;
+}
+
+const LightClusterConstants& LightCuller::GetConstants() const
+{
+    return m_constants;
+}
+
+uint32_t LightCuller::GetClusterIndex(uint32_t x, uint32_t y, uint32_t z) const
+{
+    return (z * m_constants.cluster_count_y + y) * m_constants.cluster_count_x + x;
+}
+
+const LightCullStatistics& LightCuller::GetStatistics() const
+{
+    return m_statistics;
+}
+
+void LightCuller::UpdateGrid(const Camera& camera)
+{
+    if (camera.GetWidth() == m_width && camera.GetHeight() == m_height && camera.GetFovY() == m_fov_y &&
+        camera.GetNearZ() == m_near_z && camera.GetFarZ() == m_far_z) {
+        return;
+    }
+
+    DDN_PROFILE_FUNCTION();
+
+    m_width = camera.GetWidth();
+    m_height = camera.GetHeight();
+    m_fov_y = camera.GetFovY();
+    m_near_z = camera.GetNearZ();
+    m_far_z = camera.GetFarZ();
+    if (m_width == 0 || m_height == 0 || m_near_z <= 0.0f || m_far_z <= m_near_z) {
+        throw std::invalid_argument("Light clusters need a perspective camera with a non-empty viewport");
+    }
+
+    const auto tile_size = m_desc.tile_size;
+    const auto tile_count_x = (m_width + tile_size - 1) / tile_size;
+    const auto tile_count_y = (m_height + tile_size - 1) / tile_size;
+    const auto slice_count = m_desc.depth_slice_count;
+    const float log_depth_range = std::log(m_far_z / m_near_z);
+
+    m_constants.cluster_count_x = tile_count_x;
+    m_constants.cluster_count_y = tile_count_y;
+    m_constants.cluster_count_z = slice_count;
+    m_constants.tile_size = tile_size;
+    m_constants.depth_slice_scale = slice_count / log_depth_range;
+    m_constants.depth_slice_bias = -(slice_count * std::log(m_near_z)) / log_depth_range;
+
+    m_tan_half_y = std::tan(m_fov_y * 0.5f);
+    m_tan_half_x = m_tan_half_y * camera.GetAspect();
+    m_row_stride = (tile_count_x + s_lane_count - 1) / s_lane_count * s_lane_count;
+
+    m_tile_min_x.assign(size_t(slice_count) * m_row_stride, 0.0f);
+    m_tile_max_x.assign(size_t(slice_count) * m_row_stride, 0.0f);
+    m_tile_min_y.resize(size_t(slice_count) * tile_count_y);
+    m_tile_max_y.resize(size_t(slice_count) * tile_count_y);
+    m_slice_min_z.resize(slice_count);
+    m_slice_max_z.resize(slice_count);
+
+    // Slopes of the tile edges, with the last tile of each axis ending at the viewport edge.
+    const auto get_slope_x = [&](uint32_t pixel) {
+        return (2.0f * std::min(pixel, m_width) / m_width - 1.0f) * m_tan_half_x;
+    };
+    const auto get_slope_y = [&](uint32_t pixel) {
+        return (1.0f - 2.0f * std::min(pixel, m_height) / m_height) * m_tan_half_y;
+    };
+
+    for (uint32_t slice = 0; slice < slice_count; ++slice) {
+        const float near_z = m_near_z * std::exp(log_depth_range * slice / slice_count);
+        const float far_z = m_near_z * std::exp(log_depth_range * (slice + 1) / slice_count);
+        m_slice_min_z[slice] = near_z;
+        m_slice_max_z[slice] = far_z;
+
+        for (uint32_t x = 0; x < tile_count_x; ++x) {
+            const float min_slope = get_slope_x(x * tile_size);
+            const float max_slope = get_slope_x((x + 1) * tile_size);
+            m_tile_min_x[size_t(slice) * m_row_stride + x] = std::min(min_slope * near_z, min_slope * far_z);
+            m_tile_max_x[size_t(slice) * m_row_stride + x] = std::max(max_slope * near_z, max_slope * far_z);
+        }
+        for (uint32_t y = 0; y < tile_count_y; ++y) {
+            const float min_slope = get_slope_y((y + 1) * tile_size);
+            const float max_slope = get_slope_y(y * tile_size);
+            m_tile_min_y[size_t(slice) * tile_count_y + y] = std::min(min_slope * near_z, min_slope * far_z);
+            m_tile_max_y[size_t(slice) * tile_count_y + y] = std::max(max_slope * near_z, max_slope * far_z);
+        }
+    }
+
+    m_cluster_ranges.resize(size_t(tile_count_x) * tile_count_y * slice_count);
+    m_slice_results.resize(slice_count);
+}
+
+void LightCuller::BoundLights(const Camera& camera, std::span<const PointLight> lights)
+{
+    DDN_PROFILE_FUNCTION();
+
+    const auto& view_matrix = camera.GetViewMatrix();
+    m_light_bounds.resize(lights.size());
+
+    ParallelFor(0, (lights.size() + s_lane_count - 1) / s_lane_count, s_light_grain_size / s_lane_count, [&](size_t begin, size_t end) {
+        for (size_t packet = begin; packet < end; ++packet) {
+            const auto first = packet * s_lane_count;
+            const auto lane_count = std::min<size_t>(s_lane_count, lights.size() - first);
+
+            float position[3][s_lane_count];
+            for (size_t lane = 0; lane < s_lane_count; ++lane) {
+                const auto& light = lights[first + std::min(lane, lane_count - 1)];
+                position[0][lane] = light.position.x;
+                position[1][lane] = light.position.y;
+                position[2][lane] = light.position.z;
+            }
+
+            const auto x = Float4::Load(position[0]);
+            const auto y = Float4::Load(position[1]);
+            const auto z = Float4::Load(position[2]);
+            float center[3][s_lane_count];
+            for (int row = 0; row < 3; ++row) {
+                const auto value = x * Float4::Splat(view_matrix[0][row]) + y * Float4::Splat(view_matrix[1][row]) +
+                    z * Float4::Splat(view_matrix[2][row]) + Float4::Splat(view_matrix[3][row]);
+                value.Store(center[row]);
+            }
+
+            for (size_t lane = 0; lane < lane_count; ++lane) {
+                auto& bounds = m_light_bounds[first + lane];
+                bounds.center = glm::vec3(center[0][lane], center[1][lane], center[2][lane]);
+                bounds.radius = lights[first + lane].radius;
+
+                // Invisible unless every axis below finds a range.
+                bounds.min_x = bounds.min_y = bounds.min_z = 1;
+                bounds.max_x = bounds.max_y = bounds.max_z = 0;
+
+                const float min_z = std::max(bounds.center.z - bounds.radius, m_near_z);
+                const float max_z = std::min(bounds.center.z + bounds.radius, m_far_z);
+                if (!(bounds.radius > 0.0f) || min_z > max_z) {
+                    continue;
+                }
+
+                float min_slope_x = -m_tan_half_x;
+                float max_slope_x = m_tan_half_x;
+                float min_slope_y = -m_tan_half_y;
+                float max_slope_y = m_tan_half_y;
+                GetSlopeRange(bounds.center.x, bounds.center.z, bounds.radius, min_slope_x, max_slope_x);
+                GetSlopeRange(bounds.center.y, bounds.center.z, bounds.radius, min_slope_y, max_slope_y);
+
+                GetTileRange((min_slope_x / m_tan_half_x + 1.0f) * 0.5f * m_width, (max_slope_x / m_tan_half_x + 1.0f) * 0.5f * m_width,
+                    m_desc.tile_size, m_constants.cluster_count_x, bounds.min_x, bounds.max_x);
+                GetTileRange((1.0f - max_slope_y / m_tan_half_y) * 0.5f * m_height, (1.0f - min_slope_y / m_tan_half_y) * 0.5f * m_height,
+                    m_desc.tile_size, m_constants.cluster_count_y, bounds.min_y, bounds.max_y);
+                if (bounds.min_x > bounds.max_x || bounds.min_y > bounds.max_y) {
+                    bounds.min_z = 1;
+                    bounds.max_z = 0;
+                    continue;
+                }
+
+                const float last_slice = static_cast<float>(m_constants.cluster_count_z - 1);
+                const auto get_slice = [&](float depth) {
+                    return static_cast<uint32_t>(std::clamp(std::floor(std::log(depth) * m_constants.depth_slice_scale + m_constants.depth_slice_bias), 0.0f, last_slice));
+                };
+                bounds.min_z = get_slice(min_z);
+                bounds.max_z = get_slice(max_z);
+            }
+        }
+    });
+}
+
+void LightCuller::BinLights()
+{
+    DDN_PROFILE_FUNCTION();
+
+    const auto slice_count = m_constants.cluster_count_z;
+    m_slice_offsets.assign(slice_count + 1, 0);
+    for (const auto& bounds : m_light_bounds) {
+        for (auto slice = bounds.min_z; slice <= bounds.max_z; ++slice) {
+            ++m_slice_offsets[slice + 1];
+        }
+    }
+
+    uint32_t visible_light_count = 0;
+    for (const auto& bounds : m_light_bounds) {
+        visible_light_count += bounds.min_z <= bounds.max_z;
+    }
+    m_statistics.visible_light_count = visible_light_count;
+
+    for (uint32_t slice = 0; slice < slice_count; ++slice) {
+        m_slice_offsets[slice + 1] += m_slice_offsets[slice];
+    }
+
+    m_slice_lights.resize(m_slice_offsets.back());
+    auto fill_offsets = m_slice_offsets;
+    for (uint32_t light = 0; light < m_light_bounds.size(); ++light) {
+        const auto& bounds = m_light_bounds[light];
+        for (auto slice = bounds.min_z; slice <= bounds.max_z; ++slice) {
+            m_slice_lights[fill_offsets[slice]++] = light;
+        }
+    }
+}
+
+void LightCuller::AssignSlice(uint32_t slice)
+{
+    DDN_PROFILE_FUNCTION();
+
+    auto& result = m_slice_results[slice];
+    result.pairs.clear();
+    result.test_count = 0;
+    result.dropped_count = 0;
+    result.occupied_count = 0;
+    result.max_count = 0;
+
+    const auto tile_count_x = m_constants.cluster_count_x;
+    const auto tile_count_y = m_constants.cluster_count_y;
+    const float slice_min_z = m_slice_min_z[slice];
+    const float slice_max_z = m_slice_max_z[slice];
+    const auto* tile_min_x = &m_tile_min_x[size_t(slice) * m_row_stride];
+    const auto* tile_max_x = &m_tile_max_x[size_t(slice) * m_row_stride];
+    const auto* tile_min_y = &m_tile_min_y[size_t(slice) * tile_count_y];
+    const auto* tile_max_y = &m_tile_max_y[size_t(slice) * tile_count_y];
+    const auto zero = Float4::Splat(0.0f);
+    const auto lanes = Float4::Set(0.0f, 1.0f, 2.0f, 3.0f);
+
+    // Squared sphere-to-box distance, split into the z term per slice, the y term per tile row and the x terms
+    // of four tile columns at once.
+    for (auto i = m_slice_offsets[slice]; i < m_slice_offsets[slice + 1]; ++i) {
+        const auto light = m_slice_lights[i];
+        const auto& bounds = m_light_bounds[light];
+        const float distance_z = std::max({ slice_min_z - bounds.center.z, bounds.center.z - slice_max_z, 0.0f });
+        const float radius_squared = bounds.radius * bounds.radius - distance_z * distance_z;
+        if (radius_squared < 0.0f) {
+            continue;
+        }
+
+        const auto center_x = Float4::Splat(bounds.center.x);
+        const auto first_x = bounds.min_x / s_lane_count * s_lane_count;
+        const auto min_x = Float4::Splat(static_cast<float>(bounds.min_x));
+        const auto max_x = Float4::Splat(static_cast<float>(bounds.max_x));
+        for (auto y = bounds.min_y; y <= bounds.max_y; ++y) {
+            const float distance_y = std::max({ tile_min_y[y] - bounds.center.y, bounds.center.y - tile_max_y[y], 0.0f });
+            const float remaining = radius_squared - distance_y * distance_y;
+            if (remaining < 0.0f) {
+                continue;
+            }
+
+            const auto remaining_squared = Float4::Splat(remaining);
+            for (auto x = first_x; x <= bounds.max_x; x += s_lane_count) {
+                const auto distance_x = Max(Max(Float4::Load(tile_min_x + x) - center_x, center_x - Float4::Load(tile_max_x + x)), zero);
+                const auto column = Float4::Splat(static_cast<float>(x)) + lanes;
+                auto bits = GetBits((distance_x * distance_x <= remaining_squared) & (column >= min_x) & (column <= max_x));
+                result.test_count += s_lane_count;
+                while (bits != 0) {
+                    const auto lane = static_cast<uint32_t>(std::countr_zero(bits));
+                    result.pairs.push_back({ y * tile_count_x + x + lane, light });
+                    bits &= bits - 1;
+                }
+            }
+        }
+    }
+
+    // Counting sort of the pairs by cluster; lights were visited in ascending order, so each cluster's list is
+    // sorted too. Offsets are relative to this slice until Cull rebases them.
+    const auto slice_cluster_count = tile_count_x * tile_count_y;
+    auto* ranges = &m_cluster_ranges[size_t(slice) * slice_cluster_count];
+    for (uint32_t cluster = 0; cluster < slice_cluster_count; ++cluster) {
+        ranges[cluster] = {};
+    }
+    for (const auto& pair : result.pairs) {
+        ++ranges[pair.cluster].count;
+    }
+
+    uint32_t offset = 0;
+    for (uint32_t cluster = 0; cluster < slice_cluster_count; ++cluster) {
+        auto& range = ranges[cluster];
+        const auto count = std::min(range.count, m_desc.max_lights_per_cluster);
+        result.occupied_count += count != 0;
+        result.max_count = std::max(result.max_count, count);
+        range.offset = offset;
+        range.count = 0;
+        offset += count;
+    }
+
+    result.indexes.resize(offset);
+    for (const auto& pair : result.pairs) {
+        auto& range = ranges[pair.cluster];
+        if (range.count == m_desc.max_lights_per_cluster) {
+            ++result.dropped_count;
+            continue;
+        }
+        result.indexes[range.offset + range.count++] = pair.light;
+    }
+}
+
+}  // namespace ddn
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+class Camera;
+
+struct PointLight
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    float radius = 1.0f;
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 1.0f;
+};
+
+struct LightCullerDesc
+{
+    uint32_t tile_size = 64;
+    uint32_t depth_slice_count = 24;
+    uint32_t max_lights_per_cluster = 128;
+};
+
+// Indexes GetLightIndexes; one per cluster, laid out like the cluster grid.
+struct LightClusterRange
+{
+    uint32_t offset = 0;
+    uint32_t count = 0;
+};
+
+// What a shader needs to find its cluster: x and y from the pixel position divided by tile_size, and the depth
+// slice as floor(log(view_depth) * depth_slice_scale + depth_slice_bias).
+struct LightClusterConstants
+{
+    uint32_t cluster_count_x = 0;
+    uint32_t cluster_count_y = 0;
+    uint32_t cluster_count_z = 0;
+    uint32_t tile_size = 0;
+    float depth_slice_scale = 0.0f;
+    float depth_slice_bias = 0.0f;
+};
+
+struct LightCullStatistics
+{
+    double cull_ms = 0.0;
+    uint32_t light_count = 0;
+    uint32_t visible_light_count = 0;
+    uint32_t cluster_count = 0;
+    uint32_t occupied_cluster_count = 0;
+    uint32_t max_cluster_light_count = 0;
+    uint64_t test_count = 0;
+    uint64_t index_count = 0;
+    uint64_t dropped_index_count = 0;
+};
+
+// Assigns point lights to a froxel grid of screen tiles by exponential depth slices between the camera's near
+// and far planes. Each light is first bounded to a range of tiles and slices, then tested against the view
+// space bounds of the clusters in that range, four clusters at a time. Slices are filled in parallel and
+// each cluster lists its lights in ascending order, up to max_lights_per_cluster.
+class LightCuller
+{
+public:
+    explicit LightCuller(const LightCullerDesc& desc = {});
+
+    void Cull(const Camera& camera, std::span<const PointLight> lights);
+
+    std::span<const LightClusterRange> GetClusterRanges() const;
+    std::span<const uint32_t> GetLightIndexes() const;
+    const LightClusterConstants& GetConstants() const;
+    uint32_t GetClusterIndex(uint32_t x, uint32_t y, uint32_t z) const;
+
+    const LightCullStatistics& GetStatistics() const;
+
+private:
+    struct LightBounds
+    {
+        glm::vec3 center;
+        float radius;
+        uint32_t min_x;
+        uint32_t max_x;
+        uint32_t min_y;
+        uint32_t max_y;
+        uint32_t min_z;
+        uint32_t max_z;
+    };
+
+    struct ClusterLight
+    {
+        uint32_t cluster;
+        uint32_t light;
+    };
+
+    struct SliceResult
+    {
+        std::vector<ClusterLight> pairs;
+        std::vector<uint32_t> indexes;
+        uint64_t test_count = 0;
+        uint64_t dropped_count = 0;
+        uint32_t occupied_count = 0;
+        uint32_t max_count = 0;
+    };
+
+    void UpdateGrid(const Camera& camera);
+    void BoundLights(const Camera& camera, std::span<const PointLight> lights);
+    void BinLights();
+    void AssignSlice(uint32_t slice);
+
+private:
+    LightCullerDesc m_desc;
+    LightClusterConstants m_constants;
+    LightCullStatistics m_statistics;
+
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    float m_fov_y = 0.0f;
+    float m_near_z = 0.0f;
+    float m_far_z = 0.0f;
+    float m_tan_half_x = 0.0f;
+    float m_tan_half_y = 0.0f;
+    uint32_t m_row_stride = 0;
+
+    // View space bounds of the clusters, which separate into x extents per slice and tile column, padded to
+    // m_row_stride columns, y extents per slice and tile row, and z extents per slice.
+    std::vector<float> m_tile_min_x;
+    std::vector<float> m_tile_max_x;
+    std::vector<float> m_tile_min_y;
+    std::vector<float> m_tile_max_y;
+    std::vector<float> m_slice_min_z;
+    std::vector<float> m_slice_max_z;
+
+    std::vector<LightBounds> m_light_bounds;
+    std::vector<uint32_t> m_slice_offsets;
+    std::vector<uint32_t> m_slice_lights;
+    std::vector<SliceResult> m_slice_results;
+
+    std::vector<LightClusterRange> m_cluster_ranges;
+    std::vector<uint32_t> m_light_indexes;
+};
+
+}  // namespace ddn
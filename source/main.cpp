@@ -1,10 +1,24 @@
 #include "cube.h"
 #include "utils.h"
 #include "camera.h"
+#include "profiler.h"
+#include "benchmark.h"
+#include "async-io.h"
+#include "deferred-release-queue.h"
+#include "frame-arena.h"
+#include "frame-pacer.h"
+#include "allocation-counter.h"
+#include "memory-tracker.h"
 #include "application.h"
 
 #include "swap-chain.h"
 #include "command-queue.h"
+#include "command-list-pool.h"
+#include "gpu-profiler.h"
+#include "geometry-pool.h"
+#include "render-queue.h"
+#include "indirect-renderer.h"
+#include "render-state-cache.h"
 
 #include <directx/d3dx12.h>
 
@@ -14,7 +28,12 @@
 #include <array>
 #include <vector>
 #include <memory>
+#include <limits>
+#include <algorithm>
 #include <chrono>
+#include <iostream>
+#include <exception>
+#include <stdexcept>
 
 using namespace ddn;
 using namespace Microsoft::WRL;
@@ -22,15 +41,22 @@ using namespace Microsoft::WRL;
 class DandelionApp : public Application
 {
 public:
-    DandelionApp(const std::wstring& title, uint32_t width, uint32_t height)
+    DandelionApp(const std::wstring& title, uint32_t width, uint32_t height, const BenchmarkOptions& benchmark_options)
         : Application(title, width, height)
         , m_camera([width, height]() {
             auto camera = Camera(width, height, 45.0f, 0.1f, 100.0f);
             camera.SetPosition(glm::vec3(0.0f, 0.0f, -10.0));
             return camera;
         }())
+        , m_frame_arena({ benchmark_options.frames_in_flight })
+        , m_frame_pacer({ benchmark_options.frames_in_flight })
         , m_model_matrix(1.0f)
+        , m_benchmark_options(benchmark_options)
+        , m_frame_statistics({ "update", "render", "present", "wait" })
+        , m_memory_counters(std::string(s_memory_counters_name) + "-" + std::to_string(GetCurrentProcessId()))
     {
+        DDN_PROFILE_THREAD("Main");
+
         GetWindow().Subscribe(&m_camera);
 
         InitDevice();
@@ -40,10 +66,12 @@ public:
         InitDsvDescriptorHeap();
         InitRootSignature();
         InitGraphicsPipelineState();
-        InitVertexBuffer();
-        InitIndexBuffer();
+        InitIndirectRenderer();
+        InitGeometryPool();
+        InitGpuProfiler();
 
         m_last_time = std::chrono::steady_clock::now();;
+        m_last_allocation_counters = GetAllocationCounters();
     }
 
     void OnResize(uint32_t width, uint32_t height) override
@@ -56,6 +84,9 @@ public:
 
     void OnUpdate() override
     {
+        DDN_PROFILE_SCOPE("OnUpdate");
+        FramePhaseTimer phase_timer(m_frame_statistics, s_update_phase);
+
         auto time = std::chrono::steady_clock::now();
         auto delta_time_s = std::chrono::duration<float>(time - m_last_time);
         auto delta_angle = glm::radians(s_angular_rate_deg * delta_time_s.count());
@@ -65,6 +96,7 @@ public:
             auto position = m_camera.GetPosition();
             position.y += delta_y;
             m_camera.SetPosition(position);
+            m_camera.LookAt(glm::vec3(0.0f));
         };
 
         auto& keyboard = GetKeyboard();
@@ -80,12 +112,69 @@ public:
 
     void OnRender() override
     {
+        DDN_PROFILE_SCOPE("OnRender");
+
+        {
+            FramePhaseTimer phase_timer(m_frame_statistics, s_wait_phase);
+            m_swap_chain->WaitForFenceValue(m_frame_pacer.GetWaitFenceValue());
+        }
+
+        const auto completed_fence_value = m_swap_chain->GetCompletedFenceValue();
+        m_frame_pacer.BeginFrame(completed_fence_value);
+        m_release_queue.Collect(completed_fence_value);
+        m_frame_arena.BeginFrame(completed_fence_value);
+        RecordCommandList();
+
+        {
+            FramePhaseTimer phase_timer(m_frame_statistics, s_present_phase);
+            const auto fence_value = m_swap_chain->Present();
+            m_frame_pacer.EndFrame(fence_value, m_swap_chain->GetLastPresentCount());
+            if (const auto timing = m_swap_chain->GetLastPresentTiming()) {
+                m_frame_pacer.OnPresented(timing->present_count, timing->time);
+            }
+            m_frame_arena.EndFrame(fence_value);
+            m_command_list_pool->Release(std::move(m_command_list), fence_value);
+            m_command_list_pool->Trim();
+        }
+
+        m_frame_statistics.EndFrame();
+        UpdateAllocationStatistics();
+        UpdateMemoryTracking();
+        UpdateBenchmark();
+    }
+
+    void OnDestroy() override
+    {
+        m_command_queue->Flush();
+        m_release_queue.Collect(std::numeric_limits<uint64_t>::max());
+
+#ifdef DDN_PROFILING_ENABLED
+        Profiler::GetInstance().WriteChromeTrace(std::filesystem::current_path() / s_trace_file_name);
+#endif
+    }
+
+    int GetExitCode() const
+    {
+        return m_exit_code;
+    }
+
+private:
+    void RecordCommandList()
+    {
+        FramePhaseTimer phase_timer(m_frame_statistics, s_render_phase);
+
         const auto buffer_index = m_swap_chain->GetCurrentBackBufferIndex();
+        const auto frame_index = m_frame_pacer.GetFrameIndex();
         ComPtr<ID3D12Resource> back_buffer = m_swap_chain->GetCurrentBackBuffer();
 
-        ID3D12CommandAllocator* command_allocator = m_command_allocators[buffer_index].Get();
-        ValidateResult(command_allocator->Reset());
-        ValidateResult(m_command_list->Reset(command_allocator, m_pipeline_state.Get()));
+        m_command_list = m_command_list_pool->Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT, m_swap_chain->GetCompletedFenceValue(), m_pipeline_state.Get());
+
+        // Finished reads are delivered here so that their uploads are recorded into this frame's command list.
+        m_async_io.DispatchCompletions();
+
+#ifdef DDN_PROFILING_ENABLED
+        m_gpu_profiler->BeginFrame(frame_index);
+#endif
 
         const Window& window = GetWindow();
         const uint32_t width = window.GetWidth();
@@ -108,37 +197,127 @@ public:
         m_command_list->ClearDepthStencilView(dsv_handle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
 
         m_command_list->SetGraphicsRootSignature(m_root_signature.Get());
-
-        const auto camera_matrix = m_camera.GetProjectionViewMatrix();
-        const auto mvp_matrix = camera_matrix * m_model_matrix;
-        m_command_list->SetGraphicsRoot32BitConstants(0, sizeof(glm::mat4) / sizeof(float), &mvp_matrix, 0);
-
         m_command_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        m_command_list->IASetVertexBuffers(0, 1, &m_vertex_buffer_view);
-        m_command_list->IASetIndexBuffer(&m_index_buffer_view);
         m_command_list->OMSetRenderTargets(1, &rtv_handle, false, &dsv_handle);
 
-        auto index_count = static_cast<UINT>(m_cube.GetIndexCount());
-        m_command_list->DrawIndexedInstanced(index_count, 1, 0, 0, 0);
+        auto& frame_arena = m_frame_arena.GetThreadArena();
+        RenderQueue render_queue(&frame_arena);
+        std::pmr::vector<RenderBatch> render_batches(&frame_arena);
+
+        m_draw_items.front().model_matrix = m_model_matrix;
+        BuildRenderQueue(render_queue, render_batches);
+
+        {
+            DDN_GPU_PROFILE_SCOPE(*m_gpu_profiler, *m_command_list.Get(), "Draw");
+            SubmitRenderQueue(frame_index, render_queue, render_batches);
+        }
 
         auto barrier2 = CD3DX12_RESOURCE_BARRIER::Transition(back_buffer.Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
         m_command_list->ResourceBarrier(1, &barrier2);
 
+#ifdef DDN_PROFILING_ENABLED
+        m_gpu_profiler->EndFrame(*m_command_list.Get());
+#endif
+
         m_command_list->Close();
 
         m_command_queue->Clear();
-        m_command_queue->Add(m_command_list);
+        m_command_queue->Add(m_command_list.Get());
         m_command_queue->Execute();
+    }
 
-        m_swap_chain->Present();
+    void BuildRenderQueue(RenderQueue& render_queue, std::pmr::vector<RenderBatch>& render_batches)
+    {
+        const auto& view_matrix = m_camera.GetViewMatrix();
+        const float far_z = m_camera.GetFarZ();
+
+        render_queue.Reserve(m_visible_draw_items.size());
+        for (const auto item_index : m_visible_draw_items) {
+            // Removing a mesh can defragment its page and move the others, so the ranges are read every frame.
+            auto& item = m_draw_items[item_index];
+            const auto& range = m_geometry_pool->GetRange(m_draw_item_meshes[item_index]);
+            item.index_count = range.index_count;
+            item.start_index = range.start_index;
+            item.base_vertex = range.base_vertex;
+            const auto view_position = view_matrix * item.model_matrix[3];
+
+            RenderKey key;
+            key.geometry = range.page_index;
+            key.depth = view_position.z / far_z;
+            render_queue.Add(key, item_index);
+        }
+        render_queue.Sort();
+        render_queue.BuildBatches(render_batches);
+
+        const auto packets = render_queue.GetPackets();
+        std::pmr::vector<uint32_t> sorted_draw_items(packets.size(), render_batches.get_allocator());
+        std::transform(packets.begin(), packets.end(), sorted_draw_items.begin(), [](const RenderPacket& packet) {
+            return packet.item_index;
+        });
+        m_indirect_draw_builder.Build(m_draw_items, sorted_draw_items, m_camera.GetProjectionViewMatrix());
     }
 
-    void OnDestroy() override
+    void SubmitRenderQueue(uint32_t frame_index, const RenderQueue& render_queue, std::span<const RenderBatch> render_batches)
     {
-        m_command_queue->Flush();
+        m_indirect_renderer->Upload(frame_index, m_indirect_draw_builder.GetCommands());
+
+        RenderStateCache state_cache(*m_command_list.Get(), m_pipeline_state.Get());
+        const auto packets = render_queue.GetPackets();
+        for (const auto& batch : render_batches) {
+            const auto key = DecodeRenderKey(packets[batch.first_packet].sort_key);
+            state_cache.SetPipelineState(m_pipeline_state.Get());
+            state_cache.SetVertexBuffer(m_geometry_pool->GetVertexBufferView(key.geometry));
+            state_cache.SetIndexBuffer(m_geometry_pool->GetIndexBufferView(key.geometry));
+            m_indirect_renderer->Draw(*m_command_list.Get(), frame_index, batch.first_packet, batch.packet_count);
+        }
+    }
+
+    void UpdateAllocationStatistics()
+    {
+        const auto allocation_counters = GetAllocationCounters();
+        const auto frame_allocation_count = (allocation_counters - m_last_allocation_counters).allocation_count;
+        m_last_allocation_counters = allocation_counters;
+
+        if (m_frame_statistics.GetFrameCount() > s_allocation_warmup_frame_count) {
+            m_max_frame_allocation_count = std::max(m_max_frame_allocation_count, frame_allocation_count);
+        }
+    }
+
+    void UpdateMemoryTracking()
+    {
+        const auto time = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(time - m_last_memory_sample_time).count() >= s_memory_sample_interval_s) {
+            m_memory_counters.Publish(m_memory_tracker.Sample());
+            m_last_memory_sample_time = time;
+        }
+    }
+
+    void UpdateBenchmark()
+    {
+        if (m_benchmark_options.frame_count == 0 || m_frame_statistics.GetFrameCount() != m_benchmark_options.frame_count) {
+            return;
+        }
+
+        std::vector<BenchmarkResult> results;
+        results.push_back(CreateBenchmarkResult("frame", m_frame_statistics.GetFrameSummary()));
+        results.back().counters["hitches"] = static_cast<double>(m_frame_statistics.GetHitchCount());
+        if (IsAllocationCountingEnabled()) {
+            results.back().counters["max_global_allocations"] = static_cast<double>(m_max_frame_allocation_count);
+        }
+        for (size_t i = 0; i < m_frame_statistics.GetPhaseCount(); ++i) {
+            results.push_back(CreateBenchmarkResult("frame/" + m_frame_statistics.GetPhaseName(i), m_frame_statistics.GetPhaseSummary(i)));
+        }
+        results.push_back(CreateBenchmarkResult("frame/latency", m_frame_pacer.GetLatencySummary()));
+        results.back().counters["frames_in_flight"] = m_frame_pacer.GetFrameCount();
+
+        if (!m_benchmark_options.memory_snapshot_path.empty()) {
+            WriteMemorySnapshot(m_benchmark_options.memory_snapshot_path, m_memory_tracker.Sample());
+        }
+
+        m_exit_code = ReportBenchmarkResults(results, m_benchmark_options);
+        PostMessage(GetWindow().GetHandle(), WM_CLOSE, 0, 0);
     }
 
-private:
     void InitDevice()
     {
         m_factory = CreateFactory();
@@ -150,13 +329,7 @@ private:
     {
         m_command_queue = std::make_unique<CommandQueue>(*m_device.Get(), D3D12_COMMAND_LIST_TYPE_DIRECT);
 
-        m_command_allocators.resize(s_back_buffer_count);
-        for (auto& command_allocator : m_command_allocators) {
-            ValidateResult(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&command_allocator)));
-        }
-
-        ValidateResult(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_command_allocators.front().Get(), nullptr, IID_PPV_ARGS(&m_command_list)));
-        ValidateResult(m_command_list->Close());
+        m_command_list_pool = std::make_unique<CommandListPool>(*m_device.Get());
     }
 
     void InitSwapChain()
@@ -206,8 +379,24 @@ private:
     void InitGraphicsPipelineState()
     {
         const auto shader_path = std::filesystem::current_path() / "shaders" / "main.hlsl";
-        ComPtr<ID3DBlob> vertex_shader = CompileShader(shader_path, "VSMain", "vs_5_1");
-        ComPtr<ID3DBlob> pixel_shader = CompileShader(shader_path, "PSMain", "ps_5_1");
+        std::vector<uint8_t> shader_source;
+
+        IoRequestDesc shader_request;
+        shader_request.path = shader_path;
+        shader_request.priority = IoPriority::Critical;
+        shader_request.complete = [&shader_source](IoResult& result) {
+            if (result.status != IoStatus::Completed) {
+                throw std::runtime_error("Failed to load shader: " + result.error);
+            }
+            shader_source = std::move(result.data);
+        };
+        m_async_io.Submit(std::move(shader_request));
+        m_async_io.WaitIdle();
+        m_async_io.DispatchCompletions();
+
+        const auto shader_name = shader_path.string();
+        ComPtr<ID3DBlob> vertex_shader = CompileShader(shader_source, shader_name, "VSMain", "vs_5_1");
+        ComPtr<ID3DBlob> pixel_shader = CompileShader(shader_source, shader_name, "PSMain", "ps_5_1");
 
         std::array<D3D12_INPUT_ELEMENT_DESC, 2> input_descs = {};
         input_descs[0] = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(VertexData, position), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA };
@@ -230,56 +419,39 @@ private:
         ValidateResult(m_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&m_pipeline_state)));
     }
 
-    void InitVertexBuffer()
+    void InitIndirectRenderer()
     {
-        auto vertices = m_cube.GetVertices();
-        ComPtr<ID3D12Resource> upload_resource = CreateBuffer(*m_device.Get(), vertices.size(), D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
-        m_vertex_buffer = CreateBuffer(*m_device.Get(), vertices.size(), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COPY_DEST);
-
-        m_vertex_buffer_view.BufferLocation = m_vertex_buffer->GetGPUVirtualAddress();
-        m_vertex_buffer_view.SizeInBytes = static_cast<UINT>(vertices.size());
-        m_vertex_buffer_view.StrideInBytes = static_cast<UINT>(m_cube.GetVertexSize());
-
-        D3D12_SUBRESOURCE_DATA subresource_data = {};
-        subresource_data.pData = vertices.data();
-        subresource_data.RowPitch = vertices.size();
-        subresource_data.SlicePitch = subresource_data.RowPitch;
-
-        auto buffer_index = m_swap_chain->GetCurrentBackBufferIndex();
-        m_command_list->Reset(m_command_allocators[buffer_index].Get(), nullptr);
-        UpdateSubresources(m_command_list.Get(), m_vertex_buffer.Get(), upload_resource.Get(), 0, 0, 1, &subresource_data);
-        m_command_list->Close();
-
-        m_command_queue->Clear();
-        m_command_queue->Add(m_command_list);
-        m_command_queue->Execute();
-        m_command_queue->Flush();
+        m_indirect_renderer = std::make_unique<IndirectRenderer>(*m_device.Get(), *m_root_signature.Get(), 0, m_frame_pacer.GetFrameCount(), s_max_draw_count);
     }
 
-    void InitIndexBuffer()
+    void InitGeometryPool()
     {
-        auto indexes = m_cube.GetIndexes();
-        ComPtr<ID3D12Resource> upload_resource = CreateBuffer(*m_device.Get(), indexes.size(), D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
-        m_index_buffer = CreateBuffer(*m_device.Get(), indexes.size(), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COPY_DEST);
-
-        m_index_buffer_view.BufferLocation = m_index_buffer->GetGPUVirtualAddress();
-        m_index_buffer_view.SizeInBytes = static_cast<UINT>(indexes.size());
-        m_index_buffer_view.Format = DXGI_FORMAT_R16_UINT;
-
-        D3D12_SUBRESOURCE_DATA subresource_data = {};
-        subresource_data.pData = indexes.data();
-        subresource_data.RowPitch = indexes.size();
-        subresource_data.SlicePitch = subresource_data.RowPitch;
-
-        auto buffer_index = m_swap_chain->GetCurrentBackBufferIndex();
-        m_command_list->Reset(m_command_allocators[buffer_index].Get(), nullptr);
-        UpdateSubresources(m_command_list.Get(), m_index_buffer.Get(), upload_resource.Get(), 0, 0, 1, &subresource_data);
-        m_command_list->Close();
+        m_geometry_pool = std::make_unique<GeometryPool>(*m_device.Get(), m_release_queue);
+
+        // The upload buffer lives until the first present signals the frame fence after this list.
+        auto command_list = m_command_list_pool->Acquire(D3D12_COMMAND_LIST_TYPE_DIRECT, m_swap_chain->GetCompletedFenceValue());
+        m_cube_mesh_id = m_geometry_pool->Add(*command_list.Get(), m_cube, m_swap_chain->GetSignaledFenceValue() + 1);
+        command_list->Close();
 
         m_command_queue->Clear();
-        m_command_queue->Add(m_command_list);
+        m_command_queue->Add(command_list.Get());
         m_command_queue->Execute();
         m_command_queue->Flush();
+        // The queue is idle, so the list is free for the first frame already.
+        m_command_list_pool->Release(std::move(command_list), 0);
+
+        DrawItem cube_item;
+        cube_item.model_matrix = m_model_matrix;
+        m_draw_items.push_back(cube_item);
+        m_draw_item_meshes.push_back(m_cube_mesh_id);
+        m_visible_draw_items.push_back(0);
+    }
+
+    void InitGpuProfiler()
+    {
+#ifdef DDN_PROFILING_ENABLED
+        m_gpu_profiler = std::make_unique<GpuProfiler>(*m_device.Get(), *m_command_queue, m_frame_pacer.GetFrameCount());
+#endif
     }
 
     void UpdateBackBufferViews()
@@ -298,10 +470,16 @@ private:
             return;
         }
 
+        // Frames that are still in flight keep rendering into the old depth buffer.
+        if (m_depth_resource) {
+            m_release_queue.Release(m_swap_chain->GetSignaledFenceValue(), std::move(m_depth_resource));
+        }
+
         auto heap_properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
         auto desc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_D32_FLOAT, width, height, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL);
         auto clear_value = CD3DX12_CLEAR_VALUE(DXGI_FORMAT_D32_FLOAT, 1.0f, 0);
         ValidateResult(m_device->CreateCommittedResource(&heap_properties, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_DEPTH_WRITE, &clear_value, IID_PPV_ARGS(&m_depth_resource)));
+        TrackGpuMemory(*m_depth_resource.Get(), MemoryTag::GpuRenderTarget);
 
         D3D12_DEPTH_STENCIL_VIEW_DESC dsv_desc = {};
         dsv_desc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
@@ -309,15 +487,23 @@ private:
     }
 
 private:
-    static constexpr uint32_t s_back_buffer_count = 2;
+    static constexpr uint32_t s_back_buffer_count = 3;
+    static constexpr uint32_t s_max_draw_count = 1024;
     static constexpr float s_angular_rate_deg = 45.0;
     static constexpr float s_movement_speed = 10.0;
+    static constexpr size_t s_update_phase = 0;
+    static constexpr size_t s_render_phase = 1;
+    static constexpr size_t s_present_phase = 2;
+    static constexpr size_t s_wait_phase = 3;
+    static constexpr uint32_t s_allocation_warmup_frame_count = 8;
+    static constexpr double s_memory_sample_interval_s = 0.25;
+    static constexpr const char* s_trace_file_name = "3dandelion-trace.json";
+    static constexpr const char* s_memory_counters_name = "3dandelion-memory";
 
     ComPtr<IDXGIFactory6> m_factory;
     ComPtr<ID3D12Device> m_device;
 
-    ComPtr<ID3D12GraphicsCommandList> m_command_list;
-    std::vector<ComPtr<ID3D12CommandAllocator>> m_command_allocators;
+    PooledCommandList m_command_list;
 
     ComPtr<ID3D12DescriptorHeap> m_rtv_descriptor_heap;
     UINT m_rtv_descriptor_size = 0;
@@ -328,27 +514,55 @@ private:
     ComPtr<ID3D12RootSignature> m_root_signature;
     ComPtr<ID3D12PipelineState> m_pipeline_state;
 
-    ComPtr<ID3D12Resource> m_vertex_buffer;
-    D3D12_VERTEX_BUFFER_VIEW m_vertex_buffer_view = {};
-
-    ComPtr<ID3D12Resource> m_index_buffer;
-    D3D12_INDEX_BUFFER_VIEW m_index_buffer_view = {};
-
     ComPtr<ID3D12Resource> m_depth_resource;
+    DeferredReleaseQueue m_release_queue;
 
     std::unique_ptr<CommandQueue> m_command_queue;
+    std::unique_ptr<CommandListPool> m_command_list_pool;
     std::unique_ptr<SwapChain> m_swap_chain;
+    std::unique_ptr<GpuProfiler> m_gpu_profiler;
+    std::unique_ptr<IndirectRenderer> m_indirect_renderer;
+    std::unique_ptr<GeometryPool> m_geometry_pool;
 
     Camera m_camera;
     Cube m_cube;
+    GeometryPool::MeshId m_cube_mesh_id = 0;
+
+    std::vector<DrawItem> m_draw_items;
+    std::vector<GeometryPool::MeshId> m_draw_item_meshes;
+    std::vector<uint32_t> m_visible_draw_items;
+    IndirectDrawBuilder m_indirect_draw_builder;
+    FrameArena m_frame_arena;
+    FramePacer m_frame_pacer;
+    AsyncIo m_async_io;
 
     glm::mat4 m_model_matrix;
 
+    BenchmarkOptions m_benchmark_options;
+    FrameStatistics m_frame_statistics;
+    int m_exit_code = 0;
+
+    AllocationCounters m_last_allocation_counters;
+    uint64_t m_max_frame_allocation_count = 0;
+
+    MemoryTracker m_memory_tracker;
+    SharedMemoryCounters m_memory_counters;
+    std::chrono::steady_clock::time_point m_last_memory_sample_time = {};
+
     std::chrono::steady_clock::time_point m_last_time = {};
 };
 
-int main()
+int main(int argc, char* argv[])
 {
-    DandelionApp app(L"3Dandelion", 800, 600);
-    return app.Run();
+    BenchmarkOptions benchmark_options;
+    try {
+        benchmark_options = ParseBenchmarkOptions(argc, argv);
+    } catch (const std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 2;
+    }
+
+    DandelionApp app(L"3Dandelion", 800, 600, benchmark_options);
+    const int exit_code = app.Run();
+    return exit_code != 0 ? exit_code : app.GetExitCode();
 }
@@ -0,0 +1,329 @@
+#include "memory-tracker.h"
+#include "json.h"
+
+#include <new>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+
+// Counters are kept per thread and written only by their owner, so that recording costs plain stores rather
+// than locked adds; threads beyond the slot count share the last slot, which falls back to atomic adds. Peaks
+// need a process-wide live size, which threads update only once their pending change exceeds a threshold.
+constexpr size_t s_thread_slot_count = 256;
+constexpr size_t s_shared_thread_slot = s_thread_slot_count - 1;
+constexpr int64_t s_pending_live_size_threshold = 64 * 1024;
+
+struct alignas(64) TagCounters
+{
+    std::atomic_int64_t live_size;
+    std::atomic_uint64_t peak_size;
+};
+
+struct alignas(64) ThreadCounters
+{
+    std::atomic_uint64_t allocation_count[ddn::s_memory_tag_count];
+    std::atomic_uint64_t deallocation_count[ddn::s_memory_tag_count];
+    std::atomic_uint64_t allocated_size[ddn::s_memory_tag_count];
+    std::atomic_uint64_t deallocated_size[ddn::s_memory_tag_count];
+    int64_t pending_live_size[ddn::s_memory_tag_count];
+};
+
+constexpr const char* s_memory_tag_names[] = {
+    "heap",
+    "arena",
+    "mesh",
+    "animation",
+    "particles",
+    "io",
+    "gpu_buffer",
+    "gpu_render_target",
+};
+
+static_assert(std::size(s_memory_tag_names) == ddn::s_memory_tag_count);
+
+TagCounters s_tag_counters[ddn::s_memory_tag_count];
+ThreadCounters s_thread_counters[s_thread_slot_count];
+std::atomic_size_t s_next_thread_slot = 0;
+
+thread_local ddn::MemoryTag s_current_tag = ddn::MemoryTag::Heap;
+thread_local ThreadCounters* s_current_thread_counters = nullptr;
+
+ThreadCounters& GetThreadCounters() noexcept
+{
+    if (!s_current_thread_counters) {
+        const auto slot = s_next_thread_slot.fetch_add(1, std::memory_order_relaxed);
+        s_current_thread_counters = &s_thread_counters[std::min(slot, s_shared_thread_slot)];
+    }
+    return *s_current_thread_counters;
+}
+
+bool IsShared(const ThreadCounters& thread_counters) noexcept
+{
+    return &thread_counters == &s_thread_counters[s_shared_thread_slot];
+}
+
+void Increment(ThreadCounters& thread_counters, std::atomic_uint64_t& counter, uint64_t value) noexcept
+{
+    if (IsShared(thread_counters)) {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    } else {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+}
+
+void UpdateLiveSize(ThreadCounters& thread_counters, size_t index, int64_t delta) noexcept
+{
+    int64_t pending_size = delta;
+    if (!IsShared(thread_counters)) {
+        pending_size += thread_counters.pending_live_size[index];
+        if (pending_size > -s_pending_live_size_threshold && pending_size < s_pending_live_size_threshold) {
+            thread_counters.pending_live_size[index] = pending_size;
+            return;
+        }
+        thread_counters.pending_live_size[index] = 0;
+    }
+
+    auto& counters = s_tag_counters[index];
+    const auto live_size = counters.live_size.fetch_add(pending_size, std::memory_order_relaxed) + pending_size;
+    if (live_size > 0) {
+        auto peak_size = counters.peak_size.load(std::memory_order_relaxed);
+        while (static_cast<uint64_t>(live_size) > peak_size && !counters.peak_size.compare_exchange_weak(peak_size, live_size, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+ddn::JsonValue ToJson(const ddn::MemoryTagStatistics& statistics)
+{
+    ddn::JsonValue::Object object;
+    object["live_size"] = statistics.counters.live_size;
+    object["peak_size"] = statistics.counters.peak_size;
+    object["allocation_count"] = statistics.counters.allocation_count;
+    object["deallocation_count"] = statistics.counters.deallocation_count;
+    object["allocated_size"] = statistics.counters.allocated_size;
+    object["allocations_per_s"] = statistics.allocations_per_s;
+    object["allocated_bytes_per_s"] = statistics.allocated_bytes_per_s;
+    return object;
+}
+
+}
+
+namespace ddn
+{
+
+const char* GetMemoryTagName(MemoryTag tag)
+{
+    if (tag >= MemoryTag::Count) {
+        throw std::out_of_range("Invalid memory tag");
+    }
+    return s_memory_tag_names[static_cast<size_t>(tag)];
+}
+
+bool IsGpuMemoryTag(MemoryTag tag)
+{
+    return tag == MemoryTag::GpuBuffer || tag == MemoryTag::GpuRenderTarget;
+}
+
+void RecordAllocation(MemoryTag tag, uint64_t size) noexcept
+{
+    const auto index = static_cast<size_t>(tag);
+    auto& thread_counters = GetThreadCounters();
+    Increment(thread_counters, thread_counters.allocation_count[index], 1);
+    Increment(thread_counters, thread_counters.allocated_size[index], size);
+    UpdateLiveSize(thread_counters, index, static_cast<int64_t>(size));
+}
+
+void RecordDeallocation(MemoryTag tag, uint64_t size) noexcept
+{
+    const auto index = static_cast<size_t>(tag);
+    auto& thread_counters = GetThreadCounters();
+    Increment(thread_counters, thread_counters.deallocation_count[index], 1);
+    Increment(thread_counters, thread_counters.deallocated_size[index], size);
+    UpdateLiveSize(thread_counters, index, -static_cast<int64_t>(size));
+}
+
+MemoryTagCounters GetMemoryTagCounters(MemoryTag tag)
+{
+    if (tag >= MemoryTag::Count) {
+        throw std::out_of_range("Invalid memory tag");
+    }
+
+    const auto index = static_cast<size_t>(tag);
+    MemoryTagCounters result;
+    uint64_t deallocated_size = 0;
+    const auto thread_slot_count = std::min(s_next_thread_slot.load(std::memory_order_relaxed), s_thread_slot_count);
+    for (size_t i = 0; i < thread_slot_count; ++i) {
+        const auto& thread_counters = s_thread_counters[i];
+        result.allocation_count += thread_counters.allocation_count[index].load(std::memory_order_relaxed);
+        result.deallocation_count += thread_counters.deallocation_count[index].load(std::memory_order_relaxed);
+        result.allocated_size += thread_counters.allocated_size[index].load(std::memory_order_relaxed);
+        deallocated_size += thread_counters.deallocated_size[index].load(std::memory_order_relaxed);
+    }
+
+    // Slots are read one after another, so a block freed on another thread may be seen before its allocation.
+    result.live_size = result.allocated_size > deallocated_size ? result.allocated_size - deallocated_size : 0;
+    result.peak_size = std::max(s_tag_counters[index].peak_size.load(std::memory_order_relaxed), result.live_size);
+    return result;
+}
+
+MemoryTagScope::MemoryTagScope(MemoryTag tag) noexcept
+    : m_previous_tag(s_current_tag)
+{
+    s_current_tag = tag;
+}
+
+MemoryTagScope::~MemoryTagScope()
+{
+    s_current_tag = m_previous_tag;
+}
+
+MemoryTag GetCurrentMemoryTag() noexcept
+{
+    return s_current_tag;
+}
+
+MemoryTracker::MemoryTracker()
+    : m_start_time(std::chrono::steady_clock::now())
+{
+    Sample();
+}
+
+const MemorySnapshot& MemoryTracker::Sample()
+{
+    const auto time_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start_time).count();
+    const auto interval_s = time_s - m_snapshot.time_s;
+
+    for (size_t i = 0; i < s_memory_tag_count; ++i) {
+        auto& statistics = m_snapshot.tags[i];
+        const auto counters = GetMemoryTagCounters(static_cast<MemoryTag>(i));
+        if (interval_s > 0.0) {
+            statistics.allocations_per_s = (counters.allocation_count - statistics.counters.allocation_count) / interval_s;
+            statistics.allocated_bytes_per_s = (counters.allocated_size - statistics.counters.allocated_size) / interval_s;
+        }
+        statistics.counters = counters;
+    }
+    m_snapshot.time_s = time_s;
+    return m_snapshot;
+}
+
+const MemorySnapshot& MemoryTracker::GetSnapshot() const
+{
+    return m_snapshot;
+}
+
+void WriteMemorySnapshot(const std::filesystem::path& file_path, const MemorySnapshot& snapshot)
+{
+    std::ofstream stream(file_path);
+    if (!stream) {
+        throw std::runtime_error("Failed to open memory snapshot file");
+    }
+
+    JsonValue::Object tags;
+    for (size_t i = 0; i < s_memory_tag_count; ++i) {
+        tags[GetMemoryTagName(static_cast<MemoryTag>(i))] = ToJson(snapshot.tags[i]);
+    }
+
+    JsonValue::Object root;
+    root["time_s"] = snapshot.time_s;
+    root["tags"] = std::move(tags);
+
+    stream << std::setprecision(17);
+    WriteJson(stream, root);
+    stream << std::endl;
+}
+
+SharedMemoryCounters::SharedMemoryCounters(const std::string& name)
+    : m_name(name)
+{
+    if (name.empty() || name.find_first_of("/\\") != std::string::npos) {
+        throw std::invalid_argument("Invalid shared memory name");
+    }
+
+    constexpr auto block_size = sizeof(SharedMemoryCounterBlock);
+    void* view = nullptr;
+#ifdef _WIN32
+    const auto handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(block_size), ("Local\\" + name).c_str());
+    if (!handle) {
+        throw std::runtime_error("Failed to create shared memory counters");
+    }
+    view = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, block_size);
+    if (!view) {
+        CloseHandle(handle);
+        throw std::runtime_error("Failed to map shared memory counters");
+    }
+    m_handle = handle;
+#else
+    const auto path = "/" + name;
+    const int descriptor = shm_open(path.c_str(), O_CREAT | O_RDWR, 0600);
+    if (descriptor < 0) {
+        throw std::runtime_error("Failed to create shared memory counters");
+    }
+    if (ftruncate(descriptor, block_size) == 0) {
+        view = mmap(nullptr, block_size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+    if (!view || view == MAP_FAILED) {
+        shm_unlink(path.c_str());
+        throw std::runtime_error("Failed to map shared memory counters");
+    }
+#endif
+
+    m_block = new (view) SharedMemoryCounterBlock{};
+    m_block->sequence.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_block->magic = SharedMemoryCounterBlock::s_magic;
+    m_block->version = SharedMemoryCounterBlock::s_version;
+    m_block->tag_count = static_cast<uint32_t>(s_memory_tag_count);
+    for (size_t i = 0; i < s_memory_tag_count; ++i) {
+        std::strncpy(m_block->tags[i].name, s_memory_tag_names[i], sizeof(m_block->tags[i].name) - 1);
+    }
+    m_block->sequence.store(2, std::memory_order_release);
+}
+
+SharedMemoryCounters::~SharedMemoryCounters()
+{
+#ifdef _WIN32
+    UnmapViewOfFile(m_block);
+    CloseHandle(static_cast<HANDLE>(m_handle));
+#else
+    munmap(m_block, sizeof(SharedMemoryCounterBlock));
+    shm_unlink(("/" + m_name).c_str());
+#endif
+}
+
+void SharedMemoryCounters::Publish(const MemorySnapshot& snapshot)
+{
+    const auto sequence = m_block->sequence.load(std::memory_order_relaxed);
+    m_block->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    m_block->time_s = snapshot.time_s;
+    for (size_t i = 0; i < s_memory_tag_count; ++i) {
+        const auto& statistics = snapshot.tags[i];
+        auto& tag = m_block->tags[i];
+        tag.live_size = statistics.counters.live_size;
+        tag.peak_size = statistics.counters.peak_size;
+        tag.allocation_count = statistics.counters.allocation_count;
+        tag.deallocation_count = statistics.counters.deallocation_count;
+        tag.allocated_size = statistics.counters.allocated_size;
+        tag.allocations_per_s = statistics.allocations_per_s;
+        tag.allocated_bytes_per_s = statistics.allocated_bytes_per_s;
+    }
+
+    m_block->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+}  // namespace ddn
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <filesystem>
+
+namespace ddn
+{
+
+// CPU tags attribute global operator new/delete calls and therefore only count when the build replaces them
+// (DDN_ALLOCATION_COUNTING_ENABLED); Heap collects everything outside a MemoryTagScope. GPU tags are recorded
+// explicitly when resources are created and released.
+enum class MemoryTag : uint8_t
+{
+    Heap,
+    Arena,
+    Mesh,
+    Animation,
+    Particles,
+    Io,
+    GpuBuffer,
+    GpuRenderTarget,
+    Count,
+};
+
+constexpr size_t s_memory_tag_count = static_cast<size_t>(MemoryTag::Count);
+
+const char* GetMemoryTagName(MemoryTag tag);
+bool IsGpuMemoryTag(MemoryTag tag);
+
+struct MemoryTagCounters
+{
+    uint64_t live_size = 0;
+    uint64_t peak_size = 0;
+    uint64_t allocation_count = 0;
+    uint64_t deallocation_count = 0;
+    uint64_t allocated_size = 0;
+};
+
+// Lock-free and cheap enough to call on every allocation. Counts and live sizes are exact; peaks are tracked
+// from per-thread changes batched in 64 KiB steps and may miss up to that much per thread.
+void RecordAllocation(MemoryTag tag, uint64_t size) noexcept;
+void RecordDeallocation(MemoryTag tag, uint64_t size) noexcept;
+MemoryTagCounters GetMemoryTagCounters(MemoryTag tag);
+
+// Attributes heap allocations made by the current thread to a tag until the scope ends. Memory is charged to
+// the tag it was allocated under no matter which thread or scope frees it.
+class MemoryTagScope
+{
+public:
+    explicit MemoryTagScope(MemoryTag tag) noexcept;
+    ~MemoryTagScope();
+
+    MemoryTagScope(const MemoryTagScope& other) = delete;
+    MemoryTagScope& operator =(const MemoryTagScope& other) = delete;
+
+private:
+    MemoryTag m_previous_tag;
+};
+
+MemoryTag GetCurrentMemoryTag() noexcept;
+
+struct MemoryTagStatistics
+{
+    MemoryTagCounters counters;
+    double allocations_per_s = 0.0;
+    double allocated_bytes_per_s = 0.0;
+};
+
+struct MemorySnapshot
+{
+    double time_s = 0.0;
+    std::array<MemoryTagStatistics, s_memory_tag_count> tags = {};
+};
+
+// Samples the tag counters and derives allocation rates over the interval since the previous sample.
+class MemoryTracker
+{
+public:
+    MemoryTracker();
+
+    const MemorySnapshot& Sample();
+    const MemorySnapshot& GetSnapshot() const;
+
+private:
+    std::chrono::steady_clock::time_point m_start_time;
+    MemorySnapshot m_snapshot;
+};
+
+void WriteMemorySnapshot(const std::filesystem::path& file_path, const MemorySnapshot& snapshot);
+
+// Layout of the shared memory block, for tools that read the counters of a running process. The writer makes
+// sequence odd while it updates the block; a reader copies the block and retries until it sees the same even
+// sequence before and after the copy.
+struct SharedMemoryTagCounters
+{
+    char name[24];
+    uint64_t live_size;
+    uint64_t peak_size;
+    uint64_t allocation_count;
+    uint64_t deallocation_count;
+    uint64_t allocated_size;
+    double allocations_per_s;
+    double allocated_bytes_per_s;
+};
+
+struct SharedMemoryCounterBlock
+{
+    static constexpr uint32_t s_magic = 0x4d4e4444;  // "DDNM"
+    static constexpr uint32_t s_version = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t tag_count;
+    uint32_t reserved;
+    std::atomic_uint64_t sequence;
+    double time_s;
+    SharedMemoryTagCounters tags[s_memory_tag_count];
+};
+
+// Publishes snapshots to a named shared memory block: "/<name>" with shm_open, "Local\<name>" on Windows.
+class SharedMemoryCounters
+{
+public:
+    explicit SharedMemoryCounters(const std::string& name);
+    ~SharedMemoryCounters();
+
+    SharedMemoryCounters(const SharedMemoryCounters& other) = delete;
+    SharedMemoryCounters& operator =(const SharedMemoryCounters& other) = delete;
+
+    void Publish(const MemorySnapshot& snapshot);
+
+private:
+    std::string m_name;
+    SharedMemoryCounterBlock* m_block = nullptr;
+    void* m_handle = nullptr;
+};
+
+}  // namespace ddn
@@ -0,0 +1,413 @@
+#include "mesh-attributes.h"
+#include "simd.h"
+#include "profiler.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <limits>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr size_t s_corner_grain_size = 65536;
+constexpr size_t s_packet_grain_size = 4096;
+constexpr size_t s_vertex_grain_size = 16384;
+constexpr uint32_t s_min_bucket_shift = 12;
+constexpr uint32_t s_max_bucket_count = 4096;
+constexpr uint32_t s_lane_count = 4;
+
+using ddn::Float4;
+
+struct Float4x3
+{
+    Float4 x;
+    Float4 y;
+    Float4 z;
+};
+
+Float4x3 operator -(const Float4x3& lhs, const Float4x3& rhs) { return { lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z }; }
+Float4x3 operator *(const Float4x3& lhs, Float4 rhs) { return { lhs.x * rhs, lhs.y * rhs, lhs.z * rhs }; }
+
+Float4 Dot(const Float4x3& lhs, const Float4x3& rhs)
+{
+    return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+}
+
+Float4x3 Cross(const Float4x3& lhs, const Float4x3& rhs)
+{
+    return { lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z, lhs.x * rhs.y - lhs.y * rhs.x };
+}
+
+Float4 GetInverseLength(const Float4x3& value)
+{
+    const auto length = ddn::Sqrt(Dot(value, value));
+    return ddn::Select(length > Float4::Splat(0.0f), Float4::Splat(1.0f) / length, Float4::Splat(0.0f));
+}
+
+Float4x3 Normalize(const Float4x3& value)
+{
+    return value * GetInverseLength(value);
+}
+
+Float4x3 ProjectOnPlane(const Float4x3& value, const Float4x3& normal)
+{
+    return value - normal * Dot(normal, value);
+}
+
+// Polynomial approximation with an absolute error below 7e-5 radians, accurate enough for weights.
+Float4 Acos(Float4 value)
+{
+    const auto one = Float4::Splat(1.0f);
+    const auto x = ddn::Min(ddn::Abs(value), one);
+    auto polynomial = Float4::Splat(-0.0187293f) * x + Float4::Splat(0.0742610f);
+    polynomial = polynomial * x - Float4::Splat(0.2121144f);
+    polynomial = polynomial * x + Float4::Splat(1.5707288f);
+    const auto result = ddn::Sqrt(one - x) * polynomial;
+    return ddn::Select(value < Float4::Splat(0.0f), Float4::Splat(glm::pi<float>()) - result, result);
+}
+
+Float4x3 Gather(const glm::vec3* const* values)
+{
+    return {
+        Float4::Set(values[0]->x, values[1]->x, values[2]->x, values[3]->x),
+        Float4::Set(values[0]->y, values[1]->y, values[2]->y, values[3]->y),
+        Float4::Set(values[0]->z, values[1]->z, values[2]->z, values[3]->z),
+    };
+}
+
+void Scatter(const Float4x3& value, glm::vec3* output, uint32_t lane_count)
+{
+    float x[s_lane_count];
+    float y[s_lane_count];
+    float z[s_lane_count];
+    value.x.Store(x);
+    value.y.Store(y);
+    value.z.Store(z);
+    for (uint32_t lane = 0; lane < lane_count; ++lane) {
+        output[lane] = glm::vec3(x[lane], y[lane], z[lane]);
+    }
+}
+
+glm::vec3 GetPerpendicular(const glm::vec3& normal)
+{
+    if (glm::dot(normal, normal) <= 0.0f) {
+        return glm::vec3(1.0f, 0.0f, 0.0f);
+    }
+    const auto helper = std::abs(normal.x) > 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+    return glm::normalize(glm::cross(helper, normal));
+}
+
+struct TangentSum
+{
+    glm::vec3 positive = glm::vec3(0.0f);
+    float positive_weight = 0.0f;
+    glm::vec3 negative = glm::vec3(0.0f);
+    float negative_weight = 0.0f;
+};
+
+}
+
+namespace ddn
+{
+
+MeshAttributeGenerator::MeshAttributeGenerator(const IMesh& mesh)
+    : m_mesh(mesh)
+{
+    DDN_PROFILE_FUNCTION();
+
+    const auto index_size = mesh.GetIndexSize();
+    if (index_size != sizeof(uint16_t) && index_size != sizeof(uint32_t)) {
+        throw std::invalid_argument("Unsupported index size");
+    }
+
+    const auto corner_count = mesh.GetIndexCount() - mesh.GetIndexCount() % 3;
+    if (corner_count > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Mesh has too many indexes");
+    }
+
+    const auto vertex_count = mesh.GetVertexCount();
+    const auto indexes = mesh.GetIndexes();
+    m_indexes.resize(corner_count);
+    ParallelFor(0, corner_count, s_corner_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_indexes[i] = ReadIndex(indexes.data(), index_size, i);
+            if (m_indexes[i] >= vertex_count) {
+                throw std::out_of_range("Index exceeds vertex count");
+            }
+        }
+    });
+
+    // Each bucket owns a contiguous vertex range, so corners partitioned by bucket can be accumulated
+    // by independent tasks without atomics.
+    m_bucket_shift = s_min_bucket_shift;
+    while ((vertex_count >> m_bucket_shift) >= s_max_bucket_count) {
+        ++m_bucket_shift;
+    }
+    const size_t bucket_count = vertex_count > 0 ? ((vertex_count - 1) >> m_bucket_shift) + 1 : 0;
+    const size_t chunk_count = (corner_count + s_corner_grain_size - 1) / s_corner_grain_size;
+
+    std::vector<uint32_t> chunk_offsets(chunk_count * bucket_count, 0);
+    ParallelFor(0, chunk_count, 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            auto* counts = chunk_offsets.data() + chunk * bucket_count;
+            const auto last = std::min(corner_count, (chunk + 1) * s_corner_grain_size);
+            for (size_t corner = chunk * s_corner_grain_size; corner < last; ++corner) {
+                ++counts[m_indexes[corner] >> m_bucket_shift];
+            }
+        }
+    });
+
+    m_bucket_offsets.resize(bucket_count + 1);
+    uint32_t offset = 0;
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        m_bucket_offsets[bucket] = offset;
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+            const auto count = chunk_offsets[chunk * bucket_count + bucket];
+            chunk_offsets[chunk * bucket_count + bucket] = offset;
+            offset += count;
+        }
+    }
+    m_bucket_offsets[bucket_count] = offset;
+
+    m_bucket_corners.resize(corner_count);
+    ParallelFor(0, chunk_count, 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            auto* offsets = chunk_offsets.data() + chunk * bucket_count;
+            const auto last = std::min(corner_count, (chunk + 1) * s_corner_grain_size);
+            for (size_t corner = chunk * s_corner_grain_size; corner < last; ++corner) {
+                m_bucket_corners[offsets[m_indexes[corner] >> m_bucket_shift]++] = static_cast<uint32_t>(corner);
+            }
+        }
+    });
+}
+
+template <typename T>
+std::vector<T> MeshAttributeGenerator::ReadAttribute(size_t offset) const
+{
+    const auto vertex_size = m_mesh.GetVertexSize();
+    if (offset + sizeof(T) > vertex_size) {
+        throw std::invalid_argument("Vertex attribute offset exceeds vertex size");
+    }
+
+    const auto vertices = m_mesh.GetVertices();
+    std::vector<T> values(m_mesh.GetVertexCount());
+    ParallelFor(0, values.size(), s_vertex_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            std::memcpy(&values[i], vertices.data() + i * vertex_size + offset, sizeof(T));
+        }
+    });
+    return values;
+}
+
+template <typename Function>
+void MeshAttributeGenerator::ForEachBucket(Function&& function) const
+{
+    const auto vertex_count = static_cast<uint32_t>(m_mesh.GetVertexCount());
+    ParallelFor(0, GetBucketCount(), 1, [&](size_t begin, size_t end) {
+        for (size_t bucket = begin; bucket < end; ++bucket) {
+            const auto vertex_begin = static_cast<uint32_t>(bucket << m_bucket_shift);
+            const auto vertex_end = std::min(vertex_count, static_cast<uint32_t>((bucket + 1) << m_bucket_shift));
+            const auto corners = std::span<const uint32_t>(m_bucket_corners).subspan(m_bucket_offsets[bucket], m_bucket_offsets[bucket + 1] - m_bucket_offsets[bucket]);
+            function(vertex_begin, vertex_end, corners);
+        }
+    });
+}
+
+void MeshAttributeGenerator::ComputeNormals(size_t position_offset, NormalWeighting weighting, std::span<glm::vec3> normals) const
+{
+    DDN_PROFILE_FUNCTION();
+
+    if (normals.size() < m_mesh.GetVertexCount()) {
+        throw std::invalid_argument("Expected a normal for every vertex");
+    }
+
+    const auto positions = ReadAttribute<glm::vec3>(position_offset);
+    const auto triangle_count = m_indexes.size() / 3;
+    const bool is_angle_weighted = weighting == NormalWeighting::Angle;
+
+    std::vector<glm::vec3> face_normals(triangle_count);
+    // Corner angles of each triangle, packed as one vec3 per triangle.
+    std::vector<glm::vec3> corner_weights(is_angle_weighted ? triangle_count : 0);
+    const auto packet_count = (triangle_count + s_lane_count - 1) / s_lane_count;
+    ParallelFor(0, packet_count, s_packet_grain_size, [&](size_t begin, size_t end) {
+        for (size_t packet = begin; packet < end; ++packet) {
+            const auto first = packet * s_lane_count;
+            const auto lane_count = static_cast<uint32_t>(std::min<size_t>(s_lane_count, triangle_count - first));
+
+            const glm::vec3* corners[3][s_lane_count];
+            for (uint32_t lane = 0; lane < s_lane_count; ++lane) {
+                const auto triangle = first + std::min(lane, lane_count - 1);
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    corners[corner][lane] = &positions[m_indexes[triangle * 3 + corner]];
+                }
+            }
+
+            const auto p0 = Gather(corners[0]);
+            const auto edge_01 = Gather(corners[1]) - p0;
+            const auto edge_02 = Gather(corners[2]) - p0;
+            auto normal = Cross(edge_01, edge_02);
+
+            if (is_angle_weighted) {
+                const auto edge_12 = edge_02 - edge_01;
+                const auto inverse_length_01 = GetInverseLength(edge_01);
+                const auto inverse_length_02 = GetInverseLength(edge_02);
+                const auto inverse_length_12 = GetInverseLength(edge_12);
+                const auto angle_0 = Acos(Dot(edge_01, edge_02) * inverse_length_01 * inverse_length_02);
+                const auto angle_1 = Acos(Float4::Splat(0.0f) - Dot(edge_01, edge_12) * inverse_length_01 * inverse_length_12);
+                const auto angle_2 = Max(Float4::Splat(glm::pi<float>()) - angle_0 - angle_1, Float4::Splat(0.0f));
+
+                normal = Normalize(normal);
+                Scatter({ angle_0, angle_1, angle_2 }, &corner_weights[first], lane_count);
+            }
+            Scatter(normal, &face_normals[first], lane_count);
+        }
+    });
+
+    ForEachBucket([&](uint32_t vertex_begin, uint32_t vertex_end, std::span<const uint32_t> corners) {
+        std::fill(normals.begin() + vertex_begin, normals.begin() + vertex_end, glm::vec3(0.0f));
+        for (const auto corner : corners) {
+            const auto triangle = corner / 3;
+            const float weight = is_angle_weighted ? corner_weights[triangle][corner % 3] : 1.0f;
+            normals[m_indexes[corner]] += face_normals[triangle] * weight;
+        }
+
+        for (uint32_t vertex = vertex_begin; vertex < vertex_end; ++vertex) {
+            const float length = glm::length(normals[vertex]);
+            if (length > 0.0f) {
+                normals[vertex] /= length;
+            }
+        }
+    });
+}
+
+void MeshAttributeGenerator::ComputeTangents(size_t position_offset, size_t normal_offset, size_t uv_offset, std::span<glm::vec4> tangents) const
+{
+    DDN_PROFILE_FUNCTION();
+
+    if (tangents.size() < m_mesh.GetVertexCount()) {
+        throw std::invalid_argument("Expected a tangent for every vertex");
+    }
+
+    const auto positions = ReadAttribute<glm::vec3>(position_offset);
+    const auto normals = ReadAttribute<glm::vec3>(normal_offset);
+    const auto uvs = ReadAttribute<glm::vec2>(uv_offset);
+    const auto triangle_count = m_indexes.size() / 3;
+
+    // First order tangent and uv winding per triangle; triangles without uv area get a zero tangent and do
+    // not contribute.
+    std::vector<glm::vec3> face_tangents(triangle_count);
+    std::vector<uint8_t> face_mirrored(triangle_count);
+    const auto packet_count = (triangle_count + s_lane_count - 1) / s_lane_count;
+    ParallelFor(0, packet_count, s_packet_grain_size, [&](size_t begin, size_t end) {
+        for (size_t packet = begin; packet < end; ++packet) {
+            const auto first = packet * s_lane_count;
+            const auto lane_count = static_cast<uint32_t>(std::min<size_t>(s_lane_count, triangle_count - first));
+
+            const glm::vec3* corners[3][s_lane_count];
+            float uv_x[3][s_lane_count];
+            float uv_y[3][s_lane_count];
+            for (uint32_t lane = 0; lane < s_lane_count; ++lane) {
+                const auto triangle = first + std::min(lane, lane_count - 1);
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    const auto index = m_indexes[triangle * 3 + corner];
+                    corners[corner][lane] = &positions[index];
+                    uv_x[corner][lane] = uvs[index].x;
+                    uv_y[corner][lane] = uvs[index].y;
+                }
+            }
+
+            const auto p0 = Gather(corners[0]);
+            const auto edge_01 = Gather(corners[1]) - p0;
+            const auto edge_02 = Gather(corners[2]) - p0;
+            const auto uv_x0 = Float4::Load(uv_x[0]);
+            const auto uv_y0 = Float4::Load(uv_y[0]);
+            const auto uv_edge_01_x = Float4::Load(uv_x[1]) - uv_x0;
+            const auto uv_edge_01_y = Float4::Load(uv_y[1]) - uv_y0;
+            const auto uv_edge_02_x = Float4::Load(uv_x[2]) - uv_x0;
+            const auto uv_edge_02_y = Float4::Load(uv_y[2]) - uv_y0;
+
+            const auto signed_area = uv_edge_01_x * uv_edge_02_y - uv_edge_01_y * uv_edge_02_x;
+            const auto is_mirrored = signed_area < Float4::Splat(0.0f);
+            const auto orientation = Select(is_mirrored, Float4::Splat(-1.0f), Select(signed_area > Float4::Splat(0.0f), Float4::Splat(1.0f), Float4::Splat(0.0f)));
+            const auto tangent = Normalize(edge_01 * uv_edge_02_y - edge_02 * uv_edge_01_y) * orientation;
+
+            Scatter(tangent, &face_tangents[first], lane_count);
+            const auto mirrored_bits = GetBits(is_mirrored);
+            for (uint32_t lane = 0; lane < lane_count; ++lane) {
+                face_mirrored[first + lane] = static_cast<uint8_t>((mirrored_bits >> lane) & 1);
+            }
+        }
+    });
+
+    ForEachBucket([&](uint32_t vertex_begin, uint32_t vertex_end, std::span<const uint32_t> corners) {
+        std::vector<TangentSum> sums(vertex_end - vertex_begin);
+
+        for (size_t first = 0; first < corners.size(); first += s_lane_count) {
+            const auto lane_count = static_cast<uint32_t>(std::min<size_t>(s_lane_count, corners.size() - first));
+
+            uint32_t vertices[s_lane_count];
+            const glm::vec3* lane_normals[s_lane_count];
+            const glm::vec3* lane_tangents[s_lane_count];
+            const glm::vec3* lane_positions[3][s_lane_count];
+            for (uint32_t lane = 0; lane < s_lane_count; ++lane) {
+                const auto corner = corners[first + std::min(lane, lane_count - 1)];
+                const auto triangle = corner / 3;
+                const auto base = triangle * 3;
+                vertices[lane] = m_indexes[corner];
+                lane_normals[lane] = &normals[vertices[lane]];
+                lane_tangents[lane] = &face_tangents[triangle];
+                lane_positions[0][lane] = &positions[vertices[lane]];
+                lane_positions[1][lane] = &positions[m_indexes[base + (corner + 1) % 3]];
+                lane_positions[2][lane] = &positions[m_indexes[base + (corner + 2) % 3]];
+            }
+
+            const auto normal = Gather(lane_normals);
+            const auto position = Gather(lane_positions[0]);
+            const auto tangent = Normalize(ProjectOnPlane(Gather(lane_tangents), normal));
+            const auto edge_next = Normalize(ProjectOnPlane(Gather(lane_positions[1]) - position, normal));
+            const auto edge_previous = Normalize(ProjectOnPlane(Gather(lane_positions[2]) - position, normal));
+            const auto cosine = Max(Min(Dot(edge_next, edge_previous), Float4::Splat(1.0f)), Float4::Splat(-1.0f));
+            const auto has_tangent = Dot(tangent, tangent) > Float4::Splat(0.0f);
+            const auto weight = Select(has_tangent, Acos(cosine), Float4::Splat(0.0f));
+
+            glm::vec3 weighted_tangents[s_lane_count];
+            float weights[s_lane_count];
+            Scatter(tangent * weight, weighted_tangents, lane_count);
+            weight.Store(weights);
+
+            for (uint32_t lane = 0; lane < lane_count; ++lane) {
+                auto& sum = sums[vertices[lane] - vertex_begin];
+                if (face_mirrored[corners[first + lane] / 3]) {
+                    sum.negative += weighted_tangents[lane];
+                    sum.negative_weight += weights[lane];
+                } else {
+                    sum.positive += weighted_tangents[lane];
+                    sum.positive_weight += weights[lane];
+                }
+            }
+        }
+
+        for (uint32_t vertex = vertex_begin; vertex < vertex_end; ++vertex) {
+            const auto& sum = sums[vertex - vertex_begin];
+            const bool is_mirrored = sum.negative_weight > sum.positive_weight;
+            const auto& normal = normals[vertex];
+
+            auto tangent = is_mirrored ? sum.negative : sum.positive;
+            tangent -= normal * glm::dot(normal, tangent);
+            const float length = glm::length(tangent);
+            tangent = length > 0.0f ? tangent / length : GetPerpendicular(normal);
+            tangents[vertex] = glm::vec4(tangent, is_mirrored ? -1.0f : 1.0f);
+        }
+    });
+}
+
+uint32_t MeshAttributeGenerator::GetBucketCount() const
+{
+    return m_bucket_offsets.empty() ? 0 : static_cast<uint32_t>(m_bucket_offsets.size() - 1);
+}
+
+}  // namespace ddn
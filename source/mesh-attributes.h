@@ -0,0 +1,94 @@
+#pragma once
+
+#include "mesh.h"
+#include "thread-pool.h"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+enum class NormalWeighting
+{
+    Area,
+    Angle,
+};
+
+class MeshAttributeGenerator
+{
+public:
+    explicit MeshAttributeGenerator(const IMesh& mesh);
+
+    void ComputeNormals(size_t position_offset, NormalWeighting weighting, std::span<glm::vec3> normals) const;
+    // Angle-weighted average of the per-face uv tangents around each vertex, orthogonalized against its normal,
+    // with the bitangent sign in w. Vertices are never split: one shared across a uv mirror keeps the faces of
+    // the dominant orientation, and one on a tangent seam averages across it. This is not MikkTSpace, and
+    // normal maps baked against MikkTSpace will not match along such seams.
+    void ComputeTangents(size_t position_offset, size_t normal_offset, size_t uv_offset, std::span<glm::vec4> tangents) const;
+
+    uint32_t GetBucketCount() const;
+
+private:
+    template <typename T>
+    std::vector<T> ReadAttribute(size_t offset) const;
+
+    template <typename Function>
+    void ForEachBucket(Function&& function) const;
+
+private:
+    const IMesh& m_mesh;
+    std::vector<uint32_t> m_indexes;
+    std::vector<uint32_t> m_bucket_corners;
+    std::vector<uint32_t> m_bucket_offsets;
+    uint32_t m_bucket_shift = 0;
+};
+
+template <typename Vertex, typename T>
+size_t GetMemberOffset(const Vertex& vertex, T Vertex::* member)
+{
+    return static_cast<size_t>(reinterpret_cast<const uint8_t*>(&(vertex.*member)) - reinterpret_cast<const uint8_t*>(&vertex));
+}
+
+template <typename Vertex, typename Index, template <typename> typename Allocator>
+void GenerateNormals(Mesh<Vertex, Index, Allocator>& mesh, glm::vec3 Vertex::* position, glm::vec3 Vertex::* normal, NormalWeighting weighting = NormalWeighting::Angle)
+{
+    auto vertices = mesh.GetMutableVertices();
+    if (vertices.empty()) {
+        return;
+    }
+
+    std::vector<glm::vec3> normals(vertices.size());
+    MeshAttributeGenerator(mesh).ComputeNormals(GetMemberOffset(vertices[0], position), weighting, normals);
+
+    ParallelFor(0, vertices.size(), 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            vertices[i].*normal = normals[i];
+        }
+    });
+}
+
+template <typename Vertex, typename Index, template <typename> typename Allocator>
+void GenerateTangents(Mesh<Vertex, Index, Allocator>& mesh, glm::vec3 Vertex::* position, glm::vec3 Vertex::* normal, glm::vec2 Vertex::* uv, glm::vec4 Vertex::* tangent)
+{
+    auto vertices = mesh.GetMutableVertices();
+    if (vertices.empty()) {
+        return;
+    }
+
+    std::vector<glm::vec4> tangents(vertices.size());
+    MeshAttributeGenerator(mesh).ComputeTangents(GetMemberOffset(vertices[0], position), GetMemberOffset(vertices[0], normal), GetMemberOffset(vertices[0], uv), tangents);
+
+    ParallelFor(0, vertices.size(), 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            vertices[i].*tangent = tangents[i];
+        }
+    });
+}
+
+}  // namespace ddn
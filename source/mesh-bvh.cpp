@@ -0,0 +1,226 @@
+#include "mesh-bvh.h"
+#include "simd.h"
+#include "profiler.h"
+#include "thread-pool.h"
+
+#include <glm/glm.hpp>
+
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr size_t s_triangle_grain_size = 16384;
+constexpr size_t s_ray_grain_size = 256;
+
+}
+
+namespace ddn
+{
+
+void MeshBvh::Build(const IMesh& mesh, size_t position_offset, const BvhBuildDesc& desc)
+{
+    DDN_PROFILE_FUNCTION();
+
+    const auto index_size = mesh.GetIndexSize();
+    if (index_size != sizeof(uint16_t) && index_size != sizeof(uint32_t)) {
+        throw std::invalid_argument("Unsupported index size");
+    }
+
+    const auto vertex_size = mesh.GetVertexSize();
+    if (position_offset + sizeof(glm::vec3) > vertex_size) {
+        throw std::invalid_argument("Position offset exceeds vertex size");
+    }
+
+    const auto vertices = mesh.GetVertices();
+    const auto vertex_count = mesh.GetVertexCount();
+    const auto indexes = mesh.GetIndexes();
+    const auto triangle_count = mesh.GetIndexCount() / 3;
+
+    std::vector<std::array<glm::vec3, 3>> triangles(triangle_count);
+    std::vector<Aabb> bounds(triangle_count);
+    ParallelFor(0, triangle_count, s_triangle_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            auto& triangle = triangles[i];
+            for (size_t j = 0; j < 3; ++j) {
+                const auto index = ReadIndex(indexes.data(), index_size, i * 3 + j);
+                if (index >= vertex_count) {
+                    throw std::out_of_range("Index exceeds vertex count");
+                }
+                std::memcpy(&triangle[j], vertices.data() + index * vertex_size + position_offset, sizeof(glm::vec3));
+            }
+            bounds[i].min = glm::min(triangle[0], glm::min(triangle[1], triangle[2]));
+            bounds[i].max = glm::max(triangle[0], glm::max(triangle[1], triangle[2]));
+        }
+    });
+
+    m_bvh.Build(bounds, desc);
+    m_triangle_count = static_cast<uint32_t>(triangle_count);
+
+    // Padded so that the last leaf can always be loaded as a full SIMD packet.
+    const auto padded_count = triangle_count + s_lane_count - 1;
+    for (size_t axis = 0; axis < 3; ++axis) {
+        m_positions[axis].assign(padded_count, 0.0f);
+        m_edges_a[axis].assign(padded_count, 0.0f);
+        m_edges_b[axis].assign(padded_count, 0.0f);
+    }
+
+    const auto primitive_indices = m_bvh.GetPrimitiveIndices();
+    ParallelFor(0, triangle_count, s_triangle_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto& triangle = triangles[primitive_indices[i]];
+            const auto edge_a = triangle[1] - triangle[0];
+            const auto edge_b = triangle[2] - triangle[0];
+            for (int axis = 0; axis < 3; ++axis) {
+                m_positions[axis][i] = triangle[0][axis];
+                m_edges_a[axis][i] = edge_a[axis];
+                m_edges_b[axis][i] = edge_b[axis];
+            }
+        }
+    });
+}
+
+MeshHit MeshBvh::Raycast(const Ray& ray) const
+{
+    MeshHit hit;
+    hit.distance = ray.max_distance;
+
+    m_bvh.RaycastLeaves(ray, [&](uint32_t first, uint32_t count, BvhHit& bvh_hit) {
+        if (IntersectLeaf<false>(ray, first, count, hit)) {
+            bvh_hit.primitive = hit.triangle;
+            bvh_hit.distance = hit.distance;
+        }
+        return false;
+    });
+
+    return hit;
+}
+
+bool MeshBvh::IsOccluded(const Ray& ray) const
+{
+    MeshHit hit;
+    hit.distance = ray.max_distance;
+
+    m_bvh.RaycastLeaves(ray, [&](uint32_t first, uint32_t count, BvhHit&) {
+        return IntersectLeaf<true>(ray, first, count, hit);
+    });
+
+    return hit.IsValid();
+}
+
+void MeshBvh::Raycast(std::span<const Ray> rays, std::span<MeshHit> hits) const
+{
+    DDN_PROFILE_FUNCTION();
+
+    if (hits.size() < rays.size()) {
+        throw std::invalid_argument("Expected a hit for every ray");
+    }
+
+    ParallelFor(0, rays.size(), s_ray_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            hits[i] = Raycast(rays[i]);
+        }
+    });
+}
+
+void MeshBvh::IsOccluded(std::span<const Ray> rays, std::span<uint8_t> occluded) const
+{
+    DDN_PROFILE_FUNCTION();
+
+    if (occluded.size() < rays.size()) {
+        throw std::invalid_argument("Expected a result for every ray");
+    }
+
+    ParallelFor(0, rays.size(), s_ray_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            occluded[i] = IsOccluded(rays[i]) ? 1 : 0;
+        }
+    });
+}
+
+const Bvh& MeshBvh::GetBvh() const
+{
+    return m_bvh;
+}
+
+uint32_t MeshBvh::GetTriangleCount() const
+{
+    return m_triangle_count;
+}
+
+template <bool IsAnyHit>
+bool MeshBvh::IntersectLeaf(const Ray& ray, uint32_t first, uint32_t count, MeshHit& hit) const
+{
+    const auto direction_x = Float4::Splat(ray.direction.x);
+    const auto direction_y = Float4::Splat(ray.direction.y);
+    const auto direction_z = Float4::Splat(ray.direction.z);
+    const auto zero = Float4::Splat(0.0f);
+    const auto one = Float4::Splat(1.0f);
+    const auto min_determinant = Float4::Splat(std::numeric_limits<float>::min());
+    const auto lanes = Float4::Set(0.0f, 1.0f, 2.0f, 3.0f);
+
+    bool is_hit = false;
+    for (uint32_t packet = first; packet < first + count; packet += s_lane_count) {
+        const auto edge_a_x = Float4::Load(&m_edges_a[0][packet]);
+        const auto edge_a_y = Float4::Load(&m_edges_a[1][packet]);
+        const auto edge_a_z = Float4::Load(&m_edges_a[2][packet]);
+        const auto edge_b_x = Float4::Load(&m_edges_b[0][packet]);
+        const auto edge_b_y = Float4::Load(&m_edges_b[1][packet]);
+        const auto edge_b_z = Float4::Load(&m_edges_b[2][packet]);
+
+        const auto p_x = direction_y * edge_b_z - direction_z * edge_b_y;
+        const auto p_y = direction_z * edge_b_x - direction_x * edge_b_z;
+        const auto p_z = direction_x * edge_b_y - direction_y * edge_b_x;
+        const auto determinant = edge_a_x * p_x + edge_a_y * p_y + edge_a_z * p_z;
+        const auto inverse_determinant = one / determinant;
+
+        const auto t_x = Float4::Splat(ray.origin.x) - Float4::Load(&m_positions[0][packet]);
+        const auto t_y = Float4::Splat(ray.origin.y) - Float4::Load(&m_positions[1][packet]);
+        const auto t_z = Float4::Splat(ray.origin.z) - Float4::Load(&m_positions[2][packet]);
+        const auto u = (t_x * p_x + t_y * p_y + t_z * p_z) * inverse_determinant;
+
+        const auto q_x = t_y * edge_a_z - t_z * edge_a_y;
+        const auto q_y = t_z * edge_a_x - t_x * edge_a_z;
+        const auto q_z = t_x * edge_a_y - t_y * edge_a_x;
+        const auto v = (direction_x * q_x + direction_y * q_y + direction_z * q_z) * inverse_determinant;
+        const auto distance = (edge_b_x * q_x + edge_b_y * q_y + edge_b_z * q_z) * inverse_determinant;
+
+        const auto mask = (lanes < Float4::Splat(static_cast<float>(first + count - packet)))
+            & (Abs(determinant) > min_determinant)
+            & (u >= zero) & (v >= zero) & (u + v <= one)
+            & (distance >= zero) & (distance < Float4::Splat(hit.distance));
+
+        auto bits = GetBits(mask);
+        if (bits == 0) {
+            continue;
+        }
+
+        float distances[s_lane_count];
+        float us[s_lane_count];
+        float vs[s_lane_count];
+        distance.Store(distances);
+        u.Store(us);
+        v.Store(vs);
+
+        while (bits != 0) {
+            const auto lane = static_cast<uint32_t>(std::countr_zero(bits));
+            bits &= bits - 1;
+            if (distances[lane] < hit.distance) {
+                hit.triangle = m_bvh.GetPrimitiveIndices()[packet + lane];
+                hit.distance = distances[lane];
+                hit.barycentrics = glm::vec2(us[lane], vs[lane]);
+                is_hit = true;
+            }
+        }
+
+        if (IsAnyHit) {
+            return true;
+        }
+    }
+
+    return is_hit;
+}
+
+}  // namespace ddn
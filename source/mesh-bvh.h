@@ -0,0 +1,55 @@
+#pragma once
+
+#include "bvh.h"
+#include "mesh.h"
+#include "bounds.h"
+
+#include <glm/vec2.hpp>
+
+#include <span>
+#include <array>
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+namespace ddn
+{
+
+struct MeshHit
+{
+    uint32_t triangle = std::numeric_limits<uint32_t>::max();
+    float distance = std::numeric_limits<float>::max();
+    glm::vec2 barycentrics = glm::vec2(0.0f);
+
+    bool IsValid() const { return triangle != std::numeric_limits<uint32_t>::max(); }
+};
+
+class MeshBvh
+{
+public:
+    void Build(const IMesh& mesh, size_t position_offset = 0, const BvhBuildDesc& desc = {});
+
+    MeshHit Raycast(const Ray& ray) const;
+    bool IsOccluded(const Ray& ray) const;
+
+    void Raycast(std::span<const Ray> rays, std::span<MeshHit> hits) const;
+    void IsOccluded(std::span<const Ray> rays, std::span<uint8_t> occluded) const;
+
+    const Bvh& GetBvh() const;
+    uint32_t GetTriangleCount() const;
+
+private:
+    template <bool IsAnyHit>
+    bool IntersectLeaf(const Ray& ray, uint32_t first, uint32_t count, MeshHit& hit) const;
+
+private:
+    static constexpr uint32_t s_lane_count = 4;
+
+    Bvh m_bvh;
+    std::array<std::vector<float>, 3> m_positions;
+    std::array<std::vector<float>, 3> m_edges_a;
+    std::array<std::vector<float>, 3> m_edges_b;
+    uint32_t m_triangle_count = 0;
+};
+
+}  // namespace ddn
@@ -0,0 +1,189 @@
+#include "mesh-generator.h"
+#include "profiler.h"
+#include "thread-pool.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr size_t s_element_grain_size = 16384;
+constexpr size_t s_max_16bit_vertex_count = size_t(std::numeric_limits<uint16_t>::max()) + 1;
+
+size_t GetRowGrainSize(size_t row_size)
+{
+    return std::max<size_t>(1, s_element_grain_size / std::max<size_t>(1, row_size));
+}
+
+// Vertices form a (column_count + 1) x (row_count + 1) grid. With poles, the first and last vertex rows
+// collapse to a point, so those rows emit one triangle per column instead of two.
+template <typename Index, typename VertexFunction>
+std::unique_ptr<ddn::IMesh> CreateIndexedGridMesh(uint32_t column_count, uint32_t row_count, bool has_poles, VertexFunction&& vertex_function)
+{
+    const size_t row_size = size_t(column_count) + 1;
+    const size_t row_index_count = size_t(column_count) * 6;
+    const size_t pole_index_count = has_poles ? size_t(column_count) * 3 : 0;
+
+    std::vector<ddn::MeshVertex> vertices(row_size * (size_t(row_count) + 1));
+    ddn::ParallelFor(0, size_t(row_count) + 1, GetRowGrainSize(row_size), [&](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; ++row) {
+            for (size_t column = 0; column < row_size; ++column) {
+                vertices[row * row_size + column] = vertex_function(static_cast<uint32_t>(column), static_cast<uint32_t>(row));
+            }
+        }
+    });
+
+    std::vector<Index> indexes(row_count * row_index_count - 2 * pole_index_count);
+    ddn::ParallelFor(0, row_count, GetRowGrainSize(row_size), [&](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; ++row) {
+            auto* output = indexes.data() + row * row_index_count - (row > 0 ? pole_index_count : 0);
+            const bool is_first_skipped = has_poles && row == 0;
+            const bool is_second_skipped = has_poles && row + 1 == row_count;
+
+            for (size_t column = 0; column < column_count; ++column) {
+                const auto a = static_cast<Index>(row * row_size + column);
+                const auto b = static_cast<Index>(a + row_size);
+                if (!is_first_skipped) {
+                    *output++ = a;
+                    *output++ = b;
+                    *output++ = static_cast<Index>(a + 1);
+                }
+                if (!is_second_skipped) {
+                    *output++ = static_cast<Index>(a + 1);
+                    *output++ = b;
+                    *output++ = static_cast<Index>(b + 1);
+                }
+            }
+        }
+    });
+
+    return std::make_unique<ddn::Mesh<ddn::MeshVertex, Index>>(std::move(vertices), std::move(indexes));
+}
+
+template <typename VertexFunction>
+std::unique_ptr<ddn::IMesh> CreateGridMesh(uint32_t column_count, uint32_t row_count, bool has_poles, VertexFunction&& vertex_function)
+{
+    if (column_count == 0 || row_count == 0) {
+        throw std::invalid_argument("Expected at least one segment per axis");
+    }
+
+    const auto vertex_count = (size_t(column_count) + 1) * (size_t(row_count) + 1);
+    if (vertex_count > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Generated mesh exceeds 32-bit index range");
+    }
+
+    if (vertex_count <= s_max_16bit_vertex_count) {
+        return CreateIndexedGridMesh<uint16_t>(column_count, row_count, has_poles, vertex_function);
+    }
+    return CreateIndexedGridMesh<uint32_t>(column_count, row_count, has_poles, vertex_function);
+}
+
+}
+
+namespace ddn
+{
+
+std::unique_ptr<IMesh> CreateSphereMesh(const SphereDesc& desc)
+{
+    DDN_PROFILE_FUNCTION();
+
+    if (desc.slice_count < 3 || desc.stack_count < 2) {
+        throw std::invalid_argument("Sphere needs at least 3 slices and 2 stacks");
+    }
+
+    const float slice_step = glm::two_pi<float>() / desc.slice_count;
+    const float stack_step = glm::pi<float>() / desc.stack_count;
+    return CreateGridMesh(desc.slice_count, desc.stack_count, true, [&](uint32_t slice, uint32_t stack) {
+        const float phi = slice * slice_step;
+        const float theta = stack * stack_step;
+        const float sin_theta = std::sin(theta);
+        const glm::vec3 normal(sin_theta * std::cos(phi), std::cos(theta), -sin_theta * std::sin(phi));
+
+        MeshVertex vertex;
+        vertex.position = normal * desc.radius;
+        vertex.normal = normal;
+        vertex.uv = glm::vec2(static_cast<float>(slice) / desc.slice_count, static_cast<float>(stack) / desc.stack_count);
+        return vertex;
+    });
+}
+
+std::unique_ptr<IMesh> CreatePlaneMesh(const PlaneDesc& desc)
+{
+    DDN_PROFILE_FUNCTION();
+
+    const glm::vec2 step = desc.size / glm::vec2(static_cast<float>(desc.segment_count_x), static_cast<float>(desc.segment_count_z));
+    const glm::vec2 origin = desc.size * -0.5f;
+    return CreateGridMesh(desc.segment_count_x, desc.segment_count_z, false, [&](uint32_t x, uint32_t z) {
+        MeshVertex vertex;
+        vertex.position = glm::vec3(origin.x + x * step.x, 0.0f, origin.y + z * step.y);
+        vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+        vertex.uv = glm::vec2(static_cast<float>(x) / desc.segment_count_x, static_cast<float>(z) / desc.segment_count_z);
+        return vertex;
+    });
+}
+
+std::unique_ptr<IMesh> CreateTorusMesh(const TorusDesc& desc)
+{
+    DDN_PROFILE_FUNCTION();
+
+    if (desc.major_segment_count < 3 || desc.minor_segment_count < 3) {
+        throw std::invalid_argument("Torus needs at least 3 segments per ring");
+    }
+
+    const float major_step = glm::two_pi<float>() / desc.major_segment_count;
+    const float minor_step = glm::two_pi<float>() / desc.minor_segment_count;
+    return CreateGridMesh(desc.major_segment_count, desc.minor_segment_count, false, [&](uint32_t major, uint32_t minor) {
+        const float u = major * major_step;
+        const float v = minor * minor_step;
+        const glm::vec3 ring_direction(std::cos(u), 0.0f, std::sin(u));
+        const glm::vec3 normal = ring_direction * std::cos(v) + glm::vec3(0.0f, std::sin(v), 0.0f);
+
+        MeshVertex vertex;
+        vertex.position = ring_direction * desc.major_radius + normal * desc.minor_radius;
+        vertex.normal = normal;
+        vertex.uv = glm::vec2(static_cast<float>(major) / desc.major_segment_count, static_cast<float>(minor) / desc.minor_segment_count);
+        return vertex;
+    });
+}
+
+std::unique_ptr<IMesh> CreateHeightmapMesh(const HeightmapDesc& desc)
+{
+    DDN_PROFILE_FUNCTION();
+
+    if (desc.sample_count_x < 2 || desc.sample_count_z < 2) {
+        throw std::invalid_argument("Heightmap needs at least 2x2 samples");
+    }
+    if (desc.heights.size() < size_t(desc.sample_count_x) * desc.sample_count_z) {
+        throw std::invalid_argument("Heightmap has fewer samples than its dimensions");
+    }
+
+    const glm::vec2 step = desc.size / glm::vec2(static_cast<float>(desc.sample_count_x - 1), static_cast<float>(desc.sample_count_z - 1));
+    const glm::vec2 origin = desc.size * -0.5f;
+    const auto get_height = [&](uint32_t x, uint32_t z) {
+        return desc.heights[size_t(z) * desc.sample_count_x + x] * desc.height_scale;
+    };
+
+    return CreateGridMesh(desc.sample_count_x - 1, desc.sample_count_z - 1, false, [&](uint32_t x, uint32_t z) {
+        const auto left = x > 0 ? x - 1 : x;
+        const auto right = std::min(x + 1, desc.sample_count_x - 1);
+        const auto back = z > 0 ? z - 1 : z;
+        const auto front = std::min(z + 1, desc.sample_count_z - 1);
+        const float slope_x = (get_height(right, z) - get_height(left, z)) / ((right - left) * step.x);
+        const float slope_z = (get_height(x, front) - get_height(x, back)) / ((front - back) * step.y);
+
+        MeshVertex vertex;
+        vertex.position = glm::vec3(origin.x + x * step.x, get_height(x, z), origin.y + z * step.y);
+        vertex.normal = glm::normalize(glm::vec3(-slope_x, 1.0f, -slope_z));
+        vertex.uv = glm::vec2(static_cast<float>(x) / (desc.sample_count_x - 1), static_cast<float>(z) / (desc.sample_count_z - 1));
+        return vertex;
+    });
+}
+
+}  // namespace ddn
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "mesh.h"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <span>
+#include <memory>
+#include <cstdint>
+
+namespace ddn
+{
+
+struct MeshVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+};
+
+struct SphereDesc
+{
+    float radius = 1.0f;
+    uint32_t slice_count = 32;
+    uint32_t stack_count = 16;
+};
+
+struct PlaneDesc
+{
+    glm::vec2 size = glm::vec2(1.0f);
+    uint32_t segment_count_x = 1;
+    uint32_t segment_count_z = 1;
+};
+
+struct TorusDesc
+{
+    float major_radius = 1.0f;
+    float minor_radius = 0.25f;
+    uint32_t major_segment_count = 48;
+    uint32_t minor_segment_count = 24;
+};
+
+struct HeightmapDesc
+{
+    std::span<const float> heights;
+    uint32_t sample_count_x = 0;
+    uint32_t sample_count_z = 0;
+    glm::vec2 size = glm::vec2(1.0f);
+    float height_scale = 1.0f;
+};
+
+std::unique_ptr<IMesh> CreateSphereMesh(const SphereDesc& desc = {});
+std::unique_ptr<IMesh> CreatePlaneMesh(const PlaneDesc& desc = {});
+std::unique_ptr<IMesh> CreateTorusMesh(const TorusDesc& desc = {});
+std::unique_ptr<IMesh> CreateHeightmapMesh(const HeightmapDesc& desc);
+
+}  // namespace ddn
@@ -3,7 +3,9 @@
 #include <span>
 #include <vector>
 #include <cstdint>
+#include <cstring>
 #include <utility>
+#include <memory_resource>
 
 namespace ddn
 {
@@ -11,6 +13,8 @@ namespace ddn
 class IMesh
 {
 public:
+    virtual ~IMesh() = default;
+
     virtual std::span<const uint8_t> GetVertices() const = 0;
     virtual size_t GetVertexSize() const = 0;
     virtual size_t GetVertexCount() const = 0;
@@ -20,11 +24,28 @@ public:
     virtual size_t GetIndexCount() const = 0;
 };
 
-template <typename Vertex, typename Index>
+// Reads index i of an index buffer of 16- or 32-bit indexes, as returned by IMesh::GetIndexes.
+inline uint32_t ReadIndex(const uint8_t* indexes, size_t index_size, size_t i)
+{
+    if (index_size == sizeof(uint16_t)) {
+        uint16_t index;
+        std::memcpy(&index, indexes + i * sizeof(uint16_t), sizeof(index));
+        return index;
+    }
+
+    uint32_t index;
+    std::memcpy(&index, indexes + i * sizeof(uint32_t), sizeof(index));
+    return index;
+}
+
+template <typename Vertex, typename Index, template <typename> typename Allocator = std::allocator>
 class Mesh : public IMesh
 {
 public:
-    Mesh(std::vector<Vertex>&& vertices, std::vector<Index>&& indexes)
+    using VertexBuffer = std::vector<Vertex, Allocator<Vertex>>;
+    using IndexBuffer = std::vector<Index, Allocator<Index>>;
+
+    Mesh(VertexBuffer&& vertices, IndexBuffer&& indexes)
         : m_vertices(std::move(vertices))
         , m_indexes(std::move(indexes))
     {}
@@ -53,14 +74,23 @@ public:
         return m_indexes.size();
     }
 
+    std::span<Vertex> GetMutableVertices() {
+        return m_vertices;
+    }
+
 private:
-    template <typename T>
-    std::span<const uint8_t> CreateBuffer(const std::vector<T>& elements) const {
+    template <typename T, typename ElementAllocator>
+    std::span<const uint8_t> CreateBuffer(const std::vector<T, ElementAllocator>& elements) const {
         return std::span(reinterpret_cast<const uint8_t*>(elements.data()), sizeof(T) * elements.size());
     }
 
-    std::vector<Vertex> m_vertices;
-    std::vector<Index> m_indexes;
+    VertexBuffer m_vertices;
+    IndexBuffer m_indexes;
 };
 
+// Mesh whose buffers come from a std::pmr resource, e.g. a pool for long-lived meshes or a LinearArena
+// for meshes built and consumed within one frame.
+template <typename Vertex, typename Index>
+using PmrMesh = Mesh<Vertex, Index, std::pmr::polymorphic_allocator>;
+
 }  // namespace ddn
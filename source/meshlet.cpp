@@ -0,0 +1,605 @@
+#include "meshlet.h"
+#include "simd.h"
+#include "camera.h"
+#include "profiler.h"
+#include "thread-pool.h"
+#include "memory-tracker.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <array>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+using ddn::Float4;
+
+constexpr uint32_t s_lane_count = 4;
+constexpr uint8_t s_unassigned = 0xff;
+constexpr uint8_t s_candidate = 1;
+constexpr uint8_t s_emitted = 2;
+constexpr size_t s_partition_size = 65536;
+constexpr uint32_t s_no_triangle = std::numeric_limits<uint32_t>::max();
+constexpr size_t s_triangle_grain_size = 16384;
+constexpr size_t s_meshlet_grain_size = 256;
+constexpr size_t s_cull_chunk_size = 1024;
+// Cones whose normals spread this close to a hemisphere are too wide to reject anything in practice.
+constexpr float s_min_cone_spread = 0.1f;
+
+struct MeshletList
+{
+    std::vector<ddn::Meshlet> meshlets;
+    std::vector<uint32_t> vertex_indexes;
+    std::vector<uint8_t> triangle_indexes;
+};
+
+// Grows the meshlets of one partition on its own copy of the partition's topology, so partitions can be built
+// in parallel without sharing state. Each meshlet starts next to the previous one, or at the first free
+// triangle in Morton order, and then adds adjacent triangles by the fewest new vertices and then the distance
+// to its centroid. Triangles that would leave a vertex dangling are taken early, which avoids small islands.
+class MeshletGrower
+{
+public:
+    MeshletGrower(std::span<const uint32_t> indexes, std::span<const glm::vec3> centroids, std::span<const uint32_t> triangles)
+        : m_triangle_count(static_cast<uint32_t>(triangles.size()))
+    {
+        m_corners.resize(triangles.size() * 3);
+        m_centroids.resize(triangles.size());
+        for (size_t i = 0; i < triangles.size(); ++i) {
+            std::copy_n(&indexes[size_t(triangles[i]) * 3], 3, &m_corners[i * 3]);
+            m_centroids[i] = centroids[triangles[i]];
+        }
+
+        m_vertices = m_corners;
+        std::sort(m_vertices.begin(), m_vertices.end());
+        m_vertices.erase(std::unique(m_vertices.begin(), m_vertices.end()), m_vertices.end());
+        for (auto& corner : m_corners) {
+            corner = static_cast<uint32_t>(std::lower_bound(m_vertices.begin(), m_vertices.end(), corner) - m_vertices.begin());
+        }
+
+        const auto vertex_count = m_vertices.size();
+        m_live_counts.assign(vertex_count, 0);
+        for (const auto corner : m_corners) {
+            ++m_live_counts[corner];
+        }
+        m_adjacency_offsets.resize(vertex_count + 1);
+        m_adjacency_offsets[0] = 0;
+        for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+            m_adjacency_offsets[vertex + 1] = m_adjacency_offsets[vertex] + m_live_counts[vertex];
+        }
+        m_adjacent_triangles.resize(m_corners.size());
+        auto fill_offsets = m_adjacency_offsets;
+        for (size_t corner = 0; corner < m_corners.size(); ++corner) {
+            m_adjacent_triangles[fill_offsets[m_corners[corner]]++] = static_cast<uint32_t>(corner / 3);
+        }
+
+        m_local_indexes.assign(vertex_count, s_unassigned);
+        m_flags.assign(triangles.size(), 0);
+    }
+
+    void Grow(const ddn::MeshletDesc& desc, MeshletList& list)
+    {
+        uint32_t next_seed = 0;
+        auto seed = s_no_triangle;
+        while (true) {
+            if (seed == s_no_triangle) {
+                while (next_seed < m_triangle_count && (m_flags[next_seed] & s_emitted)) {
+                    ++next_seed;
+                }
+                if (next_seed == m_triangle_count) {
+                    break;
+                }
+                seed = next_seed;
+            }
+
+            AddTriangle(seed, list);
+            while (m_meshlet.triangle_count < desc.max_triangle_count) {
+                const auto center = m_centroid_sum / static_cast<float>(m_meshlet.triangle_count);
+                size_t best = m_candidates.size();
+                uint32_t best_priority = std::numeric_limits<uint32_t>::max();
+                uint32_t best_new_vertex_count = 0;
+                float best_distance = std::numeric_limits<float>::max();
+                for (size_t i = 0; i < m_candidates.size(); ++i) {
+                    const auto triangle = m_candidates[i];
+                    const auto new_vertex_count = CountNewVertices(triangle);
+                    const auto priority = GetPriority(triangle, new_vertex_count);
+                    if (priority > best_priority) {
+                        continue;
+                    }
+                    const auto offset = m_centroids[triangle] - center;
+                    const float distance = glm::dot(offset, offset);
+                    if (priority < best_priority || distance < best_distance) {
+                        best = i;
+                        best_priority = priority;
+                        best_new_vertex_count = new_vertex_count;
+                        best_distance = distance;
+                    }
+                    // Triangles that add no vertices only fill in the meshlet, so any of them will do.
+                    if (priority == 0) {
+                        break;
+                    }
+                }
+
+                if (best == m_candidates.size() || m_meshlet.vertex_count + best_new_vertex_count > desc.max_vertex_count) {
+                    break;
+                }
+
+                const auto triangle = m_candidates[best];
+                m_candidates[best] = m_candidates.back();
+                m_candidates.pop_back();
+                AddTriangle(triangle, list);
+            }
+
+            // The next meshlet continues from the candidate in the most consumed corner of this one.
+            seed = s_no_triangle;
+            uint32_t seed_live_count = std::numeric_limits<uint32_t>::max();
+            for (const auto triangle : m_candidates) {
+                const auto* corners = &m_corners[size_t(triangle) * 3];
+                const auto live_count = std::min({ m_live_counts[corners[0]], m_live_counts[corners[1]], m_live_counts[corners[2]] });
+                if (live_count < seed_live_count) {
+                    seed = triangle;
+                    seed_live_count = live_count;
+                }
+            }
+            CloseMeshlet(list);
+        }
+    }
+
+private:
+    uint32_t CountNewVertices(uint32_t triangle) const
+    {
+        const auto a = m_corners[size_t(triangle) * 3];
+        const auto b = m_corners[size_t(triangle) * 3 + 1];
+        const auto c = m_corners[size_t(triangle) * 3 + 2];
+        return (m_local_indexes[a] == s_unassigned) + (m_local_indexes[b] == s_unassigned && b != a) +
+            (m_local_indexes[c] == s_unassigned && c != a && c != b);
+    }
+
+    // 0 for triangles that add no vertices, 1 for triangles that add one or would otherwise leave a vertex
+    // with a single free triangle, and one more per additional new vertex.
+    uint32_t GetPriority(uint32_t triangle, uint32_t new_vertex_count) const
+    {
+        if (new_vertex_count == 0) {
+            return 0;
+        }
+        const auto* corners = &m_corners[size_t(triangle) * 3];
+        const bool is_dangling = m_live_counts[corners[0]] == 1 || m_live_counts[corners[1]] == 1 || m_live_counts[corners[2]] == 1;
+        return is_dangling ? 1 : new_vertex_count;
+    }
+
+    void AddTriangle(uint32_t triangle, MeshletList& list)
+    {
+        m_flags[triangle] = s_emitted;
+        const auto* corners = &m_corners[size_t(triangle) * 3];
+        for (size_t corner = 0; corner < 3; ++corner) {
+            const auto vertex = corners[corner];
+            --m_live_counts[vertex];
+            auto& local_index = m_local_indexes[vertex];
+            if (local_index == s_unassigned) {
+                local_index = static_cast<uint8_t>(m_meshlet.vertex_count++);
+                list.vertex_indexes.push_back(m_vertices[vertex]);
+                for (auto i = m_adjacency_offsets[vertex]; i < m_adjacency_offsets[vertex + 1]; ++i) {
+                    const auto adjacent = m_adjacent_triangles[i];
+                    if (m_flags[adjacent] == 0) {
+                        m_flags[adjacent] = s_candidate;
+                        m_candidates.push_back(adjacent);
+                    }
+                }
+            }
+            list.triangle_indexes.push_back(local_index);
+        }
+        ++m_meshlet.triangle_count;
+        m_centroid_sum += m_centroids[triangle];
+    }
+
+    void CloseMeshlet(MeshletList& list)
+    {
+        for (uint32_t i = 0; i < m_meshlet.vertex_count; ++i) {
+            const auto vertex = std::lower_bound(m_vertices.begin(), m_vertices.end(), list.vertex_indexes[m_meshlet.vertex_offset + i]);
+            m_local_indexes[vertex - m_vertices.begin()] = s_unassigned;
+        }
+        for (const auto triangle : m_candidates) {
+            m_flags[triangle] = 0;
+        }
+        m_candidates.clear();
+
+        list.meshlets.push_back(m_meshlet);
+        m_meshlet.vertex_offset = static_cast<uint32_t>(list.vertex_indexes.size());
+        m_meshlet.triangle_offset = static_cast<uint32_t>(list.triangle_indexes.size() / 3);
+        m_meshlet.vertex_count = 0;
+        m_meshlet.triangle_count = 0;
+        m_centroid_sum = glm::vec3(0.0f);
+    }
+
+private:
+    uint32_t m_triangle_count = 0;
+    std::vector<uint32_t> m_corners;
+    std::vector<glm::vec3> m_centroids;
+    std::vector<uint32_t> m_vertices;
+    std::vector<uint32_t> m_live_counts;
+    std::vector<uint32_t> m_adjacency_offsets;
+    std::vector<uint32_t> m_adjacent_triangles;
+    std::vector<uint8_t> m_local_indexes;
+    std::vector<uint8_t> m_flags;
+    std::vector<uint32_t> m_candidates;
+    ddn::Meshlet m_meshlet;
+    glm::vec3 m_centroid_sum = glm::vec3(0.0f);
+};
+
+uint32_t ExpandBits(uint32_t value)
+{
+    value = (value * 0x00010001u) & 0xff0000ffu;
+    value = (value * 0x00000101u) & 0x0f00f00fu;
+    value = (value * 0x00000011u) & 0xc30c30c3u;
+    value = (value * 0x00000005u) & 0x49249249u;
+    return value;
+}
+
+uint32_t GetMortonCode(const glm::vec3& position)
+{
+    const auto cell = glm::clamp(position * 1024.0f, glm::vec3(0.0f), glm::vec3(1023.0f));
+    return ExpandBits(uint32_t(cell.x)) << 2 | ExpandBits(uint32_t(cell.y)) << 1 | ExpandBits(uint32_t(cell.z));
+}
+
+}
+
+namespace ddn
+{
+
+MeshletMesh::MeshletMesh(const IMesh& mesh, size_t position_offset, const MeshletDesc& desc)
+{
+    DDN_PROFILE_FUNCTION();
+
+    if (desc.max_vertex_count < 3 || desc.max_vertex_count > s_unassigned) {
+        throw std::invalid_argument("Meshlet vertex count must be between 3 and 255");
+    }
+    if (desc.max_triangle_count == 0) {
+        throw std::invalid_argument("Meshlet triangle count must not be zero");
+    }
+
+    const auto index_size = mesh.GetIndexSize();
+    if (index_size != sizeof(uint16_t) && index_size != sizeof(uint32_t)) {
+        throw std::invalid_argument("Unsupported index size");
+    }
+
+    const auto vertex_size = mesh.GetVertexSize();
+    if (position_offset + sizeof(glm::vec3) > vertex_size) {
+        throw std::invalid_argument("Vertex attribute offset exceeds vertex size");
+    }
+
+    const auto corner_count = mesh.GetIndexCount() - mesh.GetIndexCount() % 3;
+    if (corner_count > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Mesh has too many indexes");
+    }
+
+    MemoryTagScope tag_scope(MemoryTag::Mesh);
+    const auto vertex_count = mesh.GetVertexCount();
+    const auto vertices = mesh.GetVertices();
+    std::vector<glm::vec3> positions(vertex_count);
+    ParallelFor(0, vertex_count, s_triangle_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            std::memcpy(&positions[i], vertices.data() + i * vertex_size + position_offset, sizeof(glm::vec3));
+        }
+    });
+
+    const auto index_data = mesh.GetIndexes();
+    std::vector<uint32_t> indexes(corner_count);
+    ParallelFor(0, corner_count, s_triangle_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            indexes[i] = ReadIndex(index_data.data(), index_size, i);
+            if (indexes[i] >= vertex_count) {
+                throw std::out_of_range("Index exceeds vertex count");
+            }
+        }
+    });
+
+    BuildMeshlets(indexes, positions, desc);
+    ComputeBounds(positions);
+}
+
+std::span<const Meshlet> MeshletMesh::GetMeshlets() const
+{
+    return m_meshlets;
+}
+
+std::span<const MeshletBounds> MeshletMesh::GetBounds() const
+{
+    return m_bounds;
+}
+
+std::span<const uint32_t> MeshletMesh::GetVertexIndexes() const
+{
+    return m_vertex_indexes;
+}
+
+std::span<const uint8_t> MeshletMesh::GetTriangleIndexes() const
+{
+    return m_triangle_indexes;
+}
+
+const MeshletCullData& MeshletMesh::GetCullData() const
+{
+    return m_cull_data;
+}
+
+size_t MeshletMesh::GetMeshletCount() const
+{
+    return m_meshlets.size();
+}
+
+size_t MeshletMesh::GetTriangleCount() const
+{
+    return m_triangle_indexes.size() / 3;
+}
+
+void MeshletMesh::BuildMeshlets(std::span<const uint32_t> indexes, std::span<const glm::vec3> positions, const MeshletDesc& desc)
+{
+    DDN_PROFILE_FUNCTION();
+
+    const auto triangle_count = indexes.size() / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+
+    auto min = glm::vec3(std::numeric_limits<float>::max());
+    auto max = glm::vec3(std::numeric_limits<float>::lowest());
+    for (const auto index : indexes) {
+        min = glm::min(min, positions[index]);
+        max = glm::max(max, positions[index]);
+    }
+    const auto scale = 1.0f / glm::max(max - min, glm::vec3(std::numeric_limits<float>::min()));
+
+    // Morton code in the high half, triangle in the low half, so one sort orders triangles along the curve.
+    std::vector<glm::vec3> centroids(triangle_count);
+    std::vector<uint64_t> keys(triangle_count);
+    ParallelFor(0, triangle_count, s_triangle_grain_size, [&](size_t begin, size_t end) {
+        for (size_t triangle = begin; triangle < end; ++triangle) {
+            const auto* corners = &indexes[triangle * 3];
+            centroids[triangle] = (positions[corners[0]] + positions[corners[1]] + positions[corners[2]]) * (1.0f / 3.0f);
+            keys[triangle] = uint64_t(GetMortonCode((centroids[triangle] - min) * scale)) << 32 | triangle;
+        }
+    });
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<uint32_t> sorted_triangles(triangle_count);
+    for (size_t i = 0; i < triangle_count; ++i) {
+        sorted_triangles[i] = static_cast<uint32_t>(keys[i]);
+    }
+
+    // Consecutive runs of the Morton order form partitions that grow their meshlets independently.
+    const auto partition_count = (triangle_count + s_partition_size - 1) / s_partition_size;
+    std::vector<MeshletList> lists(partition_count);
+    ParallelFor(0, partition_count, 1, [&](size_t begin, size_t end) {
+        for (size_t partition = begin; partition < end; ++partition) {
+            const auto first = partition * s_partition_size;
+            const auto triangles = std::span(sorted_triangles).subspan(first, std::min(s_partition_size, triangle_count - first));
+            MeshletGrower(indexes, centroids, triangles).Grow(desc, lists[partition]);
+        }
+    });
+
+    m_vertex_indexes.reserve(triangle_count);
+    m_triangle_indexes.reserve(triangle_count * 3);
+    for (const auto& list : lists) {
+        const auto vertex_offset = static_cast<uint32_t>(m_vertex_indexes.size());
+        const auto triangle_offset = static_cast<uint32_t>(m_triangle_indexes.size() / 3);
+        for (auto meshlet : list.meshlets) {
+            meshlet.vertex_offset += vertex_offset;
+            meshlet.triangle_offset += triangle_offset;
+            m_meshlets.push_back(meshlet);
+        }
+        m_vertex_indexes.insert(m_vertex_indexes.end(), list.vertex_indexes.begin(), list.vertex_indexes.end());
+        m_triangle_indexes.insert(m_triangle_indexes.end(), list.triangle_indexes.begin(), list.triangle_indexes.end());
+    }
+}
+
+void MeshletMesh::ComputeBounds(std::span<const glm::vec3> positions)
+{
+    DDN_PROFILE_FUNCTION();
+
+    const auto meshlet_count = m_meshlets.size();
+    const auto padded_count = (meshlet_count + s_lane_count - 1) / s_lane_count * s_lane_count;
+    m_bounds.resize(meshlet_count);
+    for (auto* stream : { &m_cull_data.center_x, &m_cull_data.center_y, &m_cull_data.center_z, &m_cull_data.radius,
+             &m_cull_data.axis_x, &m_cull_data.axis_y, &m_cull_data.axis_z, &m_cull_data.cutoff }) {
+        stream->assign(padded_count, 0.0f);
+    }
+
+    ParallelFor(0, meshlet_count, s_meshlet_grain_size, [&](size_t begin, size_t end) {
+        std::vector<glm::vec3> normals;
+        for (size_t i = begin; i < end; ++i) {
+            const auto& meshlet = m_meshlets[i];
+            const auto vertexes = std::span(m_vertex_indexes).subspan(meshlet.vertex_offset, meshlet.vertex_count);
+            const auto triangles = std::span(m_triangle_indexes).subspan(size_t(meshlet.triangle_offset) * 3, size_t(meshlet.triangle_count) * 3);
+
+            auto min = positions[vertexes[0]];
+            auto max = min;
+            for (const auto vertex : vertexes) {
+                min = glm::min(min, positions[vertex]);
+                max = glm::max(max, positions[vertex]);
+            }
+
+            auto& bounds = m_bounds[i];
+            bounds.sphere.center = (min + max) * 0.5f;
+            float radius_squared = 0.0f;
+            for (const auto vertex : vertexes) {
+                const auto offset = positions[vertex] - bounds.sphere.center;
+                radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+            }
+            bounds.sphere.radius = std::sqrt(radius_squared);
+
+            // Unweighted normals, so slivers count as much as large triangles towards the cone.
+            normals.clear();
+            auto axis = glm::vec3(0.0f);
+            for (size_t corner = 0; corner < triangles.size(); corner += 3) {
+                const auto p0 = positions[vertexes[triangles[corner]]];
+                const auto normal = glm::cross(positions[vertexes[triangles[corner + 1]]] - p0, positions[vertexes[triangles[corner + 2]]] - p0);
+                const float length = glm::length(normal);
+                if (length > 0.0f) {
+                    normals.push_back(normal / length);
+                    axis += normals.back();
+                }
+            }
+
+            const float axis_length = glm::length(axis);
+            if (axis_length > 0.0f) {
+                axis /= axis_length;
+                float min_dot = 1.0f;
+                for (const auto& normal : normals) {
+                    min_dot = std::min(min_dot, glm::dot(normal, axis));
+                }
+
+                // The cone of view directions that see only back faces is the normal cone widened by 90
+                // degrees, whose cosine is the sine of the normal spread.
+                bounds.cone_axis = axis;
+                bounds.cone_cutoff = min_dot > s_min_cone_spread ? std::sqrt(1.0f - min_dot * min_dot) : 1.0f;
+            }
+
+            m_cull_data.center_x[i] = bounds.sphere.center.x;
+            m_cull_data.center_y[i] = bounds.sphere.center.y;
+            m_cull_data.center_z[i] = bounds.sphere.center.z;
+            m_cull_data.radius[i] = bounds.sphere.radius;
+            m_cull_data.axis_x[i] = bounds.cone_axis.x;
+            m_cull_data.axis_y[i] = bounds.cone_axis.y;
+            m_cull_data.axis_z[i] = bounds.cone_axis.z;
+            m_cull_data.cutoff[i] = bounds.cone_cutoff;
+        }
+    });
+}
+
+void MeshletCuller::BeginFrame()
+{
+    m_statistics = {};
+}
+
+void MeshletCuller::Cull(const MeshletMesh& mesh, const Camera& camera, std::vector<uint32_t>& indexes)
+{
+    Cull(mesh, camera, glm::mat4(1.0f), indexes);
+}
+
+void MeshletCuller::Cull(const MeshletMesh& mesh, const Camera& camera, const glm::mat4& model_matrix, std::vector<uint32_t>& indexes)
+{
+    DDN_PROFILE_FUNCTION();
+    ScopedTimer timer(m_statistics.cull_ms);
+
+    const auto meshlets = mesh.GetMeshlets();
+    const auto& data = mesh.GetCullData();
+    const auto meshlet_count = meshlets.size();
+    const auto chunk_count = (meshlet_count + s_cull_chunk_size - 1) / s_cull_chunk_size;
+    m_visibility.resize(meshlet_count);
+    m_chunk_counts.assign(chunk_count, {});
+    m_chunk_offsets.resize(chunk_count + 1);
+
+    // The tests run in model space: planes transform with the transposed model matrix and the camera
+    // position with its inverse.
+    const auto transposed_model_matrix = glm::transpose(model_matrix);
+    std::array<glm::vec4, static_cast<size_t>(FrustumPlane::Count)> planes;
+    for (size_t i = 0; i < planes.size(); ++i) {
+        planes[i] = NormalizePlane(transposed_model_matrix * camera.GetFrustum().planes[i]);
+    }
+    const auto eye = glm::vec3(glm::inverse(model_matrix) * glm::vec4(camera.GetPosition(), 1.0f));
+
+    ParallelFor(0, chunk_count, 1, [&](size_t begin, size_t end) {
+        DDN_PROFILE_SCOPE("MeshletCuller::Test");
+        std::array<Float4, static_cast<size_t>(FrustumPlane::Count) * 4> plane_components;
+        for (size_t i = 0; i < planes.size(); ++i) {
+            plane_components[i * 4 + 0] = Float4::Splat(planes[i].x);
+            plane_components[i * 4 + 1] = Float4::Splat(planes[i].y);
+            plane_components[i * 4 + 2] = Float4::Splat(planes[i].z);
+            plane_components[i * 4 + 3] = Float4::Splat(planes[i].w);
+        }
+        const auto eye_x = Float4::Splat(eye.x);
+        const auto eye_y = Float4::Splat(eye.y);
+        const auto eye_z = Float4::Splat(eye.z);
+
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            auto& counts = m_chunk_counts[chunk];
+            const auto first = chunk * s_cull_chunk_size;
+            const auto last = std::min(meshlet_count, first + s_cull_chunk_size);
+            for (size_t i = first; i < last; i += s_lane_count) {
+                const auto center_x = Float4::Load(&data.center_x[i]);
+                const auto center_y = Float4::Load(&data.center_y[i]);
+                const auto center_z = Float4::Load(&data.center_z[i]);
+                const auto radius = Float4::Load(&data.radius[i]);
+                const auto negative_radius = Float4::Splat(0.0f) - radius;
+
+                uint32_t inside_bits = 0xf;
+                for (size_t plane = 0; plane < planes.size(); ++plane) {
+                    const auto* p = &plane_components[plane * 4];
+                    const auto distance = p[0] * center_x + p[1] * center_y + p[2] * center_z + p[3];
+                    inside_bits &= GetBits(distance >= negative_radius);
+                }
+
+                const auto offset_x = center_x - eye_x;
+                const auto offset_y = center_y - eye_y;
+                const auto offset_z = center_z - eye_z;
+                const auto distance = Sqrt(offset_x * offset_x + offset_y * offset_y + offset_z * offset_z);
+                const auto cone_dot = offset_x * Float4::Load(&data.axis_x[i]) + offset_y * Float4::Load(&data.axis_y[i]) + offset_z * Float4::Load(&data.axis_z[i]);
+                const uint32_t back_facing_bits = GetBits(cone_dot >= Float4::Load(&data.cutoff[i]) * distance + radius);
+
+                const auto lane_count = std::min<size_t>(s_lane_count, last - i);
+                for (size_t lane = 0; lane < lane_count; ++lane) {
+                    const auto triangle_count = meshlets[i + lane].triangle_count;
+                    if ((inside_bits >> lane & 1) == 0) {
+                        m_visibility[i + lane] = Visibility::FrustumCulled;
+                        counts.frustum_rejected_triangle_count += triangle_count;
+                    } else if (back_facing_bits >> lane & 1) {
+                        m_visibility[i + lane] = Visibility::ConeCulled;
+                        counts.cone_rejected_triangle_count += triangle_count;
+                    } else {
+                        m_visibility[i + lane] = Visibility::Visible;
+                        counts.visible_triangle_count += triangle_count;
+                        ++counts.visible_meshlet_count;
+                    }
+                }
+            }
+        }
+    });
+
+    m_chunk_offsets[0] = 0;
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+        const auto& counts = m_chunk_counts[chunk];
+        m_chunk_offsets[chunk + 1] = m_chunk_offsets[chunk] + counts.visible_triangle_count;
+        m_statistics.visible_meshlet_count += counts.visible_meshlet_count;
+        m_statistics.frustum_rejected_triangle_count += counts.frustum_rejected_triangle_count;
+        m_statistics.cone_rejected_triangle_count += counts.cone_rejected_triangle_count;
+    }
+    m_statistics.meshlet_count += static_cast<uint32_t>(meshlet_count);
+    m_statistics.triangle_count += mesh.GetTriangleCount();
+
+    const auto first_index = indexes.size();
+    indexes.resize(first_index + m_chunk_offsets[chunk_count] * 3);
+
+    const auto vertex_indexes = mesh.GetVertexIndexes();
+    const auto triangle_indexes = mesh.GetTriangleIndexes();
+    ParallelFor(0, chunk_count, 1, [&](size_t begin, size_t end) {
+        DDN_PROFILE_SCOPE("MeshletCuller::Compact");
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            auto* output = indexes.data() + first_index + m_chunk_offsets[chunk] * 3;
+            const auto last = std::min(meshlet_count, (chunk + 1) * s_cull_chunk_size);
+            for (size_t i = chunk * s_cull_chunk_size; i < last; ++i) {
+                if (m_visibility[i] != Visibility::Visible) {
+                    continue;
+                }
+
+                const auto& meshlet = meshlets[i];
+                const auto* vertexes = &vertex_indexes[meshlet.vertex_offset];
+                const auto* triangles = &triangle_indexes[size_t(meshlet.triangle_offset) * 3];
+                for (size_t corner = 0; corner < size_t(meshlet.triangle_count) * 3; ++corner) {
+                    *output++ = vertexes[triangles[corner]];
+                }
+            }
+        }
+    });
+}
+
+const MeshletCullStatistics& MeshletCuller::GetStatistics() const
+{
+    return m_statistics;
+}
+
+}  // namespace ddn
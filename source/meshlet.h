@@ -0,0 +1,137 @@
+#pragma once
+
+#include "mesh.h"
+#include "bounds.h"
+#include "mesh-attributes.h"
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+class Camera;
+
+struct MeshletDesc
+{
+    uint32_t max_vertex_count = 64;
+    uint32_t max_triangle_count = 124;
+};
+
+// Offsets index GetVertexIndexes and triangles, i.e. triples of GetTriangleIndexes.
+struct Meshlet
+{
+    uint32_t vertex_offset = 0;
+    uint32_t triangle_offset = 0;
+    uint32_t vertex_count = 0;
+    uint32_t triangle_count = 0;
+};
+
+// The cone bounds the geometric normals of the meshlet's triangles. A cutoff of 1 means the normals spread
+// too far for the cone to ever reject the meshlet.
+struct MeshletBounds
+{
+    Sphere sphere;
+    glm::vec3 cone_axis = glm::vec3(0.0f);
+    float cone_cutoff = 1.0f;
+};
+
+// Meshlet culling data as one stream per component, padded to a multiple of the SIMD width.
+struct MeshletCullData
+{
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> radius;
+    std::vector<float> axis_x;
+    std::vector<float> axis_y;
+    std::vector<float> axis_z;
+    std::vector<float> cutoff;
+};
+
+// Splits a mesh into clusters of at most max_vertex_count vertices and max_triangle_count triangles. Meshlets
+// grow greedily over shared vertices from seeds taken in Morton order, in parallel over runs of that order.
+// Meshlet vertices index the source mesh; meshlet triangles are three local uint8 indexes each.
+class MeshletMesh
+{
+public:
+    MeshletMesh(const IMesh& mesh, size_t position_offset, const MeshletDesc& desc = {});
+
+    std::span<const Meshlet> GetMeshlets() const;
+    std::span<const MeshletBounds> GetBounds() const;
+    std::span<const uint32_t> GetVertexIndexes() const;
+    std::span<const uint8_t> GetTriangleIndexes() const;
+    const MeshletCullData& GetCullData() const;
+
+    size_t GetMeshletCount() const;
+    size_t GetTriangleCount() const;
+
+private:
+    void BuildMeshlets(std::span<const uint32_t> indexes, std::span<const glm::vec3> positions, const MeshletDesc& desc);
+    void ComputeBounds(std::span<const glm::vec3> positions);
+
+private:
+    std::vector<Meshlet> m_meshlets;
+    std::vector<MeshletBounds> m_bounds;
+    std::vector<uint32_t> m_vertex_indexes;
+    std::vector<uint8_t> m_triangle_indexes;
+    MeshletCullData m_cull_data;
+};
+
+template <typename Vertex, typename Index, template <typename> typename Allocator>
+MeshletMesh BuildMeshlets(const Mesh<Vertex, Index, Allocator>& mesh, glm::vec3 Vertex::* position, const MeshletDesc& desc = {})
+{
+    return MeshletMesh(mesh, GetMemberOffset(Vertex(), position), desc);
+}
+
+struct MeshletCullStatistics
+{
+    double cull_ms = 0.0;
+    uint32_t meshlet_count = 0;
+    uint32_t visible_meshlet_count = 0;
+    uint64_t triangle_count = 0;
+    uint64_t frustum_rejected_triangle_count = 0;
+    uint64_t cone_rejected_triangle_count = 0;
+};
+
+// Culls meshlets against the camera frustum and their normal cones, and appends the triangles of the
+// surviving meshlets to one index stream that can be drawn with the source mesh's vertex buffer. The cone
+// test assumes model matrices without non-uniform scale. Statistics accumulate until the next BeginFrame.
+class MeshletCuller
+{
+public:
+    void BeginFrame();
+
+    void Cull(const MeshletMesh& mesh, const Camera& camera, std::vector<uint32_t>& indexes);
+    void Cull(const MeshletMesh& mesh, const Camera& camera, const glm::mat4& model_matrix, std::vector<uint32_t>& indexes);
+
+    const MeshletCullStatistics& GetStatistics() const;
+
+private:
+    enum class Visibility : uint8_t
+    {
+        Visible,
+        FrustumCulled,
+        ConeCulled,
+    };
+
+    struct ChunkCounts
+    {
+        uint64_t visible_triangle_count = 0;
+        uint64_t frustum_rejected_triangle_count = 0;
+        uint64_t cone_rejected_triangle_count = 0;
+        uint32_t visible_meshlet_count = 0;
+    };
+
+private:
+    MeshletCullStatistics m_statistics;
+    std::vector<Visibility> m_visibility;
+    std::vector<ChunkCounts> m_chunk_counts;
+    std::vector<uint64_t> m_chunk_offsets;
+};
+
+}  // namespace ddn
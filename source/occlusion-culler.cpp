@@ -0,0 +1,367 @@
+#include "occlusion-culler.h"
+#include "simd.h"
+#include "profiler.h"
+#include "thread-pool.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr uint32_t s_tile_size = 8;
+constexpr uint32_t s_tile_pixel_count = s_tile_size * s_tile_size;
+constexpr size_t s_vertex_grain_size = 4096;
+constexpr size_t s_test_grain_size = 256;
+
+}
+
+namespace ddn
+{
+
+OcclusionCuller::OcclusionCuller(const OcclusionCullerDesc& desc)
+    : m_desc(desc)
+    , m_projection_view_matrix(1.0f)
+{
+    if (desc.width == 0 || desc.height == 0) {
+        throw std::invalid_argument("Expected non-zero occlusion buffer size");
+    }
+
+    m_tile_count_x = (desc.width + s_tile_size - 1) / s_tile_size;
+    m_tile_count_y = (desc.height + s_tile_size - 1) / s_tile_size;
+    m_depth.resize(static_cast<size_t>(m_tile_count_x) * m_tile_count_y * s_tile_pixel_count);
+    m_tile_depth.resize(static_cast<size_t>(m_tile_count_x) * m_tile_count_y);
+    m_tile_row_triangles.resize(m_tile_count_y);
+}
+
+void OcclusionCuller::BeginFrame(const glm::mat4& projection_view_matrix)
+{
+    m_projection_view_matrix = projection_view_matrix;
+    m_triangles.clear();
+    m_statistics = {};
+}
+
+void OcclusionCuller::AddOccluder(const IMesh& mesh, const glm::mat4& model_matrix, size_t position_offset)
+{
+    DDN_PROFILE_FUNCTION();
+    ScopedTimer timer(m_statistics.rasterization_ms);
+
+    const auto index_size = mesh.GetIndexSize();
+    if (index_size != sizeof(uint16_t) && index_size != sizeof(uint32_t)) {
+        throw std::invalid_argument("Unsupported index size");
+    }
+
+    const auto vertex_size = mesh.GetVertexSize();
+    if (position_offset + sizeof(glm::vec3) > vertex_size) {
+        throw std::invalid_argument("Position offset exceeds vertex size");
+    }
+
+    const auto vertices = mesh.GetVertices();
+    const auto vertex_count = mesh.GetVertexCount();
+    const auto transform = m_projection_view_matrix * model_matrix;
+
+    m_clip_positions.resize(vertex_count);
+    ParallelFor(0, vertex_count, s_vertex_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            glm::vec3 position;
+            std::memcpy(&position, vertices.data() + i * vertex_size + position_offset, sizeof(position));
+            m_clip_positions[i] = transform * glm::vec4(position, 1.0f);
+        }
+    });
+
+    const auto indexes = mesh.GetIndexes();
+    const auto index_count = mesh.GetIndexCount() - mesh.GetIndexCount() % 3;
+    for (size_t i = 0; i < index_count; i += 3) {
+        const auto i0 = ReadIndex(indexes.data(), index_size, i);
+        const auto i1 = ReadIndex(indexes.data(), index_size, i + 1);
+        const auto i2 = ReadIndex(indexes.data(), index_size, i + 2);
+        if (i0 >= vertex_count || i1 >= vertex_count || i2 >= vertex_count) {
+            throw std::out_of_range("Index exceeds vertex count");
+        }
+        SetupTriangle(m_clip_positions[i0], m_clip_positions[i1], m_clip_positions[i2]);
+    }
+    m_statistics.occluder_triangle_count += static_cast<uint32_t>(index_count / 3);
+}
+
+void OcclusionCuller::Rasterize()
+{
+    DDN_PROFILE_FUNCTION();
+    ScopedTimer timer(m_statistics.rasterization_ms);
+
+    for (auto& triangles : m_tile_row_triangles) {
+        triangles.clear();
+    }
+
+    for (uint32_t i = 0; i < m_triangles.size(); ++i) {
+        const auto& triangle = m_triangles[i];
+        const auto begin_row = static_cast<uint32_t>(triangle.min_y) / s_tile_size;
+        const auto end_row = static_cast<uint32_t>(triangle.max_y) / s_tile_size;
+        for (uint32_t row = begin_row; row <= end_row; ++row) {
+            m_tile_row_triangles[row].push_back(i);
+        }
+    }
+    m_statistics.rasterized_triangle_count = static_cast<uint32_t>(m_triangles.size());
+
+    ParallelFor(0, m_tile_count_y, 1, [&](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; ++row) {
+            auto* row_depth = m_depth.data() + row * m_tile_count_x * s_tile_pixel_count;
+            std::fill(row_depth, row_depth + m_tile_count_x * s_tile_pixel_count, 0.0f);
+
+            const auto min_y = static_cast<int32_t>(row * s_tile_size);
+            const auto max_y = min_y + static_cast<int32_t>(s_tile_size) - 1;
+            for (const auto triangle_index : m_tile_row_triangles[row]) {
+                RasterizeTriangle(m_triangles[triangle_index], min_y, max_y);
+            }
+
+            UpdateTileDepth(static_cast<uint32_t>(row));
+        }
+    });
+}
+
+bool OcclusionCuller::IsVisible(const Aabb& aabb) const
+{
+    const auto& m = m_projection_view_matrix;
+    const auto corner_x = Float4::Set(aabb.min.x, aabb.max.x, aabb.min.x, aabb.max.x);
+    const auto corner_y = Float4::Set(aabb.min.y, aabb.min.y, aabb.max.y, aabb.max.y);
+
+    const auto min_w = Float4::Splat(m_desc.min_w);
+    const auto half_width = Float4::Splat(0.5f * m_desc.width);
+    const auto half_height = Float4::Splat(0.5f * m_desc.height);
+
+    auto screen_min_x = Float4::Splat(std::numeric_limits<float>::max());
+    auto screen_min_y = screen_min_x;
+    auto screen_max_x = Float4::Splat(std::numeric_limits<float>::lowest());
+    auto screen_max_y = screen_max_x;
+    auto nearest_depth = Float4::Splat(0.0f);
+
+    for (const float z : { aabb.min.z, aabb.max.z }) {
+        const auto clip_x = Float4::Splat(m[0][0]) * corner_x + Float4::Splat(m[1][0]) * corner_y + Float4::Splat(m[2][0] * z + m[3][0]);
+        const auto clip_y = Float4::Splat(m[0][1]) * corner_x + Float4::Splat(m[1][1]) * corner_y + Float4::Splat(m[2][1] * z + m[3][1]);
+        const auto clip_w = Float4::Splat(m[0][3]) * corner_x + Float4::Splat(m[1][3]) * corner_y + Float4::Splat(m[2][3] * z + m[3][3]);
+        if (AnyTrue(clip_w < min_w)) {
+            return true;
+        }
+
+        const auto inverse_w = Float4::Splat(1.0f) / clip_w;
+        const auto screen_x = (clip_x * inverse_w + Float4::Splat(1.0f)) * half_width;
+        const auto screen_y = (Float4::Splat(1.0f) - clip_y * inverse_w) * half_height;
+
+        screen_min_x = Min(screen_min_x, screen_x);
+        screen_min_y = Min(screen_min_y, screen_y);
+        screen_max_x = Max(screen_max_x, screen_x);
+        screen_max_y = Max(screen_max_y, screen_y);
+        nearest_depth = Max(nearest_depth, inverse_w);
+    }
+
+    const float min_x = HorizontalMin(screen_min_x);
+    const float min_y = HorizontalMin(screen_min_y);
+    const float max_x = HorizontalMax(screen_max_x);
+    const float max_y = HorizontalMax(screen_max_y);
+    if (max_x < 0.0f || max_y < 0.0f || min_x >= m_desc.width || min_y >= m_desc.height) {
+        return false;
+    }
+
+    const auto begin_x = static_cast<uint32_t>(std::max(0.0f, std::floor(min_x)));
+    const auto begin_y = static_cast<uint32_t>(std::max(0.0f, std::floor(min_y)));
+    const auto end_x = std::min(m_desc.width - 1, static_cast<uint32_t>(std::floor(max_x)));
+    const auto end_y = std::min(m_desc.height - 1, static_cast<uint32_t>(std::floor(max_y)));
+    const float depth = HorizontalMax(nearest_depth);
+    const auto depth4 = Float4::Splat(depth);
+
+    for (uint32_t tile_y = begin_y / s_tile_size; tile_y <= end_y / s_tile_size; ++tile_y) {
+        for (uint32_t tile_x = begin_x / s_tile_size; tile_x <= end_x / s_tile_size; ++tile_x) {
+            const auto tile_index = tile_y * m_tile_count_x + tile_x;
+            if (m_tile_depth[tile_index] > depth) {
+                continue;
+            }
+
+            const auto tile_begin_x = tile_x * s_tile_size;
+            const auto tile_begin_y = tile_y * s_tile_size;
+            const auto row_begin = std::max(begin_y, tile_begin_y) - tile_begin_y;
+            const auto row_end = std::min(end_y, tile_begin_y + s_tile_size - 1) - tile_begin_y;
+            const auto column_begin = Float4::Splat(static_cast<float>(std::max(begin_x, tile_begin_x) - tile_begin_x));
+            const auto column_end = Float4::Splat(static_cast<float>(std::min(end_x, tile_begin_x + s_tile_size - 1) - tile_begin_x));
+
+            const float* tile_depth = m_depth.data() + static_cast<size_t>(tile_index) * s_tile_pixel_count;
+            for (uint32_t row = row_begin; row <= row_end; ++row) {
+                for (uint32_t column = 0; column < s_tile_size; column += 4) {
+                    const auto columns = Float4::Set(column + 0.0f, column + 1.0f, column + 2.0f, column + 3.0f);
+                    const auto in_range = (columns >= column_begin) & (columns <= column_end);
+                    const auto pixel_depth = Float4::Load(tile_depth + row * s_tile_size + column);
+                    if (AnyTrue(in_range & (pixel_depth <= depth4))) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+void OcclusionCuller::Cull(std::span<const Aabb> bounds, std::span<const uint32_t> items, std::vector<uint32_t>& visible_items)
+{
+    DDN_PROFILE_FUNCTION();
+    ScopedTimer timer(m_statistics.test_ms);
+
+    m_visibility.resize(items.size());
+    ParallelFor(0, items.size(), s_test_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_visibility[i] = IsVisible(bounds[items[i]]) ? 1 : 0;
+        }
+    });
+
+    visible_items.clear();
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (m_visibility[i]) {
+            visible_items.push_back(items[i]);
+        }
+    }
+
+    m_statistics.tested_count += static_cast<uint32_t>(items.size());
+    m_statistics.occluded_count += static_cast<uint32_t>(items.size() - visible_items.size());
+}
+
+uint32_t OcclusionCuller::GetWidth() const
+{
+    return m_desc.width;
+}
+
+uint32_t OcclusionCuller::GetHeight() const
+{
+    return m_desc.height;
+}
+
+float OcclusionCuller::GetDepth(uint32_t x, uint32_t y) const
+{
+    return m_depth.at(GetPixelOffset(x, y));
+}
+
+const OcclusionStatistics& OcclusionCuller::GetStatistics() const
+{
+    return m_statistics;
+}
+
+void OcclusionCuller::SetupTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2)
+{
+    if (clip0.w < m_desc.min_w || clip1.w < m_desc.min_w || clip2.w < m_desc.min_w) {
+        return;
+    }
+
+    const float half_width = 0.5f * m_desc.width;
+    const float half_height = 0.5f * m_desc.height;
+    float x[3];
+    float y[3];
+    float z[3];
+    const glm::vec4* clips[3] = { &clip0, &clip1, &clip2 };
+    for (int i = 0; i < 3; ++i) {
+        z[i] = 1.0f / clips[i]->w;
+        x[i] = (clips[i]->x * z[i] + 1.0f) * half_width;
+        y[i] = (1.0f - clips[i]->y * z[i]) * half_height;
+    }
+
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (std::fabs(area) < 1e-6f) {
+        return;
+    }
+    if (area < 0.0f) {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(z[1], z[2]);
+        area = -area;
+    }
+
+    Triangle triangle;
+    triangle.min_x = std::max(0, static_cast<int32_t>(std::floor(std::min({ x[0], x[1], x[2] }))));
+    triangle.min_y = std::max(0, static_cast<int32_t>(std::floor(std::min({ y[0], y[1], y[2] }))));
+    triangle.max_x = std::min(static_cast<int32_t>(m_desc.width) - 1, static_cast<int32_t>(std::floor(std::max({ x[0], x[1], x[2] }))));
+    triangle.max_y = std::min(static_cast<int32_t>(m_desc.height) - 1, static_cast<int32_t>(std::floor(std::max({ y[0], y[1], y[2] }))));
+    if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y) {
+        return;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        const int j = (i + 1) % 3;
+        triangle.edge_a[i] = y[i] - y[j];
+        triangle.edge_b[i] = x[j] - x[i];
+        triangle.edge_c[i] = x[i] * y[j] - x[j] * y[i] - 0.5f * (std::fabs(triangle.edge_a[i]) + std::fabs(triangle.edge_b[i]));
+    }
+
+    const float depth1 = z[1] - z[0];
+    const float depth2 = z[2] - z[0];
+    triangle.depth_a = (depth1 * (y[2] - y[0]) - depth2 * (y[1] - y[0])) / area;
+    triangle.depth_b = (depth2 * (x[1] - x[0]) - depth1 * (x[2] - x[0])) / area;
+    triangle.depth_c = z[0] - triangle.depth_a * x[0] - triangle.depth_b * y[0] - 0.5f * (std::fabs(triangle.depth_a) + std::fabs(triangle.depth_b));
+
+    m_triangles.push_back(triangle);
+}
+
+void OcclusionCuller::RasterizeTriangle(const Triangle& triangle, int32_t min_y, int32_t max_y)
+{
+    const auto lane_offsets = Float4::Set(0.5f, 1.5f, 2.5f, 3.5f);
+    const auto zero = Float4::Splat(0.0f);
+    const auto edge_a0 = Float4::Splat(triangle.edge_a[0]);
+    const auto edge_a1 = Float4::Splat(triangle.edge_a[1]);
+    const auto edge_a2 = Float4::Splat(triangle.edge_a[2]);
+    const auto depth_a = Float4::Splat(triangle.depth_a);
+
+    const auto begin_y = std::max(min_y, triangle.min_y);
+    const auto end_y = std::min(max_y, triangle.max_y);
+    const auto begin_x = triangle.min_x & ~3;
+
+    for (int32_t y = begin_y; y <= end_y; ++y) {
+        const float pixel_y = y + 0.5f;
+        const auto edge_row0 = Float4::Splat(triangle.edge_b[0] * pixel_y + triangle.edge_c[0]);
+        const auto edge_row1 = Float4::Splat(triangle.edge_b[1] * pixel_y + triangle.edge_c[1]);
+        const auto edge_row2 = Float4::Splat(triangle.edge_b[2] * pixel_y + triangle.edge_c[2]);
+        const auto depth_row = Float4::Splat(triangle.depth_b * pixel_y + triangle.depth_c);
+
+        bool was_inside = false;
+        for (int32_t x = begin_x; x <= triangle.max_x; x += 4) {
+            const auto pixel_x = Float4::Splat(static_cast<float>(x)) + lane_offsets;
+            const auto inside = (edge_a0 * pixel_x + edge_row0 >= zero)
+                & (edge_a1 * pixel_x + edge_row1 >= zero)
+                & (edge_a2 * pixel_x + edge_row2 >= zero);
+
+            if (!AnyTrue(inside)) {
+                if (was_inside) {
+                    break;
+                }
+                continue;
+            }
+            was_inside = true;
+
+            float* depth = m_depth.data() + GetPixelOffset(x, y);
+            const auto current_depth = Float4::Load(depth);
+            const auto triangle_depth = depth_a * pixel_x + depth_row;
+            Select(inside, Max(current_depth, triangle_depth), current_depth).Store(depth);
+        }
+    }
+}
+
+void OcclusionCuller::UpdateTileDepth(uint32_t tile_row)
+{
+    for (uint32_t tile_x = 0; tile_x < m_tile_count_x; ++tile_x) {
+        const auto tile_index = tile_row * m_tile_count_x + tile_x;
+        const float* depth = m_depth.data() + static_cast<size_t>(tile_index) * s_tile_pixel_count;
+
+        auto min_depth = Float4::Load(depth);
+        for (uint32_t i = 4; i < s_tile_pixel_count; i += 4) {
+            min_depth = Min(min_depth, Float4::Load(depth + i));
+        }
+        m_tile_depth[tile_index] = HorizontalMin(min_depth);
+    }
+}
+
+size_t OcclusionCuller::GetPixelOffset(uint32_t x, uint32_t y) const
+{
+    const auto tile_index = static_cast<size_t>(y / s_tile_size) * m_tile_count_x + x / s_tile_size;
+    return tile_index * s_tile_pixel_count + (y % s_tile_size) * s_tile_size + x % s_tile_size;
+}
+
+}  // namespace ddn
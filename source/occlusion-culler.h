@@ -0,0 +1,84 @@
+#pragma once
+
+#include "mesh.h"
+#include "bounds.h"
+
+#include <glm/mat4x4.hpp>
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+struct OcclusionCullerDesc
+{
+    uint32_t width = 320;
+    uint32_t height = 192;
+    float min_w = 1e-3f;
+};
+
+struct OcclusionStatistics
+{
+    double rasterization_ms = 0.0;
+    double test_ms = 0.0;
+    uint32_t occluder_triangle_count = 0;
+    uint32_t rasterized_triangle_count = 0;
+    uint32_t tested_count = 0;
+    uint32_t occluded_count = 0;
+};
+
+class OcclusionCuller
+{
+public:
+    explicit OcclusionCuller(const OcclusionCullerDesc& desc = {});
+
+    void BeginFrame(const glm::mat4& projection_view_matrix);
+    void AddOccluder(const IMesh& mesh, const glm::mat4& model_matrix, size_t position_offset = 0);
+    void Rasterize();
+
+    bool IsVisible(const Aabb& aabb) const;
+    void Cull(std::span<const Aabb> bounds, std::span<const uint32_t> items, std::vector<uint32_t>& visible_items);
+
+    uint32_t GetWidth() const;
+    uint32_t GetHeight() const;
+    float GetDepth(uint32_t x, uint32_t y) const;
+    const OcclusionStatistics& GetStatistics() const;
+
+private:
+    struct Triangle
+    {
+        float edge_a[3];
+        float edge_b[3];
+        float edge_c[3];
+        float depth_a;
+        float depth_b;
+        float depth_c;
+        int32_t min_x;
+        int32_t min_y;
+        int32_t max_x;
+        int32_t max_y;
+    };
+
+    void SetupTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2);
+    void RasterizeTriangle(const Triangle& triangle, int32_t min_y, int32_t max_y);
+    void UpdateTileDepth(uint32_t tile_row);
+
+    size_t GetPixelOffset(uint32_t x, uint32_t y) const;
+
+private:
+    OcclusionCullerDesc m_desc;
+    uint32_t m_tile_count_x = 0;
+    uint32_t m_tile_count_y = 0;
+    glm::mat4 m_projection_view_matrix;
+    std::vector<float> m_depth;
+    std::vector<float> m_tile_depth;
+    std::vector<Triangle> m_triangles;
+    std::vector<std::vector<uint32_t>> m_tile_row_triangles;
+    std::vector<glm::vec4> m_clip_positions;
+    std::vector<uint8_t> m_visibility;
+    OcclusionStatistics m_statistics;
+};
+
+}  // namespace ddn
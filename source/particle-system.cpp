@@ -0,0 +1,274 @@
+#include "particle-system.h"
+#include "simd.h"
+#include "profiler.h"
+#include "thread-pool.h"
+#include "memory-tracker.h"
+
+#include <glm/glm.hpp>
+
+#include <bit>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr size_t s_emission_grain_size = 4096;
+constexpr size_t s_move_grain_size = 2048;
+constexpr size_t s_instance_grain_size = 16384;
+constexpr uint32_t s_lane_count = 4;
+
+uint32_t Hash(uint32_t value)
+{
+    // PCG output permutation; cheap and good enough to decorrelate consecutive particle indexes.
+    const uint32_t state = value * 747796405u + 2891336453u;
+    const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float ToUnitFloat(uint32_t value)
+{
+    return static_cast<float>(value >> 8) * (1.0f / 16777216.0f);
+}
+
+uint32_t PackColor(const glm::vec4& color)
+{
+    const auto clamped = glm::clamp(color, glm::vec4(0.0f), glm::vec4(1.0f)) * 255.0f + 0.5f;
+    return uint32_t(clamped.x) | uint32_t(clamped.y) << 8 | uint32_t(clamped.z) << 16 | uint32_t(clamped.w) << 24;
+}
+
+}
+
+namespace ddn
+{
+
+ParticleSystem::ParticleSystem(const ParticleSystemDesc& desc)
+    : m_desc(desc)
+    , m_capacity(desc.capacity)
+{
+    if (desc.capacity == 0) {
+        throw std::invalid_argument("Expected non-zero particle capacity");
+    }
+
+    MemoryTagScope tag_scope(MemoryTag::Particles);
+    // Integration runs whole SIMD lanes, so the streams are padded to a multiple of the lane count.
+    const size_t padded_capacity = (size_t(m_capacity) + s_lane_count - 1) / s_lane_count * s_lane_count;
+    for (auto* stream : { &m_position_x, &m_position_y, &m_position_z, &m_velocity_x, &m_velocity_y, &m_velocity_z, &m_life, &m_inverse_lifetime, &m_size }) {
+        stream->resize(padded_capacity);
+    }
+    m_color.resize(padded_capacity);
+
+    const size_t chunk_count = (size_t(m_capacity) + s_chunk_size - 1) / s_chunk_size;
+    m_dead_indexes.resize(m_capacity);
+    m_chunk_dead_counts.resize(chunk_count);
+    m_moves.reserve(m_capacity);
+}
+
+ParticleEmitterId ParticleSystem::AddEmitter(const ParticleEmitterDesc& desc)
+{
+    const auto id = static_cast<ParticleEmitterId>(m_emitters.size());
+    m_emitters.emplace_back();
+    SetEmitter(id, desc);
+    return id;
+}
+
+void ParticleSystem::SetEmitter(ParticleEmitterId id, const ParticleEmitterDesc& desc)
+{
+    if (desc.min_lifetime <= 0.0f || desc.max_lifetime < desc.min_lifetime) {
+        throw std::invalid_argument("Expected positive lifetime range");
+    }
+
+    auto& emitter = m_emitters.at(id);
+    emitter.desc = desc;
+    emitter.color = PackColor(desc.color);
+}
+
+void ParticleSystem::Emit(ParticleEmitterId id, uint32_t count)
+{
+    const auto& emitter = m_emitters.at(id);
+    const uint32_t emitted_count = std::min(count, m_capacity - m_count);
+    m_statistics.dropped_count += count - emitted_count;
+    if (emitted_count == 0) {
+        return;
+    }
+
+    const uint32_t first = m_count;
+    const uint32_t first_key = m_emission_index * 4 + m_desc.seed * 0x9e3779b9u;
+    ParallelFor(0, emitted_count, s_emission_grain_size, [&](size_t begin, size_t end) {
+        const auto& desc = emitter.desc;
+        for (size_t i = begin; i < end; ++i) {
+            const uint32_t key = first_key + static_cast<uint32_t>(i) * 4;
+            const glm::vec3 offset(ToUnitFloat(Hash(key)) * 2.0f - 1.0f, ToUnitFloat(Hash(key + 1)) * 2.0f - 1.0f, ToUnitFloat(Hash(key + 2)) * 2.0f - 1.0f);
+            const float lifetime = desc.min_lifetime + (desc.max_lifetime - desc.min_lifetime) * ToUnitFloat(Hash(key + 3));
+
+            const glm::vec3 position = desc.position + offset * desc.spawn_radius;
+            const glm::vec3 velocity = desc.velocity + offset * desc.velocity_spread;
+            const size_t index = first + i;
+            m_position_x[index] = position.x;
+            m_position_y[index] = position.y;
+            m_position_z[index] = position.z;
+            m_velocity_x[index] = velocity.x;
+            m_velocity_y[index] = velocity.y;
+            m_velocity_z[index] = velocity.z;
+            m_life[index] = lifetime;
+            m_inverse_lifetime[index] = 1.0f / lifetime;
+            m_size[index] = desc.size;
+            m_color[index] = emitter.color;
+        }
+    });
+
+    m_count += emitted_count;
+    m_emission_index += emitted_count;
+    m_statistics.emitted_count += emitted_count;
+}
+
+void ParticleSystem::Update(float delta_time)
+{
+    DDN_PROFILE_SCOPE("ParticleSystem::Update");
+
+    Integrate(delta_time);
+    Compact();
+
+    for (ParticleEmitterId id = 0; id < m_emitters.size(); ++id) {
+        auto& emitter = m_emitters[id];
+        emitter.pending_count += emitter.desc.rate * delta_time;
+        const float count = std::floor(emitter.pending_count);
+        emitter.pending_count -= count;
+        Emit(id, static_cast<uint32_t>(count));
+    }
+}
+
+void ParticleSystem::WriteInstances(std::span<ParticleInstance> instances) const
+{
+    if (instances.size() < m_count) {
+        throw std::invalid_argument("Instance span is smaller than the particle count");
+    }
+
+    ParallelFor(0, m_count, s_instance_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const float alpha = std::clamp(m_life[i] * m_inverse_lifetime[i], 0.0f, 1.0f) * static_cast<float>(m_color[i] >> 24);
+            auto& instance = instances[i];
+            instance.position = glm::vec3(m_position_x[i], m_position_y[i], m_position_z[i]);
+            instance.size = m_size[i];
+            instance.color = (m_color[i] & 0x00ffffffu) | static_cast<uint32_t>(alpha + 0.5f) << 24;
+        }
+    });
+}
+
+uint32_t ParticleSystem::GetParticleCount() const
+{
+    return m_count;
+}
+
+uint32_t ParticleSystem::GetCapacity() const
+{
+    return m_capacity;
+}
+
+const ParticleStatistics& ParticleSystem::GetStatistics() const
+{
+    return m_statistics;
+}
+
+void ParticleSystem::Integrate(float delta_time)
+{
+    const size_t chunk_count = (size_t(m_count) + s_chunk_size - 1) / s_chunk_size;
+    const Float4 time = Float4::Splat(delta_time);
+    const Float4 damping = Float4::Splat(std::max(0.0f, 1.0f - m_desc.drag * delta_time));
+    const Float4 gravity_x = Float4::Splat(m_desc.gravity.x * delta_time);
+    const Float4 gravity_y = Float4::Splat(m_desc.gravity.y * delta_time);
+    const Float4 gravity_z = Float4::Splat(m_desc.gravity.z * delta_time);
+    const Float4 zero = Float4::Splat(0.0f);
+
+    ParallelFor(0, chunk_count, 1, [&](size_t chunk_begin, size_t chunk_end) {
+        for (size_t chunk = chunk_begin; chunk < chunk_end; ++chunk) {
+            const size_t begin = chunk * s_chunk_size;
+            const size_t end = std::min<size_t>(begin + s_chunk_size, m_count);
+            uint32_t* dead_indexes = m_dead_indexes.data() + begin;
+            uint32_t dead_count = 0;
+
+            for (size_t i = begin; i < end; i += s_lane_count) {
+                const Float4 velocity_x = Float4::Load(&m_velocity_x[i]) * damping + gravity_x;
+                const Float4 velocity_y = Float4::Load(&m_velocity_y[i]) * damping + gravity_y;
+                const Float4 velocity_z = Float4::Load(&m_velocity_z[i]) * damping + gravity_z;
+                velocity_x.Store(&m_velocity_x[i]);
+                velocity_y.Store(&m_velocity_y[i]);
+                velocity_z.Store(&m_velocity_z[i]);
+                (Float4::Load(&m_position_x[i]) + velocity_x * time).Store(&m_position_x[i]);
+                (Float4::Load(&m_position_y[i]) + velocity_y * time).Store(&m_position_y[i]);
+                (Float4::Load(&m_position_z[i]) + velocity_z * time).Store(&m_position_z[i]);
+
+                const Float4 life = Float4::Load(&m_life[i]) - time;
+                life.Store(&m_life[i]);
+
+                // Lanes past the end hold stale data, which is masked off here.
+                uint32_t dead_bits = GetBits(life <= zero);
+                if (end - i < s_lane_count) {
+                    dead_bits &= (1u << (end - i)) - 1;
+                }
+                while (dead_bits != 0) {
+                    const uint32_t lane = static_cast<uint32_t>(std::countr_zero(dead_bits));
+                    dead_indexes[dead_count++] = static_cast<uint32_t>(i + lane);
+                    dead_bits &= dead_bits - 1;
+                }
+            }
+
+            m_chunk_dead_counts[chunk] = dead_count;
+        }
+    });
+}
+
+void ParticleSystem::Compact()
+{
+    // Gather the per-chunk dead lists into one ascending list.
+    const size_t chunk_count = (size_t(m_count) + s_chunk_size - 1) / s_chunk_size;
+    uint32_t dead_count = 0;
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+        const uint32_t* chunk_dead_indexes = m_dead_indexes.data() + chunk * s_chunk_size;
+        std::copy_n(chunk_dead_indexes, m_chunk_dead_counts[chunk], m_dead_indexes.data() + dead_count);
+        dead_count += m_chunk_dead_counts[chunk];
+    }
+
+    m_statistics.killed_count += dead_count;
+    m_statistics.moved_count = 0;
+    if (dead_count == 0) {
+        return;
+    }
+
+    // Every dead slot below the new count takes the highest live particle that is not yet moved; dead
+    // particles at or above the new count are the tail of the ascending list and are skipped.
+    const uint32_t live_count = m_count - dead_count;
+    m_moves.clear();
+    uint32_t source = m_count;
+    uint32_t tail_dead = dead_count;
+    for (uint32_t hole = 0; hole < dead_count && m_dead_indexes[hole] < live_count; ++hole) {
+        --source;
+        while (tail_dead > 0 && m_dead_indexes[tail_dead - 1] == source) {
+            --tail_dead;
+            --source;
+        }
+        m_moves.push_back({ source, m_dead_indexes[hole] });
+    }
+
+    ParallelFor(0, m_moves.size(), s_move_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto [from, to] = m_moves[i];
+            m_position_x[to] = m_position_x[from];
+            m_position_y[to] = m_position_y[from];
+            m_position_z[to] = m_position_z[from];
+            m_velocity_x[to] = m_velocity_x[from];
+            m_velocity_y[to] = m_velocity_y[from];
+            m_velocity_z[to] = m_velocity_z[from];
+            m_life[to] = m_life[from];
+            m_inverse_lifetime[to] = m_inverse_lifetime[from];
+            m_size[to] = m_size[from];
+            m_color[to] = m_color[from];
+        }
+    });
+
+    m_count = live_count;
+    m_statistics.moved_count = static_cast<uint32_t>(m_moves.size());
+}
+
+}  // namespace ddn
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+using ParticleEmitterId = uint32_t;
+
+struct ParticleEmitterDesc
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    float spawn_radius = 0.0f;
+    glm::vec3 velocity = glm::vec3(0.0f, 1.0f, 0.0f);
+    float velocity_spread = 0.0f;
+    float min_lifetime = 1.0f;
+    float max_lifetime = 1.0f;
+    // Particles per second emitted by Update.
+    float rate = 0.0f;
+    float size = 1.0f;
+    glm::vec4 color = glm::vec4(1.0f);
+};
+
+struct ParticleSystemDesc
+{
+    uint32_t capacity = 1u << 20;
+    glm::vec3 gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+    float drag = 0.0f;
+    uint32_t seed = 1;
+};
+
+// Per-particle vertex buffer element; color is RGBA8 with alpha faded over the particle's lifetime.
+struct ParticleInstance
+{
+    glm::vec3 position;
+    float size = 0.0f;
+    uint32_t color = 0;
+};
+
+static_assert(sizeof(ParticleInstance) == 20);
+
+struct ParticleStatistics
+{
+    uint64_t emitted_count = 0;
+    uint64_t killed_count = 0;
+    uint64_t dropped_count = 0;
+    uint32_t moved_count = 0;
+};
+
+// Particles are kept in structure-of-arrays streams with no holes below GetParticleCount(). Update integrates
+// them four at a time in parallel chunks, then fills the slots of dead particles with live ones from the end
+// of the range, so compaction costs in proportion to the number of deaths rather than the particle count.
+// Particle order is therefore not stable.
+class ParticleSystem
+{
+public:
+    explicit ParticleSystem(const ParticleSystemDesc& desc = {});
+
+    ParticleSystem(const ParticleSystem& other) = delete;
+    ParticleSystem& operator =(const ParticleSystem& other) = delete;
+
+    ParticleEmitterId AddEmitter(const ParticleEmitterDesc& desc);
+    void SetEmitter(ParticleEmitterId id, const ParticleEmitterDesc& desc);
+
+    // Spawns count particles right away; what does not fit into the capacity is dropped.
+    void Emit(ParticleEmitterId id, uint32_t count);
+
+    void Update(float delta_time);
+
+    // Writes GetParticleCount() instances.
+    void WriteInstances(std::span<ParticleInstance> instances) const;
+
+    uint32_t GetParticleCount() const;
+    uint32_t GetCapacity() const;
+    const ParticleStatistics& GetStatistics() const;
+
+private:
+    struct Emitter
+    {
+        ParticleEmitterDesc desc;
+        uint32_t color = 0;
+        float pending_count = 0.0f;
+    };
+
+    struct Move
+    {
+        uint32_t source = 0;
+        uint32_t destination = 0;
+    };
+
+    void Integrate(float delta_time);
+    void Compact();
+
+private:
+    static constexpr uint32_t s_chunk_size = 16 * 1024;
+
+    ParticleSystemDesc m_desc;
+    uint32_t m_capacity = 0;
+    uint32_t m_count = 0;
+    uint32_t m_emission_index = 0;
+
+    std::vector<float> m_position_x;
+    std::vector<float> m_position_y;
+    std::vector<float> m_position_z;
+    std::vector<float> m_velocity_x;
+    std::vector<float> m_velocity_y;
+    std::vector<float> m_velocity_z;
+    std::vector<float> m_life;
+    std::vector<float> m_inverse_lifetime;
+    std::vector<float> m_size;
+    std::vector<uint32_t> m_color;
+
+    std::vector<Emitter> m_emitters;
+    std::vector<uint32_t> m_dead_indexes;
+    std::vector<uint32_t> m_chunk_dead_counts;
+    std::vector<Move> m_moves;
+    ParticleStatistics m_statistics;
+};
+
+}  // namespace ddn
@@ -0,0 +1,353 @@
+#include "path-tracer.h"
+#include "profiler.h"
+#include "thread-pool.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr float s_ray_offset = 1e-4f;
+constexpr uint32_t s_russian_roulette_bounce = 2;
+
+uint64_t MixBits(uint64_t value)
+{
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+glm::vec3 OffsetPosition(const glm::vec3& position, const glm::vec3& normal)
+{
+    const float scale = 1.0f + std::max(std::abs(position.x), std::max(std::abs(position.y), std::abs(position.z)));
+    return position + normal * (s_ray_offset * scale);
+}
+
+float LinearToSrgb(float value)
+{
+    value = std::clamp(value, 0.0f, 1.0f);
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+}
+
+namespace ddn
+{
+
+struct PathTracer::Random
+{
+    uint64_t state;
+
+    Random(uint64_t seed, uint64_t sequence)
+        : state(MixBits(seed ^ MixBits(sequence)))
+    {}
+
+    uint32_t NextUint()
+    {
+        const auto old_state = state;
+        state = old_state * 6364136223846793005ull + 1442695040888963407ull;
+        const auto xor_shifted = static_cast<uint32_t>(((old_state >> 18) ^ old_state) >> 27);
+        const auto rotation = static_cast<uint32_t>(old_state >> 59);
+        return (xor_shifted >> rotation) | (xor_shifted << ((32 - rotation) & 31));
+    }
+
+    float NextFloat()
+    {
+        return static_cast<float>(NextUint() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    glm::vec3 NextCosineDirection(const glm::vec3& normal)
+    {
+        const float radius = std::sqrt(NextFloat());
+        const float phi = glm::two_pi<float>() * NextFloat();
+        const float x = radius * std::cos(phi);
+        const float y = radius * std::sin(phi);
+        const float z = std::sqrt(std::max(0.0f, 1.0f - x * x - y * y));
+
+        const auto helper = std::abs(normal.x) > 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+        const auto tangent = glm::normalize(glm::cross(helper, normal));
+        const auto bitangent = glm::cross(normal, tangent);
+        return glm::normalize(tangent * x + bitangent * y + normal * z);
+    }
+};
+
+PathTracer::PathTracer(const PathTracerDesc& desc)
+    : m_desc(desc)
+    , m_sun_direction(glm::normalize(desc.sun_direction))
+{
+    if (desc.width == 0 || desc.height == 0 || desc.tile_size == 0) {
+        throw std::invalid_argument("Expected non-zero image and tile size");
+    }
+
+    m_tile_count_x = (desc.width + desc.tile_size - 1) / desc.tile_size;
+    m_tile_count_y = (desc.height + desc.tile_size - 1) / desc.tile_size;
+    m_accumulation.resize(static_cast<size_t>(desc.width) * desc.height, glm::vec3(0.0f));
+    m_tile_ray_counts.resize(static_cast<size_t>(m_tile_count_x) * m_tile_count_y);
+}
+
+void PathTracer::AddMesh(const IMesh& mesh, const glm::mat4& model_matrix, size_t position_offset, size_t color_offset)
+{
+    const auto index_size = mesh.GetIndexSize();
+    if (index_size != sizeof(uint16_t) && index_size != sizeof(uint32_t)) {
+        throw std::invalid_argument("Unsupported index size");
+    }
+
+    const auto vertex_size = mesh.GetVertexSize();
+    if (position_offset + sizeof(glm::vec3) > vertex_size || color_offset + sizeof(glm::vec3) > vertex_size) {
+        throw std::invalid_argument("Vertex attribute offset exceeds vertex size");
+    }
+
+    const auto vertices = mesh.GetVertices();
+    const auto vertex_count = mesh.GetVertexCount();
+    const auto indexes = mesh.GetIndexes();
+    const auto index_count = mesh.GetIndexCount() - mesh.GetIndexCount() % 3;
+
+    m_positions.reserve(m_positions.size() + index_count);
+    m_colors.reserve(m_colors.size() + index_count);
+    for (size_t i = 0; i < index_count; ++i) {
+        const auto index = ReadIndex(indexes.data(), index_size, i);
+        if (index >= vertex_count) {
+            throw std::out_of_range("Index exceeds vertex count");
+        }
+
+        glm::vec3 position;
+        glm::vec3 color;
+        std::memcpy(&position, vertices.data() + index * vertex_size + position_offset, sizeof(position));
+        std::memcpy(&color, vertices.data() + index * vertex_size + color_offset, sizeof(color));
+        m_positions.push_back(glm::vec3(model_matrix * glm::vec4(position, 1.0f)));
+        m_colors.push_back(color);
+    }
+
+    m_is_built = false;
+}
+
+void PathTracer::Build()
+{
+    DDN_PROFILE_FUNCTION();
+
+    std::vector<uint32_t> indexes(m_positions.size());
+    std::iota(indexes.begin(), indexes.end(), 0u);
+    const Mesh<glm::vec3, uint32_t> scene(std::vector<glm::vec3>(m_positions), std::move(indexes));
+    m_bvh.Build(scene);
+    m_is_built = true;
+    Reset();
+}
+
+void PathTracer::Reset()
+{
+    std::fill(m_accumulation.begin(), m_accumulation.end(), glm::vec3(0.0f));
+    m_sample_count = 0;
+}
+
+void PathTracer::Render(const Camera& camera, uint32_t sample_count)
+{
+    DDN_PROFILE_FUNCTION();
+
+    if (!m_is_built) {
+        throw std::logic_error("Path tracer scene must be built before rendering");
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    const auto origin = camera.GetPosition();
+    const float tan_half_fov = std::tan(camera.GetFovY() * 0.5f);
+    const auto right = camera.GetRight() * (tan_half_fov * camera.GetAspect());
+    const auto up = camera.GetUp() * tan_half_fov;
+    const auto forward = camera.GetForward();
+    const auto first_sample = m_sample_count;
+
+    ParallelFor(0, m_tile_ray_counts.size(), 1, [&](size_t tile_begin, size_t tile_end) {
+        for (size_t tile = tile_begin; tile < tile_end; ++tile) {
+            const auto min_x = static_cast<uint32_t>(tile % m_tile_count_x) * m_desc.tile_size;
+            const auto min_y = static_cast<uint32_t>(tile / m_tile_count_x) * m_desc.tile_size;
+            const auto max_x = std::min(min_x + m_desc.tile_size, m_desc.width);
+            const auto max_y = std::min(min_y + m_desc.tile_size, m_desc.height);
+
+            uint64_t ray_count = 0;
+            for (uint32_t y = min_y; y < max_y; ++y) {
+                for (uint32_t x = min_x; x < max_x; ++x) {
+                    const auto pixel = static_cast<size_t>(y) * m_desc.width + x;
+                    glm::vec3 radiance(0.0f);
+                    for (uint32_t sample = 0; sample < sample_count; ++sample) {
+                        Random random(m_desc.seed, (static_cast<uint64_t>(first_sample + sample) << 32) | pixel);
+                        const float ndc_x = 2.0f * (x + random.NextFloat()) / m_desc.width - 1.0f;
+                        const float ndc_y = 1.0f - 2.0f * (y + random.NextFloat()) / m_desc.height;
+
+                        Ray ray;
+                        ray.origin = origin;
+                        ray.direction = glm::normalize(forward + right * ndc_x + up * ndc_y);
+                        radiance += TracePath(ray, random, ray_count);
+                    }
+                    m_accumulation[pixel] += radiance;
+                }
+            }
+            m_tile_ray_counts[tile] = ray_count;
+        }
+    });
+
+    m_sample_count += sample_count;
+    m_statistics.ray_count = std::accumulate(m_tile_ray_counts.begin(), m_tile_ray_counts.end(), uint64_t(0));
+    m_statistics.render_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+uint32_t PathTracer::GetWidth() const
+{
+    return m_desc.width;
+}
+
+uint32_t PathTracer::GetHeight() const
+{
+    return m_desc.height;
+}
+
+uint32_t PathTracer::GetSampleCount() const
+{
+    return m_sample_count;
+}
+
+uint32_t PathTracer::GetTriangleCount() const
+{
+    return static_cast<uint32_t>(m_positions.size() / 3);
+}
+
+glm::vec3 PathTracer::GetPixel(uint32_t x, uint32_t y) const
+{
+    if (x >= m_desc.width || y >= m_desc.height) {
+        throw std::out_of_range("Pixel is outside of the image");
+    }
+
+    if (m_sample_count == 0) {
+        return glm::vec3(0.0f);
+    }
+    return m_accumulation[static_cast<size_t>(y) * m_desc.width + x] / static_cast<float>(m_sample_count);
+}
+
+const PathTracerStatistics& PathTracer::GetStatistics() const
+{
+    return m_statistics;
+}
+
+void PathTracer::WriteImage(const std::filesystem::path& file_path) const
+{
+    const auto extension = file_path.extension();
+    if (extension == ".ppm") {
+        WritePpm(file_path);
+    } else if (extension == ".pfm") {
+        WritePfm(file_path);
+    } else {
+        throw std::invalid_argument("Unsupported image format: " + extension.string());
+    }
+}
+
+glm::vec3 PathTracer::TracePath(Ray ray, Random& random, uint64_t& ray_count) const
+{
+    glm::vec3 radiance(0.0f);
+    glm::vec3 throughput(1.0f);
+
+    for (uint32_t bounce = 0; bounce <= m_desc.max_bounce_count; ++bounce) {
+        const auto hit = m_bvh.Raycast(ray);
+        ++ray_count;
+        if (!hit.IsValid()) {
+            radiance += throughput * GetSkyRadiance(ray.direction);
+            break;
+        }
+
+        const auto vertex = static_cast<size_t>(hit.triangle) * 3;
+        const auto& p0 = m_positions[vertex];
+        auto normal = glm::normalize(glm::cross(m_positions[vertex + 1] - p0, m_positions[vertex + 2] - p0));
+        if (glm::dot(normal, ray.direction) > 0.0f) {
+            normal = -normal;
+        }
+
+        const float u = hit.barycentrics.x;
+        const float v = hit.barycentrics.y;
+        const auto albedo = m_colors[vertex] * (1.0f - u - v) + m_colors[vertex + 1] * u + m_colors[vertex + 2] * v;
+        const auto position = OffsetPosition(ray.origin + ray.direction * hit.distance, normal);
+
+        const float sun_cosine = glm::dot(normal, m_sun_direction);
+        if (sun_cosine > 0.0f) {
+            Ray shadow_ray;
+            shadow_ray.origin = position;
+            shadow_ray.direction = m_sun_direction;
+            ++ray_count;
+            if (!m_bvh.IsOccluded(shadow_ray)) {
+                radiance += throughput * albedo * m_desc.sun_radiance * (sun_cosine * glm::one_over_pi<float>());
+            }
+        }
+
+        throughput *= albedo;
+        if (bounce >= s_russian_roulette_bounce) {
+            const float survival = std::clamp(std::max(throughput.x, std::max(throughput.y, throughput.z)), 0.05f, 0.95f);
+            if (random.NextFloat() >= survival) {
+                break;
+            }
+            throughput /= survival;
+        }
+
+        ray.origin = position;
+        ray.direction = random.NextCosineDirection(normal);
+    }
+
+    return radiance;
+}
+
+glm::vec3 PathTracer::GetSkyRadiance(const glm::vec3& direction) const
+{
+    const float height = std::clamp(direction.y, 0.0f, 1.0f);
+    return glm::mix(m_desc.sky_horizon_radiance, m_desc.sky_zenith_radiance, height);
+}
+
+void PathTracer::WritePpm(const std::filesystem::path& file_path) const
+{
+    std::ofstream stream(file_path, std::ios::binary);
+    if (!stream) {
+        throw std::runtime_error("Failed to open image file");
+    }
+
+    stream << "P6\n" << m_desc.width << " " << m_desc.height << "\n255\n";
+
+    std::vector<uint8_t> row(static_cast<size_t>(m_desc.width) * 3);
+    for (uint32_t y = 0; y < m_desc.height; ++y) {
+        for (uint32_t x = 0; x < m_desc.width; ++x) {
+            const auto color = GetPixel(x, y);
+            for (int channel = 0; channel < 3; ++channel) {
+                row[x * 3 + channel] = static_cast<uint8_t>(LinearToSrgb(color[channel]) * 255.0f + 0.5f);
+            }
+        }
+        stream.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+    }
+}
+
+void PathTracer::WritePfm(const std::filesystem::path& file_path) const
+{
+    std::ofstream stream(file_path, std::ios::binary);
+    if (!stream) {
+        throw std::runtime_error("Failed to open image file");
+    }
+
+    // Negative scale marks little-endian data; rows are stored bottom to top.
+    stream << "PF\n" << m_desc.width << " " << m_desc.height << "\n-1.0\n";
+
+    std::vector<float> row(static_cast<size_t>(m_desc.width) * 3);
+    for (uint32_t y = m_desc.height; y-- > 0;) {
+        for (uint32_t x = 0; x < m_desc.width; ++x) {
+            const auto color = GetPixel(x, y);
+            for (int channel = 0; channel < 3; ++channel) {
+                row[x * 3 + channel] = color[channel];
+            }
+        }
+        stream.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size() * sizeof(float)));
+    }
+}
+
+}  // namespace ddn
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "cube.h"
+#include "mesh.h"
+#include "camera.h"
+#include "mesh-bvh.h"
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace ddn
+{
+
+struct PathTracerDesc
+{
+    uint32_t width = 640;
+    uint32_t height = 360;
+    uint32_t tile_size = 16;
+    uint32_t max_bounce_count = 4;
+    uint32_t seed = 0;
+    glm::vec3 sky_zenith_radiance = glm::vec3(0.35f, 0.5f, 0.8f);
+    glm::vec3 sky_horizon_radiance = glm::vec3(0.8f, 0.85f, 0.9f);
+    glm::vec3 sun_direction = glm::vec3(0.4f, 0.8f, -0.45f);
+    glm::vec3 sun_radiance = glm::vec3(2.5f, 2.4f, 2.2f);
+};
+
+struct PathTracerStatistics
+{
+    double render_ms = 0.0;
+    uint64_t ray_count = 0;
+};
+
+class PathTracer
+{
+public:
+    explicit PathTracer(const PathTracerDesc& desc = {});
+
+    void AddMesh(const IMesh& mesh, const glm::mat4& model_matrix, size_t position_offset = offsetof(VertexData, position), size_t color_offset = offsetof(VertexData, color));
+    void Build();
+
+    void Reset();
+    void Render(const Camera& camera, uint32_t sample_count = 1);
+
+    uint32_t GetWidth() const;
+    uint32_t GetHeight() const;
+    uint32_t GetSampleCount() const;
+    uint32_t GetTriangleCount() const;
+    glm::vec3 GetPixel(uint32_t x, uint32_t y) const;
+    const PathTracerStatistics& GetStatistics() const;
+
+    void WriteImage(const std::filesystem::path& file_path) const;
+
+private:
+    struct Random;
+
+    glm::vec3 TracePath(Ray ray, Random& random, uint64_t& ray_count) const;
+    glm::vec3 GetSkyRadiance(const glm::vec3& direction) const;
+
+    void WritePpm(const std::filesystem::path& file_path) const;
+    void WritePfm(const std::filesystem::path& file_path) const;
+
+private:
+    PathTracerDesc m_desc;
+    glm::vec3 m_sun_direction;
+    uint32_t m_tile_count_x = 0;
+    uint32_t m_tile_count_y = 0;
+
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::vec3> m_colors;
+    MeshBvh m_bvh;
+    bool m_is_built = false;
+
+    std::vector<glm::vec3> m_accumulation;
+    std::vector<uint64_t> m_tile_ray_counts;
+    uint32_t m_sample_count = 0;
+    PathTracerStatistics m_statistics;
+};
+
+}  // namespace ddn
@@ -0,0 +1,205 @@
+#include "profiler.h"
+
+#include <map>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+void WriteJsonString(std::ostream& stream, const std::string& value)
+{
+    stream << '"';
+    for (const char symbol : value) {
+        switch (symbol) {
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\\':
+            stream << "\\\\";
+            break;
+        case '\n':
+            stream << "\\n";
+            break;
+        default:
+            if (static_cast<unsigned char>(symbol) >= 0x20) {
+                stream << symbol;
+            }
+            break;
+        }
+    }
+    stream << '"';
+}
+
+void WriteCompleteEvent(std::ostream& stream, const std::string& name, uint32_t thread_id, uint64_t begin_ns, uint64_t end_ns, bool& is_first)
+{
+    stream << (is_first ? "\n" : ",\n");
+    is_first = false;
+
+    stream << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << thread_id << ",\"name\":";
+    WriteJsonString(stream, name);
+    stream << ",\"ts\":" << static_cast<double>(begin_ns) / 1000.0;
+    stream << ",\"dur\":" << static_cast<double>(end_ns - begin_ns) / 1000.0 << "}";
+}
+
+void WriteThreadName(std::ostream& stream, const std::string& name, uint32_t thread_id, bool& is_first)
+{
+    stream << (is_first ? "\n" : ",\n");
+    is_first = false;
+
+    stream << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << thread_id << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+    WriteJsonString(stream, name);
+    stream << "}}";
+}
+
+}
+
+namespace ddn
+{
+
+ProfilerThreadBuffer::ProfilerThreadBuffer(uint32_t thread_id)
+    : m_slots(s_capacity)
+    , m_thread_id(thread_id)
+    , m_thread_name("Thread " + std::to_string(thread_id))
+{
+}
+
+uint32_t ProfilerThreadBuffer::GetThreadId() const
+{
+    return m_thread_id;
+}
+
+void ProfilerThreadBuffer::SetThreadName(std::string name)
+{
+    std::lock_guard guard(m_name_mutex);
+    m_thread_name = std::move(name);
+}
+
+std::string ProfilerThreadBuffer::GetThreadName() const
+{
+    std::lock_guard guard(m_name_mutex);
+    return m_thread_name;
+}
+
+std::vector<ProfilerEvent> ProfilerThreadBuffer::CopyEvents() const
+{
+    const auto head = m_head.load(std::memory_order_acquire);
+    const auto first = head > s_capacity ? head - s_capacity : 0;
+
+    std::vector<ProfilerEvent> events;
+    events.reserve(static_cast<size_t>(head - first));
+    for (auto index = first; index < head; ++index) {
+        const auto& slot = m_slots[index & (s_capacity - 1)];
+        events.push_back({ slot.name.load(std::memory_order_relaxed), slot.begin.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed) });
+    }
+
+    // Any write announced by now may have replaced a slot mid-copy; the events that started there are dropped.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto write_count = m_write_count.load(std::memory_order_relaxed);
+    const auto valid_first = write_count > s_capacity ? write_count - s_capacity : 0;
+    if (valid_first > first) {
+        events.erase(events.begin(), events.begin() + static_cast<ptrdiff_t>(std::min(valid_first, head) - first));
+    }
+    return events;
+}
+
+Profiler& Profiler::GetInstance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+uint64_t Profiler::GetSteadyClockNs() noexcept
+{
+    const auto time = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count());
+}
+
+Profiler::Profiler()
+    : m_epoch_ticks(GetTimestamp())
+    , m_epoch_ns(GetSteadyClockNs())
+{
+}
+
+void Profiler::SetThreadName(std::string name)
+{
+    GetThreadBuffer().SetThreadName(std::move(name));
+}
+
+void Profiler::RecordTrackEvent(std::string track, const char* name, uint64_t begin_ns, uint64_t end_ns)
+{
+    std::lock_guard guard(m_mutex);
+    m_track_events.push_back({ std::move(track), name, begin_ns, end_ns });
+}
+
+void Profiler::WriteChromeTrace(const std::filesystem::path& file_path)
+{
+    std::ofstream stream(file_path);
+    if (!stream) {
+        throw std::runtime_error("Failed to open trace file");
+    }
+
+    const double ticks_per_ns = GetTicksPerNs();
+
+    std::lock_guard guard(m_mutex);
+
+    stream << std::fixed << std::setprecision(3);
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool is_first = true;
+    for (const auto& buffer : m_thread_buffers) {
+        const auto thread_id = buffer->GetThreadId();
+        WriteThreadName(stream, buffer->GetThreadName(), thread_id, is_first);
+
+        for (const auto& event : buffer->CopyEvents()) {
+            const auto begin_ns = TicksToNs(event.begin, ticks_per_ns);
+            const auto end_ns = std::max(begin_ns, TicksToNs(event.end, ticks_per_ns));
+            WriteCompleteEvent(stream, event.name ? event.name : "", thread_id, begin_ns, end_ns, is_first);
+        }
+    }
+
+    std::map<std::string, uint32_t> track_to_thread_id;
+    for (const auto& event : m_track_events) {
+        auto it = track_to_thread_id.find(event.track);
+        if (it == track_to_thread_id.end()) {
+            const auto thread_id = static_cast<uint32_t>(m_thread_buffers.size() + track_to_thread_id.size()) + 1;
+            it = track_to_thread_id.emplace(event.track, thread_id).first;
+            WriteThreadName(stream, event.track, thread_id, is_first);
+        }
+
+        const auto begin_ns = event.begin_ns > m_epoch_ns ? event.begin_ns - m_epoch_ns : 0;
+        const auto end_ns = std::max(begin_ns, event.end_ns > m_epoch_ns ? event.end_ns - m_epoch_ns : 0);
+        WriteCompleteEvent(stream, event.name ? event.name : "", it->second, begin_ns, end_ns, is_first);
+    }
+
+    stream << "\n]}\n";
+}
+
+ProfilerThreadBuffer& Profiler::CreateThreadBuffer()
+{
+    std::lock_guard guard(m_mutex);
+    const auto thread_id = static_cast<uint32_t>(m_thread_buffers.size()) + 1;
+    return *m_thread_buffers.emplace_back(std::make_unique<ProfilerThreadBuffer>(thread_id));
+}
+
+double Profiler::GetTicksPerNs() const
+{
+    const auto ticks = GetTimestamp();
+    const auto ns = GetSteadyClockNs();
+    if (ticks <= m_epoch_ticks || ns <= m_epoch_ns) {
+        return 1.0;
+    }
+    return static_cast<double>(ticks - m_epoch_ticks) / static_cast<double>(ns - m_epoch_ns);
+}
+
+uint64_t Profiler::TicksToNs(uint64_t ticks, double ticks_per_ns) const
+{
+    if (ticks <= m_epoch_ticks) {
+        return 0;
+    }
+    return static_cast<uint64_t>(static_cast<double>(ticks - m_epoch_ticks) / ticks_per_ns);
+}
+
+}  // namespace ddn
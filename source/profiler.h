@@ -0,0 +1,198 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <filesystem>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define DDN_PROFILER_HAS_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define DDN_PROFILER_HAS_RDTSC
+#endif
+
+namespace ddn
+{
+
+struct ProfilerEvent
+{
+    const char* name = nullptr;
+    uint64_t begin = 0;
+    uint64_t end = 0;
+};
+
+// Ring of the most recent events of one thread. Only the owning thread pushes; CopyEvents may run on any thread
+// at the same time and drops the slots that were overwritten while it copied them.
+class ProfilerThreadBuffer
+{
+public:
+    static constexpr size_t s_capacity = 1 << 16;
+
+    ProfilerThreadBuffer(uint32_t thread_id);
+
+    ProfilerThreadBuffer(const ProfilerThreadBuffer& other) = delete;
+    ProfilerThreadBuffer& operator =(const ProfilerThreadBuffer& other) = delete;
+
+    void Push(const ProfilerEvent& event) noexcept
+    {
+        // Announcing the write before the slot changes lets CopyEvents tell which of its copies to discard.
+        const auto head = m_head.load(std::memory_order_relaxed);
+        m_write_count.store(head + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto& slot = m_slots[head & (s_capacity - 1)];
+        slot.name.store(event.name, std::memory_order_relaxed);
+        slot.begin.store(event.begin, std::memory_order_relaxed);
+        slot.end.store(event.end, std::memory_order_relaxed);
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    uint32_t GetThreadId() const;
+
+    void SetThreadName(std::string name);
+    std::string GetThreadName() const;
+
+    std::vector<ProfilerEvent> CopyEvents() const;
+
+private:
+    struct Slot
+    {
+        std::atomic<const char*> name = nullptr;
+        std::atomic_uint64_t begin = 0;
+        std::atomic_uint64_t end = 0;
+    };
+
+private:
+    std::vector<Slot> m_slots;
+    std::atomic_uint64_t m_head = 0;
+    std::atomic_uint64_t m_write_count = 0;
+    uint32_t m_thread_id = 0;
+
+    mutable std::mutex m_name_mutex;
+    std::string m_thread_name;
+};
+
+struct ProfilerTrackEvent
+{
+    std::string track;
+    const char* name = nullptr;
+    uint64_t begin_ns = 0;
+    uint64_t end_ns = 0;
+};
+
+class Profiler
+{
+public:
+    static Profiler& GetInstance();
+
+    static uint64_t GetTimestamp() noexcept
+    {
+#ifdef DDN_PROFILER_HAS_RDTSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    static uint64_t GetSteadyClockNs() noexcept;
+
+    static ProfilerThreadBuffer& GetThreadBuffer()
+    {
+        thread_local ProfilerThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            buffer = &GetInstance().CreateThreadBuffer();
+        }
+        return *buffer;
+    }
+
+    Profiler(const Profiler& other) = delete;
+    Profiler& operator =(const Profiler& other) = delete;
+
+    void SetThreadName(std::string name);
+
+    void RecordTrackEvent(std::string track, const char* name, uint64_t begin_ns, uint64_t end_ns);
+
+    void WriteChromeTrace(const std::filesystem::path& file_path);
+
+private:
+    Profiler();
+
+    ProfilerThreadBuffer& CreateThreadBuffer();
+
+    double GetTicksPerNs() const;
+    uint64_t TicksToNs(uint64_t ticks, double ticks_per_ns) const;
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<ProfilerThreadBuffer>> m_thread_buffers;
+    std::vector<ProfilerTrackEvent> m_track_events;
+
+    uint64_t m_epoch_ticks = 0;
+    uint64_t m_epoch_ns = 0;
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name) noexcept
+        : m_name(name)
+        , m_begin(Profiler::GetTimestamp())
+    {}
+
+    ~ProfileScope()
+    {
+        const auto end = Profiler::GetTimestamp();
+        Profiler::GetThreadBuffer().Push({ m_name, m_begin, end });
+    }
+
+    ProfileScope(const ProfileScope& other) = delete;
+    ProfileScope& operator =(const ProfileScope& other) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_begin;
+};
+
+// Adds the time between construction and destruction to elapsed_ms, for statistics that are reported
+// whether or not profiling is enabled.
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(double& elapsed_ms) noexcept
+        : m_elapsed_ms(elapsed_ms)
+        , m_begin(std::chrono::steady_clock::now())
+    {}
+
+    ~ScopedTimer()
+    {
+        m_elapsed_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_begin).count();
+    }
+
+    ScopedTimer(const ScopedTimer& other) = delete;
+    ScopedTimer& operator =(const ScopedTimer& other) = delete;
+
+private:
+    double& m_elapsed_ms;
+    std::chrono::steady_clock::time_point m_begin;
+};
+
+}  // namespace ddn
+
+#define DDN_PROFILE_CONCAT_IMPL(a, b) a##b
+#define DDN_PROFILE_CONCAT(a, b) DDN_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef DDN_PROFILING_ENABLED
+#define DDN_PROFILE_SCOPE(name) ::ddn::ProfileScope DDN_PROFILE_CONCAT(ddn_profile_scope_, __LINE__)(name)
+#define DDN_PROFILE_FUNCTION() DDN_PROFILE_SCOPE(__func__)
+#define DDN_PROFILE_THREAD(name) ::ddn::Profiler::GetInstance().SetThreadName(name)
+#else
+#define DDN_PROFILE_SCOPE(name) ((void)0)
+#define DDN_PROFILE_FUNCTION() ((void)0)
+#define DDN_PROFILE_THREAD(name) ((void)0)
+#endif
@@ -0,0 +1,113 @@
+#include "range-allocator.h"
+
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+namespace ddn
+{
+
+RangeAllocator::RangeAllocator(uint64_t size)
+    : m_size(size)
+{
+    Reset();
+}
+
+uint64_t RangeAllocator::Allocate(uint64_t size)
+{
+    if (size == 0) {
+        return s_invalid_offset;
+    }
+
+    for (auto it = m_offset_to_free_size.begin(); it != m_offset_to_free_size.end(); ++it) {
+        const auto [offset, free_size] = *it;
+        if (free_size < size) {
+            continue;
+        }
+
+        m_offset_to_free_size.erase(it);
+        if (free_size > size) {
+            m_offset_to_free_size.emplace(offset + size, free_size - size);
+        }
+
+        m_used_size += size;
+        return offset;
+    }
+
+    return s_invalid_offset;
+}
+
+void RangeAllocator::Free(uint64_t offset, uint64_t size)
+{
+    if (size == 0 || offset + size > m_size || size > m_used_size) {
+        throw std::invalid_argument("Invalid range");
+    }
+
+    auto next = m_offset_to_free_size.lower_bound(offset);
+    if (next != m_offset_to_free_size.end() && next->first < offset + size) {
+        throw std::invalid_argument("Range is already free");
+    }
+
+    auto previous = next != m_offset_to_free_size.begin() ? std::prev(next) : m_offset_to_free_size.end();
+    if (previous != m_offset_to_free_size.end() && previous->first + previous->second > offset) {
+        throw std::invalid_argument("Range is already free");
+    }
+
+    m_used_size -= size;
+
+    if (next != m_offset_to_free_size.end() && next->first == offset + size) {
+        size += next->second;
+        m_offset_to_free_size.erase(next);
+    }
+
+    if (previous != m_offset_to_free_size.end() && previous->first + previous->second == offset) {
+        previous->second += size;
+        return;
+    }
+
+    m_offset_to_free_size.emplace(offset, size);
+}
+
+void RangeAllocator::Reset()
+{
+    m_used_size = 0;
+    m_offset_to_free_size.clear();
+    if (m_size > 0) {
+        m_offset_to_free_size.emplace(0, m_size);
+    }
+}
+
+uint64_t RangeAllocator::GetSize() const
+{
+    return m_size;
+}
+
+uint64_t RangeAllocator::GetUsedSize() const
+{
+    return m_used_size;
+}
+
+uint64_t RangeAllocator::GetLargestFreeRange() const
+{
+    uint64_t largest = 0;
+    for (const auto& [offset, size] : m_offset_to_free_size) {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
+
+size_t RangeAllocator::GetFreeRangeCount() const
+{
+    return m_offset_to_free_size.size();
+}
+
+float RangeAllocator::GetFragmentation() const
+{
+    const auto free_size = m_size - m_used_size;
+    if (free_size == 0) {
+        return 0.0f;
+    }
+    return 1.0f - static_cast<float>(GetLargestFreeRange()) / static_cast<float>(free_size);
+}
+
+}  // namespace ddn
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <map>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+namespace ddn
+{
+
+class RangeAllocator
+{
+public:
+    static constexpr uint64_t s_invalid_offset = std::numeric_limits<uint64_t>::max();
+
+    explicit RangeAllocator(uint64_t size = 0);
+
+    uint64_t Allocate(uint64_t size);
+    void Free(uint64_t offset, uint64_t size);
+    void Reset();
+
+    uint64_t GetSize() const;
+    uint64_t GetUsedSize() const;
+    uint64_t GetLargestFreeRange() const;
+    size_t GetFreeRangeCount() const;
+    float GetFragmentation() const;
+
+private:
+    uint64_t m_size = 0;
+    uint64_t m_used_size = 0;
+    std::map<uint64_t, uint64_t> m_offset_to_free_size;
+};
+
+}  // namespace ddn
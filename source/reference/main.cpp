@@ -0,0 +1,118 @@
+#include "cube.h"
+#include "camera.h"
+#include "path-tracer.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <string>
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+
+struct ReferenceOptions
+{
+    std::string output_path = "reference.ppm";
+    uint32_t width = 640;
+    uint32_t height = 360;
+    uint32_t sample_count = 64;
+    uint32_t bounce_count = 4;
+};
+
+ReferenceOptions ParseReferenceOptions(int argc, char* argv[])
+{
+    ReferenceOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view argument = argv[i];
+        if (argument.substr(0, 2) != "--") {
+            throw std::invalid_argument("Unexpected argument: " + std::string(argument));
+        }
+
+        std::string key;
+        std::string value;
+        if (const auto separator = argument.find('='); separator != std::string_view::npos) {
+            key = argument.substr(2, separator - 2);
+            value = argument.substr(separator + 1);
+        } else if (i + 1 < argc) {
+            key = argument.substr(2);
+            value = argv[++i];
+        } else {
+            throw std::invalid_argument("Missing value for argument: " + std::string(argument));
+        }
+
+        if (key == "output") {
+            options.output_path = value;
+        } else if (key == "width") {
+            options.width = static_cast<uint32_t>(std::stoul(value));
+        } else if (key == "height") {
+            options.height = static_cast<uint32_t>(std::stoul(value));
+        } else if (key == "samples") {
+            options.sample_count = static_cast<uint32_t>(std::stoul(value));
+        } else if (key == "bounces") {
+            options.bounce_count = static_cast<uint32_t>(std::stoul(value));
+        } else {
+            throw std::invalid_argument("Unknown argument: " + key);
+        }
+    }
+    return options;
+}
+
+void AddScene(ddn::PathTracer& path_tracer, const ddn::Cube& cube)
+{
+    auto ground = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, 6.0f));
+    path_tracer.AddMesh(cube, glm::scale(ground, glm::vec3(12.0f, 0.05f, 12.0f)));
+
+    for (int z = 0; z < 4; ++z) {
+        for (int x = 0; x < 5; ++x) {
+            const float height = 0.5f + 0.25f * static_cast<float>((x * 7 + z * 3) % 5);
+            auto model = glm::translate(glm::mat4(1.0f), glm::vec3(-6.0f + x * 3.0f, height - 0.95f, 2.0f + z * 3.0f));
+            model = glm::rotate(model, 0.3f * static_cast<float>(x + z), glm::vec3(0.0f, 1.0f, 0.0f));
+            path_tracer.AddMesh(cube, glm::scale(model, glm::vec3(0.6f, height, 0.6f)));
+        }
+    }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    try {
+        const auto options = ParseReferenceOptions(argc, argv);
+
+        ddn::PathTracerDesc desc;
+        desc.width = options.width;
+        desc.height = options.height;
+        desc.max_bounce_count = options.bounce_count;
+
+        const ddn::Cube cube;
+        ddn::PathTracer path_tracer(desc);
+        AddScene(path_tracer, cube);
+        path_tracer.Build();
+
+        ddn::Camera camera(options.width, options.height, 60.0f, 0.1f, 100.0f);
+        camera.SetPosition(glm::vec3(0.0f, 4.0f, -6.0f));
+        camera.LookAt(glm::vec3(0.0f, 0.0f, 6.0f));
+
+        double render_ms = 0.0;
+        uint64_t ray_count = 0;
+        for (uint32_t sample = 0; sample < options.sample_count; ++sample) {
+            path_tracer.Render(camera);
+            render_ms += path_tracer.GetStatistics().render_ms;
+            ray_count += path_tracer.GetStatistics().ray_count;
+            std::cout << "\rSample " << sample + 1 << "/" << options.sample_count << std::flush;
+        }
+        std::cout << std::endl;
+
+        path_tracer.WriteImage(options.output_path);
+        std::cout << path_tracer.GetTriangleCount() << " triangles, " << render_ms << " ms, "
+                  << ray_count / (render_ms * 1e-3) << " rays/s, written to " << options.output_path << std::endl;
+        return 0;
+    } catch (const std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 2;
+    }
+}
@@ -0,0 +1,219 @@
+#include "render-queue.h"
+#include "thread-pool.h"
+
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr uint32_t s_pass_bits = 4;
+constexpr uint32_t s_pipeline_bits = 10;
+constexpr uint32_t s_material_bits = 14;
+constexpr uint32_t s_geometry_bits = 12;
+constexpr uint32_t s_depth_bits = 24;
+
+constexpr uint32_t s_depth_shift = 0;
+constexpr uint32_t s_geometry_shift = s_depth_shift + s_depth_bits;
+constexpr uint32_t s_material_shift = s_geometry_shift + s_geometry_bits;
+constexpr uint32_t s_pipeline_shift = s_material_shift + s_material_bits;
+constexpr uint32_t s_pass_shift = s_pipeline_shift + s_pipeline_bits;
+
+static_assert(s_pass_shift + s_pass_bits == 64);
+
+constexpr uint32_t s_radix_bits = 8;
+constexpr uint32_t s_radix_size = 1 << s_radix_bits;
+constexpr uint32_t s_radix_pass_count = 64 / s_radix_bits;
+constexpr size_t s_min_chunk_size = 16384;
+
+constexpr uint64_t GetMask(uint32_t bits)
+{
+    return (uint64_t(1) << bits) - 1;
+}
+
+uint64_t EncodeField(uint32_t value, uint32_t bits, uint32_t shift)
+{
+    if (value > GetMask(bits)) {
+        throw std::out_of_range("Render key field is out of range");
+    }
+    return static_cast<uint64_t>(value) << shift;
+}
+
+uint32_t DecodeField(uint64_t sort_key, uint32_t bits, uint32_t shift)
+{
+    return static_cast<uint32_t>((sort_key >> shift) & GetMask(bits));
+}
+
+}
+
+namespace ddn
+{
+
+uint64_t EncodeRenderKey(const RenderKey& key)
+{
+    const float depth = std::clamp(std::isnan(key.depth) ? 0.0f : key.depth, 0.0f, 1.0f);
+    const auto quantized_depth = static_cast<uint32_t>(depth * static_cast<float>(GetMask(s_depth_bits)));
+
+    return EncodeField(key.pass, s_pass_bits, s_pass_shift)
+        | EncodeField(key.pipeline, s_pipeline_bits, s_pipeline_shift)
+        | EncodeField(key.material, s_material_bits, s_material_shift)
+        | EncodeField(key.geometry, s_geometry_bits, s_geometry_shift)
+        | EncodeField(quantized_depth, s_depth_bits, s_depth_shift);
+}
+
+RenderKey DecodeRenderKey(uint64_t sort_key)
+{
+    RenderKey key;
+    key.pass = DecodeField(sort_key, s_pass_bits, s_pass_shift);
+    key.pipeline = DecodeField(sort_key, s_pipeline_bits, s_pipeline_shift);
+    key.material = DecodeField(sort_key, s_material_bits, s_material_shift);
+    key.geometry = DecodeField(sort_key, s_geometry_bits, s_geometry_shift);
+    key.depth = static_cast<float>(DecodeField(sort_key, s_depth_bits, s_depth_shift)) / static_cast<float>(GetMask(s_depth_bits));
+    return key;
+}
+
+uint64_t GetRenderStateKey(uint64_t sort_key)
+{
+    return sort_key >> s_geometry_shift;
+}
+
+void RadixSort(std::span<RenderPacket> packets, std::span<RenderPacket> scratch, std::pmr::memory_resource* resource)
+{
+    if (scratch.size() < packets.size()) {
+        throw std::invalid_argument("Scratch buffer is too small");
+    }
+
+    const size_t packet_count = packets.size();
+    if (packet_count < 2) {
+        return;
+    }
+
+    const size_t max_chunk_count = static_cast<size_t>(ThreadPool::GetInstance().GetThreadCount()) * 2;
+    const size_t chunk_count = std::clamp<size_t>(packet_count / s_min_chunk_size, 1, max_chunk_count);
+    const size_t chunk_size = (packet_count + chunk_count - 1) / chunk_count;
+    std::pmr::vector<std::array<uint32_t, s_radix_size>> histograms(chunk_count, resource);
+
+    RenderPacket* source = packets.data();
+    RenderPacket* destination = scratch.data();
+
+    for (uint32_t radix_pass = 0; radix_pass < s_radix_pass_count; ++radix_pass) {
+        const uint32_t shift = radix_pass * s_radix_bits;
+
+        ParallelFor(0, chunk_count, 1, [&](size_t chunk_begin, size_t chunk_end) {
+            for (size_t chunk = chunk_begin; chunk < chunk_end; ++chunk) {
+                auto& histogram = histograms[chunk];
+                histogram.fill(0);
+
+                const size_t end = std::min(packet_count, (chunk + 1) * chunk_size);
+                for (size_t i = chunk * chunk_size; i < end; ++i) {
+                    ++histogram[(source[i].sort_key >> shift) & (s_radix_size - 1)];
+                }
+            }
+        });
+
+        bool is_sorted_by_digit = false;
+        uint32_t offset = 0;
+        for (uint32_t digit = 0; digit < s_radix_size; ++digit) {
+            uint32_t digit_count = 0;
+            for (auto& histogram : histograms) {
+                const auto count = histogram[digit];
+                histogram[digit] = offset;
+                offset += count;
+                digit_count += count;
+            }
+
+            if (digit_count == packet_count) {
+                is_sorted_by_digit = true;
+                break;
+            }
+        }
+
+        if (is_sorted_by_digit) {
+            continue;
+        }
+
+        ParallelFor(0, chunk_count, 1, [&](size_t chunk_begin, size_t chunk_end) {
+            for (size_t chunk = chunk_begin; chunk < chunk_end; ++chunk) {
+                auto& offsets = histograms[chunk];
+
+                const size_t end = std::min(packet_count, (chunk + 1) * chunk_size);
+                for (size_t i = chunk * chunk_size; i < end; ++i) {
+                    const auto digit = (source[i].sort_key >> shift) & (s_radix_size - 1);
+                    destination[offsets[digit]++] = source[i];
+                }
+            }
+        });
+
+        std::swap(source, destination);
+    }
+
+    if (source != packets.data()) {
+        std::copy(source, source + packet_count, packets.data());
+    }
+}
+
+RenderQueue::RenderQueue(std::pmr::memory_resource* resource)
+    : m_packets(resource)
+    , m_scratch(resource)
+{
+}
+
+void RenderQueue::Clear()
+{
+    m_packets.clear();
+}
+
+void RenderQueue::Reserve(size_t packet_count)
+{
+    m_packets.reserve(packet_count);
+    m_scratch.reserve(packet_count);
+}
+
+void RenderQueue::Resize(size_t packet_count)
+{
+    m_packets.resize(packet_count);
+}
+
+void RenderQueue::Add(const RenderKey& key, uint32_t item_index)
+{
+    Add(EncodeRenderKey(key), item_index);
+}
+
+void RenderQueue::Add(uint64_t sort_key, uint32_t item_index)
+{
+    m_packets.push_back({ sort_key, item_index });
+}
+
+void RenderQueue::Sort()
+{
+    if (m_scratch.size() < m_packets.size()) {
+        m_scratch.resize(m_packets.size());
+    }
+    RadixSort(m_packets, m_scratch, m_packets.get_allocator().resource());
+}
+
+void RenderQueue::BuildBatches(std::pmr::vector<RenderBatch>& batches) const
+{
+    batches.clear();
+    for (uint32_t i = 0; i < m_packets.size(); ++i) {
+        const auto state_key = GetRenderStateKey(m_packets[i].sort_key);
+        if (batches.empty() || batches.back().state_key != state_key) {
+            batches.push_back({ state_key, i, 0 });
+        }
+        ++batches.back().packet_count;
+    }
+}
+
+std::span<RenderPacket> RenderQueue::GetPackets()
+{
+    return m_packets;
+}
+
+std::span<const RenderPacket> RenderQueue::GetPackets() const
+{
+    return m_packets;
+}
+
+}  // namespace ddn
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <memory_resource>
+
+namespace ddn
+{
+
+struct RenderKey
+{
+    uint32_t pass = 0;
+    uint32_t pipeline = 0;
+    uint32_t material = 0;
+    uint32_t geometry = 0;
+    float depth = 0.0f;
+};
+
+struct RenderPacket
+{
+    uint64_t sort_key = 0;
+    uint32_t item_index = 0;
+};
+
+struct RenderBatch
+{
+    uint64_t state_key = 0;
+    uint32_t first_packet = 0;
+    uint32_t packet_count = 0;
+};
+
+uint64_t EncodeRenderKey(const RenderKey& key);
+RenderKey DecodeRenderKey(uint64_t sort_key);
+uint64_t GetRenderStateKey(uint64_t sort_key);
+
+void RadixSort(std::span<RenderPacket> packets, std::span<RenderPacket> scratch, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+class RenderQueue
+{
+public:
+    explicit RenderQueue(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    void Clear();
+    void Reserve(size_t packet_count);
+    void Resize(size_t packet_count);
+    void Add(const RenderKey& key, uint32_t item_index);
+    void Add(uint64_t sort_key, uint32_t item_index);
+
+    void Sort();
+    void BuildBatches(std::pmr::vector<RenderBatch>& batches) const;
+
+    std::span<RenderPacket> GetPackets();
+    std::span<const RenderPacket> GetPackets() const;
+
+private:
+    std::pmr::vector<RenderPacket> m_packets;
+    std::pmr::vector<RenderPacket> m_scratch;
+};
+
+}  // namespace ddn
@@ -0,0 +1,77 @@
+#include "render-state-cache.h"
+
+namespace ddn
+{
+
+RenderStateCache::RenderStateCache(ID3D12GraphicsCommandList& command_list, ID3D12PipelineState* pipeline_state)
+    : m_command_list(command_list)
+    , m_pipeline_state(pipeline_state)
+{
+}
+
+void RenderStateCache::SetPipelineState(ID3D12PipelineState* pipeline_state)
+{
+    if (Apply(m_pipeline_state == pipeline_state)) {
+        m_pipeline_state = pipeline_state;
+        m_command_list.SetPipelineState(pipeline_state);
+    }
+}
+
+void RenderStateCache::SetGraphicsRootSignature(ID3D12RootSignature* root_signature)
+{
+    if (Apply(m_root_signature == root_signature)) {
+        m_root_signature = root_signature;
+        m_command_list.SetGraphicsRootSignature(root_signature);
+    }
+}
+
+void RenderStateCache::SetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view)
+{
+    const bool is_redundant = m_has_vertex_buffer
+        && m_vertex_buffer_view.BufferLocation == view.BufferLocation
+        && m_vertex_buffer_view.SizeInBytes == view.SizeInBytes
+        && m_vertex_buffer_view.StrideInBytes == view.StrideInBytes;
+
+    if (Apply(is_redundant)) {
+        m_vertex_buffer_view = view;
+        m_has_vertex_buffer = true;
+        m_command_list.IASetVertexBuffers(0, 1, &view);
+    }
+}
+
+void RenderStateCache::SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view)
+{
+    const bool is_redundant = m_has_index_buffer
+        && m_index_buffer_view.BufferLocation == view.BufferLocation
+        && m_index_buffer_view.SizeInBytes == view.SizeInBytes
+        && m_index_buffer_view.Format == view.Format;
+
+    if (Apply(is_redundant)) {
+        m_index_buffer_view = view;
+        m_has_index_buffer = true;
+        m_command_list.IASetIndexBuffer(&view);
+    }
+}
+
+uint32_t RenderStateCache::GetAppliedCount() const
+{
+    return m_applied_count;
+}
+
+uint32_t RenderStateCache::GetSkippedCount() const
+{
+    return m_skipped_count;
+}
+
+bool RenderStateCache::Apply(bool is_redundant)
+{
+    if (is_redundant) {
+        ++m_skipped_count;
+        return false;
+    }
+
+    ++m_applied_count;
+    return true;
+}
+
+}  // namespace ddn
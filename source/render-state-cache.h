@@ -0,0 +1,38 @@
+#pragma once
+
+#include <directx/d3dx12.h>
+
+#include <cstdint>
+
+namespace ddn
+{
+
+class RenderStateCache
+{
+public:
+    explicit RenderStateCache(ID3D12GraphicsCommandList& command_list, ID3D12PipelineState* pipeline_state = nullptr);
+
+    void SetPipelineState(ID3D12PipelineState* pipeline_state);
+    void SetGraphicsRootSignature(ID3D12RootSignature* root_signature);
+    void SetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view);
+    void SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view);
+
+    uint32_t GetAppliedCount() const;
+    uint32_t GetSkippedCount() const;
+
+private:
+    bool Apply(bool is_redundant);
+
+private:
+    ID3D12GraphicsCommandList& m_command_list;
+    ID3D12PipelineState* m_pipeline_state = nullptr;
+    ID3D12RootSignature* m_root_signature = nullptr;
+    D3D12_VERTEX_BUFFER_VIEW m_vertex_buffer_view = {};
+    D3D12_INDEX_BUFFER_VIEW m_index_buffer_view = {};
+    bool m_has_vertex_buffer = false;
+    bool m_has_index_buffer = false;
+    uint32_t m_applied_count = 0;
+    uint32_t m_skipped_count = 0;
+};
+
+}  // namespace ddn
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DDN_SIMD_SSE
+#include <emmintrin.h>
+#else
+#include <cmath>
+#include <algorithm>
+#endif
+
+namespace ddn
+{
+
+#ifdef DDN_SIMD_SSE
+
+struct Mask4
+{
+    __m128 value;
+};
+
+struct Float4
+{
+    __m128 value;
+
+    static Float4 Splat(float scalar) { return { _mm_set1_ps(scalar) }; }
+    static Float4 Set(float x, float y, float z, float w) { return { _mm_setr_ps(x, y, z, w) }; }
+    static Float4 Load(const float* data) { return { _mm_loadu_ps(data) }; }
+    void Store(float* data) const { _mm_storeu_ps(data, value); }
+};
+
+inline Float4 operator +(Float4 lhs, Float4 rhs) { return { _mm_add_ps(lhs.value, rhs.value) }; }
+inline Float4 operator -(Float4 lhs, Float4 rhs) { return { _mm_sub_ps(lhs.value, rhs.value) }; }
+inline Float4 operator *(Float4 lhs, Float4 rhs) { return { _mm_mul_ps(lhs.value, rhs.value) }; }
+inline Float4 operator /(Float4 lhs, Float4 rhs) { return { _mm_div_ps(lhs.value, rhs.value) }; }
+
+inline Float4 Min(Float4 lhs, Float4 rhs) { return { _mm_min_ps(lhs.value, rhs.value) }; }
+inline Float4 Max(Float4 lhs, Float4 rhs) { return { _mm_max_ps(lhs.value, rhs.value) }; }
+inline Float4 Abs(Float4 value) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), value.value) }; }
+inline Float4 Sqrt(Float4 value) { return { _mm_sqrt_ps(value.value) }; }
+
+inline Mask4 operator <(Float4 lhs, Float4 rhs) { return { _mm_cmplt_ps(lhs.value, rhs.value) }; }
+inline Mask4 operator <=(Float4 lhs, Float4 rhs) { return { _mm_cmple_ps(lhs.value, rhs.value) }; }
+inline Mask4 operator >(Float4 lhs, Float4 rhs) { return { _mm_cmpgt_ps(lhs.value, rhs.value) }; }
+inline Mask4 operator >=(Float4 lhs, Float4 rhs) { return { _mm_cmpge_ps(lhs.value, rhs.value) }; }
+
+inline Mask4 operator &(Mask4 lhs, Mask4 rhs) { return { _mm_and_ps(lhs.value, rhs.value) }; }
+inline Mask4 operator |(Mask4 lhs, Mask4 rhs) { return { _mm_or_ps(lhs.value, rhs.value) }; }
+
+inline uint32_t GetBits(Mask4 mask) { return static_cast<uint32_t>(_mm_movemask_ps(mask.value)); }
+
+inline Float4 Select(Mask4 mask, Float4 if_true, Float4 if_false)
+{
+    return { _mm_or_ps(_mm_and_ps(mask.value, if_true.value), _mm_andnot_ps(mask.value, if_false.value)) };
+}
+
+inline float HorizontalMin(Float4 value)
+{
+    __m128 result = _mm_min_ps(value.value, _mm_shuffle_ps(value.value, value.value, _MM_SHUFFLE(1, 0, 3, 2)));
+    result = _mm_min_ps(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(result);
+}
+
+inline float HorizontalMax(Float4 value)
+{
+    __m128 result = _mm_max_ps(value.value, _mm_shuffle_ps(value.value, value.value, _MM_SHUFFLE(1, 0, 3, 2)));
+    result = _mm_max_ps(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(result);
+}
+
+inline float HorizontalSum(Float4 value)
+{
+    __m128 result = _mm_add_ps(value.value, _mm_shuffle_ps(value.value, value.value, _MM_SHUFFLE(1, 0, 3, 2)));
+    result = _mm_add_ps(result, _mm_shuffle_ps(result, result, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(result);
+}
+
+#else
+
+struct Mask4
+{
+    bool value[4];
+};
+
+struct Float4
+{
+    float value[4];
+
+    static Float4 Splat(float scalar) { return { { scalar, scalar, scalar, scalar } }; }
+    static Float4 Set(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+    static Float4 Load(const float* data) { return { { data[0], data[1], data[2], data[3] } }; }
+    void Store(float* data) const { std::copy(value, value + 4, data); }
+};
+
+inline Float4 operator +(Float4 lhs, Float4 rhs) { return { { lhs.value[0] + rhs.value[0], lhs.value[1] + rhs.value[1], lhs.value[2] + rhs.value[2], lhs.value[3] + rhs.value[3] } }; }
+inline Float4 operator -(Float4 lhs, Float4 rhs) { return { { lhs.value[0] - rhs.value[0], lhs.value[1] - rhs.value[1], lhs.value[2] - rhs.value[2], lhs.value[3] - rhs.value[3] } }; }
+inline Float4 operator *(Float4 lhs, Float4 rhs) { return { { lhs.value[0] * rhs.value[0], lhs.value[1] * rhs.value[1], lhs.value[2] * rhs.value[2], lhs.value[3] * rhs.value[3] } }; }
+inline Float4 operator /(Float4 lhs, Float4 rhs) { return { { lhs.value[0] / rhs.value[0], lhs.value[1] / rhs.value[1], lhs.value[2] / rhs.value[2], lhs.value[3] / rhs.value[3] } }; }
+
+inline Float4 Min(Float4 lhs, Float4 rhs) { return { { std::min(lhs.value[0], rhs.value[0]), std::min(lhs.value[1], rhs.value[1]), std::min(lhs.value[2], rhs.value[2]), std::min(lhs.value[3], rhs.value[3]) } }; }
+inline Float4 Max(Float4 lhs, Float4 rhs) { return { { std::max(lhs.value[0], rhs.value[0]), std::max(lhs.value[1], rhs.value[1]), std::max(lhs.value[2], rhs.value[2]), std::max(lhs.value[3], rhs.value[3]) } }; }
+inline Float4 Abs(Float4 value) { return { { std::fabs(value.value[0]), std::fabs(value.value[1]), std::fabs(value.value[2]), std::fabs(value.value[3]) } }; }
+inline Float4 Sqrt(Float4 value) { return { { std::sqrt(value.value[0]), std::sqrt(value.value[1]), std::sqrt(value.value[2]), std::sqrt(value.value[3]) } }; }
+
+inline Mask4 operator <(Float4 lhs, Float4 rhs) { return { { lhs.value[0] < rhs.value[0], lhs.value[1] < rhs.value[1], lhs.value[2] < rhs.value[2], lhs.value[3] < rhs.value[3] } }; }
+inline Mask4 operator <=(Float4 lhs, Float4 rhs) { return { { lhs.value[0] <= rhs.value[0], lhs.value[1] <= rhs.value[1], lhs.value[2] <= rhs.value[2], lhs.value[3] <= rhs.value[3] } }; }
+inline Mask4 operator >(Float4 lhs, Float4 rhs) { return rhs < lhs; }
+inline Mask4 operator >=(Float4 lhs, Float4 rhs) { return rhs <= lhs; }
+
+inline Mask4 operator &(Mask4 lhs, Mask4 rhs) { return { { lhs.value[0] && rhs.value[0], lhs.value[1] && rhs.value[1], lhs.value[2] && rhs.value[2], lhs.value[3] && rhs.value[3] } }; }
+inline Mask4 operator |(Mask4 lhs, Mask4 rhs) { return { { lhs.value[0] || rhs.value[0], lhs.value[1] || rhs.value[1], lhs.value[2] || rhs.value[2], lhs.value[3] || rhs.value[3] } }; }
+
+inline uint32_t GetBits(Mask4 mask)
+{
+    return uint32_t(mask.value[0]) | uint32_t(mask.value[1]) << 1 | uint32_t(mask.value[2]) << 2 | uint32_t(mask.value[3]) << 3;
+}
+
+inline Float4 Select(Mask4 mask, Float4 if_true, Float4 if_false)
+{
+    Float4 result;
+    for (int i = 0; i < 4; ++i) {
+        result.value[i] = mask.value[i] ? if_true.value[i] : if_false.value[i];
+    }
+    return result;
+}
+
+inline float HorizontalMin(Float4 value)
+{
+    return std::min(std::min(value.value[0], value.value[1]), std::min(value.value[2], value.value[3]));
+}
+
+inline float HorizontalMax(Float4 value)
+{
+    return std::max(std::max(value.value[0], value.value[1]), std::max(value.value[2], value.value[3]));
+}
+
+inline float HorizontalSum(Float4 value)
+{
+    return (value.value[0] + value.value[1]) + (value.value[2] + value.value[3]);
+}
+
+#endif
+
+inline bool AnyTrue(Mask4 mask) { return GetBits(mask) != 0; }
+inline bool AllTrue(Mask4 mask) { return GetBits(mask) == 0xf; }
+
+}  // namespace ddn
@@ -2,6 +2,7 @@
 
 #include "utils.h"
 #include "window.h"
+#include "profiler.h"
 #include "command-queue.h"
 
 #include <utility>
@@ -79,7 +80,10 @@ void SwapChain::Resize(uint32_t width, uint32_t height)
     width = std::max<uint32_t>(1, width);
     height = std::max<uint32_t>(1, height);
 
-    m_command_queue.Flush();
+    // ResizeBuffers requires every frame that references the back buffers to have completed, and as the last
+    // signaled value follows all submissions this idles the queue. Everything else that the resize replaces
+    // goes through a DeferredReleaseQueue instead, so only the swap chain itself still needs the idle.
+    m_fence.Wait();
 
     ReleaseBackBuffers();
 
@@ -90,16 +94,62 @@ void SwapChain::Resize(uint32_t width, uint32_t height)
     UpdateBackBuffers();
 }
 
-void SwapChain::Present()
+uint64_t SwapChain::Present()
 {
+    DDN_PROFILE_SCOPE("SwapChain::Present");
+
     auto index = GetCurrentBackBufferIndex();
     m_back_buffers[index].fence_value = m_fence.Signal(m_command_queue);
 
     UINT present_flags = m_is_tearing_supported ? DXGI_PRESENT_ALLOW_TEARING : 0;
     m_instance->Present(0, present_flags);
 
-    index = GetCurrentBackBufferIndex();
-    m_fence.Wait(m_back_buffers[index].fence_value);
+    // Rendering into the next back buffer is ordered after its previous present on the queue, so there is
+    // nothing to wait for here; callers limit how far ahead they run through the returned fence value.
+    return m_back_buffers[index].fence_value;
+}
+
+uint32_t SwapChain::GetLastPresentCount() const
+{
+    UINT present_count = 0;
+    ValidateResult(m_instance->GetLastPresentCount(&present_count));
+    return present_count;
+}
+
+std::optional<PresentTiming> SwapChain::GetLastPresentTiming() const
+{
+    DXGI_FRAME_STATISTICS statistics = {};
+    if (FAILED(m_instance->GetFrameStatistics(&statistics))) {
+        return std::nullopt;
+    }
+
+    // MSVC implements steady_clock on top of QueryPerformanceCounter, so the vblank's QPC ticks map directly
+    // to its nanoseconds.
+    LARGE_INTEGER frequency = {};
+    QueryPerformanceFrequency(&frequency);
+    const auto ticks = static_cast<uint64_t>(statistics.SyncQPCTime.QuadPart);
+    const auto ticks_per_second = static_cast<uint64_t>(frequency.QuadPart);
+    const std::chrono::nanoseconds time((ticks / ticks_per_second) * 1'000'000'000 + (ticks % ticks_per_second) * 1'000'000'000 / ticks_per_second);
+
+    PresentTiming timing;
+    timing.present_count = statistics.PresentCount;
+    timing.time = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(time));
+    return timing;
+}
+
+uint64_t SwapChain::GetCompletedFenceValue() const
+{
+    return m_fence.GetCompletedValue();
+}
+
+uint64_t SwapChain::GetSignaledFenceValue() const
+{
+    return m_fence.GetSignaledValue();
+}
+
+void SwapChain::WaitForFenceValue(uint64_t value)
+{
+    m_fence.Wait(value);
 }
 
 void SwapChain::ReleaseBackBuffers()
@@ -115,6 +165,7 @@ void SwapChain::UpdateBackBuffers()
     m_back_buffers.resize(m_back_buffer_count);
     for (uint32_t i = 0; i < m_back_buffer_count; ++i) {
         ValidateResult(m_instance->GetBuffer(i, IID_PPV_ARGS(&m_back_buffers[i].resource)));
+        TrackGpuMemory(*m_back_buffers[i].resource.Get(), MemoryTag::GpuRenderTarget);
     }
 }
 
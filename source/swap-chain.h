@@ -6,8 +6,10 @@
 #include <dxgi1_5.h>
 #include <directx/d3dx12.h>
 
+#include <chrono>
 #include <vector>
 #include <cstdint>
+#include <optional>
 
 namespace ddn
 {
@@ -15,6 +17,12 @@ namespace ddn
 class Window;
 class CommandQueue;
 
+struct PresentTiming
+{
+    uint32_t present_count = 0;
+    std::chrono::steady_clock::time_point time = {};
+};
+
 class SwapChain
 {
 public:
@@ -29,7 +37,14 @@ public:
     Microsoft::WRL::ComPtr<ID3D12Resource> GetBackBuffer(uint32_t index);
 
     void Resize(uint32_t width, uint32_t height);
-    void Present();
+    uint64_t Present();
+    uint32_t GetLastPresentCount() const;
+    // When the most recently displayed present reached the screen, from DXGI frame statistics. Empty while
+    // the statistics are unavailable, e.g. before the first vblank or after a mode change.
+    std::optional<PresentTiming> GetLastPresentTiming() const;
+    uint64_t GetCompletedFenceValue() const;
+    uint64_t GetSignaledFenceValue() const;
+    void WaitForFenceValue(uint64_t value);
 
 private:
     void ReleaseBackBuffers();
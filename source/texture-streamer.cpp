@@ -0,0 +1,386 @@
+#include "texture-streamer.h"
+#include "texture.h"
+#include "profiler.h"
+#include "thread-pool.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr size_t s_texture_grain_size = 1024;
+
+}
+
+namespace ddn
+{
+
+TextureStreamer::TextureStreamer(const TextureStreamerDesc& desc)
+    : m_desc(desc)
+{
+}
+
+StreamingTextureId TextureStreamer::AddTexture(const StreamingTextureDesc& desc)
+{
+    if (desc.width == 0 || desc.height == 0) {
+        throw std::invalid_argument("Streaming texture must not be empty");
+    }
+
+    TextureState state;
+    state.desc = desc;
+    state.mip_count = ddn::GetMipCount(desc.width, desc.height);
+    while (state.tail_mip + 1 < state.mip_count && std::max(desc.width >> state.tail_mip, desc.height >> state.tail_mip) > m_desc.tail_size) {
+        ++state.tail_mip;
+    }
+    state.resident_mip = state.tail_mip;
+    state.desired_lod = static_cast<float>(state.mip_count);
+    state.is_active = true;
+
+    StreamingTextureId id = 0;
+    if (m_free_ids.empty()) {
+        id = static_cast<StreamingTextureId>(m_textures.size());
+        m_textures.push_back(state);
+    } else {
+        id = m_free_ids.back();
+        m_free_ids.pop_back();
+        m_textures[id] = state;
+    }
+
+    for (uint32_t mip = state.tail_mip; mip < state.mip_count; ++mip) {
+        m_statistics.resident_size += GetMipSize(id, mip);
+    }
+    return id;
+}
+
+void TextureStreamer::RemoveTexture(StreamingTextureId id)
+{
+    auto& state = GetState(id);
+    for (uint32_t mip = state.resident_mip; mip < state.mip_count; ++mip) {
+        m_statistics.resident_size -= GetMipSize(id, mip);
+    }
+    if (state.pending_mip != s_no_mip) {
+        m_statistics.pending_size -= GetMipSize(id, state.pending_mip);
+        --m_statistics.pending_load_count;
+    }
+
+    state = {};
+    m_free_ids.push_back(id);
+}
+
+void TextureStreamer::SetBounds(StreamingTextureId id, const Sphere& bounds)
+{
+    GetState(id).desc.bounds = bounds;
+}
+
+std::span<const StreamingRequest> TextureStreamer::Update(const Camera& camera)
+{
+    DDN_PROFILE_FUNCTION();
+
+    m_requests.clear();
+    m_load_candidates.clear();
+    m_has_eviction_candidates = false;
+    ++m_update_index;
+
+    UpdateDesiredLods(camera);
+
+    for (StreamingTextureId id = 0; id < m_textures.size(); ++id) {
+        auto& state = m_textures[id];
+        if (!state.is_active || state.pending_mip != s_no_mip) {
+            state.unwanted_update_count = 0;
+            continue;
+        }
+
+        const auto resident_lod = static_cast<float>(state.resident_mip);
+        if (state.resident_mip < state.tail_mip && state.desired_lod >= resident_lod + 1.0f + m_desc.hysteresis) {
+            if (++state.unwanted_update_count >= m_desc.eviction_delay) {
+                Evict(id, false);
+            }
+        } else {
+            state.unwanted_update_count = 0;
+        }
+
+        if (state.resident_mip > 0 && state.desired_lod < static_cast<float>(state.resident_mip)) {
+            m_load_candidates.push_back({ id, static_cast<float>(state.resident_mip) - state.desired_lod });
+        }
+    }
+
+    std::sort(m_load_candidates.begin(), m_load_candidates.end(), [](const LoadCandidate& lhs, const LoadCandidate& rhs) {
+        return lhs.priority != rhs.priority ? lhs.priority > rhs.priority : lhs.texture < rhs.texture;
+    });
+
+    for (const auto& candidate : m_load_candidates) {
+        if (m_statistics.pending_load_count >= m_desc.max_pending_load_count) {
+            break;
+        }
+
+        // Budget evictions may have just dropped this texture's finest mip; reloading it would thrash.
+        auto& state = m_textures[candidate.texture];
+        if (state.eviction_update == m_update_index) {
+            continue;
+        }
+
+        const uint32_t mip = state.resident_mip - 1;
+        const uint64_t size = GetMipSize(candidate.texture, mip);
+        if (!MakeRoom(size, candidate.priority)) {
+            continue;
+        }
+
+        if (mip == state.evicted_mip && m_update_index - state.eviction_update <= m_desc.eviction_delay) {
+            ++m_statistics.reload_count;
+        }
+        state.pending_mip = mip;
+        state.pending_serial = m_next_serial++;
+        m_statistics.pending_size += size;
+        ++m_statistics.pending_load_count;
+        ++m_statistics.load_count;
+        m_requests.push_back({ StreamingRequestType::Load, candidate.texture, mip, size, candidate.priority, state.pending_serial });
+    }
+    return m_requests;
+}
+
+void TextureStreamer::CompleteLoad(const StreamingRequest& request)
+{
+    const StreamingTextureId id = request.texture;
+    const uint32_t mip = request.mip;
+    if (request.type != StreamingRequestType::Load) {
+        throw std::invalid_argument("Only loads can be completed");
+    }
+    if (id >= m_textures.size()) {
+        throw std::out_of_range("Invalid streaming texture id");
+    }
+
+    auto& state = m_textures[id];
+    if (!state.is_active || state.pending_mip != mip || state.pending_serial != request.serial) {
+        return;
+    }
+
+    const uint64_t size = GetMipSize(id, mip);
+    m_statistics.pending_size -= size;
+    m_statistics.resident_size += size;
+    --m_statistics.pending_load_count;
+    state.resident_mip = mip;
+    state.pending_mip = s_no_mip;
+}
+
+uint32_t TextureStreamer::GetMipCount(StreamingTextureId id) const
+{
+    return GetState(id).mip_count;
+}
+
+uint32_t TextureStreamer::GetResidentMip(StreamingTextureId id) const
+{
+    return GetState(id).resident_mip;
+}
+
+uint32_t TextureStreamer::GetPendingMip(StreamingTextureId id) const
+{
+    return GetState(id).pending_mip;
+}
+
+float TextureStreamer::GetDesiredLod(StreamingTextureId id) const
+{
+    return GetState(id).desired_lod;
+}
+
+uint64_t TextureStreamer::GetMipSize(StreamingTextureId id, uint32_t mip) const
+{
+    const auto& state = GetState(id);
+    if (mip >= state.mip_count) {
+        throw std::out_of_range("Mip exceeds mip count");
+    }
+    return GetImageByteCount(state.desc.format, std::max(state.desc.width >> mip, 1u), std::max(state.desc.height >> mip, 1u));
+}
+
+size_t TextureStreamer::GetTextureCount() const
+{
+    return m_textures.size() - m_free_ids.size();
+}
+
+const TextureStreamerDesc& TextureStreamer::GetDesc() const
+{
+    return m_desc;
+}
+
+const TextureStreamerStatistics& TextureStreamer::GetStatistics() const
+{
+    return m_statistics;
+}
+
+TextureStreamer::TextureState& TextureStreamer::GetState(StreamingTextureId id)
+{
+    if (id >= m_textures.size() || !m_textures[id].is_active) {
+        throw std::out_of_range("Invalid streaming texture id");
+    }
+    return m_textures[id];
+}
+
+const TextureStreamer::TextureState& TextureStreamer::GetState(StreamingTextureId id) const
+{
+    if (id >= m_textures.size() || !m_textures[id].is_active) {
+        throw std::out_of_range("Invalid streaming texture id");
+    }
+    return m_textures[id];
+}
+
+void TextureStreamer::UpdateDesiredLods(const Camera& camera)
+{
+    DDN_PROFILE_FUNCTION();
+
+    // A sphere of radius r at distance d covers about r * cot(fov / 2) * height / d pixels vertically.
+    const auto& frustum = camera.GetFrustum();
+    const auto position = camera.GetPosition();
+    const float pixel_scale = camera.GetProjectionMatrix()[1][1] * static_cast<float>(camera.GetHeight());
+    const float near_z = camera.GetNearZ();
+
+    ParallelFor(0, m_textures.size(), s_texture_grain_size, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            auto& state = m_textures[i];
+            if (!state.is_active) {
+                continue;
+            }
+
+            // Textures out of view want nothing above the tail, so they drain once the eviction delay passes.
+            const auto& bounds = state.desc.bounds;
+            const float max_lod = static_cast<float>(state.mip_count);
+            if (!frustum.Intersects(bounds)) {
+                state.desired_lod = max_lod;
+                continue;
+            }
+
+            const float distance = std::max(glm::length(bounds.center - position) - bounds.radius, near_z);
+            const float pixel_count = bounds.radius * pixel_scale / distance;
+            const float texel_count = static_cast<float>(std::max(state.desc.width, state.desc.height)) * state.desc.uv_density;
+            const float lod = pixel_count > 0.0f ? std::log2(texel_count / pixel_count) + m_desc.lod_bias : max_lod;
+            state.desired_lod = std::clamp(lod, 0.0f, max_lod);
+        }
+    });
+}
+
+void TextureStreamer::Evict(StreamingTextureId id, bool is_budget_eviction)
+{
+    auto& state = m_textures[id];
+    const uint32_t mip = state.resident_mip;
+    const uint64_t size = GetMipSize(id, mip);
+
+    m_statistics.resident_size -= size;
+    ++m_statistics.eviction_count;
+    if (is_budget_eviction) {
+        ++m_statistics.budget_eviction_count;
+    }
+
+    state.resident_mip = mip + 1;
+    state.unwanted_update_count = 0;
+    state.evicted_mip = mip;
+    state.eviction_update = m_update_index;
+    m_requests.push_back({ StreamingRequestType::Evict, id, mip, size, 0.0f });
+}
+
+// Evicts finest mips of the textures that would be least short of their desired LOD afterwards, but only
+// while that shortfall stays below the requesting load's by the hysteresis margin.
+bool TextureStreamer::MakeRoom(uint64_t size, float deficit)
+{
+    const auto fits = [&]() {
+        return m_statistics.resident_size + m_statistics.pending_size + size <= m_desc.memory_budget;
+    };
+    if (fits()) {
+        return true;
+    }
+
+    const auto get_eviction_deficit = [](const TextureState& state) {
+        return static_cast<float>(state.resident_mip + 1) - state.desired_lod;
+    };
+    const auto is_evictable = [](const TextureState& state) {
+        return state.is_active && state.pending_mip == s_no_mip && state.resident_mip < state.tail_mip;
+    };
+    const auto is_more_evictable = [](const EvictionCandidate& lhs, const EvictionCandidate& rhs) {
+        return lhs.deficit > rhs.deficit;
+    };
+
+    if (!m_has_eviction_candidates) {
+        m_eviction_candidates.clear();
+        for (StreamingTextureId id = 0; id < m_textures.size(); ++id) {
+            if (is_evictable(m_textures[id])) {
+                m_eviction_candidates.push_back({ id, get_eviction_deficit(m_textures[id]) });
+            }
+        }
+        std::make_heap(m_eviction_candidates.begin(), m_eviction_candidates.end(), is_more_evictable);
+        m_has_eviction_candidates = true;
+    }
+
+    while (!fits()) {
+        if (m_eviction_candidates.empty() || m_eviction_candidates.front().deficit >= deficit - m_desc.hysteresis) {
+            return false;
+        }
+
+        std::pop_heap(m_eviction_candidates.begin(), m_eviction_candidates.end(), is_more_evictable);
+        const auto victim = m_eviction_candidates.back();
+        m_eviction_candidates.pop_back();
+
+        // Entries go stale when a texture gets a pending load or was already evicted this update.
+        const auto& state = m_textures[victim.texture];
+        if (!is_evictable(state)) {
+            continue;
+        }
+        if (get_eviction_deficit(state) != victim.deficit) {
+            m_eviction_candidates.push_back({ victim.texture, get_eviction_deficit(state) });
+            std::push_heap(m_eviction_candidates.begin(), m_eviction_candidates.end(), is_more_evictable);
+            continue;
+        }
+
+        Evict(victim.texture, true);
+        if (is_evictable(state)) {
+            m_eviction_candidates.push_back({ victim.texture, get_eviction_deficit(state) });
+            std::push_heap(m_eviction_candidates.begin(), m_eviction_candidates.end(), is_more_evictable);
+        }
+    }
+    return true;
+}
+
+SimulatedTextureLoader::SimulatedTextureLoader(const SimulatedTextureLoaderDesc& desc)
+    : m_desc(desc)
+{
+}
+
+void SimulatedTextureLoader::Submit(std::span<const StreamingRequest> requests)
+{
+    for (const auto& request : requests) {
+        if (request.type == StreamingRequestType::Load) {
+            m_pending_loads.push_back({ request, m_update_index + m_desc.latency });
+        }
+    }
+}
+
+void SimulatedTextureLoader::Update(TextureStreamer& streamer)
+{
+    ++m_update_index;
+
+    // A load larger than the per-update bandwidth still completes when it is first in line.
+    uint64_t completed_size = 0;
+    while (!m_pending_loads.empty() && completed_size < m_desc.bandwidth) {
+        const auto& load = m_pending_loads.front();
+        if (load.ready_update > m_update_index) {
+            break;
+        }
+
+        streamer.CompleteLoad(load.request);
+        completed_size += load.request.size;
+        m_loaded_size += load.request.size;
+        m_pending_loads.pop_front();
+    }
+}
+
+size_t SimulatedTextureLoader::GetPendingCount() const
+{
+    return m_pending_loads.size();
+}
+
+uint64_t SimulatedTextureLoader::GetLoadedSize() const
+{
+    return m_loaded_size;
+}
+
+}  // namespace ddn
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "bounds.h"
+#include "camera.h"
+#include "block-compression.h"
+
+#include <span>
+#include <deque>
+#include <limits>
+#include <vector>
+#include <cstdint>
+
+namespace ddn
+{
+
+using StreamingTextureId = uint32_t;
+
+struct StreamingTextureDesc
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    TextureFormat format = TextureFormat::Bc7;
+    Sphere bounds;
+    float uv_density = 1.0f;
+};
+
+struct TextureStreamerDesc
+{
+    uint64_t memory_budget = 256ull * 1024 * 1024;
+    uint32_t tail_size = 64;
+    uint32_t max_pending_load_count = 32;
+    float lod_bias = 0.0f;
+    float hysteresis = 0.5f;
+    uint32_t eviction_delay = 30;
+};
+
+enum class StreamingRequestType
+{
+    Load,
+    Evict,
+};
+
+struct StreamingRequest
+{
+    StreamingRequestType type = StreamingRequestType::Load;
+    StreamingTextureId texture = 0;
+    uint32_t mip = 0;
+    uint64_t size = 0;
+    float priority = 0.0f;
+    uint64_t serial = 0;
+};
+
+struct TextureStreamerStatistics
+{
+    uint64_t resident_size = 0;
+    uint64_t pending_size = 0;
+    uint32_t pending_load_count = 0;
+    uint64_t load_count = 0;
+    uint64_t eviction_count = 0;
+    uint64_t budget_eviction_count = 0;
+    uint64_t reload_count = 0;
+};
+
+// Decides which mips of each texture should be resident. Mips no larger than tail_size are always
+// resident; above that a texture holds a contiguous chain from its finest resident mip down, which grows
+// one level per completed load. A mip is loaded while the desired LOD is below it and evicted once the
+// desired LOD has stayed at least 1 + hysteresis levels coarser for eviction_delay updates, or earlier when
+// the budget is needed for a load with a larger LOD deficit.
+class TextureStreamer
+{
+public:
+    static constexpr uint32_t s_no_mip = std::numeric_limits<uint32_t>::max();
+
+    explicit TextureStreamer(const TextureStreamerDesc& desc = {});
+
+    StreamingTextureId AddTexture(const StreamingTextureDesc& desc);
+    void RemoveTexture(StreamingTextureId id);
+    void SetBounds(StreamingTextureId id, const Sphere& bounds);
+
+    // Returns this update's requests, loads in priority order. Evictions take effect immediately, loads
+    // count against the budget until CompleteLoad. Each load carries a serial, so loads for removed textures
+    // complete as no-ops even after their id has been reused.
+    std::span<const StreamingRequest> Update(const Camera& camera);
+    void CompleteLoad(const StreamingRequest& request);
+
+    uint32_t GetMipCount(StreamingTextureId id) const;
+    uint32_t GetResidentMip(StreamingTextureId id) const;
+    uint32_t GetPendingMip(StreamingTextureId id) const;
+    float GetDesiredLod(StreamingTextureId id) const;
+    uint64_t GetMipSize(StreamingTextureId id, uint32_t mip) const;
+
+    size_t GetTextureCount() const;
+    const TextureStreamerDesc& GetDesc() const;
+    const TextureStreamerStatistics& GetStatistics() const;
+
+private:
+    struct TextureState
+    {
+        StreamingTextureDesc desc;
+        uint32_t mip_count = 0;
+        uint32_t tail_mip = 0;
+        uint32_t resident_mip = 0;
+        uint32_t pending_mip = s_no_mip;
+        uint64_t pending_serial = 0;
+        uint32_t unwanted_update_count = 0;
+        uint32_t evicted_mip = s_no_mip;
+        uint64_t eviction_update = 0;
+        float desired_lod = 0.0f;
+        bool is_active = false;
+    };
+
+    struct LoadCandidate
+    {
+        StreamingTextureId texture = 0;
+        float priority = 0.0f;
+    };
+
+    struct EvictionCandidate
+    {
+        StreamingTextureId texture = 0;
+        float deficit = 0.0f;
+    };
+
+    TextureState& GetState(StreamingTextureId id);
+    const TextureState& GetState(StreamingTextureId id) const;
+
+    void UpdateDesiredLods(const Camera& camera);
+    void Evict(StreamingTextureId id, bool is_budget_eviction);
+    bool MakeRoom(uint64_t size, float deficit);
+
+private:
+    TextureStreamerDesc m_desc;
+    TextureStreamerStatistics m_statistics;
+    std::vector<TextureState> m_textures;
+    std::vector<StreamingTextureId> m_free_ids;
+    std::vector<StreamingRequest> m_requests;
+    std::vector<LoadCandidate> m_load_candidates;
+    std::vector<EvictionCandidate> m_eviction_candidates;
+    bool m_has_eviction_candidates = false;
+    uint64_t m_update_index = 0;
+    uint64_t m_next_serial = 1;
+};
+
+struct SimulatedTextureLoaderDesc
+{
+    uint32_t latency = 2;
+    uint64_t bandwidth = 32ull * 1024 * 1024;
+};
+
+// Stand-in for the IO path: loads finish in submission order, no sooner than latency updates after
+// submission and with at most bandwidth bytes completed per update.
+class SimulatedTextureLoader
+{
+public:
+    explicit SimulatedTextureLoader(const SimulatedTextureLoaderDesc& desc = {});
+
+    void Submit(std::span<const StreamingRequest> requests);
+    void Update(TextureStreamer& streamer);
+
+    size_t GetPendingCount() const;
+    uint64_t GetLoadedSize() const;
+
+private:
+    struct PendingLoad
+    {
+        StreamingRequest request;
+        uint64_t ready_update = 0;
+    };
+
+private:
+    SimulatedTextureLoaderDesc m_desc;
+    std::deque<PendingLoad> m_pending_loads;
+    uint64_t m_update_index = 0;
+    uint64_t m_loaded_size = 0;
+};
+
+}  // namespace ddn
@@ -0,0 +1,196 @@
+#include "texture.h"
+#include "profiler.h"
+#include "thread-pool.h"
+
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr size_t s_row_grain_size = 16;
+constexpr uint32_t s_linear_table_size = 4096;
+
+constexpr uint32_t s_dds_magic = 0x20534444;
+constexpr uint32_t s_dx10_four_cc = 0x30315844;
+
+const std::array<float, 256>& GetSrgbToLinearTable()
+{
+    static const auto s_table = []() {
+        std::array<float, 256> table;
+        for (uint32_t i = 0; i < table.size(); ++i) {
+            const float value = i / 255.0f;
+            table[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+        }
+        return table;
+    }();
+    return s_table;
+}
+
+const std::array<uint8_t, s_linear_table_size>& GetLinearToSrgbTable()
+{
+    static const auto s_table = []() {
+        std::array<uint8_t, s_linear_table_size> table;
+        for (uint32_t i = 0; i < table.size(); ++i) {
+            const float value = i / float(s_linear_table_size - 1);
+            const float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+            table[i] = static_cast<uint8_t>(std::lround(std::clamp(srgb, 0.0f, 1.0f) * 255.0f));
+        }
+        return table;
+    }();
+    return s_table;
+}
+
+ddn::Image Downsample(const ddn::Image& source, bool is_srgb)
+{
+    const auto& to_linear = GetSrgbToLinearTable();
+    const auto& to_srgb = GetLinearToSrgbTable();
+
+    ddn::Image result;
+    result.width = std::max(source.width / 2, 1u);
+    result.height = std::max(source.height / 2, 1u);
+    result.pixels.resize(size_t(result.width) * result.height * 4);
+
+    ddn::ParallelFor(0, result.height, s_row_grain_size, [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; ++y) {
+            const size_t y0 = std::min<size_t>(y * 2, source.height - 1);
+            const size_t y1 = std::min<size_t>(y * 2 + 1, source.height - 1);
+            for (size_t x = 0; x < result.width; ++x) {
+                const size_t x0 = std::min<size_t>(x * 2, source.width - 1);
+                const size_t x1 = std::min<size_t>(x * 2 + 1, source.width - 1);
+                const std::array<const uint8_t*, 4> samples = {
+                    source.pixels.data() + (y0 * source.width + x0) * 4,
+                    source.pixels.data() + (y0 * source.width + x1) * 4,
+                    source.pixels.data() + (y1 * source.width + x0) * 4,
+                    source.pixels.data() + (y1 * source.width + x1) * 4,
+                };
+
+                auto* destination = result.pixels.data() + (y * result.width + x) * 4;
+                for (uint32_t c = 0; c < 4; ++c) {
+                    if (is_srgb && c < 3) {
+                        const float sum = to_linear[samples[0][c]] + to_linear[samples[1][c]] + to_linear[samples[2][c]] + to_linear[samples[3][c]];
+                        destination[c] = to_srgb[static_cast<size_t>(sum * 0.25f * (s_linear_table_size - 1) + 0.5f)];
+                    } else {
+                        destination[c] = static_cast<uint8_t>((samples[0][c] + samples[1][c] + samples[2][c] + samples[3][c] + 2) / 4);
+                    }
+                }
+            }
+        }
+    });
+    return result;
+}
+
+uint32_t GetDxgiFormat(ddn::TextureFormat format, bool is_srgb)
+{
+    switch (format) {
+    case ddn::TextureFormat::Rgba8:
+        return is_srgb ? 29 : 28;
+    case ddn::TextureFormat::Bc1:
+        return is_srgb ? 72 : 71;
+    case ddn::TextureFormat::Bc3:
+        return is_srgb ? 78 : 77;
+    case ddn::TextureFormat::Bc4:
+        return 80;
+    case ddn::TextureFormat::Bc5:
+        return 83;
+    case ddn::TextureFormat::Bc7:
+        return is_srgb ? 99 : 98;
+    default:
+        throw std::invalid_argument("Unsupported texture format");
+    }
+}
+
+}
+
+namespace ddn
+{
+
+uint32_t GetMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t count = 1;
+    while (width > 1 || height > 1) {
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        ++count;
+    }
+    return count;
+}
+
+std::vector<Image> GenerateMipChain(const Image& image, bool is_srgb)
+{
+    DDN_PROFILE_FUNCTION();
+
+    if (image.width == 0 || image.height == 0 || image.pixels.size() != size_t(image.width) * image.height * 4) {
+        throw std::invalid_argument("Expected a non-empty RGBA8 image");
+    }
+
+    std::vector<Image> mips;
+    mips.reserve(GetMipCount(image.width, image.height));
+    mips.push_back(image);
+    while (mips.back().width > 1 || mips.back().height > 1) {
+        mips.push_back(Downsample(mips.back(), is_srgb));
+    }
+    return mips;
+}
+
+Texture CreateTexture(const Image& image, const TextureDesc& desc)
+{
+    DDN_PROFILE_FUNCTION();
+
+    // Channels without sRGB variants (BC4/BC5) always hold linear data such as normals.
+    const bool is_srgb = desc.is_srgb && GetChannelCount(desc.format) >= 3;
+    auto images = desc.has_mips ? GenerateMipChain(image, is_srgb) : std::vector<Image>{ image };
+
+    Texture texture;
+    texture.format = desc.format;
+    texture.is_srgb = is_srgb;
+    texture.mips.reserve(images.size());
+    for (auto& mip : images) {
+        auto data = IsBlockCompressed(desc.format) ? CompressImage(mip.pixels, mip.width, mip.height, desc.format, desc.quality) : std::move(mip.pixels);
+        texture.mips.push_back({ mip.width, mip.height, std::move(data) });
+    }
+    return texture;
+}
+
+void WriteDds(const std::filesystem::path& file_path, const Texture& texture)
+{
+    if (texture.mips.empty()) {
+        throw std::invalid_argument("Texture has no mips");
+    }
+
+    std::ofstream stream(file_path, std::ios::binary);
+    if (!stream) {
+        throw std::runtime_error("Failed to open texture file");
+    }
+
+    const auto& top = texture.mips.front();
+    const bool is_compressed = IsBlockCompressed(texture.format);
+    const bool has_mips = texture.mips.size() > 1;
+
+    // Magic, the 124-byte DDS_HEADER and the 20-byte DDS_HEADER_DXT10.
+    std::array<uint32_t, 1 + 31 + 5> header = {};
+    header[0] = s_dds_magic;
+    header[1] = 124;
+    header[2] = 0x1 | 0x2 | 0x4 | 0x1000 | (has_mips ? 0x20000 : 0) | (is_compressed ? 0x80000 : 0x8);
+    header[3] = top.height;
+    header[4] = top.width;
+    header[5] = is_compressed ? static_cast<uint32_t>(top.data.size()) : top.width * 4;
+    header[7] = static_cast<uint32_t>(texture.mips.size());
+    header[19] = 32;
+    header[20] = 0x4;
+    header[21] = s_dx10_four_cc;
+    header[27] = 0x1000 | (has_mips ? 0x8 | 0x400000 : 0);
+    header[32] = GetDxgiFormat(texture.format, texture.is_srgb);
+    header[33] = 3;
+    header[35] = 1;
+    stream.write(reinterpret_cast<const char*>(header.data()), sizeof(header));
+
+    for (const auto& mip : texture.mips) {
+        stream.write(reinterpret_cast<const char*>(mip.data.data()), static_cast<std::streamsize>(mip.data.size()));
+    }
+}
+
+}  // namespace ddn
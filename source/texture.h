@@ -0,0 +1,52 @@
+#pragma once
+
+#include "block-compression.h"
+
+#include <vector>
+#include <cstdint>
+#include <filesystem>
+
+namespace ddn
+{
+
+struct Image
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+struct TextureDesc
+{
+    TextureFormat format = TextureFormat::Bc7;
+    CompressionQuality quality = CompressionQuality::Fast;
+    bool is_srgb = true;
+    bool has_mips = true;
+};
+
+struct TextureMip
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> data;
+};
+
+struct Texture
+{
+    TextureFormat format = TextureFormat::Rgba8;
+    bool is_srgb = false;
+    std::vector<TextureMip> mips;
+};
+
+uint32_t GetMipCount(uint32_t width, uint32_t height);
+
+// Box-filtered RGBA8 chain down to 1x1, starting with a copy of the source. sRGB color is averaged in
+// linear space; alpha is always linear.
+std::vector<Image> GenerateMipChain(const Image& image, bool is_srgb);
+
+Texture CreateTexture(const Image& image, const TextureDesc& desc = {});
+
+// DDS with a DX10 header, loadable by the usual DirectX texture tools.
+void WriteDds(const std::filesystem::path& file_path, const Texture& texture);
+
+}  // namespace ddn
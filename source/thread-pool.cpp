@@ -0,0 +1,156 @@
+#include "thread-pool.h"
+
+#include <algorithm>
+
+namespace
+{
+
+constexpr size_t s_job_capacity = 64;
+
+thread_local uint32_t s_current_thread_index = 0;
+
+}
+
+namespace ddn
+{
+
+ThreadPool& ThreadPool::GetInstance()
+{
+    static ThreadPool thread_pool;
+    return thread_pool;
+}
+
+ThreadPool::ThreadPool(uint32_t worker_count)
+{
+    m_jobs.reserve(s_job_capacity);
+    m_workers.reserve(worker_count);
+    for (uint32_t i = 0; i < worker_count; ++i) {
+        m_workers.emplace_back(&ThreadPool::RunWorker, this, i + 1);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard guard(m_mutex);
+        m_is_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+uint32_t ThreadPool::GetThreadCount() const
+{
+    return static_cast<uint32_t>(m_workers.size()) + 1;
+}
+
+uint32_t ThreadPool::GetCurrentThreadIndex()
+{
+    return s_current_thread_index;
+}
+
+uint32_t ThreadPool::GetDefaultWorkerCount()
+{
+    const auto hardware_thread_count = std::thread::hardware_concurrency();
+    return hardware_thread_count > 1 ? hardware_thread_count - 1 : 0;
+}
+
+void ThreadPool::Execute(Job& job)
+{
+    if (job.end <= job.begin) {
+        return;
+    }
+
+    job.grain_size = std::max<size_t>(1, job.grain_size);
+    job.chunk_count = (job.end - job.begin + job.grain_size - 1) / job.grain_size;
+
+    if (job.chunk_count == 1 || m_workers.empty()) {
+        job.invoke(job.context, job.begin, job.end);
+        return;
+    }
+
+    {
+        std::lock_guard guard(m_mutex);
+        m_jobs.push_back(&job);
+    }
+    m_condition.notify_all();
+
+    ExecuteChunks(job);
+    RemoveJob(job);
+
+    while (job.completed_chunks.load(std::memory_order_acquire) != job.chunk_count || job.active_workers.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+
+    if (job.exception) {
+        std::rethrow_exception(job.exception);
+    }
+}
+
+void ThreadPool::ExecuteChunks(Job& job)
+{
+    while (true) {
+        const auto chunk = job.next_chunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= job.chunk_count) {
+            return;
+        }
+
+        const auto chunk_begin = job.begin + chunk * job.grain_size;
+        const auto chunk_end = std::min(job.end, chunk_begin + job.grain_size);
+
+        if (!job.has_exception.load(std::memory_order_relaxed)) {
+            try {
+                job.invoke(job.context, chunk_begin, chunk_end);
+            } catch (...) {
+                if (!job.has_exception.exchange(true)) {
+                    job.exception = std::current_exception();
+                }
+            }
+        }
+
+        job.completed_chunks.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void ThreadPool::RemoveJob(Job& job)
+{
+    std::lock_guard guard(m_mutex);
+    auto it = std::find(m_jobs.begin(), m_jobs.end(), &job);
+    if (it != m_jobs.end()) {
+        m_jobs.erase(it);
+    }
+}
+
+void ThreadPool::RunWorker(uint32_t thread_index)
+{
+    s_current_thread_index = thread_index;
+
+    while (true) {
+        Job* job = nullptr;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this]() {
+                return m_is_stopping || !m_jobs.empty();
+            });
+
+            if (m_is_stopping) {
+                return;
+            }
+
+            job = m_jobs.front();
+            if (job->next_chunk.load(std::memory_order_relaxed) >= job->chunk_count) {
+                m_jobs.erase(m_jobs.begin());
+                continue;
+            }
+            job->active_workers.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ExecuteChunks(*job);
+        job->active_workers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+}  // namespace ddn
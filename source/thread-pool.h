@@ -0,0 +1,84 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <exception>
+#include <type_traits>
+#include <condition_variable>
+
+namespace ddn
+{
+
+class ThreadPool
+{
+public:
+    static ThreadPool& GetInstance();
+
+    explicit ThreadPool(uint32_t worker_count = GetDefaultWorkerCount());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator =(const ThreadPool& other) = delete;
+
+    uint32_t GetThreadCount() const;
+
+    // 0 for threads outside any pool, otherwise 1 + the worker's index in its pool.
+    static uint32_t GetCurrentThreadIndex();
+
+    template <typename Function>
+    void ParallelFor(size_t begin, size_t end, size_t grain_size, Function&& function)
+    {
+        using FunctionType = std::remove_reference_t<Function>;
+
+        Job job;
+        job.invoke = [](void* context, size_t chunk_begin, size_t chunk_end) {
+            (*static_cast<FunctionType*>(context))(chunk_begin, chunk_end);
+        };
+        job.context = const_cast<void*>(static_cast<const void*>(&function));
+        job.begin = begin;
+        job.end = end;
+        job.grain_size = grain_size;
+        Execute(job);
+    }
+
+    static uint32_t GetDefaultWorkerCount();
+
+private:
+    struct Job
+    {
+        void (*invoke)(void* context, size_t chunk_begin, size_t chunk_end) = nullptr;
+        void* context = nullptr;
+        size_t begin = 0;
+        size_t end = 0;
+        size_t grain_size = 1;
+        size_t chunk_count = 0;
+        std::atomic_size_t next_chunk = 0;
+        std::atomic_size_t completed_chunks = 0;
+        std::atomic_uint32_t active_workers = 0;
+        std::atomic_bool has_exception = false;
+        std::exception_ptr exception;
+    };
+
+    void Execute(Job& job);
+    void ExecuteChunks(Job& job);
+    void RemoveJob(Job& job);
+    void RunWorker(uint32_t thread_index);
+
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<Job*> m_jobs;
+    bool m_is_stopping = false;
+};
+
+template <typename Function>
+void ParallelFor(size_t begin, size_t end, size_t grain_size, Function&& function)
+{
+    ThreadPool::GetInstance().ParallelFor(begin, end, grain_size, std::forward<Function>(function));
+}
+
+}  // namespace ddn
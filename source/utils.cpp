@@ -3,6 +3,7 @@
 #include <d3dcompiler.h>
 #include <directx/d3dx12.h>
 
+#include <atomic>
 #include <sstream>
 #include <stdexcept>
 #include <type_traits>
@@ -22,6 +23,56 @@ T CreateFlags(T initial_flags, T debug_flag)
     return flags;
 }
 
+// Attached to a resource as private data, so that the resource releases it, and with it the recorded size,
+// when the resource itself is destroyed.
+class GpuMemoryRecord : public IUnknown
+{
+public:
+    GpuMemoryRecord(ddn::MemoryTag tag, uint64_t size)
+        : m_tag(tag)
+        , m_size(size)
+    {
+        ddn::RecordAllocation(m_tag, m_size);
+    }
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+    {
+        if (!object) {
+            return E_POINTER;
+        }
+        if (riid != __uuidof(IUnknown)) {
+            *object = nullptr;
+            return E_NOINTERFACE;
+        }
+        *object = static_cast<IUnknown*>(this);
+        AddRef();
+        return S_OK;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override
+    {
+        return m_reference_count.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        const auto reference_count = m_reference_count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+        if (reference_count == 0) {
+            ddn::RecordDeallocation(m_tag, m_size);
+            delete this;
+        }
+        return reference_count;
+    }
+
+private:
+    std::atomic<ULONG> m_reference_count = 1;
+    ddn::MemoryTag m_tag;
+    uint64_t m_size = 0;
+};
+
+// {5B0C8E21-7F4A-4D3B-9C62-1E8A4F7D03B5}
+constexpr GUID s_gpu_memory_record_guid = { 0x5b0c8e21, 0x7f4a, 0x4d3b, { 0x9c, 0x62, 0x1e, 0x8a, 0x4f, 0x7d, 0x03, 0xb5 } };
+
 }
 
 namespace ddn
@@ -52,6 +103,24 @@ ComPtr<ID3DBlob> CompileShader(const std::filesystem::path& file_path, const std
     return shader;
 }
 
+ComPtr<ID3DBlob> CompileShader(std::span<const uint8_t> source, const std::string& source_name, const std::string& entry_point, const std::string& compiler_target)
+{
+    ComPtr<ID3DBlob> shader;
+    ComPtr<ID3DBlob> error;
+    auto compiler_flags = CreateFlags<UINT>(0, D3DCOMPILE_DEBUG);
+    auto hr = D3DCompile(source.data(), source.size(), source_name.c_str(), nullptr, nullptr, entry_point.c_str(), compiler_target.c_str(), compiler_flags, 0, &shader, &error);
+
+    if (FAILED(hr) && error) {
+        std::wostringstream oss;
+        oss << "Compilation error: " << static_cast<char*>(error->GetBufferPointer()) << std::endl;
+        OutputDebugString(oss.str().c_str());
+    }
+
+    ValidateResult(hr);
+
+    return shader;
+}
+
 ComPtr<IDXGIFactory6> CreateFactory()
 {
     ComPtr<IDXGIFactory6> factory;
@@ -97,7 +166,18 @@ Microsoft::WRL::ComPtr<ID3D12Resource> CreateBuffer(ID3D12Device& device, uint64
     auto heap_properties = CD3DX12_HEAP_PROPERTIES(heap_type);
     auto desc = CD3DX12_RESOURCE_DESC::Buffer(size);
     ValidateResult(device.CreateCommittedResource(&heap_properties, D3D12_HEAP_FLAG_NONE, &desc, initial_state, nullptr, IID_PPV_ARGS(&buffer)));
+    TrackGpuMemory(*buffer.Get(), MemoryTag::GpuBuffer);
     return buffer;
 }
 
+void TrackGpuMemory(ID3D12Resource& resource, MemoryTag tag)
+{
+    const auto desc = resource.GetDesc();
+    const auto size = GetDevice(resource)->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+
+    ComPtr<IUnknown> record;
+    record.Attach(new GpuMemoryRecord(tag, size));
+    ValidateResult(resource.SetPrivateDataInterface(s_gpu_memory_record_guid, record.Get()));
+}
+
 }  // namespace ddn
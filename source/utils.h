@@ -1,11 +1,15 @@
 #pragma once
 
+#include "memory-tracker.h"
+
 #include <wrl.h>
 #include <dxgi1_6.h>
 #include <directx/d3dx12.h>
 #include <Windows.h>
 
+#include <span>
 #include <string>
+#include <cstdint>
 #include <filesystem>
 
 namespace ddn
@@ -14,6 +18,7 @@ namespace ddn
 void ValidateResult(HRESULT hr);
 
 Microsoft::WRL::ComPtr<ID3DBlob> CompileShader(const std::filesystem::path& file_path, const std::string& entry_point, const std::string& compiler_target);
+Microsoft::WRL::ComPtr<ID3DBlob> CompileShader(std::span<const uint8_t> source, const std::string& source_name, const std::string& entry_point, const std::string& compiler_target);
 
 Microsoft::WRL::ComPtr<IDXGIFactory6> CreateFactory();
 
@@ -23,4 +28,8 @@ Microsoft::WRL::ComPtr<ID3D12Device> GetDevice(ID3D12DeviceChild& device_child);
 
 Microsoft::WRL::ComPtr<ID3D12Resource> CreateBuffer(ID3D12Device& device, uint64_t size, D3D12_HEAP_TYPE heap_type, D3D12_RESOURCE_STATES initial_state);
 
+// Charges the resource's allocation size to a GPU memory tag until the resource is destroyed. Tracking a
+// resource again replaces its previous record.
+void TrackGpuMemory(ID3D12Resource& resource, MemoryTag tag);
+
 }  // namespace ddn
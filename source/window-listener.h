@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ddn
+{
+
+class IWindowListener
+{
+public:
+    virtual void OnResize(uint32_t width, uint32_t height) {}
+    virtual void OnUpdate() {}
+    virtual void OnRender() {}
+    virtual void OnDestroy() {}
+    virtual void OnKeyDown(uint8_t key_code) {}
+    virtual void OnKeyUp(uint8_t key_code) {}
+};
+
+}  // namespace ddn
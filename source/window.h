@@ -1,6 +1,7 @@
 #pragma once
 
 #include "event-emitter.h"
+#include "window-listener.h"
 
 #include <Windows.h>
 
@@ -11,17 +12,6 @@
 namespace ddn
 {
 
-class IWindowListener
-{
-public:
-    virtual void OnResize(uint32_t width, uint32_t height) {}
-    virtual void OnUpdate() {}
-    virtual void OnRender() {}
-    virtual void OnDestroy() {}
-    virtual void OnKeyDown(uint8_t key_code) {}
-    virtual void OnKeyUp(uint8_t key_code) {}
-};
-
 class Window
     : public EventEmitter<IWindowListener>
 {